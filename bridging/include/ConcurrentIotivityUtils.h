@@ -90,13 +90,20 @@ namespace OC
                 {
                     while (!m_shutDownOCProcessThread)
                     {
+                        OCStackResult result;
+                        uint32_t timeout;
                         {
                             std::lock_guard<std::mutex> lock(m_iotivityApiCallMutex);
-                            OCProcess();
+                            result = OCProcess();
+                            timeout = OCGetProcessTimeout();
                         }
-                        // Hopefully it's enough for other threads to be scheduled
+                        // Wait for the next request or timer, or poll if the stack cannot
+                        // wait. Hopefully it's enough for other threads to be scheduled
                         // instead of the spin here. OCProcess is very lightweight though.
-                        usleep(OCPROCESS_SLEEP_MICROSECONDS);
+                        if (OC_STACK_OK != result || OC_STACK_OK != OCProcessWait(timeout))
+                        {
+                            usleep(OCPROCESS_SLEEP_MICROSECONDS);
+                        }
                     }
                 }
 
@@ -51,6 +51,12 @@ namespace OC
        return OC_STACK_OK;
     }
 
+    OCStackResult InProcClientWrapper::GetCallbackStats(CallbackStats& stats)
+    {
+       OC_UNUSED(stats);
+       return OC_STACK_NOTIMPL;
+    }
+
     void InProcClientWrapper::listeningFunc()
     {
     }
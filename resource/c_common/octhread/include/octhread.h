@@ -93,6 +93,15 @@ OCThreadResult_t oc_thread_free(oc_thread t);
  */
 OCThreadResult_t oc_thread_wait(oc_thread t);
 
+/**
+ * Check whether the calling thread is a given thread
+ *
+ * @param[in] t The thread to compare with the calling thread
+ * @return true if the calling thread is t, false otherwise
+ *
+ */
+bool oc_thread_is_current(oc_thread t);
+
 /**
  * Creates new mutex.
  *
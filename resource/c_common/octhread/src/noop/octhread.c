@@ -74,6 +74,11 @@ OCThreadResult_t oc_thread_wait(oc_thread t)
     return OC_THREAD_INVALID;
 }
 
+bool oc_thread_is_current(oc_thread t)
+{
+    return false;
+}
+
 oc_mutex oc_mutex_new(void)
 {
     return (oc_mutex)&g_mutexInfo;
@@ -179,6 +179,12 @@ OCThreadResult_t oc_thread_wait(oc_thread t)
     return res;
 }
 
+bool oc_thread_is_current(oc_thread t)
+{
+    oc_thread_internal *threadInfo = (oc_thread_internal*) t;
+    return threadInfo && pthread_equal(threadInfo->thread, pthread_self());
+}
+
 oc_mutex oc_mutex_new(void)
 {
     oc_mutex retVal = NULL;
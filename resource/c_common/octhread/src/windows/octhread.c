@@ -131,6 +131,12 @@ OCThreadResult_t oc_thread_wait(oc_thread t)
     return res;
 }
 
+bool oc_thread_is_current(oc_thread t)
+{
+    oc_thread_internal *threadInfo = (oc_thread_internal*) t;
+    return threadInfo && (GetThreadId(threadInfo->handle) == GetCurrentThreadId());
+}
+
 oc_mutex oc_mutex_new(void)
 {
     oc_mutex retVal = NULL;
@@ -542,23 +542,6 @@ typedef struct
     uint16_t port;      /**< socket port */
 } CASocket_t;
 
-#define HISTORYSIZE (4)
-
-typedef struct
-{
-    CATransportFlags_t flags;
-    uint16_t messageId;
-    char token[CA_MAX_TOKEN_LEN];
-    uint8_t tokenLength;
-    uint32_t ifindex;
-} CAHistoryItem_t;
-
-typedef struct
-{
-    int nextIndex;
-    CAHistoryItem_t items[HISTORYSIZE];
-} CAHistory_t;
-
 /**
  * Hold interface index for keeping track of comings and goings.
  */
@@ -637,11 +620,6 @@ typedef struct
         } nm;
     } ip;
 
-    struct calayer
-    {
-        CAHistory_t requestHistory;  /**< filter IP family in requests */
-    } ca;
-
 #ifdef TCP_ADAPTER
     /**
      * Hold global variables for TCP Adapter.
@@ -231,6 +231,20 @@ CATransportAdapter_t CAGetSelectedNetwork();
  */
 CAResult_t CAHandleRequestResponse();
 
+/**
+ * Wait until there is a request or response for CAHandleRequestResponse() to handle,
+ * CAWakeUpRequestResponse() is called or the timeout elapses.
+ * @param[in] timeoutMs    maximum time to wait in milliseconds.
+ * @return   ::CA_STATUS_OK, ::CA_NOT_SUPPORTED or ::CA_STATUS_NOT_INITIALIZED
+ */
+CAResult_t CAWaitRequestResponse(uint32_t timeoutMs);
+
+/**
+ * Make a caller waiting in CAWaitRequestResponse() return.
+ * @return   ::CA_STATUS_OK, ::CA_NOT_SUPPORTED or ::CA_STATUS_NOT_INITIALIZED
+ */
+CAResult_t CAWakeUpRequestResponse();
+
 #ifdef RA_ADAPTER
 /**
  * Set Remote Access information for XMPP Client.
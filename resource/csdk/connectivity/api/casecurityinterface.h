@@ -161,6 +161,14 @@ typedef void (*CAgetPkixInfoHandler)(PkiInfo_t * inf);
  */
 CAResult_t CAregisterPkixInfoHandler(CAgetPkixInfoHandler getPkixInfoHandler);
 
+/**
+ * Notify that the PKIX related info returned by the registered handler has changed.
+ * The SSL adapter keeps the parsed certificates, key and CRL until this is called,
+ * and drops the sessions kept for resumption.
+ * @return  ::CA_STATUS_OK or appropriate error code.
+ */
+CAResult_t CAnotifyPkixInfoChanged();
+
 /**
  * Select the cipher suite for dtls handshake.
  *
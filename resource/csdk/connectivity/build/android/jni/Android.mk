@@ -142,7 +142,7 @@ LOCAL_CFLAGS += -std=c99 -DWITH_POSIX -DWITH_BWT
 LOCAL_SRC_FILES = \
                 caconnectivitymanager.c cainterfacecontroller.c \
                 camessagehandler.c canetworkconfigurator.c caprotocolmessage.c \
-                caretransmission.c caqueueingthread.c cablockwisetransfer.c \
+                caretransmission.c caduplicatecache.c caqueueingthread.c cablockwisetransfer.c \
                 $(ADAPTER_UTILS)/caadapternetdtls.c $(ADAPTER_UTILS)/caadapterutils.c \
                 bt_le_adapter/caleadapter.c $(LE_ADAPTER_PATH)/caleclient.c \
                 $(LE_ADAPTER_PATH)/caleserver.c $(LE_ADAPTER_PATH)/caleutils.c \
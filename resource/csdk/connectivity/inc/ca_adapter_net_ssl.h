@@ -38,6 +38,15 @@ typedef void (*CAPacketReceivedCallback)(const CASecureEndpoint_t *sep,
 typedef ssize_t (*CAPacketSendCallback)(CAEndpoint_t *endpoint,
                                         const void *data, size_t dataLength);
 
+/**
+ * Counters of the completed (D)TLS handshakes.
+ */
+typedef struct
+{
+    uint64_t fullHandshakes;        /**< handshakes which exchanged and verified credentials. */
+    uint64_t resumedHandshakes;     /**< handshakes which resumed a previous session. */
+} CASslHandshakeStats_t;
+
 /**
  * Select the cipher suite for dtls handshake
  *
@@ -209,6 +218,36 @@ bool SetCASecureEndpointAttribute(const CAEndpoint_t* peer, uint32_t newAttribut
  */
 bool GetCASecureEndpointAttributes(const CAEndpoint_t* peer, uint32_t* allAttributes);
 
+/**
+ * Reports a change of the PKIX info returned by the callback set with CAsetPkixInfoCallback().
+ * The cached certificates, key and CRL are parsed again on the next handshake, and the
+ * sessions kept for resumption are dropped.
+ */
+void CAinvalidateSslPkixInfo();
+
+/**
+ * Configures the resumption of certificate based (D)TLS sessions.
+ *
+ * The server side keeps sessions in a cache and issues session tickets; the client side
+ * keeps one session per server endpoint. PSK and anonymous sessions are never resumed.
+ * May be called before CAinitSslAdapter() or at any time afterwards.
+ *
+ * @param[in] lifetime  lifetime of a session in seconds, 0 disables resumption
+ * @param[in] capacity  number of sessions kept on each side, 0 disables resumption
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CAsetSslSessionCacheConfig(uint32_t lifetime, uint32_t capacity);
+
+/**
+ * Gets the number of full and resumed handshakes completed since CAinitSslAdapter().
+ *
+ * @param[out] stats  handshake counters
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CAgetSslHandshakeStats(CASslHandshakeStats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif //__cplusplus
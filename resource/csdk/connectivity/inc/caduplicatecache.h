@@ -0,0 +1,116 @@
+/******************************************************************
+ *
+ * Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ * This file contains the cache of received requests used to drop duplicate messages.
+ */
+
+#ifndef CA_DUPLICATE_CACHE_H_
+#define CA_DUPLICATE_CACHE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "octhread.h"
+#include "cacommon.h"
+
+/** Counters of the duplicate request detection. **/
+typedef struct
+{
+    /** Number of requests currently remembered. **/
+    uint32_t entries;
+    /** Number of duplicate requests dropped. **/
+    uint64_t duplicates;
+    /** Number of requests forgotten before their lifetime because the cache was full. **/
+    uint64_t evicted;
+} CADuplicateStats_t;
+
+/** remembered request, defined in caduplicatecache.c. **/
+struct CADuplicateEntry;
+
+typedef struct
+{
+    /** How long a received request is remembered, in milliseconds. **/
+    uint64_t lifetimeMs;
+
+    /** Maximum number of remembered requests, the oldest one is forgotten first. **/
+    uint32_t maxEntries;
+
+    /** Remembered requests hashed by key. **/
+    struct CADuplicateEntry *index;
+
+    /** Remembered requests, oldest first. **/
+    struct CADuplicateEntry *list;
+
+    /** Counters of the cache. **/
+    CADuplicateStats_t stats;
+
+#ifndef SINGLE_THREAD
+    /** Requests are received on the threads of all adapters. **/
+    oc_mutex mutex;
+#endif
+} CADuplicateCache_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Initializes the duplicate cache.
+ * @param[in]   cache           duplicate cache.
+ * @param[in]   lifetimeMs      how long a received request is remembered.
+ * @param[in]   maxEntries      maximum number of remembered requests.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CADuplicateCacheInitialize(CADuplicateCache_t *cache,
+                                      uint64_t lifetimeMs, uint32_t maxEntries);
+
+/**
+ * Remember a received request and check whether it was received before.
+ * @param[in]   cache           duplicate cache.
+ * @param[in]   endpoint        sender of the request.
+ * @param[in]   id              message ID of the request.
+ * @param[in]   token           token of the request.
+ * @param[in]   tokenLength     length of the token.
+ * @return  true if the request is a duplicate to be dropped.
+ */
+bool CADuplicateCacheCheck(CADuplicateCache_t *cache, const CAEndpoint_t *endpoint,
+                           uint16_t id, CAToken_t token, uint8_t tokenLength);
+
+/**
+ * Get the counters of the duplicate cache.
+ * @param[in]   cache           duplicate cache.
+ * @param[out]  stats           current counters.
+ */
+void CADuplicateCacheGetStats(CADuplicateCache_t *cache, CADuplicateStats_t *stats);
+
+/**
+ * Forget all requests and release the duplicate cache.
+ * @param[in]   cache           duplicate cache.
+ */
+void CADuplicateCacheDestroy(CADuplicateCache_t *cache);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* CA_DUPLICATE_CACHE_H_ */
@@ -27,6 +27,7 @@
 #define CA_MESSAGE_HANDLER_H_
 
 #include "cacommon.h"
+#include "caduplicatecache.h"
 #include <coap/coap.h>
 
 #define CA_MEMORY_ALLOC_CHECK(arg) { if (NULL == arg) {OIC_LOG(ERROR, TAG, "Out of memory"); \
@@ -91,6 +92,27 @@ void CATerminateMessageHandler();
  */
 void CAHandleRequestResponseCallbacks();
 
+/**
+ * Wait until CAHandleRequestResponseCallbacks() has data to handle,
+ * CAWakeUpRequestResponseCallbacks() is called or the timeout elapses.
+ * @param[in] timeoutMs    maximum time to wait in milliseconds.
+ * @return  ::CA_STATUS_OK, or ::CA_NOT_SUPPORTED when the received data is not
+ *          handled by CAHandleRequestResponseCallbacks().
+ */
+CAResult_t CAWaitRequestResponseCallbacks(uint32_t timeoutMs);
+
+/**
+ * Make a caller waiting in CAWaitRequestResponseCallbacks() return.
+ * @return  ::CA_STATUS_OK or ::CA_NOT_SUPPORTED.
+ */
+CAResult_t CAWakeUpRequestResponseCallbacks();
+
+/**
+ * Get the counters of the duplicate request detection.
+ * @param[out] stats    counters.
+ */
+void CAGetDuplicateStats(CADuplicateStats_t *stats);
+
 /**
  * Setting the Callback funtion for network state change callback.
  * @param[in] nwMonitorHandler    callback for network state change.
@@ -44,6 +44,37 @@ typedef void (*CAThreadTask)(void *threadData);
 /** Data destroy function. **/
 typedef void (*CADataDestroyFunction)(void *data, uint32_t size);
 
+/** Function selecting queued data to remove, returns true if the data matches. **/
+typedef bool (*CAQueueingThreadDataMatch)(void *data, uint32_t size, void *ctx);
+
+/**
+ * Number of slots in the lock-free ring of each queueing thread.  Must be a power of two.
+ * Data added while the ring is full is kept on the locked overflow queue.
+ */
+#ifndef CA_QUEUEING_THREAD_RING_SIZE
+#define CA_QUEUEING_THREAD_RING_SIZE (256)
+#endif
+
+/** Slot of the lock-free ring, private to caqueueingthread.c. **/
+typedef struct CAQueueingThreadSlot CAQueueingThreadSlot_t;
+
+/** Queue depth and latency counters of a queueing thread. **/
+typedef struct
+{
+    /** Number of data currently queued. **/
+    uint32_t depth;
+    /** Highest number of data queued at once. **/
+    uint32_t maxDepth;
+    /** Number of data handed to the thread task so far. **/
+    uint64_t dequeued;
+    /** Number of data that went to the overflow queue because the ring was full. **/
+    uint64_t overflowed;
+    /** Sum of the time data spent in the ring before being dequeued, in microseconds. **/
+    uint64_t totalLatencyUs;
+    /** Longest time data spent in the ring before being dequeued, in microseconds. **/
+    uint64_t maxLatencyUs;
+} CAQueueingThreadStats_t;
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -58,8 +89,30 @@ typedef struct
     CADataDestroyFunction destroy;
     /** Variable to inform the thread to stop. **/
     bool isStop;
-    /** Que on which the thread is operating. **/
+    /** Overflow queue used while the ring is full, guarded by threadMutex. **/
     u_queue_t *dataQueue;
+    /** Lock-free ring the producers add data to. **/
+    CAQueueingThreadSlot_t *ring;
+    /** Next ring position claimed by a producer. **/
+    volatile int32_t enqueuePos;
+    /** Next ring position read by the consumer, guarded by threadMutex. **/
+    int32_t dequeuePos;
+    /** Number of data on the overflow queue. **/
+    volatile int32_t overflowCount;
+    /** Non-zero while the thread waits on threadCond for new data. **/
+    volatile int32_t sleeping;
+    /** Number of consumers waiting in CAQueueingThreadWaitData(). **/
+    volatile int32_t waiters;
+    /** Set by CAQueueingThreadWakeUp() until a waiting consumer returns, guarded by threadMutex. **/
+    bool wakeUp;
+    /** Number of times the thread polls the ring before it sleeps. **/
+    uint32_t spinLimit;
+    /** Number of data queued. **/
+    volatile int32_t depth;
+    /** Highest value of depth. **/
+    volatile int32_t maxDepth;
+    /** Consumer side counters, guarded by threadMutex. **/
+    CAQueueingThreadStats_t stats;
 } CAQueueingThread_t;
 
 /**
@@ -89,6 +142,52 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread);
  */
 CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint32_t size);
 
+/**
+ * Take the oldest queued data for processing outside of the queuing thread, when it
+ * is not started.  The caller owns the returned data.
+ * @param[in]   thread       thread data to take the data from.
+ * @param[out]  data         oldest queued data.
+ * @param[out]  size         length of the data.
+ * @return  CA_STATUS_OK, or CA_STATUS_FAILED if nothing is queued.
+ */
+CAResult_t CAQueueingThreadGetData(CAQueueingThread_t *thread, void **data, uint32_t *size);
+
+/**
+ * Wait until data is queued, CAQueueingThreadWakeUp() is called or the timeout elapses.
+ * For consumers taking the data with CAQueueingThreadGetData() while the queuing thread
+ * is not started.
+ * @param[in]   thread       thread data to wait for.
+ * @param[in]   timeoutUs    maximum time to wait in microseconds, 0 to return at once.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadWaitData(CAQueueingThread_t *thread, uint64_t timeoutUs);
+
+/**
+ * Make the consumers waiting in CAQueueingThreadWaitData() return, or the next one to
+ * wait if none is waiting.
+ * @param[in]   thread       thread data the consumers wait for.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadWakeUp(CAQueueingThread_t *thread);
+
+/**
+ * Remove and destroy the queued data selected by a match function.
+ * @param[in]   thread       thread data to remove the data from.
+ * @param[in]   match        function returning true for the data to remove.
+ * @param[in]   ctx          context passed to the match function.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadClearContextData(CAQueueingThread_t *thread,
+                                            CAQueueingThreadDataMatch match, void *ctx);
+
+/**
+ * Get the queue depth and latency counters of the queuing thread.
+ * @param[in]   thread       thread data to get the counters of.
+ * @param[out]  stats        counters.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadGetStats(CAQueueingThread_t *thread, CAQueueingThreadStats_t *stats);
+
 /**
  * Stop the queuing thread.
  * @param[in]   thread       thread data that needs to be started.
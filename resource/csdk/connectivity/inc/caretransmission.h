@@ -68,6 +68,22 @@ typedef struct
 
 } CARetransmissionConfig_t;
 
+typedef struct
+{
+    /** number of CON messages sent again after their ACK timeout. **/
+    uint32_t retransmitCount;
+
+    /** number of CON messages dropped after the last retransmission. **/
+    uint32_t timeoutCount;
+
+    /** number of CON messages currently waiting for ACK or RST. **/
+    uint32_t queueDepth;
+
+} CARetransmissionStats_t;
+
+/** pending CON message, defined in caretransmission.c. **/
+struct CARetransmissionData;
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -91,8 +107,20 @@ typedef struct
     /** Variable to inform the thread to stop. **/
     bool isStop;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** pending CON messages as a binary min-heap on next retransmission time. **/
+    struct CARetransmissionData **dataHeap;
+
+    /** number of entries in dataHeap. **/
+    size_t dataHeapSize;
+
+    /** allocated capacity of dataHeap. **/
+    size_t dataHeapCapacity;
+
+    /** pending CON messages hashed by message id and transport adapter. **/
+    struct CARetransmissionData *dataIndex;
+
+    /** retransmission counters. **/
+    CARetransmissionStats_t stats;
 
 } CARetransmission_t;
 
@@ -167,6 +195,15 @@ CAResult_t CARetransmissionStop(CARetransmission_t *context);
  */
 CAResult_t CARetransmissionDestroy(CARetransmission_t *context);
 
+/**
+ * Get the retransmission counters.
+ * @param[in]   context         context for retransmission.
+ * @param[out]  stats           current counters.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CARetransmissionGetStats(CARetransmission_t *context,
+                                    CARetransmissionStats_t *stats);
+
 /**
  * Invoke Retransmission according to TimedAction Response.
  * @param[in]   threadValue     context for retransmission.
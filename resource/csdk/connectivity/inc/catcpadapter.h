@@ -29,6 +29,7 @@
 #include "caadapterinterface.h"
 #include "cathreadpool.h"
 #include "cainterface.h"
+#include <coap/uthash.h>
 #include <coap/pdu.h>
 
 #ifdef __cplusplus
@@ -54,6 +55,26 @@ typedef enum
     DISCONNECTED
 } CATCPConnectionState_t;
 
+/**
+ * Data waiting to be written to a TCP session.
+ */
+typedef struct CATCPSendItem_t
+{
+    unsigned char *data;                /**< data to send */
+    size_t len;                         /**< data length */
+    size_t offset;                      /**< number of bytes already sent */
+    struct CATCPSendItem_t *next;       /**< next data to send */
+} CATCPSendItem_t;
+
+/**
+ * Key of the TCP session index.
+ */
+typedef struct
+{
+    char addr[MAX_ADDR_STR_SIZE_CA];    /**< remote address */
+    uint16_t port;                      /**< remote port */
+} CATCPSessionKey_t;
+
 /**
  * TCP Session Information for IPv4/IPv6 TCP transport
  */
@@ -69,6 +90,13 @@ typedef struct CATCPSessionInfo_t
     CAProtocol_t protocol;              /**< application-level protocol */
     CATCPConnectionState_t state;       /**< current tcp session state */
     bool isClient;                      /**< Host Mode of Operation. */
+    CATCPSendItem_t *sendQueue;         /**< data waiting for the socket to be writable */
+    size_t sendQueueLen;                /**< number of bytes in sendQueue */
+    CATCPSessionKey_t key;              /**< key in the session index */
+    struct CATCPSessionInfo_t *keyNext; /**< next session with the same key */
+    UT_hash_handle hh;                  /**< session index, keyed by address and port */
+    UT_hash_handle hhFd;                /**< session index, keyed by file descriptor */
+    struct CATCPSessionInfo_t *prev;    /**< Linked list; for multiple session list. */
     struct CATCPSessionInfo_t *next;    /**< Linked list; for multiple session list. */
 } CATCPSessionInfo_t;
 
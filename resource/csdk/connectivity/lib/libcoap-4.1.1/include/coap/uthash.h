@@ -67,6 +67,11 @@ typedef unsigned int uint32_t;
 #ifndef uthash_fatal
 #define uthash_fatal(msg) exit(-1)        /* fatal error (out of memory,etc) */
 #endif
+#if defined(__GNUC__) && (__GNUC__ >= 7)
+#define UTHASH_FALLTHROUGH __attribute__ ((fallthrough))
+#else
+#define UTHASH_FALLTHROUGH
+#endif
 #define uthash_malloc(sz) malloc(sz)      /* malloc fcn                      */
 #define uthash_free(ptr,sz) free(ptr)     /* free fcn                        */
 
@@ -409,16 +414,16 @@ do {
   }                                                                              \
   hashv += keylen;                                                               \
   switch ( _hj_k ) {                                                             \
-     case 11: hashv += ( (unsigned)_hj_key[10] << 24 );                          \
-     case 10: hashv += ( (unsigned)_hj_key[9] << 16 );                           \
-     case 9:  hashv += ( (unsigned)_hj_key[8] << 8 );                            \
-     case 8:  _hj_j += ( (unsigned)_hj_key[7] << 24 );                           \
-     case 7:  _hj_j += ( (unsigned)_hj_key[6] << 16 );                           \
-     case 6:  _hj_j += ( (unsigned)_hj_key[5] << 8 );                            \
-     case 5:  _hj_j += _hj_key[4];                                               \
-     case 4:  _hj_i += ( (unsigned)_hj_key[3] << 24 );                           \
-     case 3:  _hj_i += ( (unsigned)_hj_key[2] << 16 );                           \
-     case 2:  _hj_i += ( (unsigned)_hj_key[1] << 8 );                            \
+     case 11: hashv += ( (unsigned)_hj_key[10] << 24 ); UTHASH_FALLTHROUGH;      \
+     case 10: hashv += ( (unsigned)_hj_key[9] << 16 ); UTHASH_FALLTHROUGH;       \
+     case 9:  hashv += ( (unsigned)_hj_key[8] << 8 ); UTHASH_FALLTHROUGH;        \
+     case 8:  _hj_j += ( (unsigned)_hj_key[7] << 24 ); UTHASH_FALLTHROUGH;       \
+     case 7:  _hj_j += ( (unsigned)_hj_key[6] << 16 ); UTHASH_FALLTHROUGH;       \
+     case 6:  _hj_j += ( (unsigned)_hj_key[5] << 8 ); UTHASH_FALLTHROUGH;        \
+     case 5:  _hj_j += _hj_key[4]; UTHASH_FALLTHROUGH;                           \
+     case 4:  _hj_i += ( (unsigned)_hj_key[3] << 24 ); UTHASH_FALLTHROUGH;       \
+     case 3:  _hj_i += ( (unsigned)_hj_key[2] << 16 ); UTHASH_FALLTHROUGH;       \
+     case 2:  _hj_i += ( (unsigned)_hj_key[1] << 8 ); UTHASH_FALLTHROUGH;        \
      case 1:  _hj_i += _hj_key[0];                                               \
   }                                                                              \
   HASH_JEN_MIX(_hj_i, _hj_j, hashv);                                             \
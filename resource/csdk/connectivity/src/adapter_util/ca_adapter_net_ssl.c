@@ -36,6 +36,15 @@
 #include "byte_array.h"
 #include "octhread.h"
 #include "octimer.h"
+#include "oic_time.h"
+#include <coap/uthash.h>
+
+/*
+ * uthash exits the process when it cannot allocate its table or buckets. Peers are only
+ * added through AddSslPeer(), which takes the jump and fails the operation instead.
+ */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
 
 // headers required for mbed TLS
 #include "mbedtls/platform.h"
@@ -44,6 +53,8 @@
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/pkcs12.h"
 #include "mbedtls/ssl_internal.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
 #include "mbedtls/net_sockets.h"
 #include "mbedtls/oid.h"
 #ifdef __WITH_DTLS__
@@ -175,6 +186,18 @@
  */
 #define RETRANSMISSION_TIME 1
 
+/**
+ * @def SSL_SESSION_LIFETIME
+ * @brief Default lifetime (in seconds) of the sessions kept for resumption.
+ */
+#define SSL_SESSION_LIFETIME (86400)
+
+/**
+ * @def SSL_SESSION_CACHE_SIZE
+ * @brief Default number of sessions kept for resumption on each of the server and client side.
+ */
+#define SSL_SESSION_CACHE_SIZE (50)
+
 /**@def SSL_CLOSE_NOTIFY(peer, ret)
  *
  * Notifies of existing \a peer about closing TLS connection.
@@ -374,7 +397,7 @@ typedef struct TlsCallBacks
  */
 typedef struct SslContext
 {
-    u_arraylist_t *peerList;         /**< peer list which holds the mapping between
+    struct SslEndPoint *peerTable;   /**< peers by n/w address, holds the mapping between
                                               peer id, it's n/w address and mbedTLS context. */
     mbedtls_entropy_context entropy;
     mbedtls_ctr_drbg_context rnd;
@@ -398,6 +421,20 @@ typedef struct SslContext
     int timerId;
 #endif
 
+    uint32_t pkixGeneration;                  /**< PKIX info generation ca, crt, pkey and crl
+                                                   were parsed from. */
+    uint32_t pkixLoadCount;                   /**< number of times the PKIX info was parsed,
+                                                   0 if it was never parsed. */
+    uint32_t pkixConfLoadCount[2];            /**< pkixLoadCount the TLS and DTLS configs use. */
+    int pkixResult;                           /**< result of parsing the PKIX info. */
+    bool ownCertLoaded;                       /**< crt and pkey hold a usable own certificate. */
+    bool crlLoaded;                           /**< crl holds a usable CRL. */
+
+    mbedtls_ssl_cache_context sessionCache;   /**< server sessions by session ID. */
+    mbedtls_ssl_ticket_context ticketCtx;     /**< keys protecting the server session tickets. */
+    u_arraylist_t *sessionList;               /**< client sessions kept for resumption. */
+    CASslHandshakeStats_t stats;
+
 } SslContext_t;
 
 /**
@@ -423,6 +460,12 @@ static CAgetCredentialTypesHandler g_getCredentialTypesCallback = NULL;
  */
 static CAgetPkixInfoHandler g_getPkixInfoCallback = NULL;
 
+/**
+ * @var g_pkixInfoGeneration
+ * @brief generation of the PKIX info, bumped whenever the data behind g_getPkixInfoCallback changes
+ */
+static uint32_t g_pkixInfoGeneration = 0;
+
 /**
  * @var g_dtlsContextMutex
  * @brief Mutex to synchronize access to g_caSslContext and g_sslCallback.
@@ -435,6 +478,18 @@ static oc_mutex g_sslContextMutex = NULL;
  */
 static CAErrorCallback g_sslCallback = NULL;
 
+/**
+ * @var g_sessionLifetime
+ * @brief lifetime (in seconds) of the sessions kept for resumption, 0 disables resumption
+ */
+static uint32_t g_sessionLifetime = SSL_SESSION_LIFETIME;
+
+/**
+ * @var g_sessionCacheSize
+ * @brief number of sessions kept for resumption, 0 disables resumption
+ */
+static uint32_t g_sessionCacheSize = SSL_SESSION_CACHE_SIZE;
+
 /**
  * Data structure for holding the data to be received.
  */
@@ -444,23 +499,46 @@ typedef struct SslRecBuf
     size_t len;
     size_t loaded;
 } SslRecBuf_t;
+/**
+ * Hash key of a peer, see SetSslPeerKey().
+ */
+typedef struct SslPeerKey
+{
+    CATransportAdapter_t adapter;
+    uint16_t port;                  /**< 0 for BLE, where peers are matched by address only. */
+    char addr[MAX_ADDR_STR_SIZE_CA];
+} SslPeerKey_t;
+
 /**
  * Data structure for holding the data related to endpoint
  * and TLS session.
  */
 typedef struct SslEndPoint
 {
-    mbedtls_ssl_context ssl;
+    mbedtls_ssl_context ssl;        /**< must stay first, mbedTLS callbacks cast it back. */
     CASecureEndpoint_t sep;
     u_arraylist_t * cacheList;
     SslRecBuf_t recBuf;
     uint8_t master[MASTER_SECRET_LEN];
     uint8_t random[2*RANDOM_LEN];
+    bool resumed;                   /**< the handshake resumes a previous session. */
 #ifdef __WITH_DTLS__
     mbedtls_timing_delay_context timer;
 #endif // __WITH_DTLS__
+    SslPeerKey_t key;
+    UT_hash_handle hh;
 } SslEndPoint_t;
 
+/**
+ * Data structure for holding a client session kept for resumption.
+ */
+typedef struct SslSession
+{
+    CAEndpoint_t endpoint;          /**< server the session was established with. */
+    mbedtls_ssl_session session;
+    uint64_t expiry;                /**< time (in ms) after which the session is not offered. */
+} SslSession_t;
+
 void CAsetPskCredentialsCallback(CAgetPskCredentialsHandler credCallback)
 {
     // TODO Does this method needs protection of tlsContextMutex?
@@ -473,6 +551,7 @@ void CAsetPkixInfoCallback(CAgetPkixInfoHandler infoCallback)
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     g_getPkixInfoCallback = infoCallback;
+    CAinvalidateSslPkixInfo();
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
 void CAsetCredentialTypesCallback(CAgetCredentialTypesHandler credTypesCallback)
@@ -647,11 +726,14 @@ static void DeInitPkixInfo(PkiInfo_t * inf)
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
 
-//Loads PKIX related information from SRM
-static int InitPKIX(CATransportAdapter_t adapter)
+/**
+ * Parses the PKIX related information from SRM into the SSL context.
+ *
+ * @return  0 on success or -1 if no trusted CA could be parsed
+ */
+static int LoadPkixInfo()
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
-    VERIFY_NON_NULL_RET(g_getPkixInfoCallback, NET_SSL_TAG, "PKIX info callback is NULL", -1);
     // load pk key, cert, trust chain and crl
     PkiInfo_t pkiInfo = {
         BYTE_ARRAY_INITIALIZER,
@@ -660,12 +742,7 @@ static int InitPKIX(CATransportAdapter_t adapter)
         BYTE_ARRAY_INITIALIZER
     };
 
-    if (g_getPkixInfoCallback)
-    {
-        g_getPkixInfoCallback(&pkiInfo);
-    }
-
-    VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", -1);
+    g_getPkixInfoCallback(&pkiInfo);
 
     mbedtls_x509_crt_free(&g_caSslContext->ca);
     mbedtls_x509_crt_free(&g_caSslContext->crt);
@@ -677,64 +754,31 @@ static int InitPKIX(CATransportAdapter_t adapter)
     mbedtls_pk_init(&g_caSslContext->pkey);
     mbedtls_x509_crl_init(&g_caSslContext->crl);
 
-    mbedtls_ssl_config * serverConf = (adapter == CA_ADAPTER_IP ||
-                                   adapter == CA_ADAPTER_GATT_BTLE ?
-                                   &g_caSslContext->serverDtlsConf : &g_caSslContext->serverTlsConf);
-    mbedtls_ssl_config * clientConf = (adapter == CA_ADAPTER_IP ||
-                                   adapter == CA_ADAPTER_GATT_BTLE ?
-                                   &g_caSslContext->clientDtlsConf : &g_caSslContext->clientTlsConf);
+    g_caSslContext->ownCertLoaded = false;
+    g_caSslContext->crlLoaded = false;
+
     // optional
-    int ret;
     int errNum;
     int count = ParseChain(&g_caSslContext->crt, pkiInfo.crt.data, pkiInfo.crt.len, &errNum);
     if (0 >= count)
     {
         OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate chain parsing error");
-        goto required;
     }
-    if (0 != errNum)
+    else if (0 != errNum)
     {
         OIC_LOG_V(WARNING, NET_SSL_TAG, "Own certificate chain parsing error: %d certs failed to parse", errNum);
-        goto required;
     }
-    ret =  mbedtls_pk_parse_key(&g_caSslContext->pkey, pkiInfo.key.data, pkiInfo.key.len,
-                                                                               NULL, 0);
-    if (0 != ret)
+    else if (0 != mbedtls_pk_parse_key(&g_caSslContext->pkey, pkiInfo.key.data, pkiInfo.key.len,
+                                                                               NULL, 0))
     {
         OIC_LOG(WARNING, NET_SSL_TAG, "Key parsing error");
-        goto required;
     }
-
-    ret = mbedtls_ssl_conf_own_cert(serverConf, &g_caSslContext->crt, &g_caSslContext->pkey);
-    if (0 != ret)
-    {
-        OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate parsing error");
-        goto required;
-    }
-    ret = mbedtls_ssl_conf_own_cert(clientConf, &g_caSslContext->crt, &g_caSslContext->pkey);
-    if(0 != ret)
-    {
-        OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate configuration error");
-        goto required;
-    }
-
-    /* If we get here, certificates could be used, so configure OCF EKUs. */
-    ret = mbedtls_ssl_conf_ekus(serverConf, (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY),
-        (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY));
-    if (0 == ret)
-    {
-        ret = mbedtls_ssl_conf_ekus(clientConf, (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY),
-            (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY));
-    }
-    if (0 != ret)
+    else
     {
-        /* Cert-based ciphersuites will fail, but if PSK ciphersuites are in
-         * the list they might work, so don't return error.
-         */
-        OIC_LOG(WARNING, NET_SSL_TAG, "EKU configuration error");
+        g_caSslContext->ownCertLoaded = true;
     }
 
-    required:
+    // required
     count = ParseChain(&g_caSslContext->ca, pkiInfo.ca.data, pkiInfo.ca.len, &errNum);
     if(0 >= count)
     {
@@ -748,16 +792,13 @@ static int InitPKIX(CATransportAdapter_t adapter)
         OIC_LOG_V(WARNING, NET_SSL_TAG, "CA chain parsing warning: %d certs failed to parse", errNum);
     }
 
-    ret = mbedtls_x509_crl_parse_der(&g_caSslContext->crl, pkiInfo.crl.data, pkiInfo.crl.len);
-    if(0 != ret)
+    if (0 != mbedtls_x509_crl_parse_der(&g_caSslContext->crl, pkiInfo.crl.data, pkiInfo.crl.len))
     {
         OIC_LOG(WARNING, NET_SSL_TAG, "CRL parsing error");
-        CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain, &g_caSslContext->ca, NULL);
     }
     else
     {
-        CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain,
-                 &g_caSslContext->ca, &g_caSslContext->crl);
+        g_caSslContext->crlLoaded = true;
     }
 
     DeInitPkixInfo(&pkiInfo);
@@ -766,6 +807,117 @@ static int InitPKIX(CATransportAdapter_t adapter)
     return 0;
 }
 
+/**
+ * Removes the own certificate entries of a configuration.
+ *
+ * mbedtls_ssl_conf_own_cert() appends to the list, so the entries of the previous
+ * ConfigurePkix() must go before the re-parsed certificate is configured.
+ *
+ * @param[in]  conf    configuration
+ */
+static void ClearOwnCert(mbedtls_ssl_config * conf)
+{
+    mbedtls_ssl_key_cert *cur = conf->key_cert;
+    while (NULL != cur)
+    {
+        mbedtls_ssl_key_cert *next = cur->next;
+        mbedtls_free(cur);
+        cur = next;
+    }
+    conf->key_cert = NULL;
+}
+
+/**
+ * Configures a client and server configuration with the parsed PKIX information.
+ *
+ * @param[in]  clientConf    client configuration
+ * @param[in]  serverConf    server configuration
+ */
+static void ConfigurePkix(mbedtls_ssl_config * clientConf, mbedtls_ssl_config * serverConf)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    ClearOwnCert(clientConf);
+    ClearOwnCert(serverConf);
+    if (g_caSslContext->ownCertLoaded)
+    {
+        int ret = mbedtls_ssl_conf_own_cert(serverConf, &g_caSslContext->crt, &g_caSslContext->pkey);
+        if (0 != ret)
+        {
+            OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate parsing error");
+        }
+        else
+        {
+            ret = mbedtls_ssl_conf_own_cert(clientConf, &g_caSslContext->crt, &g_caSslContext->pkey);
+            if (0 != ret)
+            {
+                OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate configuration error");
+            }
+        }
+
+        if (0 == ret)
+        {
+            /* Certificates could be used, so configure OCF EKUs. */
+            ret = mbedtls_ssl_conf_ekus(serverConf, (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY),
+                (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY));
+            if (0 == ret)
+            {
+                ret = mbedtls_ssl_conf_ekus(clientConf, (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY),
+                    (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY));
+            }
+            if (0 != ret)
+            {
+                /* Cert-based ciphersuites will fail, but if PSK ciphersuites are in
+                 * the list they might work, so don't return error.
+                 */
+                OIC_LOG(WARNING, NET_SSL_TAG, "EKU configuration error");
+            }
+        }
+    }
+
+    if (0 == g_caSslContext->pkixResult)
+    {
+        CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain, &g_caSslContext->ca,
+                 g_caSslContext->crlLoaded ? &g_caSslContext->crl : NULL);
+    }
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+}
+
+/**
+ * Loads PKIX related information from SRM.
+ *
+ * The information is parsed once and shared by all handshakes until CAinvalidateSslPkixInfo()
+ * reports a change, instead of being extracted from SRM and parsed for every handshake.
+ *
+ * @param[in]  adapter    the associated transport adapter
+ *
+ * @return  0 on success or -1 on error
+ */
+static int InitPKIX(CATransportAdapter_t adapter)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    VERIFY_NON_NULL_RET(g_getPkixInfoCallback, NET_SSL_TAG, "PKIX info callback is NULL", -1);
+    VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", -1);
+
+    if (0 == g_caSslContext->pkixLoadCount ||
+        g_pkixInfoGeneration != g_caSslContext->pkixGeneration)
+    {
+        g_caSslContext->pkixGeneration = g_pkixInfoGeneration;
+        g_caSslContext->pkixResult = LoadPkixInfo();
+        g_caSslContext->pkixLoadCount++;
+    }
+
+    bool datagram = (adapter == CA_ADAPTER_IP || adapter == CA_ADAPTER_GATT_BTLE);
+    if (g_caSslContext->pkixConfLoadCount[datagram] != g_caSslContext->pkixLoadCount)
+    {
+        ConfigurePkix(datagram ? &g_caSslContext->clientDtlsConf : &g_caSslContext->clientTlsConf,
+                      datagram ? &g_caSslContext->serverDtlsConf : &g_caSslContext->serverTlsConf);
+        g_caSslContext->pkixConfLoadCount[datagram] = g_caSslContext->pkixLoadCount;
+    }
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return g_caSslContext->pkixResult;
+}
+
 /*
  * PSK callback.
  *
@@ -807,6 +959,21 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
     OIC_LOG_V(WARNING, NET_SSL_TAG, "Out %s", __func__);
     return -1;
 }
+/**
+ * Builds the hash key of a peer.
+ *
+ * @param[out] key     hash key
+ * @param[in]  peer    remote address
+ */
+static void SetSslPeerKey(SslPeerKey_t *key, const CAEndpoint_t *peer)
+{
+    // The whole key is hashed, including padding and the bytes after the address.
+    memset(key, 0, sizeof(*key));
+    key->adapter = peer->adapter;
+    key->port = (CA_ADAPTER_GATT_BTLE == peer->adapter) ? 0 : peer->port;
+    strncpy(key->addr, peer->addr, sizeof(key->addr) - 1);
+}
+
 /**
  * Gets session corresponding for endpoint.
  *
@@ -816,8 +983,6 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
  */
 static SslEndPoint_t *GetSslPeer(const CAEndpoint_t *peer)
 {
-    size_t listIndex = 0;
-    size_t listLength = 0;
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
 
     oc_mutex_assert_owner(g_sslContextMutex, true);
@@ -825,31 +990,49 @@ static SslEndPoint_t *GetSslPeer(const CAEndpoint_t *peer)
     VERIFY_NON_NULL_RET(peer, NET_SSL_TAG, "TLS peer is NULL", NULL);
     VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", NULL);
 
+    SslPeerKey_t key;
+    SetSslPeerKey(&key, peer);
+
     SslEndPoint_t *tep = NULL;
-    listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (listIndex = 0; listIndex < listLength; listIndex++)
+    HASH_FIND(hh, g_caSslContext->peerTable, &key, sizeof(key), tep);
+    if (NULL == tep)
     {
-        tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
+        OIC_LOG(DEBUG, NET_SSL_TAG, "Return NULL");
+    }
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return tep;
+}
+
+/**
+ * Adds a peer to the peer table.
+ *
+ * @param[in]  tep    peer not yet in the table
+ *
+ * @return  true on success, false if the table could not be allocated or grown.
+ *          The peer is not in the table then.
+ */
+static bool AddSslPeer(SslEndPoint_t *tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
 
-        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Compare [%s:%d] and [%s:%d] for %d adapter",
-                  peer->addr, peer->port, tep->sep.endpoint.addr, tep->sep.endpoint.port,
-                  peer->adapter);
+    HASH_ADD(hh, g_caSslContext->peerTable, key, sizeof(tep->key), tep);
+    return true;
 
-        if((peer->adapter == tep->sep.endpoint.adapter)
-                && (0 == strncmp(peer->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA))
-                && (peer->port == tep->sep.endpoint.port || CA_ADAPTER_GATT_BTLE == peer->adapter))
-        {
-            OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-            return tep;
-        }
+uthash_oom:
+    if (g_caSslContext->peerTable == tep &&
+        (NULL == tep->hh.tbl || NULL == tep->hh.tbl->buckets))
+    {
+        // The table of the first peer could not be created.
+        uthash_free(tep->hh.tbl, sizeof(UT_hash_table));
+        g_caSslContext->peerTable = NULL;
     }
-    OIC_LOG(DEBUG, NET_SSL_TAG, "Return NULL");
-    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return NULL;
+    else
+    {
+        // The buckets could not be expanded, the peer was already linked in.
+        HASH_DEL(g_caSslContext->peerTable, tep);
+    }
+    OIC_LOG(ERROR, NET_SSL_TAG, "Peer table allocation failed!");
+    return false;
 }
 
 /**
@@ -1045,24 +1228,329 @@ static void RemovePeerFromList(CAEndpoint_t * endpoint)
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
     VERIFY_NON_NULL_VOID(endpoint, NET_SSL_TAG, "endpoint");
 
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
+    SslEndPoint_t * tep = GetSslPeer(endpoint);
+    if (NULL != tep)
+    {
+        HASH_DEL(g_caSslContext->peerTable, tep);
+        DeleteSslEndPoint(tep);
+    }
+}
+
+/**
+ * Checks whether sessions using a ciphersuite may be resumed.
+ *
+ * PSK and anonymous sessions are not resumed: ownership transfer derives the owner PSK
+ * from a full handshake, and the PSK identity of the peer is not kept in the session.
+ *
+ * @param[in]  ciphersuite    negotiated ciphersuite
+ *
+ * @return  true if the session may be resumed
+ */
+static bool IsResumableCiphersuite(int ciphersuite)
+{
+    return (MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256 != ciphersuite &&
+            MBEDTLS_TLS_ECDH_ANON_WITH_AES_128_CBC_SHA256 != ciphersuite);
+}
+
+/**
+ * Checks whether session resumption is enabled.
+ *
+ * @return  true if sessions are kept for resumption
+ */
+static bool IsResumptionEnabled()
+{
+    return (0 != g_sessionLifetime && 0 != g_sessionCacheSize);
+}
+
+/**
+ * Server session cache lookup, see mbedtls_ssl_conf_session_cache().
+ */
+static int GetCachedSession(void * cache, mbedtls_ssl_session * session)
+{
+    if (!IsResumptionEnabled())
+    {
+        return -1;
+    }
+    return mbedtls_ssl_cache_get(cache, session);
+}
+
+/**
+ * Server session cache store, see mbedtls_ssl_conf_session_cache().
+ */
+static int SetCachedSession(void * cache, const mbedtls_ssl_session * session)
+{
+    if (!IsResumptionEnabled() || !IsResumableCiphersuite(session->ciphersuite))
+    {
+        return 0;
+    }
+    return mbedtls_ssl_cache_set(cache, session);
+}
+
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+/**
+ * Server session ticket writer, see mbedtls_ssl_conf_session_tickets_cb().
+ * Refusing to write a ticket makes mbedTLS send an empty one.
+ */
+static int WriteSessionTicket(void * ticketCtx, const mbedtls_ssl_session * session,
+                              unsigned char * start, const unsigned char * end,
+                              size_t * tlen, uint32_t * lifetime)
+{
+    if (!IsResumptionEnabled() || !IsResumableCiphersuite(session->ciphersuite))
+    {
+        return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+    }
+    return mbedtls_ssl_ticket_write(ticketCtx, session, start, end, tlen, lifetime);
+}
+
+/**
+ * Server session ticket parser, see mbedtls_ssl_conf_session_tickets_cb().
+ * A ticket which is not accepted falls back to a full handshake.
+ */
+static int ParseSessionTicket(void * ticketCtx, mbedtls_ssl_session * session,
+                              unsigned char * buf, size_t len)
+{
+    if (!IsResumptionEnabled())
+    {
+        return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+    }
+    return mbedtls_ssl_ticket_parse(ticketCtx, session, buf, len);
+}
+#endif // MBEDTLS_SSL_SESSION_TICKETS
+
+/**
+ * Checks whether a kept client session belongs to a server endpoint.
+ *
+ * @param[in]  entry       kept session
+ * @param[in]  endpoint    remote address and identity
+ *
+ * @return  true if the session was established with the endpoint
+ */
+static bool IsSessionOfPeer(const SslSession_t * entry, const CAEndpoint_t * endpoint)
+{
+    return (entry->endpoint.adapter == endpoint->adapter
+            && entry->endpoint.port == endpoint->port
+            && 0 == strncmp(entry->endpoint.addr, endpoint->addr, MAX_ADDR_STR_SIZE_CA)
+            && 0 == strncmp(entry->endpoint.remoteId, endpoint->remoteId, CA_MAX_IDENTITY_SIZE));
+}
+
+/**
+ * Deletes a kept client session.
+ *
+ * @param[in]  entry    kept session
+ */
+static void DeleteSslSession(SslSession_t * entry)
+{
+    if (entry)
+    {
+        mbedtls_ssl_session_free(&entry->session);
+        OICFree(entry);
+    }
+}
+
+/**
+ * Removes the client session kept for an endpoint.
+ *
+ * @param[in]  endpoint    remote address and identity
+ */
+static void RemoveSslSession(const CAEndpoint_t * endpoint)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
+
+    if (NULL == g_caSslContext->sessionList)
+    {
+        return;
+    }
+
+    size_t listLength = u_arraylist_length(g_caSslContext->sessionList);
+    for (size_t listIndex = 0; listIndex < listLength; listIndex++)
+    {
+        SslSession_t * entry = (SslSession_t *)u_arraylist_get(g_caSslContext->sessionList,
+                                                               listIndex);
+        if (NULL != entry && IsSessionOfPeer(entry, endpoint))
+        {
+            u_arraylist_remove(g_caSslContext->sessionList, listIndex);
+            DeleteSslSession(entry);
+            return;
+        }
+    }
+}
+
+/**
+ * Removes the oldest client sessions until at most @p maxSessions are kept.
+ *
+ * @param[in]  maxSessions    number of sessions to keep
+ */
+static void TrimSslSessions(size_t maxSessions)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    while (u_arraylist_length(g_caSslContext->sessionList) > maxSessions)
+    {
+        DeleteSslSession((SslSession_t *)u_arraylist_remove(g_caSslContext->sessionList, 0));
+    }
+}
+
+/**
+ * Deletes all kept client sessions.
+ */
+static void DeleteSessionList()
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
+
+    if (NULL != g_caSslContext->sessionList)
+    {
+        TrimSslSessions(0);
+        u_arraylist_free(&g_caSslContext->sessionList);
+    }
+}
+
+/**
+ * Offers the session kept for the server of a client endpoint, so that the
+ * handshake can skip the certificate exchange.
+ *
+ * @param[in]  tep    client endpoint, before its first handshake step
+ */
+static void LoadSslSession(SslEndPoint_t * tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    if (!IsResumptionEnabled() || NULL == g_caSslContext->sessionList)
+    {
+        return;
+    }
+
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    size_t listLength = u_arraylist_length(g_caSslContext->sessionList);
     for (size_t listIndex = 0; listIndex < listLength; listIndex++)
     {
-        SslEndPoint_t * tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
+        SslSession_t * entry = (SslSession_t *)u_arraylist_get(g_caSslContext->sessionList,
+                                                               listIndex);
+        if (NULL == entry || !IsSessionOfPeer(entry, &tep->sep.endpoint))
         {
             continue;
         }
-        if(0 == strncmp(endpoint->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA)
-                && (endpoint->port == tep->sep.endpoint.port))
+        if (entry->expiry <= now)
         {
-            u_arraylist_remove(g_caSslContext->peerList, listIndex);
-            DeleteSslEndPoint(tep);
+            u_arraylist_remove(g_caSslContext->sessionList, listIndex);
+            DeleteSslSession(entry);
             return;
         }
+
+        // The session must use one of the ciphersuites currently allowed for this peer.
+        for (int i = 0; i < SSL_CIPHER_MAX && 0 != g_cipherSuitesList[i]; i++)
+        {
+            if (g_cipherSuitesList[i] == entry->session.ciphersuite)
+            {
+                if (0 != mbedtls_ssl_set_session(&tep->ssl, &entry->session))
+                {
+                    OIC_LOG(WARNING, NET_SSL_TAG, "Failed to offer kept session");
+                }
+                else
+                {
+                    OIC_LOG(DEBUG, NET_SSL_TAG, "Offering kept session");
+                }
+                break;
+            }
+        }
+        return;
     }
 }
 
+/**
+ * Keeps the session of a completed client handshake for resumption.
+ *
+ * @param[in]  tep    client endpoint, after its handshake
+ */
+static void SaveSslSession(SslEndPoint_t * tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    if (!IsResumptionEnabled() || NULL == g_caSslContext->sessionList
+        || NULL == tep->ssl.session || !IsResumableCiphersuite(tep->ssl.session->ciphersuite))
+    {
+        return;
+    }
+
+    RemoveSslSession(&tep->sep.endpoint);
+
+    SslSession_t * entry = (SslSession_t *) OICCalloc(1, sizeof(SslSession_t));
+    if (NULL == entry)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Malloc failed!");
+        return;
+    }
+    entry->endpoint = tep->sep.endpoint;
+    mbedtls_ssl_session_init(&entry->session);
+    if (0 != mbedtls_ssl_get_session(&tep->ssl, &entry->session))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Failed to copy session");
+        DeleteSslSession(entry);
+        return;
+    }
+    entry->expiry = OICGetCurrentTime(TIME_IN_MS) + (uint64_t)g_sessionLifetime * 1000;
+
+    // The oldest session makes room for the new one.
+    TrimSslSessions(g_sessionCacheSize - 1);
+    if (!u_arraylist_add(g_caSslContext->sessionList, (void *) entry))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
+        DeleteSslSession(entry);
+    }
+}
+
+/**
+ * Records whether the handshake in progress resumes a session. mbedTLS releases
+ * the handshake parameters once the handshake is over.
+ *
+ * @param[in]  tep    endpoint doing the handshake
+ */
+static void UpdateResumedState(SslEndPoint_t * tep)
+{
+    if (NULL != tep->ssl.handshake)
+    {
+        tep->resumed = (0 != tep->ssl.handshake->resume);
+    }
+}
+
+/**
+ * Applies the session lifetime and cache size to the resumption state.
+ */
+static void ApplySessionCacheConfig()
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    mbedtls_ssl_cache_set_timeout(&g_caSslContext->sessionCache, (int)g_sessionLifetime);
+    mbedtls_ssl_cache_set_max_entries(&g_caSslContext->sessionCache, (int)g_sessionCacheSize);
+    g_caSslContext->ticketCtx.ticket_lifetime = g_sessionLifetime;
+    if (NULL != g_caSslContext->sessionList)
+    {
+        TrimSslSessions(IsResumptionEnabled() ? g_sessionCacheSize : 0);
+    }
+}
+
+/**
+ * Sets up session resumption for a pair of client and server configurations.
+ *
+ * @param[in]  clientConf    client configuration
+ * @param[in]  serverConf    server configuration
+ */
+static void InitSessionResumption(mbedtls_ssl_config * clientConf, mbedtls_ssl_config * serverConf)
+{
+    mbedtls_ssl_conf_session_cache(serverConf, &g_caSslContext->sessionCache,
+                                   GetCachedSession, SetCachedSession);
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+    mbedtls_ssl_conf_session_tickets(clientConf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+    mbedtls_ssl_conf_session_tickets_cb(serverConf, WriteSessionTicket, ParseSessionTicket,
+                                        &g_caSslContext->ticketCtx);
+#else
+    OC_UNUSED(clientConf);
+#endif
+}
+
  /**
   * Checks handshake result. Removes peer from list and sends alert
   * if handshake failed.
@@ -1118,6 +1606,8 @@ static bool checkSslOperation(SslEndPoint_t*  peer,
         }
 
         RemovePeerFromList(&removedEndpoint);
+        // Do not offer a session the peer may have rejected.
+        RemoveSslSession(&removedEndpoint);
 
         oc_mutex_unlock(g_sslContextMutex);
         return false;
@@ -1135,14 +1625,11 @@ static void DeletePeerList()
 
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
 
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (size_t listIndex = 0; listIndex < listLength; listIndex++)
+    SslEndPoint_t * tep = NULL;
+    SslEndPoint_t * tmp = NULL;
+    HASH_ITER(hh, g_caSslContext->peerTable, tep, tmp)
     {
-        SslEndPoint_t * tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
+        HASH_DEL(g_caSslContext->peerTable, tep);
         if (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
         {
             int ret = 0;
@@ -1154,7 +1641,6 @@ static void DeletePeerList()
         }
         DeleteSslEndPoint(tep);
     }
-    u_arraylist_free(&g_caSslContext->peerList);
 }
 
 CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
@@ -1202,16 +1688,12 @@ void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
         return;
     }
 
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    OIC_LOG_V(DEBUG, NET_SSL_TAG,
-            "Required transport [%d], peer count [%" PRIuPTR "]", transportType, listLength);
-    for (size_t i = listLength; i > 0; i--)
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Required transport [%d], peer count [%u]", transportType,
+              HASH_COUNT(g_caSslContext->peerTable));
+    SslEndPoint_t *tep = NULL;
+    SslEndPoint_t *tmp = NULL;
+    HASH_ITER(hh, g_caSslContext->peerTable, tep, tmp)
     {
-        SslEndPoint_t *tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, i - 1);
-        if (NULL == tep)
-        {
-            continue;
-        }
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "SSL Connection [%s:%d], Transport [%d]",
                   tep->sep.endpoint.addr, tep->sep.endpoint.port, tep->sep.endpoint.adapter);
 
@@ -1230,8 +1712,8 @@ void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
         }
         while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);*/
 
-        // delete from list
-        u_arraylist_remove(g_caSslContext->peerList, i - 1);
+        // delete from table
+        HASH_DEL(g_caSslContext->peerTable, tep);
         DeleteSslEndPoint(tep);
     }
     oc_mutex_unlock(g_sslContextMutex);
@@ -1264,6 +1746,7 @@ static SslEndPoint_t * NewSslEndPoint(const CAEndpoint_t * endpoint, mbedtls_ssl
 
     tep->sep.endpoint = *endpoint;
     tep->sep.endpoint.flags = (CATransportFlags_t)(tep->sep.endpoint.flags | CA_SECURE);
+    SetSslPeerKey(&tep->key, endpoint);
 
     if(0 != mbedtls_ssl_setup(&tep->ssl, config))
     {
@@ -1472,18 +1955,19 @@ static SslEndPoint_t * InitiateTlsHandshake(const CAEndpoint_t *endpoint)
     }
 
     oc_mutex_lock(g_sslContextMutex);
-    ret = u_arraylist_add(g_caSslContext->peerList, (void *) tep);
-    if (!ret)
+    if (!AddSslPeer(tep))
     {
         oc_mutex_unlock(g_sslContextMutex);
-        OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
         DeleteSslEndPoint(tep);
         return NULL;
     }
 
+    LoadSslSession(tep);
+
     while (MBEDTLS_SSL_HANDSHAKE_OVER > tep->ssl.state)
     {
         ret = mbedtls_ssl_handshake_step(&tep->ssl);
+        UpdateResumedState(tep);
         if (MBEDTLS_ERR_SSL_CONN_EOF == ret)
         {
             break;
@@ -1536,6 +2020,7 @@ void CAdeinitSslAdapter()
 
     // Clear all lists
     DeletePeerList();
+    DeleteSessionList();
 
     // De-initialize mbedTLS
     mbedtls_x509_crt_free(&g_caSslContext->crt);
@@ -1549,6 +2034,8 @@ void CAdeinitSslAdapter()
     mbedtls_ssl_config_free(&g_caSslContext->serverDtlsConf);
     mbedtls_ssl_cookie_free(&g_caSslContext->cookieCtx);
 #endif // __WITH_DTLS__
+    mbedtls_ssl_cache_free(&g_caSslContext->sessionCache);
+    mbedtls_ssl_ticket_free(&g_caSslContext->ticketCtx);
     mbedtls_ctr_drbg_free(&g_caSslContext->rnd);
     mbedtls_entropy_free(&g_caSslContext->entropy);
 #ifdef __WITH_DTLS__
@@ -1586,6 +2073,10 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
     mbedtls_ssl_conf_rng(conf, mbedtls_ctr_drbg_random, &g_caSslContext->rnd);
     mbedtls_ssl_conf_curves(conf, curve[ADAPTER_CURVE_SECP256R1]);
     mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+    // Enabled with session resumption, see InitSessionResumption().
+    mbedtls_ssl_conf_session_tickets(conf, MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+#endif
 
 #ifdef __WITH_DTLS__
     if (MBEDTLS_SSL_TRANSPORT_DATAGRAM == transport &&
@@ -1614,9 +2105,8 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
  */
 static void StartRetransmit(void *ctx)
 {
-    size_t listIndex = 0;
-    size_t listLength = 0;
     SslEndPoint_t *tep = NULL;
+    SslEndPoint_t *tmp = NULL;
     OC_UNUSED(ctx);
 
     oc_mutex_lock(g_sslContextMutex);
@@ -1632,12 +2122,9 @@ static void StartRetransmit(void *ctx)
         //clear previous timer
         unregisterTimer(g_caSslContext->timerId);
 
-        listLength = u_arraylist_length(g_caSslContext->peerList);
-        for (listIndex = 0; listIndex < listLength; listIndex++)
+        HASH_ITER(hh, g_caSslContext->peerTable, tep, tmp)
         {
-            tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
-            if (NULL == tep
-                || (tep->ssl.conf && MBEDTLS_SSL_TRANSPORT_STREAM == tep->ssl.conf->transport)
+            if ((tep->ssl.conf && MBEDTLS_SSL_TRANSPORT_STREAM == tep->ssl.conf->transport)
                 || MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
             {
                 continue;
@@ -1695,20 +2182,6 @@ CAResult_t CAinitSslAdapter()
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    // Create peer list
-    g_caSslContext->peerList = u_arraylist_create();
-
-    if(NULL == g_caSslContext->peerList)
-    {
-        OIC_LOG(ERROR, NET_SSL_TAG, "peerList initialization failed!");
-        OICFree(g_caSslContext);
-        g_caSslContext = NULL;
-        oc_mutex_unlock(g_sslContextMutex);
-        oc_mutex_free(g_sslContextMutex);
-        g_sslContextMutex = NULL;
-        return CA_STATUS_FAILED;
-    }
-
     /* Initialize TLS library
      */
 #if !defined(NDEBUG) || defined(TB_LOG)
@@ -1721,6 +2194,9 @@ CAResult_t CAinitSslAdapter()
 #endif
 #endif
 
+    mbedtls_ssl_cache_init(&g_caSslContext->sessionCache);
+    mbedtls_ssl_ticket_init(&g_caSslContext->ticketCtx);
+
     /* Entropy settings
      */
     mbedtls_entropy_init(&g_caSslContext->entropy);
@@ -1791,6 +2267,28 @@ CAResult_t CAinitSslAdapter()
     }
 #endif // __WITH_DTLS__
 
+    /* Session resumption
+     */
+    g_caSslContext->sessionList = u_arraylist_create();
+    if (NULL == g_caSslContext->sessionList ||
+        0 != mbedtls_ssl_ticket_setup(&g_caSslContext->ticketCtx, mbedtls_ctr_drbg_random,
+                                      &g_caSslContext->rnd, MBEDTLS_CIPHER_AES_256_GCM,
+                                      g_sessionLifetime))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session resumption initialization failed!");
+        oc_mutex_unlock(g_sslContextMutex);
+        CAdeinitSslAdapter();
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return CA_STATUS_FAILED;
+    }
+    ApplySessionCacheConfig();
+#ifdef __WITH_TLS__
+    InitSessionResumption(&g_caSslContext->clientTlsConf, &g_caSslContext->serverTlsConf);
+#endif // __WITH_TLS__
+#ifdef __WITH_DTLS__
+    InitSessionResumption(&g_caSslContext->clientDtlsConf, &g_caSslContext->serverDtlsConf);
+#endif // __WITH_DTLS__
+
     // set default cipher
     g_caSslContext->cipher = SSL_CIPHER_MAX;
 
@@ -2044,10 +2542,8 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
             return CA_STATUS_FAILED;
         }
 
-        ret = u_arraylist_add(g_caSslContext->peerList, (void *) peer);
-        if (!ret)
+        if (!AddSslPeer(peer))
         {
-            OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
             DeleteSslEndPoint(peer);
             oc_mutex_unlock(g_sslContextMutex);
             return CA_STATUS_FAILED;
@@ -2075,6 +2571,7 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
                                                  sizeof(sep->endpoint.addr));
             ret = mbedtls_ssl_handshake_step(&peer->ssl);
         }
+        UpdateResumedState(peer);
         uint32_t flags = mbedtls_ssl_get_verify_result(&peer->ssl);
         if (0 != flags)
         {
@@ -2110,6 +2607,21 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
 
         if (MBEDTLS_SSL_HANDSHAKE_OVER == peer->ssl.state)
         {
+            if (peer->resumed)
+            {
+                g_caSslContext->stats.resumedHandshakes++;
+            }
+            else
+            {
+                g_caSslContext->stats.fullHandshakes++;
+            }
+            OIC_LOG_V(DEBUG, NET_SSL_TAG, "%s handshake completed",
+                      peer->resumed ? "Abbreviated" : "Full");
+            if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
+            {
+                SaveSslSession(peer);
+            }
+
             SSL_RES(peer, CA_STATUS_OK);
             if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
             {
@@ -2458,6 +2970,105 @@ CAResult_t CAinitiateSslHandshake(const CAEndpoint_t *endpoint)
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
     return res;
 }
+
+/**
+ * Drops the sessions kept for resumption and renews the session ticket keys, so that
+ * every peer goes through a full handshake with the current credentials.
+ */
+static void ResetSessionResumption()
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    if (NULL != g_caSslContext->sessionList)
+    {
+        TrimSslSessions(0);
+    }
+
+    mbedtls_ssl_cache_free(&g_caSslContext->sessionCache);
+    mbedtls_ssl_cache_init(&g_caSslContext->sessionCache);
+
+    mbedtls_ssl_ticket_free(&g_caSslContext->ticketCtx);
+    mbedtls_ssl_ticket_init(&g_caSslContext->ticketCtx);
+    if (0 != mbedtls_ssl_ticket_setup(&g_caSslContext->ticketCtx, mbedtls_ctr_drbg_random,
+                                      &g_caSslContext->rnd, MBEDTLS_CIPHER_AES_256_GCM,
+                                      g_sessionLifetime))
+    {
+        // Tickets can neither be issued nor accepted, handshakes fall back to the cache.
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session ticket setup failed!");
+    }
+    ApplySessionCacheConfig();
+}
+
+void CAinvalidateSslPkixInfo()
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    if (NULL == g_sslContextMutex)
+    {
+        g_pkixInfoGeneration++;
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return;
+    }
+
+    oc_mutex_lock(g_sslContextMutex);
+    g_pkixInfoGeneration++;
+    if (NULL != g_caSslContext)
+    {
+        // Sessions established with the previous credentials, trust anchors or CRLs
+        // must not be resumed, whether or not the PKIX info was cached.
+        ResetSessionResumption();
+    }
+    oc_mutex_unlock(g_sslContextMutex);
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+}
+
+CAResult_t CAsetSslSessionCacheConfig(uint32_t lifetime, uint32_t capacity)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    if (INT_MAX < lifetime || INT_MAX < capacity)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session cache lifetime or capacity too large");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL == g_sslContextMutex)
+    {
+        // Applied when the adapter is initialized.
+        g_sessionLifetime = lifetime;
+        g_sessionCacheSize = capacity;
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return CA_STATUS_OK;
+    }
+
+    oc_mutex_lock(g_sslContextMutex);
+    g_sessionLifetime = lifetime;
+    g_sessionCacheSize = capacity;
+    if (NULL != g_caSslContext)
+    {
+        ApplySessionCacheConfig();
+    }
+    oc_mutex_unlock(g_sslContextMutex);
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAgetSslHandshakeStats(CASslHandshakeStats_t *stats)
+{
+    VERIFY_NON_NULL_RET(stats, NET_SSL_TAG, "Param stats is NULL" , CA_STATUS_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(g_sslContextMutex, NET_SSL_TAG, "SSL context is not initialized",
+                        CA_STATUS_NOT_INITIALIZED);
+
+    oc_mutex_lock(g_sslContextMutex);
+    if (NULL == g_caSslContext)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "SSL context is not initialized.");
+        oc_mutex_unlock(g_sslContextMutex);
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+    *stats = g_caSslContext->stats;
+    oc_mutex_unlock(g_sslContextMutex);
+    return CA_STATUS_OK;
+}
 /**
  * Expands the secret into blocks of data according
  * to the algorithm specified in section 5 of RFC 4346
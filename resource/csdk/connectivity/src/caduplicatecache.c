@@ -0,0 +1,298 @@
+/******************************************************************
+ *
+ * Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "caduplicatecache.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "oic_time.h"
+#include <coap/uthash.h>
+#include <coap/utlist.h>
+#include "logger.h"
+
+/* A request that cannot be indexed is not remembered, see CADuplicateAdd(). */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
+
+#define TAG "OIC_CA_DUPLICATE"
+
+typedef struct
+{
+    CATransportAdapter_t adapter;
+    uint32_t ifindex;
+    uint16_t messageId;
+    uint8_t tokenLength;
+    char token[CA_MAX_TOKEN_LEN];
+} CADuplicateKey_t;
+
+typedef struct
+{
+    uint16_t port;
+    char addr[MAX_ADDR_STR_SIZE_CA];
+} CADuplicateSender_t;
+
+/**
+ * Received request remembered for duplicate detection.  The same request received over
+ * the other IP family is a duplicate too, so the sender address is not part of the key;
+ * the sender is remembered for each family instead.
+ */
+typedef struct CADuplicateEntry
+{
+    CADuplicateKey_t key;
+    bool multicast;
+    CADuplicateSender_t senders[2];
+    uint64_t receivedTime;
+    UT_hash_handle hh;
+    struct CADuplicateEntry *prev;
+    struct CADuplicateEntry *next;
+} CADuplicateEntry_t;
+
+static void CADuplicateLock(CADuplicateCache_t *cache)
+{
+#ifndef SINGLE_THREAD
+    oc_mutex_lock(cache->mutex);
+#else
+    (void)cache;
+#endif
+}
+
+static void CADuplicateUnlock(CADuplicateCache_t *cache)
+{
+#ifndef SINGLE_THREAD
+    oc_mutex_unlock(cache->mutex);
+#else
+    (void)cache;
+#endif
+}
+
+/** Index of the sender of the family of the endpoint in CADuplicateEntry_t::senders. **/
+static size_t CADuplicateFamily(const CAEndpoint_t *ep)
+{
+    return (ep->flags & CA_IPV6) ? 1 : 0;
+}
+
+static void CADuplicateRemove(CADuplicateCache_t *cache, CADuplicateEntry_t *entry)
+{
+    HASH_DELETE(hh, cache->index, entry);
+    DL_DELETE(cache->list, entry);
+    cache->stats.entries--;
+}
+
+static bool CADuplicateAdd(CADuplicateCache_t *cache, CADuplicateEntry_t *entry)
+{
+    HASH_ADD(hh, cache->index, key, sizeof(entry->key), entry);
+    DL_APPEND(cache->list, entry);
+    cache->stats.entries++;
+    return true;
+uthash_oom:
+    if (NULL == entry->hh.tbl || NULL == entry->hh.tbl->buckets)
+    {
+        // The table of the first entry could not be created.
+        uthash_free(entry->hh.tbl, sizeof(UT_hash_table));
+        cache->index = NULL;
+    }
+    else
+    {
+        // The buckets could not be expanded, the entry was already linked in.
+        HASH_DELETE(hh, cache->index, entry);
+    }
+    OIC_LOG(ERROR, TAG, "duplicate index allocation failed");
+    return false;
+}
+
+CAResult_t CADuplicateCacheInitialize(CADuplicateCache_t *cache,
+                                      uint64_t lifetimeMs, uint32_t maxEntries)
+{
+    if (NULL == cache || 0 == maxEntries)
+    {
+        OIC_LOG(ERROR, TAG, "invalid parameter");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    memset(cache, 0, sizeof(CADuplicateCache_t));
+    cache->lifetimeMs = lifetimeMs;
+    cache->maxEntries = maxEntries;
+
+#ifndef SINGLE_THREAD
+    cache->mutex = oc_mutex_new();
+    if (NULL == cache->mutex)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create duplicate message mutex");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+#endif
+
+    return CA_STATUS_OK;
+}
+
+/*
+ * If a second message arrives with the same message ID and token on the same interface,
+ * drop it.  That is either a retransmission from the same sender, or the copy of a
+ * multicast request received over the other address family.  Typically, IPv6 beats
+ * IPv4, so the IPv4 message is dropped.  The first multicast copy over the other family
+ * names the sender of that family, any later message must come from the remembered
+ * sender of its family to be dropped.
+ * CoAP over TCP has no message ID and no retransmission, so it is not checked.
+ */
+bool CADuplicateCacheCheck(CADuplicateCache_t *cache, const CAEndpoint_t *ep,
+                           uint16_t id, CAToken_t token, uint8_t tokenLength)
+{
+    if (!ep)
+    {
+        return true;
+    }
+    if (!cache || (ep->adapter & CA_ADAPTER_TCP))
+    {
+        return false;
+    }
+
+    if (tokenLength > CA_MAX_TOKEN_LEN)
+    {
+        /*
+         * If token length is more than CA_MAX_TOKEN_LEN,
+         * we compare the first CA_MAX_TOKEN_LEN bytes only.
+         */
+        tokenLength = CA_MAX_TOKEN_LEN;
+    }
+
+    CADuplicateKey_t key;
+    memset(&key, 0, sizeof(key));
+    key.adapter = ep->adapter;
+    key.ifindex = ep->ifindex;
+    key.messageId = id;
+    key.tokenLength = tokenLength;
+    if (token && tokenLength)
+    {
+        memcpy(key.token, token, tokenLength);
+    }
+
+    bool ret = false;
+    size_t family = CADuplicateFamily(ep);
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+
+    CADuplicateLock(cache);
+
+    // forget the requests older than the lifetime
+    while (cache->list && now - cache->list->receivedTime > cache->lifetimeMs)
+    {
+        CADuplicateEntry_t *expired = cache->list;
+        CADuplicateRemove(cache, expired);
+        OICFree(expired);
+    }
+
+    CADuplicateEntry_t *entry = NULL;
+    HASH_FIND(hh, cache->index, &key, sizeof(key), entry);
+    if (entry)
+    {
+        CADuplicateSender_t *sender = &entry->senders[family];
+        if ('\0' == sender->addr[0] && entry->multicast && (ep->flags & CA_MULTICAST))
+        {
+            // copy of the multicast request received over the other family
+            sender->port = ep->port;
+            OICStrcpy(sender->addr, sizeof(sender->addr), ep->addr);
+        }
+
+        // a different sender only collides with the message ID and token
+        if (sender->port == ep->port && 0 == strncmp(sender->addr, ep->addr, sizeof(sender->addr)))
+        {
+            if (CA_ADAPTER_IP == ep->adapter)
+            {
+                OIC_LOG_V(INFO, TAG, "IPv%c duplicate message ignored",
+                          (ep->flags & CA_IPV6) ? '6' : '4');
+            }
+            else
+            {
+                OIC_LOG(INFO, TAG, "duplicate message ignored");
+            }
+            cache->stats.duplicates++;
+            ret = true;
+        }
+        else
+        {
+            CADuplicateRemove(cache, entry);
+        }
+    }
+    else if (cache->stats.entries >= cache->maxEntries)
+    {
+        entry = cache->list;
+        CADuplicateRemove(cache, entry);
+        cache->stats.evicted++;
+    }
+    else
+    {
+        entry = (CADuplicateEntry_t *) OICMalloc(sizeof(CADuplicateEntry_t));
+        if (!entry)
+        {
+            OIC_LOG(ERROR, TAG, "memory allocation failed");
+        }
+    }
+
+    if (!ret && entry)
+    {
+        entry->key = key;
+        entry->multicast = (ep->flags & CA_MULTICAST) ? true : false;
+        memset(entry->senders, 0, sizeof(entry->senders));
+        entry->senders[family].port = ep->port;
+        OICStrcpy(entry->senders[family].addr, sizeof(entry->senders[family].addr), ep->addr);
+        entry->receivedTime = now;
+        if (!CADuplicateAdd(cache, entry))
+        {
+            OICFree(entry);
+        }
+    }
+
+    CADuplicateUnlock(cache);
+
+    return ret;
+}
+
+void CADuplicateCacheGetStats(CADuplicateCache_t *cache, CADuplicateStats_t *stats)
+{
+    if (cache && stats)
+    {
+        CADuplicateLock(cache);
+        *stats = cache->stats;
+        CADuplicateUnlock(cache);
+    }
+}
+
+void CADuplicateCacheDestroy(CADuplicateCache_t *cache)
+{
+    if (NULL == cache)
+    {
+        return;
+    }
+
+    CADuplicateEntry_t *entry = NULL;
+    CADuplicateEntry_t *tmp = NULL;
+    HASH_ITER(hh, cache->index, entry, tmp)
+    {
+        CADuplicateRemove(cache, entry);
+        OICFree(entry);
+    }
+
+#ifndef SINGLE_THREAD
+    oc_mutex_free(cache->mutex);
+    cache->mutex = NULL;
+#endif
+    memset(&cache->stats, 0, sizeof(cache->stats));
+}
@@ -38,6 +38,7 @@
 #include "cainterfacecontroller.h"
 #include "caretransmission.h"
 #include "oic_string.h"
+#include "oic_time.h"
 
 #ifdef WITH_BWT
 #include "cablockwisetransfer.h"
@@ -54,6 +55,9 @@
 #define SINGLE_HANDLE
 #define MAX_THREAD_POOL_SIZE    20
 
+// maximum number of received messages handled per CAHandleRequestResponseCallbacks() call
+#define MAX_RECEIVE_BATCH_SIZE  16
+
 // thread pool handle
 static ca_thread_pool_t g_threadPoolHandle = NULL;
 
@@ -67,6 +71,21 @@ static CAQueueingThread_t g_receiveThread;
 
 #define TAG "OIC_CA_MSG_HANDLE"
 
+/** How long a received request is remembered to detect duplicates, EXCHANGE_LIFETIME. **/
+#define CA_DUPLICATE_LIFETIME_MS (247 * 1000)
+
+/** Maximum number of remembered requests, the oldest one is forgotten first. **/
+#ifndef CA_DUPLICATE_MAX_ENTRIES
+#ifdef SINGLE_THREAD
+#define CA_DUPLICATE_MAX_ENTRIES (4)
+#else
+#define CA_DUPLICATE_MAX_ENTRIES (512)
+#endif
+#endif
+
+/** Received requests remembered to drop duplicate messages. **/
+static CADuplicateCache_t g_duplicateCache;
+
 static CARetransmission_t g_retransmissionContext;
 
 // handler field
@@ -91,8 +110,6 @@ static void CAProcessReceivedData(CAData_t *data);
 #endif
 static void CADestroyData(void *data, uint32_t size);
 static void CALogPayloadInfo(CAInfo_t *info);
-static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *endpoint, uint16_t id,
-                                CAToken_t token, uint8_t tokenLength);
 
 /**
  * print send / receive message of CoAP.
@@ -202,8 +219,8 @@ static CAData_t* CAGenerateHandlerData(const CAEndpoint_t *endpoint,
             goto exit;
         }
 
-        if (CADropSecondMessage(&caglobals.ca.requestHistory, endpoint, reqInfo->info.messageId,
-                                reqInfo->info.token, reqInfo->info.tokenLength))
+        if (CADuplicateCacheCheck(&g_duplicateCache, endpoint, reqInfo->info.messageId,
+                                  reqInfo->info.token, reqInfo->info.tokenLength))
         {
             OIC_LOG(INFO, TAG, "Second Request with same Token, Drop it");
             CADestroyRequestInfoInternal(reqInfo);
@@ -676,62 +693,9 @@ static void CASendThreadProcess(void *threadData)
 }
 #endif
 
-/*
- * If a second message arrives with the same message ID, token and the other address
- * family, drop it.  Typically, IPv6 beats IPv4, so the IPv4 message is dropped.
- */
-static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *ep, uint16_t id,
-                                CAToken_t token, uint8_t tokenLength)
+void CAGetDuplicateStats(CADuplicateStats_t *stats)
 {
-    if (!ep)
-    {
-        return true;
-    }
-    if (ep->adapter != CA_ADAPTER_IP)
-    {
-        return false;
-    }
-
-    if (tokenLength > CA_MAX_TOKEN_LEN)
-    {
-        /*
-         * If token length is more than CA_MAX_TOKEN_LEN,
-         * we compare the first CA_MAX_TOKEN_LEN bytes only.
-         */
-        tokenLength = CA_MAX_TOKEN_LEN;
-    }
-
-    bool ret = false;
-    CATransportFlags_t familyFlags = ep->flags & CA_IPFAMILY_MASK;
-
-    for (size_t i = 0; i < sizeof(history->items) / sizeof(history->items[0]); i++)
-    {
-        CAHistoryItem_t *item = &(history->items[i]);
-        if (id == item->messageId && tokenLength == item->tokenLength
-            && ep->ifindex == item->ifindex && memcmp(item->token, token, tokenLength) == 0)
-        {
-            OIC_LOG_V(INFO, TAG, "IPv%c duplicate message ignored",
-                      familyFlags & CA_IPV6 ? '6' : '4');
-            ret = true;
-            break;
-        }
-    }
-
-    history->items[history->nextIndex].flags = familyFlags;
-    history->items[history->nextIndex].messageId = id;
-    history->items[history->nextIndex].ifindex = ep->ifindex;
-    if (token && tokenLength)
-    {
-        memcpy(history->items[history->nextIndex].token, token, tokenLength);
-        history->items[history->nextIndex].tokenLength = tokenLength;
-    }
-
-    if (++history->nextIndex >= HISTORYSIZE)
-    {
-        history->nextIndex = 0;
-    }
-
-    return ret;
+    CADuplicateCacheGetStats(&g_duplicateCache, stats);
 }
 
 static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
@@ -861,43 +825,59 @@ void CAHandleRequestResponseCallbacks()
     // #1 parse the data
     // #2 get endpoint
 
-    oc_mutex_lock(g_receiveThread.threadMutex);
+    // handle a bounded batch per call so that a burst does not take one call per message.
+    void *msg = NULL;
+    uint32_t size = 0;
 
-    u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
-
-    oc_mutex_unlock(g_receiveThread.threadMutex);
-
-    if (NULL == item || NULL == item->msg)
+    for (size_t i = 0; i < MAX_RECEIVE_BATCH_SIZE &&
+         CA_STATUS_OK == CAQueueingThreadGetData(&g_receiveThread, &msg, &size); i++)
     {
-        return;
-    }
+        // get endpoint
+        CAData_t *td = (CAData_t *) msg;
 
-    // get endpoint
-    CAData_t *td = (CAData_t *) item->msg;
+        if (td->requestInfo && g_requestHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "request callback : %d", td->requestInfo->info.numOptions);
+            g_requestHandler(td->remoteEndpoint, td->requestInfo);
+        }
+        else if (td->responseInfo && g_responseHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "response callback : %d", td->responseInfo->info.numOptions);
+            g_responseHandler(td->remoteEndpoint, td->responseInfo);
+        }
+        else if (td->errorInfo && g_errorHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "error callback error: %d", td->errorInfo->result);
+            g_errorHandler(td->remoteEndpoint, td->errorInfo);
+        }
 
-    if (td->requestInfo && g_requestHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "request callback : %d", td->requestInfo->info.numOptions);
-        g_requestHandler(td->remoteEndpoint, td->requestInfo);
+        CADestroyData(msg, size);
     }
-    else if (td->responseInfo && g_responseHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "response callback : %d", td->responseInfo->info.numOptions);
-        g_responseHandler(td->remoteEndpoint, td->responseInfo);
-    }
-    else if (td->errorInfo && g_errorHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "error callback error: %d", td->errorInfo->result);
-        g_errorHandler(td->remoteEndpoint, td->errorInfo);
-    }
-
-    CADestroyData(item->msg, sizeof(CAData_t));
-    OICFree(item);
 
 #endif // SINGLE_HANDLE
 #endif // SINGLE_THREAD
 }
 
+CAResult_t CAWaitRequestResponseCallbacks(uint32_t timeoutMs)
+{
+#if !defined(SINGLE_THREAD) && defined(SINGLE_HANDLE)
+    return CAQueueingThreadWaitData(&g_receiveThread, (uint64_t)timeoutMs * US_PER_MS);
+#else
+    // nothing is queued for CAHandleRequestResponseCallbacks() to wait for.
+    (void)timeoutMs;
+    return CA_NOT_SUPPORTED;
+#endif
+}
+
+CAResult_t CAWakeUpRequestResponseCallbacks()
+{
+#if !defined(SINGLE_THREAD) && defined(SINGLE_HANDLE)
+    return CAQueueingThreadWakeUp(&g_receiveThread);
+#else
+    return CA_NOT_SUPPORTED;
+#endif
+}
+
 static CAData_t* CAPrepareSendData(const CAEndpoint_t *endpoint, const void *sendData,
                                    CADataType_t dataType)
 {
@@ -984,7 +964,9 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
 
 #ifdef ARDUINO
     // If max retransmission queue is reached, then don't handle new request
-    if (CA_MAX_RT_ARRAY_SIZE == u_arraylist_length(g_retransmissionContext.dataList))
+    CARetransmissionStats_t rtStats = { 0 };
+    CARetransmissionGetStats(&g_retransmissionContext, &rtStats);
+    if (CA_MAX_RT_ARRAY_SIZE <= rtStats.queueDepth)
     {
         OIC_LOG(ERROR, TAG, "max RT queue size reached!");
         return CA_SEND_FAILED;
@@ -1072,13 +1054,21 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     CASetPacketReceivedCallback(CAReceivedPacketCallback);
     CASetErrorHandleCallback(CAErrorHandler);
 
+    CAResult_t res = CADuplicateCacheInitialize(&g_duplicateCache, CA_DUPLICATE_LIFETIME_MS,
+                                                CA_DUPLICATE_MAX_ENTRIES);
+    if (CA_STATUS_OK != res)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to Initialize duplicate cache.");
+        return res;
+    }
+
 #ifndef SINGLE_THREAD
     // create thread pool
-    CAResult_t res = ca_thread_pool_init(MAX_THREAD_POOL_SIZE, &g_threadPoolHandle);
+    res = ca_thread_pool_init(MAX_THREAD_POOL_SIZE, &g_threadPoolHandle);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread pool initialize error.");
-        return res;
+        goto exit;
     }
 
     // send thread initialize
@@ -1087,7 +1077,7 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize send queue thread");
-        return res;
+        goto exit;
     }
 
     // start send thread
@@ -1095,7 +1085,7 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread start error(send thread).");
-        return res;
+        goto exit;
     }
 
     // receive thread initialize
@@ -1104,7 +1094,7 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize receive queue thread");
-        return res;
+        goto exit;
     }
 
 #ifndef SINGLE_HANDLE // This will be enabled when RI supports multi threading
@@ -1113,7 +1103,7 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread start error(receive thread).");
-        return res;
+        goto exit;
     }
 #endif // SINGLE_HANDLE
 
@@ -1123,7 +1113,7 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize Retransmission.");
-        return res;
+        goto exit;
     }
 
 #ifdef WITH_BWT
@@ -1132,7 +1122,7 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize BlockWiseTransfer.");
-        return res;
+        goto exit;
     }
 #endif
 
@@ -1141,7 +1131,7 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread start error(retransmission thread).");
-        return res;
+        goto exit;
     }
 
     // initialize interface adapters by controller
@@ -1149,22 +1139,27 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize Adapters.");
-        return res;
+        goto exit;
     }
 #else
     // retransmission initialize
-    CAResult_t res = CARetransmissionInitialize(&g_retransmissionContext, NULL, CASendUnicastData,
-                                                CATimeoutCallback, NULL);
+    res = CARetransmissionInitialize(&g_retransmissionContext, NULL, CASendUnicastData,
+                                     CATimeoutCallback, NULL);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize Retransmission.");
-        return res;
+        goto exit;
     }
 
     CAInitializeAdapters();
 #endif // SINGLE_THREAD
 
     return CA_STATUS_OK;
+
+exit:
+    // the duplicate cache is not usable without the rest of the message handler
+    CADuplicateCacheDestroy(&g_duplicateCache);
+    return res;
 }
 
 void CATerminateMessageHandler()
@@ -1219,6 +1214,8 @@ void CATerminateMessageHandler()
     CARetransmissionStop(&g_retransmissionContext);
     CARetransmissionDestroy(&g_retransmissionContext);
 #endif // SINGLE_THREAD
+
+    CADuplicateCacheDestroy(&g_duplicateCache);
 }
 
 static void CALogPayloadInfo(CAInfo_t *info)
@@ -30,11 +30,197 @@
 #endif
 
 #include "caqueueingthread.h"
+#include "ocatomic.h"
 #include "oic_malloc.h"
+#include "oic_time.h"
 #include "logger.h"
 
 #define TAG PCF("OIC_CA_QING")
 
+/** Number of data the thread takes from the queue at once. **/
+#define CA_QUEUEING_THREAD_BATCH_SIZE (16)
+
+/** Upper bound of the number of polls before the thread sleeps. **/
+#define CA_QUEUEING_THREAD_MAX_SPIN (1024)
+
+#define CA_QUEUEING_THREAD_RING_MASK ((uint32_t)CA_QUEUEING_THREAD_RING_SIZE - 1)
+
+#if (CA_QUEUEING_THREAD_RING_SIZE & (CA_QUEUEING_THREAD_RING_SIZE - 1)) != 0
+#error "CA_QUEUEING_THREAD_RING_SIZE must be a power of two"
+#endif
+
+/**
+ * Slot of the ring.  The sequence equals the position of the slot while it is free for
+ * that position, and the position plus one once the data for it is published.
+ */
+struct CAQueueingThreadSlot
+{
+    volatile int32_t sequence;
+    uint32_t size;
+    void *msg;
+    uint64_t enqueueTime;
+};
+
+typedef struct
+{
+    void *msg;
+    uint32_t size;
+} CAQueueingThreadItem_t;
+
+static int32_t CAAtomicLoad(volatile int32_t *value)
+{
+    return oc_atomic_add(value, 0);
+}
+
+/** Difference between two ring positions, tolerating wrap around. **/
+static int32_t CAPositionDiff(int32_t a, int32_t b)
+{
+    return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+static void CAQueueingThreadDestroyItem(CAQueueingThread_t *thread, void *msg, uint32_t size)
+{
+    if (NULL != thread->destroy)
+    {
+        thread->destroy(msg, size);
+    }
+    else
+    {
+        OICFree(msg);
+    }
+}
+
+static bool CAQueueingThreadPushRing(CAQueueingThread_t *thread, void *data, uint32_t size)
+{
+    int32_t pos = CAAtomicLoad(&thread->enqueuePos);
+    CAQueueingThreadSlot_t *slot = NULL;
+
+    for (;;)
+    {
+        slot = &thread->ring[(uint32_t)pos & CA_QUEUEING_THREAD_RING_MASK];
+        int32_t diff = CAPositionDiff(CAAtomicLoad(&slot->sequence), pos);
+        if (0 == diff)
+        {
+            if (oc_atomic_cmpxchg(&thread->enqueuePos, pos, (int32_t)((uint32_t)pos + 1)))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // the consumer has not freed this slot yet, the ring is full.
+            return false;
+        }
+        pos = CAAtomicLoad(&thread->enqueuePos);
+    }
+
+    slot->msg = data;
+    slot->size = size;
+    slot->enqueueTime = OICGetCurrentTime(TIME_IN_US);
+    oc_atomic_increment(&slot->sequence);
+    return true;
+}
+
+static bool CAQueueingThreadRingHasData(CAQueueingThread_t *thread)
+{
+    int32_t pos = thread->dequeuePos;
+    CAQueueingThreadSlot_t *slot = &thread->ring[(uint32_t)pos & CA_QUEUEING_THREAD_RING_MASK];
+    return CAPositionDiff(CAAtomicLoad(&slot->sequence), pos) > 0;
+}
+
+static bool CAQueueingThreadHasData(CAQueueingThread_t *thread)
+{
+    return CAQueueingThreadRingHasData(thread) || CAAtomicLoad(&thread->overflowCount) > 0;
+}
+
+/**
+ * Take the oldest data from the ring, or from the overflow queue once the ring is empty.
+ * The data of an entry removed by CAQueueingThreadClearContextData() is NULL.
+ * Must be called with threadMutex held.
+ */
+static bool CAQueueingThreadPop(CAQueueingThread_t *thread, CAQueueingThreadItem_t *item,
+                                uint64_t now)
+{
+    if (CAQueueingThreadRingHasData(thread))
+    {
+        int32_t pos = thread->dequeuePos;
+        CAQueueingThreadSlot_t *slot = &thread->ring[(uint32_t)pos & CA_QUEUEING_THREAD_RING_MASK];
+        item->msg = slot->msg;
+        item->size = slot->size;
+        if (now && NULL != item->msg)
+        {
+            uint64_t latency = (now > slot->enqueueTime) ? now - slot->enqueueTime : 0;
+            thread->stats.totalLatencyUs += latency;
+            if (latency > thread->stats.maxLatencyUs)
+            {
+                thread->stats.maxLatencyUs = latency;
+            }
+        }
+
+        // hand the slot back to the producers for the next lap.
+        oc_atomic_add(&slot->sequence, CA_QUEUEING_THREAD_RING_SIZE - 1);
+        thread->dequeuePos = (int32_t)((uint32_t)pos + 1);
+    }
+    else if (CAAtomicLoad(&thread->overflowCount) > 0)
+    {
+        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
+        if (NULL == message)
+        {
+            return false;
+        }
+        oc_atomic_decrement(&thread->overflowCount);
+        item->msg = message->msg;
+        item->size = message->size;
+        OICFree(message);
+    }
+    else
+    {
+        return false;
+    }
+
+    oc_atomic_decrement(&thread->depth);
+    if (NULL != item->msg)
+    {
+        thread->stats.dequeued++;
+    }
+    return true;
+}
+
+static size_t CAQueueingThreadPopBatch(CAQueueingThread_t *thread, CAQueueingThreadItem_t *batch)
+{
+    uint64_t now = OICGetCurrentTime(TIME_IN_US);
+    size_t count = 0;
+    CAQueueingThreadItem_t item;
+
+    while (count < CA_QUEUEING_THREAD_BATCH_SIZE && CAQueueingThreadPop(thread, &item, now))
+    {
+        if (NULL != item.msg)
+        {
+            batch[count++] = item;
+        }
+    }
+    return count;
+}
+
+/**
+ * Poll the queue for a while before going to sleep.  The number of polls grows while
+ * data keeps arriving during the polling and shrinks while it does not.
+ */
+static bool CAQueueingThreadSpin(CAQueueingThread_t *thread)
+{
+    for (uint32_t i = 0; i < thread->spinLimit; i++)
+    {
+        if (CAQueueingThreadHasData(thread) || thread->isStop)
+        {
+            thread->spinLimit = (thread->spinLimit * 2 > CA_QUEUEING_THREAD_MAX_SPIN) ?
+                                CA_QUEUEING_THREAD_MAX_SPIN : thread->spinLimit * 2;
+            return true;
+        }
+    }
+    thread->spinLimit = (thread->spinLimit > 1) ? thread->spinLimit / 2 : 1;
+    return false;
+}
+
 static void CAQueueingThreadBaseRoutine(void *threadValue)
 {
     OIC_LOG(DEBUG, TAG, "message handler main thread start..");
@@ -47,53 +233,50 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
         return;
     }
 
+    CAQueueingThreadItem_t batch[CA_QUEUEING_THREAD_BATCH_SIZE];
+
     while (!thread->isStop)
     {
         // mutex lock
         oc_mutex_lock(thread->threadMutex);
+        size_t count = CAQueueingThreadPopBatch(thread, batch);
+        oc_mutex_unlock(thread->threadMutex);
 
-        // if queue is empty, thread will wait
-        if (!thread->isStop && u_queue_get_size(thread->dataQueue) <= 0)
+        if (0 == count)
         {
-            OIC_LOG(DEBUG, TAG, "wait..");
+            if (CAQueueingThreadSpin(thread))
+            {
+                continue;
+            }
 
-            // wait
-            oc_cond_wait(thread->threadCond, thread->threadMutex);
+            oc_mutex_lock(thread->threadMutex);
 
-            OIC_LOG(DEBUG, TAG, "wake up..");
-        }
+            // producers signal only while this flag is set, so check the queue after it is.
+            oc_atomic_cmpxchg(&thread->sleeping, 0, 1);
+            if (!thread->isStop && !CAQueueingThreadHasData(thread))
+            {
+                OIC_LOG(DEBUG, TAG, "wait..");
 
-        // check stop flag
-        if (thread->isStop)
-        {
-            // mutex unlock
-            oc_mutex_unlock(thread->threadMutex);
-            continue;
-        }
+                // wait
+                oc_cond_wait(thread->threadCond, thread->threadMutex);
 
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
-        // mutex unlock
-        oc_mutex_unlock(thread->threadMutex);
-        if (NULL == message)
-        {
+                OIC_LOG(DEBUG, TAG, "wake up..");
+            }
+            oc_atomic_cmpxchg(&thread->sleeping, 1, 0);
+
+            oc_mutex_unlock(thread->threadMutex);
             continue;
         }
 
         // process data
-        thread->threadTask(message->msg);
-
-        // free
-        if (NULL != thread->destroy)
+        for (size_t i = 0; i < count; i++)
         {
-            thread->destroy(message->msg, message->size);
-        }
-        else
-        {
-            OICFree(message->msg);
+            if (!thread->isStop)
+            {
+                thread->threadTask(batch[i].msg);
+            }
+            CAQueueingThreadDestroyItem(thread, batch[i].msg, batch[i].size);
         }
-
-        OICFree(message);
     }
 
     oc_mutex_lock(thread->threadMutex);
@@ -123,16 +306,34 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
     // set send thread data
     thread->threadPool = handle;
     thread->dataQueue = u_queue_create();
+    thread->ring = (CAQueueingThreadSlot_t *) OICCalloc(CA_QUEUEING_THREAD_RING_SIZE,
+                                                       sizeof(CAQueueingThreadSlot_t));
     thread->threadMutex = oc_mutex_new();
     thread->threadCond = oc_cond_new();
     thread->isStop = true;
     thread->threadTask = task;
     thread->destroy = destroy;
-    if (NULL == thread->dataQueue || NULL == thread->threadMutex || NULL == thread->threadCond)
+    thread->enqueuePos = 0;
+    thread->dequeuePos = 0;
+    thread->overflowCount = 0;
+    thread->sleeping = 0;
+    thread->waiters = 0;
+    thread->wakeUp = false;
+    thread->spinLimit = 1;
+    thread->depth = 0;
+    thread->maxDepth = 0;
+    memset(&thread->stats, 0, sizeof(thread->stats));
+    if (NULL == thread->dataQueue || NULL == thread->ring ||
+        NULL == thread->threadMutex || NULL == thread->threadCond)
     {
         goto ERROR_MEM_FAILURE;
     }
 
+    for (int32_t i = 0; i < CA_QUEUEING_THREAD_RING_SIZE; i++)
+    {
+        thread->ring[i].sequence = i;
+    }
+
     return CA_STATUS_OK;
 
 ERROR_MEM_FAILURE:
@@ -141,6 +342,8 @@ ERROR_MEM_FAILURE:
         u_queue_delete(thread->dataQueue);
         thread->dataQueue = NULL;
     }
+    OICFree(thread->ring);
+    thread->ring = NULL;
     if (thread->threadMutex)
     {
         oc_mutex_free(thread->threadMutex);
@@ -209,12 +412,43 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
         return CA_STATUS_INVALID_PARAM;
     }
 
+    int32_t depth = oc_atomic_increment(&thread->depth);
+    for (int32_t maxDepth = CAAtomicLoad(&thread->maxDepth); depth > maxDepth;
+         maxDepth = CAAtomicLoad(&thread->maxDepth))
+    {
+        if (oc_atomic_cmpxchg(&thread->maxDepth, maxDepth, depth))
+        {
+            break;
+        }
+    }
+
+    // data goes to the overflow queue while it is in use, to keep the order of the data.
+    if (0 == CAAtomicLoad(&thread->overflowCount) &&
+        CAQueueingThreadPushRing(thread, data, size))
+    {
+        // notify the thread only if it is sleeping, or the consumers waiting for data
+        if (CAAtomicLoad(&thread->waiters))
+        {
+            oc_mutex_lock(thread->threadMutex);
+            oc_cond_broadcast(thread->threadCond);
+            oc_mutex_unlock(thread->threadMutex);
+        }
+        else if (CAAtomicLoad(&thread->sleeping))
+        {
+            oc_mutex_lock(thread->threadMutex);
+            oc_cond_signal(thread->threadCond);
+            oc_mutex_unlock(thread->threadMutex);
+        }
+        return CA_STATUS_OK;
+    }
+
     // create thread data
     u_queue_message_t *message = (u_queue_message_t *) OICMalloc(sizeof(u_queue_message_t));
 
     if (NULL == message)
     {
         OIC_LOG(ERROR, TAG, "memory error!!");
+        oc_atomic_decrement(&thread->depth);
         return CA_MEMORY_ALLOC_FAILED;
     }
 
@@ -226,9 +460,18 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
 
     // add thread data into list
     u_queue_add_element(thread->dataQueue, message);
+    oc_atomic_increment(&thread->overflowCount);
+    thread->stats.overflowed++;
 
     // notity the thread
-    oc_cond_signal(thread->threadCond);
+    if (CAAtomicLoad(&thread->waiters))
+    {
+        oc_cond_broadcast(thread->threadCond);
+    }
+    else
+    {
+        oc_cond_signal(thread->threadCond);
+    }
 
     // mutex unlock
     oc_mutex_unlock(thread->threadMutex);
@@ -236,6 +479,165 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
     return CA_STATUS_OK;
 }
 
+CAResult_t CAQueueingThreadGetData(CAQueueingThread_t *thread, void **data, uint32_t *size)
+{
+    if (NULL == thread || NULL == data || NULL == size)
+    {
+        OIC_LOG(ERROR, TAG, "invalid parameter..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL == thread->ring)
+    {
+        // not initialized, or already destroyed.
+        return CA_STATUS_FAILED;
+    }
+
+    CAQueueingThreadItem_t item = { NULL, 0 };
+    uint64_t now = OICGetCurrentTime(TIME_IN_US);
+
+    oc_mutex_lock(thread->threadMutex);
+    while (CAQueueingThreadPop(thread, &item, now) && NULL == item.msg)
+    {
+        // skip the entries removed by CAQueueingThreadClearContextData()
+    }
+    oc_mutex_unlock(thread->threadMutex);
+
+    if (NULL == item.msg)
+    {
+        return CA_STATUS_FAILED;
+    }
+
+    *data = item.msg;
+    *size = item.size;
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAQueueingThreadWaitData(CAQueueingThread_t *thread, uint64_t timeoutUs)
+{
+    if (NULL == thread)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL == thread->ring)
+    {
+        // not initialized, or already destroyed.
+        return CA_STATUS_FAILED;
+    }
+
+    oc_mutex_lock(thread->threadMutex);
+
+    // producers notify only while waiters is set, so check the queue after it is.
+    oc_atomic_increment(&thread->waiters);
+    if (0 < timeoutUs && !thread->wakeUp && !CAQueueingThreadHasData(thread))
+    {
+        oc_cond_wait_for(thread->threadCond, thread->threadMutex, timeoutUs);
+    }
+    thread->wakeUp = false;
+    oc_atomic_decrement(&thread->waiters);
+
+    oc_mutex_unlock(thread->threadMutex);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAQueueingThreadWakeUp(CAQueueingThread_t *thread)
+{
+    if (NULL == thread)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL == thread->threadMutex)
+    {
+        return CA_STATUS_FAILED;
+    }
+
+    oc_mutex_lock(thread->threadMutex);
+    thread->wakeUp = true;
+    oc_cond_broadcast(thread->threadCond);
+    oc_mutex_unlock(thread->threadMutex);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAQueueingThreadClearContextData(CAQueueingThread_t *thread,
+                                            CAQueueingThreadDataMatch match, void *ctx)
+{
+    if (NULL == thread || NULL == match)
+    {
+        OIC_LOG(ERROR, TAG, "invalid parameter..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    u_queue_t *remaining = u_queue_create();
+    if (NULL == remaining)
+    {
+        OIC_LOG(ERROR, TAG, "memory error!!");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    oc_mutex_lock(thread->threadMutex);
+
+    // entries of the ring are only marked as removed, the consumer skips them.
+    for (int32_t pos = thread->dequeuePos; ; pos = (int32_t)((uint32_t)pos + 1))
+    {
+        CAQueueingThreadSlot_t *slot = &thread->ring[(uint32_t)pos & CA_QUEUEING_THREAD_RING_MASK];
+        if (CAPositionDiff(CAAtomicLoad(&slot->sequence), pos) <= 0)
+        {
+            break;
+        }
+        if (NULL != slot->msg && match(slot->msg, slot->size, ctx))
+        {
+            CAQueueingThreadDestroyItem(thread, slot->msg, slot->size);
+            slot->msg = NULL;
+        }
+    }
+
+    u_queue_message_t *message = NULL;
+    while (NULL != (message = u_queue_get_element(thread->dataQueue)))
+    {
+        if (match(message->msg, message->size, ctx))
+        {
+            CAQueueingThreadDestroyItem(thread, message->msg, message->size);
+            OICFree(message);
+            oc_atomic_decrement(&thread->overflowCount);
+            oc_atomic_decrement(&thread->depth);
+        }
+        else
+        {
+            u_queue_add_element(remaining, message);
+        }
+    }
+    u_queue_delete(thread->dataQueue);
+    thread->dataQueue = remaining;
+
+    oc_mutex_unlock(thread->threadMutex);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAQueueingThreadGetStats(CAQueueingThread_t *thread, CAQueueingThreadStats_t *stats)
+{
+    if (NULL == thread || NULL == stats)
+    {
+        OIC_LOG(ERROR, TAG, "invalid parameter..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    oc_mutex_lock(thread->threadMutex);
+    *stats = thread->stats;
+    oc_mutex_unlock(thread->threadMutex);
+
+    int32_t depth = CAAtomicLoad(&thread->depth);
+    stats->depth = (depth > 0) ? (uint32_t)depth : 0;
+    stats->maxDepth = (uint32_t)CAAtomicLoad(&thread->maxDepth);
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
@@ -250,29 +652,19 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
     oc_mutex_lock(thread->threadMutex);
 
     // remove all remained list data.
-    while (u_queue_get_size(thread->dataQueue) > 0)
+    CAQueueingThreadItem_t item;
+    while (CAQueueingThreadPop(thread, &item, 0))
     {
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
-
-        // free
-        if (NULL != message)
+        if (NULL != item.msg)
         {
-            if (NULL != thread->destroy)
-            {
-                thread->destroy(message->msg, message->size);
-            }
-            else
-            {
-                OICFree(message->msg);
-            }
-
-            OICFree(message);
+            CAQueueingThreadDestroyItem(thread, item.msg, item.size);
         }
     }
 
     u_queue_delete(thread->dataQueue);
     thread->dataQueue = NULL;
+    OICFree(thread->ring);
+    thread->ring = NULL;
 
     // mutex unlock
     oc_mutex_unlock(thread->threadMutex);
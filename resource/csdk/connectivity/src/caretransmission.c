@@ -71,22 +71,40 @@
 #include "oic_malloc.h"
 #include "oic_time.h"
 #include "ocrandom.h"
+#include <coap/uthash.h>
 #include "logger.h"
 
+/* Running out of memory in HASH_ADD fails CAAddRetransmissionData() instead of exiting. */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
+
 #define TAG "OIC_CA_RETRANS"
 
+/** initial capacity of the retransmission heap. **/
+#define INITIAL_HEAP_CAPACITY (8)
+
 typedef struct
+{
+    uint16_t messageId;                 /**< coap PDU message id */
+    CATransportAdapter_t adapter;       /**< transport adapter of the remote endpoint */
+} CARetransmissionKey_t;
+
+typedef struct CARetransmissionData
 {
     uint64_t timeStamp;                 /**< last sent time. microseconds */
 #ifndef SINGLE_THREAD
     uint64_t timeout;                   /**< timeout value. microseconds */
 #endif
+    uint64_t deadline;                  /**< next retransmission time. microseconds */
+    size_t heapIndex;                   /**< position in the retransmission heap */
     uint8_t triedCount;                 /**< retransmission count */
     uint16_t messageId;                 /**< coap PDU message id */
     CADataType_t dataType;              /**< data Type (Request/Response) */
     CAEndpoint_t *endpoint;             /**< remote endpoint */
     void *pdu;                          /**< coap PDU */
     uint32_t size;                      /**< coap PDU size */
+    CARetransmissionKey_t key;          /**< key in the message id index */
+    UT_hash_handle hh;
 } CARetransmissionData_t;
 
 static const uint64_t USECS_PER_SEC = 1000000;
@@ -140,37 +158,179 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
 }
 #endif
 
+
 /**
- * @brief   check timeout routine
- * @param   currentTime     [IN]microseconds
+ * @brief   get the time at which the data has to be sent again
  * @param   retData         [IN]retransmission data
- * @return  true if the timeout period has elapsed, false otherwise
+ * @return  microseconds
  */
-static bool CACheckTimeout(uint64_t currentTime, CARetransmissionData_t *retData)
+static uint64_t CAGetRetransmissionDeadline(const CARetransmissionData_t *retData)
 {
 #ifndef SINGLE_THREAD
-    // #1. calculate timeout
     uint64_t milliTimeoutValue = retData->timeout / USECS_PER_MSEC;
-    uint64_t timeout = (milliTimeoutValue << retData->triedCount) * USECS_PER_MSEC;
+    return retData->timeStamp + (milliTimeoutValue << retData->triedCount) * USECS_PER_MSEC;
+#else
+    return retData->timeStamp + (2 << retData->triedCount) * (uint64_t) USECS_PER_SEC;
+#endif
+}
 
-    if (currentTime >= retData->timeStamp + timeout)
+static void CAHeapSwap(CARetransmission_t *context, size_t i, size_t j)
+{
+    CARetransmissionData_t *tmp = context->dataHeap[i];
+    context->dataHeap[i] = context->dataHeap[j];
+    context->dataHeap[j] = tmp;
+    context->dataHeap[i]->heapIndex = i;
+    context->dataHeap[j]->heapIndex = j;
+}
+
+static void CAHeapSiftUp(CARetransmission_t *context, size_t index)
+{
+    while (index > 0)
     {
-        OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
-                  timeout, retData->triedCount);
-        return true;
+        size_t parent = (index - 1) / 2;
+        if (context->dataHeap[parent]->deadline <= context->dataHeap[index]->deadline)
+        {
+            break;
+        }
+        CAHeapSwap(context, parent, index);
+        index = parent;
     }
-#else
-    // #1. calculate timeout
-    uint64_t timeOut = (2 << retData->triedCount) * (uint64_t) USECS_PER_SEC;
+}
 
-    if (currentTime >= retData->timeStamp + timeOut)
+static void CAHeapSiftDown(CARetransmission_t *context, size_t index)
+{
+    for (;;)
     {
-        OIC_LOG_V(DEBUG, TAG, "timeout=%d, tried cnt=%d",
-                  (2 << retData->triedCount), retData->triedCount);
-        return true;
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+
+        if (left < context->dataHeapSize
+            && context->dataHeap[left]->deadline < context->dataHeap[smallest]->deadline)
+        {
+            smallest = left;
+        }
+        if (right < context->dataHeapSize
+            && context->dataHeap[right]->deadline < context->dataHeap[smallest]->deadline)
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        CAHeapSwap(context, index, smallest);
+        index = smallest;
     }
-#endif
-    return false;
+}
+
+static CAResult_t CAHeapPush(CARetransmission_t *context, CARetransmissionData_t *retData)
+{
+    if (context->dataHeapSize == context->dataHeapCapacity)
+    {
+        size_t newCapacity = context->dataHeapCapacity ?
+                             (context->dataHeapCapacity * 2) : INITIAL_HEAP_CAPACITY;
+        CARetransmissionData_t **heap = (CARetransmissionData_t **) OICRealloc(
+                context->dataHeap, newCapacity * sizeof(CARetransmissionData_t *));
+        if (NULL == heap)
+        {
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        context->dataHeap = heap;
+        context->dataHeapCapacity = newCapacity;
+    }
+
+    retData->heapIndex = context->dataHeapSize;
+    context->dataHeap[context->dataHeapSize++] = retData;
+    CAHeapSiftUp(context, retData->heapIndex);
+    return CA_STATUS_OK;
+}
+
+static void CAHeapRemove(CARetransmission_t *context, CARetransmissionData_t *retData)
+{
+    size_t index = retData->heapIndex;
+    size_t last = --context->dataHeapSize;
+
+    if (index != last)
+    {
+        CAHeapSwap(context, index, last);
+        CAHeapSiftUp(context, index);
+        CAHeapSiftDown(context, index);
+    }
+}
+
+static void CAMakeRetransmissionKey(CARetransmissionKey_t *key, uint16_t messageId,
+                                    CATransportAdapter_t adapter)
+{
+    memset(key, 0, sizeof(*key));
+    key->messageId = messageId;
+    key->adapter = adapter;
+}
+
+static CARetransmissionData_t *CAFindRetransmissionData(CARetransmission_t *context,
+                                                        uint16_t messageId,
+                                                        CATransportAdapter_t adapter)
+{
+    CARetransmissionKey_t key;
+    CAMakeRetransmissionKey(&key, messageId, adapter);
+
+    CARetransmissionData_t *retData = NULL;
+    HASH_FIND(hh, context->dataIndex, &key, sizeof(key), retData);
+    return retData;
+}
+
+/**
+ * @brief   add data to the heap and the message id index.
+ *          the context owns the data afterwards if this succeeds.
+ * @param   context         [IN]context for retransmission
+ * @param   retData         [IN]retransmission data
+ * @return  ::CA_STATUS_OK or ::CA_MEMORY_ALLOC_FAILED.
+ */
+static CAResult_t CAAddRetransmissionData(CARetransmission_t *context,
+                                          CARetransmissionData_t *retData)
+{
+    if (CA_STATUS_OK != CAHeapPush(context, retData))
+    {
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    HASH_ADD(hh, context->dataIndex, key, sizeof(retData->key), retData);
+    context->stats.queueDepth = (uint32_t) context->dataHeapSize;
+    return CA_STATUS_OK;
+uthash_oom:
+    if (NULL == retData->hh.tbl || NULL == retData->hh.tbl->buckets)
+    {
+        // the table of the first data could not be created
+        uthash_free(retData->hh.tbl, sizeof(UT_hash_table));
+        context->dataIndex = NULL;
+    }
+    else
+    {
+        // the buckets could not be expanded, the data was already linked in
+        HASH_DELETE(hh, context->dataIndex, retData);
+    }
+    CAHeapRemove(context, retData);
+    return CA_MEMORY_ALLOC_FAILED;
+}
+
+/**
+ * @brief   remove data from the heap and the message id index.
+ *          the caller owns the data afterwards.
+ * @param   context         [IN]context for retransmission
+ * @param   retData         [IN]retransmission data
+ */
+static void CARemoveRetransmissionData(CARetransmission_t *context,
+                                       CARetransmissionData_t *retData)
+{
+    CAHeapRemove(context, retData);
+    HASH_DELETE(hh, context->dataIndex, retData);
+    context->stats.queueDepth = (uint32_t) context->dataHeapSize;
+}
+
+static void CAFreeRetransmissionData(CARetransmissionData_t *retData)
+{
+    CAFreeEndpoint(retData->endpoint);
+    OICFree(retData->pdu);
+    OICFree(retData);
 }
 
 static void CACheckRetransmissionList(CARetransmission_t *context)
@@ -184,64 +344,58 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    size_t len = u_arraylist_length(context->dataList);
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
 
-    for (size_t i = 0; i < len; i++)
+    // only the data at the top of the heap can be due.
+    while (0 < context->dataHeapSize)
     {
-        CARetransmissionData_t *retData = u_arraylist_get(context->dataList, i);
+        CARetransmissionData_t *retData = context->dataHeap[0];
 
-        if (NULL == retData)
+        if (currentTime < retData->deadline
+            && retData->triedCount < context->config.tryingCount)
         {
-            continue;
+            break;
         }
 
-        uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
-
-        if (CACheckTimeout(currentTime, retData))
+        if (currentTime >= retData->deadline)
         {
-            // #2. if time's up, send the data.
+            OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
+                      retData->deadline - retData->timeStamp, retData->triedCount);
+
+            // #1. if time's up, send the data.
             if (NULL != context->dataSendMethod)
             {
                 OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
                           retData->messageId);
                 context->dataSendMethod(retData->endpoint, retData->pdu,
                                         retData->size, retData->dataType);
+                context->stats.retransmitCount++;
             }
 
-            // #3. increase the retransmission count and update timestamp.
+            // #2. increase the retransmission count and update timestamp.
             retData->timeStamp = currentTime;
             retData->triedCount++;
+            retData->deadline = CAGetRetransmissionDeadline(retData);
+            CAHeapSiftDown(context, 0);
         }
 
-        // #4. if tried count is max, remove the retransmission data from list.
+        // #3. if tried count is max, remove the retransmission data.
         if (retData->triedCount >= context->config.tryingCount)
         {
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
-            {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
-                // mutex unlock
-                oc_mutex_unlock(context->threadMutex);
-                return;
-            }
+            CARemoveRetransmissionData(context, retData);
+            context->stats.timeoutCount++;
+
             OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
-                      "msgid=%d", removedData->messageId);
+                      "msgid=%d", retData->messageId);
 
             // callback for retransmit timeout
             if (NULL != context->timeoutCallback)
             {
-                context->timeoutCallback(removedData->endpoint, removedData->pdu,
-                                         removedData->size);
+                context->timeoutCallback(retData->endpoint, retData->pdu,
+                                         retData->size);
             }
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-
-            OICFree(removedData);
-
-            // modify loop value.
-            len = u_arraylist_length(context->dataList);
-            --i;
+            CAFreeRetransmissionData(retData);
         }
     }
 
@@ -276,7 +430,7 @@ void CARetransmissionBaseRoutine(void *threadValue)
         // mutex lock
         oc_mutex_lock(context->threadMutex);
 
-        if (!context->isStop && u_arraylist_length(context->dataList) <= 0)
+        if (!context->isStop && 0 == context->dataHeapSize)
         {
             // if list is empty, thread will wait
             OIC_LOG(DEBUG, TAG, "wait..there is no retransmission data.");
@@ -288,13 +442,19 @@ void CARetransmissionBaseRoutine(void *threadValue)
         }
         else if (!context->isStop)
         {
-            // check each RETRANSMISSION_CHECK_PERIOD_SEC time.
-            OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
-                      RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC);
+            // sleep until the earliest retransmission is due.
+            uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+            uint64_t deadline = context->dataHeap[0]->deadline;
 
-            // wait
-            uint64_t absTime = RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC;
-            oc_cond_wait_for(context->threadCond, context->threadMutex, absTime );
+            if (deadline > currentTime)
+            {
+                OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
+                          deadline - currentTime);
+
+                // wait
+                oc_cond_wait_for(context->threadCond, context->threadMutex,
+                                 deadline - currentTime);
+            }
         }
         else
         {
@@ -360,7 +520,10 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
     context->timeoutCallback = timeoutCallback;
     context->config = cfg;
     context->isStop = false;
-    context->dataList = u_arraylist_create();
+    context->dataHeap = NULL;
+    context->dataHeapSize = 0;
+    context->dataHeapCapacity = 0;
+    context->dataIndex = NULL;
 
     return CA_STATUS_OK;
 }
@@ -431,53 +594,49 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     retData->timeout = CAGetTimeoutValue();
 #endif
     retData->triedCount = 0;
+    retData->deadline = CAGetRetransmissionDeadline(retData);
     retData->messageId = messageId;
     retData->endpoint = remoteEndpoint;
     retData->pdu = pduData;
     retData->size = size;
     retData->dataType = dataType;
-#ifndef SINGLE_THREAD
+    CAMakeRetransmissionKey(&retData->key, messageId, endpoint->adapter);
+
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    size_t len = u_arraylist_length(context->dataList);
-
-    // #3. add data into list
-    for (size_t i = 0; i < len; i++)
+    // #3. add data into the heap and the message id index
+    if (NULL != CAFindRetransmissionData(context, messageId, endpoint->adapter))
     {
-        CARetransmissionData_t *currData = u_arraylist_get(context->dataList, i);
+        OIC_LOG(ERROR, TAG, "Duplicate message ID");
 
-        if (NULL == currData)
-        {
-            continue;
-        }
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-        // found index
-        if (NULL != currData->endpoint && currData->messageId == messageId
-            && (currData->endpoint->adapter == endpoint->adapter))
-        {
-            OIC_LOG(ERROR, TAG, "Duplicate message ID");
+        CAFreeRetransmissionData(retData);
+        return CA_STATUS_FAILED;
+    }
 
-            // mutex unlock
-            oc_mutex_unlock(context->threadMutex);
+    if (CA_STATUS_OK != CAAddRetransmissionData(context, retData))
+    {
+        OIC_LOG(ERROR, TAG, "memory error");
 
-            OICFree(retData);
-            OICFree(pduData);
-            OICFree(remoteEndpoint);
-            return CA_STATUS_FAILED;
-        }
-    }
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-    u_arraylist_add(context->dataList, (void *) retData);
+        CAFreeRetransmissionData(retData);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
 
+#ifndef SINGLE_THREAD
     // notify the thread
     oc_cond_signal(context->threadCond);
 
     // mutex unlock
     oc_mutex_unlock(context->threadMutex);
-
 #else
-    u_arraylist_add(context->dataList, (void *) retData);
+    // mutex unlock
+    oc_mutex_unlock(context->threadMutex);
 
     CACheckRetransmissionList(context);
 #endif
@@ -519,73 +678,46 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
 
     // mutex lock
     oc_mutex_lock(context->threadMutex);
-    size_t len = u_arraylist_length(context->dataList);
 
-    for (size_t i = 0; i < len; i++)
+    CARetransmissionData_t *retData = CAFindRetransmissionData(context, messageId,
+                                                               endpoint->adapter);
+    if (NULL != retData)
     {
-        CARetransmissionData_t *retData = (CARetransmissionData_t *) u_arraylist_get(
-                context->dataList, i);
-
-        if (NULL == retData)
+        // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
+        // if retransmission was finish..token will be unavailable.
+        if (CA_EMPTY == code)
         {
-            continue;
-        }
+            OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
 
-        // found index
-        if (NULL != retData->endpoint && retData->messageId == messageId
-            && (retData->endpoint->adapter == endpoint->adapter))
-        {
-            // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
-            // if retransmission was finish..token will be unavailable.
-            if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
+            if (NULL == retData->pdu)
             {
-                OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
-
-                if (NULL == retData->pdu)
-                {
-                    OIC_LOG(ERROR, TAG, "retData->pdu is null");
-                    OICFree(retData);
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_STATUS_FAILED;
-                }
-
-                // copy PDU data
-                (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
-                if ((*retransmissionPdu) == NULL)
-                {
-                    OICFree(retData);
-                    OIC_LOG(ERROR, TAG, "memory error");
-
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy((*retransmissionPdu), retData->pdu, retData->size);
+                OIC_LOG(ERROR, TAG, "retData->pdu is null");
+                // mutex unlock
+                oc_mutex_unlock(context->threadMutex);
+
+                return CA_STATUS_FAILED;
             }
 
-            // #2. remove data from list
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
+            // copy PDU data
+            (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
+            if ((*retransmissionPdu) == NULL)
             {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
+                OIC_LOG(ERROR, TAG, "memory error");
 
                 // mutex unlock
                 oc_mutex_unlock(context->threadMutex);
 
-                return CA_STATUS_FAILED;
+                return CA_MEMORY_ALLOC_FAILED;
             }
+            memcpy((*retransmissionPdu), retData->pdu, retData->size);
+        }
 
-            OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+        // #2. remove data from the heap and the index
+        CARemoveRetransmissionData(context, retData);
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-            OICFree(removedData);
+        OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
 
-            break;
-        }
+        CAFreeRetransmissionData(retData);
     }
 
     // mutex unlock
@@ -633,24 +765,37 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
     OIC_LOG(DEBUG, TAG, "retransmission context destroy..");
 
     oc_mutex_lock(context->threadMutex);
-    size_t len = u_arraylist_length(context->dataList);
-    for (size_t i = 0; i < len; i++)
+    HASH_CLEAR(hh, context->dataIndex);
+    for (size_t i = 0; i < context->dataHeapSize; i++)
     {
-        CARetransmissionData_t *data = u_arraylist_get(context->dataList, i);
-        if (NULL == data)
-        {
-            continue;
-        }
-        CAFreeEndpoint(data->endpoint);
-        OICFree(data->pdu);
-        OICFree(data);
+        CAFreeRetransmissionData(context->dataHeap[i]);
     }
+    OICFree(context->dataHeap);
+    context->dataHeap = NULL;
+    context->dataHeapSize = 0;
+    context->dataHeapCapacity = 0;
+    context->stats.queueDepth = 0;
     oc_mutex_unlock(context->threadMutex);
 
     oc_mutex_free(context->threadMutex);
     context->threadMutex = NULL;
     oc_cond_free(context->threadCond);
-    u_arraylist_free(&context->dataList);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CARetransmissionGetStats(CARetransmission_t *context,
+                                    CARetransmissionStats_t *stats)
+{
+    if (NULL == context || NULL == stats)
+    {
+        OIC_LOG(ERROR, TAG, "invalid parameter");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    oc_mutex_lock(context->threadMutex);
+    *stats = context->stats;
+    oc_mutex_unlock(context->threadMutex);
 
     return CA_STATUS_OK;
 }
@@ -46,6 +46,9 @@
 #ifdef HAVE_SYS_SELECT_H
 #include <sys/select.h>
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
 #endif
@@ -89,6 +92,17 @@
 
 #define SELECT_TIMEOUT 1     // select() seconds (and termination latency)
 
+#if defined(HAVE_SYS_EPOLL_H) && !defined(WSA_WAIT_EVENT_0)
+/*
+ * Wait for the sockets with epoll and drain them with recvmmsg.
+ * select() is still used when the epoll instance cannot be created.
+ */
+#define IP_USE_EPOLL
+
+#define EPOLL_MAX_EVENTS     16   // events returned by one epoll_wait()
+#define RECV_BATCH_SIZE      16   // datagrams read by one recvmmsg()
+#endif
+
 #define IPv4_MULTICAST     "224.0.1.187"
 static struct in_addr IPv4MulticastAddress = { 0 };
 
@@ -155,6 +169,10 @@ static void CAEventReturned(CASocketFd_t socket);
 #endif
 
 static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags);
+static CAResult_t CAHandleReceivedPacket(CATransportFlags_t flags,
+                                         struct sockaddr_storage *srcAddr, int namelen,
+                                         unsigned char *pktinfo,
+                                         char *recvBuffer, size_t recvLen);
 
 static void CAReceiveHandler(void *data)
 {
@@ -175,6 +193,58 @@ static void CAReceiveHandler(void *data)
 
 #if !defined(WSA_WAIT_EVENT_0)
 
+static void CAHandleNetlinkEvent()
+{
+#if NETWORK_INTERFACE_CHANGED_LOGGING
+    OIC_LOG_V(DEBUG, TAG, "Netlink event detacted");
+#endif
+    u_arraylist_t *iflist = CAFindInterfaceChange();
+    if (iflist)
+    {
+        size_t listLength = u_arraylist_length(iflist);
+        for (size_t i = 0; i < listLength; i++)
+        {
+            CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
+            if (ifitem)
+            {
+                CAProcessNewInterface(ifitem);
+            }
+        }
+        u_arraylist_destroy(iflist);
+    }
+}
+
+#ifdef IP_USE_EPOLL
+/*
+ * Tags stored in epoll_event.data.u32. Values below EPOLL_TAG_NETLINK
+ * index g_epollSockets.
+ */
+#define EPOLL_TAG_NETLINK   8
+#define EPOLL_TAG_SHUTDOWN  9
+
+typedef struct
+{
+    CASocket_t *socket;
+    CATransportFlags_t flags;
+} CAEpollSocket_t;
+
+static const CAEpollSocket_t g_epollSockets[EPOLL_TAG_NETLINK] = {
+    { &caglobals.ip.u6,  CA_IPV6 },
+    { &caglobals.ip.u6s, CA_IPV6 | CA_SECURE },
+    { &caglobals.ip.u4,  CA_IPV4 },
+    { &caglobals.ip.u4s, CA_IPV4 | CA_SECURE },
+    { &caglobals.ip.m6,  CA_MULTICAST | CA_IPV6 },
+    { &caglobals.ip.m6s, CA_MULTICAST | CA_IPV6 | CA_SECURE },
+    { &caglobals.ip.m4,  CA_MULTICAST | CA_IPV4 },
+    { &caglobals.ip.m4s, CA_MULTICAST | CA_IPV4 | CA_SECURE }
+};
+
+static int g_epollFd = -1;
+
+static void CAEpollFindReadyMessage();
+static void CAReceiveMessageBatch(CASocketFd_t fd, CATransportFlags_t flags);
+#endif
+
 #define SET(TYPE, FDS) \
     if (caglobals.ip.TYPE.fd != OC_INVALID_SOCKET) \
     { \
@@ -191,6 +261,13 @@ static void CAReceiveHandler(void *data)
 
 static void CAFindReadyMessage()
 {
+#ifdef IP_USE_EPOLL
+    if (-1 != g_epollFd)
+    {
+        CAEpollFindReadyMessage();
+        return;
+    }
+#endif
     fd_set readFds;
     struct timeval timeout;
 
@@ -258,23 +335,7 @@ static void CASelectReturned(fd_set *readFds, int ret)
         else ISSET(m4s, readFds, CA_MULTICAST | CA_IPV4 | CA_SECURE)
         else if ((caglobals.ip.netlinkFd != OC_INVALID_SOCKET) && FD_ISSET(caglobals.ip.netlinkFd, readFds))
         {
-#if NETWORK_INTERFACE_CHANGED_LOGGING
-            OIC_LOG_V(DEBUG, TAG, "Netlink event detacted");
-#endif
-            u_arraylist_t *iflist = CAFindInterfaceChange();
-            if (iflist)
-            {
-                size_t listLength = u_arraylist_length(iflist);
-                for (size_t i = 0; i < listLength; i++)
-                {
-                    CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
-                    if (ifitem)
-                    {
-                        CAProcessNewInterface(ifitem);
-                    }
-                }
-                u_arraylist_destroy(iflist);
-            }
+            CAHandleNetlinkEvent();
             break;
         }
         else if (FD_ISSET(caglobals.ip.shutdownFds[0], readFds))
@@ -296,6 +357,115 @@ static void CASelectReturned(fd_set *readFds, int ret)
     }
 }
 
+#ifdef IP_USE_EPOLL
+static bool CAEpollAdd(int fd, uint32_t events, uint32_t tag)
+{
+    struct epoll_event event = { .events = events, .data = { .u32 = tag } };
+    if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl failed: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static void CAEpollTerminate()
+{
+    if (-1 != g_epollFd)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+    }
+}
+
+/*
+ * Register the sockets created by CAIPStartServer. The data sockets are
+ * edge-triggered and drained with recvmmsg; the netlink and shutdown fds
+ * stay level-triggered as they are read one message at a time.
+ * On failure g_epollFd is left invalid and CAFindReadyMessage uses select().
+ */
+static void CAEpollInitialize()
+{
+    CAEpollTerminate();
+
+    g_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == g_epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed, using select: %s", strerror(errno));
+        return;
+    }
+
+    bool success = true;
+    for (uint32_t i = 0; success && i < EPOLL_TAG_NETLINK; i++)
+    {
+        if (OC_INVALID_SOCKET != g_epollSockets[i].socket->fd)
+        {
+            success = CAEpollAdd(g_epollSockets[i].socket->fd, EPOLLIN | EPOLLET, i);
+        }
+    }
+    if (success && OC_INVALID_SOCKET != caglobals.ip.netlinkFd)
+    {
+        success = CAEpollAdd(caglobals.ip.netlinkFd, EPOLLIN, EPOLL_TAG_NETLINK);
+    }
+    if (success && -1 != caglobals.ip.shutdownFds[0])
+    {
+        success = CAEpollAdd(caglobals.ip.shutdownFds[0], EPOLLIN, EPOLL_TAG_SHUTDOWN);
+    }
+
+    if (!success)
+    {
+        OIC_LOG(ERROR, TAG, "epoll registration failed, using select");
+        CAEpollTerminate();
+    }
+}
+
+static void CAEpollFindReadyMessage()
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int timeout = caglobals.ip.selectTimeout == -1 ? -1 : caglobals.ip.selectTimeout * 1000;
+
+    int ret = epoll_wait(g_epollFd, events, EPOLL_MAX_EVENTS, timeout);
+
+    if (caglobals.ip.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+
+    if (0 > ret)
+    {
+        if (EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; i < ret && !caglobals.ip.terminate; i++)
+    {
+        uint32_t tag = events[i].data.u32;
+        if (EPOLL_TAG_NETLINK == tag)
+        {
+            CAHandleNetlinkEvent();
+        }
+        else if (EPOLL_TAG_SHUTDOWN == tag)
+        {
+            char buf[10] = {0};
+            ssize_t len = read(caglobals.ip.shutdownFds[0], buf, sizeof (buf));
+            (void)len;
+        }
+        else if (tag < EPOLL_TAG_NETLINK)
+        {
+            CASocketFd_t fd = g_epollSockets[tag].socket->fd;
+            if (OC_INVALID_SOCKET != fd)
+            {
+                CAReceiveMessageBatch(fd, g_epollSockets[tag].flags);
+            }
+        }
+    }
+}
+#endif // IP_USE_EPOLL
+
 #else // if defined(WSA_WAIT_EVENT_0)
 
 #define PUSH_HANDLE(HANDLE, ARRAY, INDEX) \
@@ -538,6 +708,9 @@ void CADeInitializeIPGlobals()
     CLOSE_SOCKET(m4s);
 
     CAUnregisterForAddressChanges();
+#ifdef IP_USE_EPOLL
+    CAEpollTerminate();
+#endif
 }
 
 static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
@@ -642,6 +815,14 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
         }
     }
 #endif // !defined(WSA_CMSG_DATA)
+    return CAHandleReceivedPacket(flags, &srcAddr, namelen, pktinfo, recvBuffer, recvLen);
+}
+
+static CAResult_t CAHandleReceivedPacket(CATransportFlags_t flags,
+                                         struct sockaddr_storage *srcAddr, int namelen,
+                                         unsigned char *pktinfo,
+                                         char *recvBuffer, size_t recvLen)
+{
     if (!pktinfo)
     {
         OIC_LOG(ERROR, TAG, "pktinfo is null");
@@ -680,7 +861,7 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
         }
     }
 
-    CAConvertAddrToName(&srcAddr, namelen, sep.endpoint.addr, &sep.endpoint.port);
+    CAConvertAddrToName(srcAddr, namelen, sep.endpoint.addr, &sep.endpoint.port);
 
     if (flags & CA_SECURE)
     {
@@ -705,6 +886,93 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
     return CA_STATUS_OK;
 }
 
+#ifdef IP_USE_EPOLL
+/*
+ * Read every datagram queued on an edge-triggered socket, RECV_BATCH_SIZE
+ * datagrams per recvmmsg() call. Only the receive thread calls this, so the
+ * buffers are static.
+ */
+static void CAReceiveMessageBatch(CASocketFd_t fd, CATransportFlags_t flags)
+{
+    static char recvBuffers[RECV_BATCH_SIZE][COAP_MAX_PDU_SIZE];
+    static struct sockaddr_storage srcAddrs[RECV_BATCH_SIZE];
+    static union control
+    {
+        struct cmsghdr cmsg;
+        unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
+    } cmsgs[RECV_BATCH_SIZE];
+    struct iovec iovs[RECV_BATCH_SIZE];
+    struct mmsghdr msgs[RECV_BATCH_SIZE];
+
+    int namelen = 0;
+    int level = 0;
+    int type = 0;
+    if (flags & CA_IPV6)
+    {
+        namelen = sizeof (struct sockaddr_in6);
+        level = IPPROTO_IPV6;
+        type = IPV6_PKTINFO;
+    }
+    else
+    {
+        namelen = sizeof (struct sockaddr_in);
+        level = IPPROTO_IP;
+        type = IP_PKTINFO;
+    }
+
+    while (!caglobals.ip.terminate)
+    {
+        memset(msgs, 0, sizeof (msgs));
+        for (size_t i = 0; i < RECV_BATCH_SIZE; i++)
+        {
+            iovs[i].iov_base = recvBuffers[i];
+            iovs[i].iov_len = sizeof (recvBuffers[i]);
+            msgs[i].msg_hdr.msg_name = &srcAddrs[i];
+            msgs[i].msg_hdr.msg_namelen = namelen;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = &cmsgs[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof (cmsgs[i]);
+        }
+
+        int count = recvmmsg(fd, msgs, RECV_BATCH_SIZE, MSG_DONTWAIT, NULL);
+        if (-1 == count)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if (EAGAIN != errno && EWOULDBLOCK != errno)
+            {
+                OIC_LOG_V(ERROR, TAG, "recvmmsg failed %s", strerror(errno));
+            }
+            return;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            unsigned char *pktinfo = NULL;
+            for (struct cmsghdr *cmp = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmp != NULL;
+                 cmp = CMSG_NXTHDR(&msgs[i].msg_hdr, cmp))
+            {
+                if (cmp->cmsg_level == level && cmp->cmsg_type == type)
+                {
+                    pktinfo = CMSG_DATA(cmp);
+                }
+            }
+            (void)CAHandleReceivedPacket(flags, &srcAddrs[i], namelen, pktinfo,
+                                         recvBuffers[i], msgs[i].msg_len);
+        }
+
+        if (RECV_BATCH_SIZE > count)
+        {
+            // socket queue is drained; the next datagram raises a new edge.
+            return;
+        }
+    }
+}
+#endif // IP_USE_EPOLL
+
 void CAIPPullData()
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
@@ -988,6 +1256,11 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
     // create source of network address change notifications
     CARegisterForAddressChanges();
 
+#ifdef IP_USE_EPOLL
+    // wait on the sockets above with epoll, falling back to select on failure
+    CAEpollInitialize();
+#endif
+
     caglobals.ip.selectTimeout = CAGetPollingInterval(caglobals.ip.selectTimeout);
 
     res = CAIPStartListenServer();
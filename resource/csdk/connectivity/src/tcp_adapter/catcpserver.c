@@ -36,6 +36,9 @@
 #ifdef HAVE_SYS_POLL_H
 #include <sys/poll.h>
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 #include <stdio.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -71,6 +74,13 @@
 #include "ca_adapter_net_ssl.h"
 #endif
 
+/*
+ * The session indexes are grown by CAIndexSessionKey() and CAIndexSessionFd() only, which
+ * undo a HASH_ADD that ran out of memory and report it.
+ */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
+
 /**
  * Logging tag for module name.
  */
@@ -87,6 +97,25 @@
  */
 #define TLS_HEADER_SIZE 5
 
+#if defined(HAVE_SYS_EPOLL_H) && !defined(WSA_WAIT_EVENT_0)
+/**
+ * Wait for the sockets with epoll and use non-blocking sockets with
+ * per-session send queues. select() is still used when the epoll instance
+ * cannot be created.
+ */
+#define TCP_USE_EPOLL
+
+/**
+ * Events returned by one epoll_wait().
+ */
+#define EPOLL_MAX_EVENTS 64
+
+/**
+ * Maximum number of bytes queued on a session waiting to be sent.
+ */
+#define TCP_MAX_SEND_QUEUE_SIZE (1024 * 1024)
+#endif
+
 /**
  * Mutex to synchronize device object list.
  */
@@ -117,6 +146,23 @@ static CATCPConnectionHandleCallback g_connectionCallback = NULL;
  */
 static CATCPSessionInfo_t *g_sessionList = NULL;
 
+/**
+ * Sessions hashed by remote address and port.
+ */
+static CATCPSessionInfo_t *g_sessionIndex = NULL;
+
+/**
+ * Sessions hashed by file descriptor.
+ */
+static CATCPSessionInfo_t *g_sessionFdIndex = NULL;
+
+#ifdef TCP_USE_EPOLL
+/**
+ * epoll instance used by the receive thread, -1 when select() is used.
+ */
+static int g_epollFd = -1;
+#endif
+
 static CAResult_t CATCPCreateMutex();
 static void CATCPDestroyMutex();
 static CAResult_t CATCPCreateCond();
@@ -131,7 +177,14 @@ static void CASocketEventReturned(CASocketFd_t socket, long networkEvents);
 #endif
 static CAResult_t CAReceiveMessage(CATCPSessionInfo_t *svritem);
 static void CAReceiveHandler(void *data);
-static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem);
+static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem,
+                                    CASocketFd_t *sockFd, bool *connected);
+static bool CAAddSession(CATCPSessionInfo_t *session);
+static void CARemoveSession(CATCPSessionInfo_t *session);
+static bool CAIndexSessionKey(CATCPSessionInfo_t *session);
+static bool CAIndexSessionFd(CATCPSessionInfo_t *session);
+static CATCPSessionInfo_t *CAFindSession(const CAEndpoint_t *endpoint);
+static CATCPSessionInfo_t *CAFindSessionByFd(CASocketFd_t fd);
 
 #if defined(WSA_WAIT_EVENT_0)
 #define CHECKFD(FD)
@@ -206,6 +259,169 @@ static CAResult_t CATCPCreateCond()
     return CA_STATUS_OK;
 }
 
+static void CAMakeSessionKey(CATCPSessionKey_t *key, const char *addr, uint16_t port)
+{
+    memset(key, 0, sizeof(*key));
+    OICStrcpy(key->addr, sizeof(key->addr), addr);
+    key->port = port;
+}
+
+/**
+ * Add a session to the session list and the endpoint index.
+ * g_mutexObjectList must be held by the caller.
+ *
+ * @return false if the indexes could not grow, the session is not added then.
+ */
+static bool CAAddSession(CATCPSessionInfo_t *session)
+{
+    CAMakeSessionKey(&session->key, session->sep.endpoint.addr, session->sep.endpoint.port);
+
+    CATCPSessionInfo_t *head = NULL;
+    HASH_FIND(hh, g_sessionIndex, &session->key, sizeof(session->key), head);
+    if (head)
+    {
+        // same address and port with other transport flags, chain it behind the indexed one.
+        CATCPSessionInfo_t *last = head;
+        while (last->keyNext)
+        {
+            last = last->keyNext;
+        }
+        last->keyNext = session;
+    }
+    else if (!CAIndexSessionKey(session))
+    {
+        return false;
+    }
+
+    DL_APPEND(g_sessionList, session);
+    if (!CAIndexSessionFd(session))
+    {
+        CARemoveSession(session);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Index a session by its endpoint key.
+ * g_mutexObjectList must be held by the caller.
+ */
+static bool CAIndexSessionKey(CATCPSessionInfo_t *session)
+{
+    HASH_ADD(hh, g_sessionIndex, key, sizeof(session->key), session);
+    return true;
+uthash_oom:
+    if (NULL == session->hh.tbl || NULL == session->hh.tbl->buckets)
+    {
+        // The table of the first session could not be created.
+        uthash_free(session->hh.tbl, sizeof(UT_hash_table));
+        g_sessionIndex = NULL;
+    }
+    else
+    {
+        // The buckets could not be expanded, the session was already linked in.
+        HASH_DELETE(hh, g_sessionIndex, session);
+    }
+    OIC_LOG(ERROR, TAG, "session index allocation failed");
+    return false;
+}
+
+/**
+ * Index a session by its socket once the socket has been created.
+ * g_mutexObjectList must be held by the caller.
+ */
+static bool CAIndexSessionFd(CATCPSessionInfo_t *session)
+{
+    if (OC_INVALID_SOCKET != session->fd && !CAFindSessionByFd(session->fd))
+    {
+        HASH_ADD(hhFd, g_sessionFdIndex, fd, sizeof(session->fd), session);
+    }
+    return true;
+uthash_oom:
+    if (NULL == session->hhFd.tbl || NULL == session->hhFd.tbl->buckets)
+    {
+        uthash_free(session->hhFd.tbl, sizeof(UT_hash_table));
+        g_sessionFdIndex = NULL;
+    }
+    else
+    {
+        HASH_DELETE(hhFd, g_sessionFdIndex, session);
+    }
+    OIC_LOG(ERROR, TAG, "session fd index allocation failed");
+    return false;
+}
+
+/**
+ * Remove a session from the session list and the indexes.
+ * g_mutexObjectList must be held by the caller.
+ */
+static void CARemoveSession(CATCPSessionInfo_t *session)
+{
+    CATCPSessionInfo_t *head = NULL;
+    HASH_FIND(hh, g_sessionIndex, &session->key, sizeof(session->key), head);
+    if (head == session)
+    {
+        HASH_DELETE(hh, g_sessionIndex, session);
+        if (session->keyNext)
+        {
+            // if this fails, the chained sessions are still found by their sockets and
+            // cleaned up when they disconnect, only the endpoint lookup misses them.
+            CAIndexSessionKey(session->keyNext);
+        }
+    }
+    else
+    {
+        for (CATCPSessionInfo_t *item = head; item; item = item->keyNext)
+        {
+            if (item->keyNext == session)
+            {
+                item->keyNext = session->keyNext;
+                break;
+            }
+        }
+    }
+    session->keyNext = NULL;
+
+    if (OC_INVALID_SOCKET != session->fd && CAFindSessionByFd(session->fd) == session)
+    {
+        HASH_DELETE(hhFd, g_sessionFdIndex, session);
+    }
+
+    DL_DELETE(g_sessionList, session);
+}
+
+/**
+ * Find the session of a remote endpoint.
+ * g_mutexObjectList must be held by the caller.
+ */
+static CATCPSessionInfo_t *CAFindSession(const CAEndpoint_t *endpoint)
+{
+    CATCPSessionKey_t key;
+    CAMakeSessionKey(&key, endpoint->addr, endpoint->port);
+
+    CATCPSessionInfo_t *session = NULL;
+    HASH_FIND(hh, g_sessionIndex, &key, sizeof(key), session);
+    for (; session; session = session->keyNext)
+    {
+        if (session->sep.endpoint.flags & endpoint->flags)
+        {
+            return session;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Find the session using a socket.
+ * g_mutexObjectList must be held by the caller.
+ */
+static CATCPSessionInfo_t *CAFindSessionByFd(CASocketFd_t fd)
+{
+    CATCPSessionInfo_t *session = NULL;
+    HASH_FIND(hhFd, g_sessionFdIndex, &fd, sizeof(fd), session);
+    return session;
+}
+
 static void CAReceiveHandler(void *data)
 {
     (void)data;
@@ -225,8 +441,19 @@ static void CAReceiveHandler(void *data)
 
 #if !defined(WSA_WAIT_EVENT_0)
 
+#ifdef TCP_USE_EPOLL
+static void CAEpollFindReadyMessage();
+#endif
+
 static void CAFindReadyMessage()
 {
+#ifdef TCP_USE_EPOLL
+    if (-1 != g_epollFd)
+    {
+        CAEpollFindReadyMessage();
+        return;
+    }
+#endif
     fd_set readFds;
     struct timeval timeout = { .tv_sec = caglobals.tcp.selectTimeout };
 
@@ -336,7 +563,7 @@ static void CASelectReturned(fd_set *readFds)
                             OIC_LOG(ERROR, TAG, "Failed to close TLS session");
                         }
 #endif
-                        LL_DELETE(g_sessionList, session);
+                        CARemoveSession(session);
                         CADisconnectTCPSession(session);
                         oc_mutex_unlock(g_mutexObjectList);
                         return;
@@ -348,6 +575,334 @@ static void CASelectReturned(fd_set *readFds)
     }
 }
 
+#ifdef TCP_USE_EPOLL
+static bool CAEpollControl(int op, CASocketFd_t fd, uint32_t events)
+{
+    struct epoll_event event = { .events = events, .data = { .fd = fd } };
+    if (-1 == epoll_ctl(g_epollFd, op, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl(%d) failed: %s", op, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static bool CASetNonBlocking(CASocketFd_t fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    if (-1 == flags || -1 == fcntl(fd, F_SETFL, flags | O_NONBLOCK))
+    {
+        OIC_LOG_V(ERROR, TAG, "set O_NONBLOCK failed: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Register a session socket with the receive thread. The socket is watched for
+ * writability while it is connecting or has queued data.
+ * g_mutexObjectList must be held by the caller.
+ */
+static bool CAEpollWatchSession(CATCPSessionInfo_t *session, int op)
+{
+    uint32_t events = EPOLLIN;
+    if (CONNECTING == session->state || session->sendQueue)
+    {
+        events |= EPOLLOUT;
+    }
+    return CAEpollControl(op, session->fd, events);
+}
+
+static void CAEpollTerminate()
+{
+    if (-1 != g_epollFd)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+    }
+}
+
+/**
+ * Create the epoll instance and register the accept sockets and pipes.
+ * On failure g_epollFd is left invalid and CAFindReadyMessage uses select().
+ */
+static void CAEpollInitialize()
+{
+    CAEpollTerminate();
+
+    g_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == g_epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed, using select: %s", strerror(errno));
+        return;
+    }
+
+    CASocketFd_t fds[] = { caglobals.tcp.ipv4.fd, caglobals.tcp.ipv4s.fd,
+                           caglobals.tcp.ipv6.fd, caglobals.tcp.ipv6s.fd,
+                           caglobals.tcp.shutdownFds[0], caglobals.tcp.connectionFds[0] };
+    for (size_t i = 0; i < sizeof(fds) / sizeof(fds[0]); i++)
+    {
+        if (OC_INVALID_SOCKET != fds[i] && !CAEpollControl(EPOLL_CTL_ADD, fds[i], EPOLLIN))
+        {
+            OIC_LOG(ERROR, TAG, "epoll registration failed, using select");
+            CAEpollTerminate();
+            return;
+        }
+    }
+}
+
+/**
+ * Write as much queued data as the socket accepts.
+ * g_mutexObjectList must be held by the caller.
+ */
+static CAResult_t CAFlushSendQueue(CATCPSessionInfo_t *session)
+{
+    while (session->sendQueue)
+    {
+        CATCPSendItem_t *item = session->sendQueue;
+        ssize_t len = send(session->fd, item->data + item->offset, item->len - item->offset, 0);
+        if (-1 == len)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if (EAGAIN == errno || EWOULDBLOCK == errno)
+            {
+                return CA_STATUS_OK;
+            }
+            OIC_LOG_V(ERROR, TAG, "send failed: %s", strerror(errno));
+            return CA_SEND_FAILED;
+        }
+
+        item->offset += len;
+        session->sendQueueLen -= len;
+        if (item->offset == item->len)
+        {
+            session->sendQueue = item->next;
+            OICFree(item->data);
+            OICFree(item);
+        }
+    }
+    return CA_STATUS_OK;
+}
+
+/**
+ * Queue data behind the data already waiting on a session.
+ * g_mutexObjectList must be held by the caller.
+ */
+static CAResult_t CAQueueSendData(CATCPSessionInfo_t *session, const void *data, size_t dlen)
+{
+    if (TCP_MAX_SEND_QUEUE_SIZE < session->sendQueueLen + dlen)
+    {
+        OIC_LOG_V(ERROR, TAG, "send queue of [%s:%u] is full",
+                  session->sep.endpoint.addr, session->sep.endpoint.port);
+        return CA_SEND_FAILED;
+    }
+
+    CATCPSendItem_t *item = (CATCPSendItem_t *) OICCalloc(1, sizeof (*item));
+    if (!item)
+    {
+        OIC_LOG(ERROR, TAG, "Out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    item->data = (unsigned char *) OICMalloc(dlen);
+    if (!item->data)
+    {
+        OIC_LOG(ERROR, TAG, "Out of memory");
+        OICFree(item);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    memcpy(item->data, data, dlen);
+    item->len = dlen;
+
+    LL_APPEND(session->sendQueue, item);
+    session->sendQueueLen += dlen;
+    return CA_STATUS_OK;
+}
+
+/**
+ * Report data that will never be sent because the session is closing.
+ */
+static void CAReportSendQueueFailure(CATCPSessionInfo_t *session)
+{
+    CATCPSendItem_t *item = NULL;
+    LL_FOREACH(session->sendQueue, item)
+    {
+        if (g_tcpErrorHandler)
+        {
+            g_tcpErrorHandler(&session->sep.endpoint, item->data + item->offset,
+                              item->len - item->offset, CA_SEND_FAILED);
+        }
+    }
+}
+
+static void CAClearSendQueue(CATCPSessionInfo_t *session)
+{
+    CATCPSendItem_t *item = NULL;
+    CATCPSendItem_t *tmp = NULL;
+    LL_FOREACH_SAFE(session->sendQueue, item, tmp)
+    {
+        OICFree(item->data);
+        OICFree(item);
+    }
+    session->sendQueue = NULL;
+    session->sendQueueLen = 0;
+}
+
+/**
+ * Finish a non-blocking connect once the socket reports writable.
+ * g_mutexObjectList must be held by the caller, which reports the connection
+ * to the CA Common Layer once it released the lock.
+ */
+static CAResult_t CACompleteConnect(CATCPSessionInfo_t *session)
+{
+    int error = 0;
+    socklen_t len = sizeof (error);
+    if (0 != getsockopt(session->fd, SOL_SOCKET, SO_ERROR, &error, &len))
+    {
+        error = errno;
+    }
+    if (0 != error)
+    {
+        OIC_LOG_V(ERROR, TAG, "failed to connect socket, %s", strerror(error));
+        CALogSendStateInfo(session->sep.endpoint.adapter, session->sep.endpoint.addr,
+                           session->sep.endpoint.port, 0, false, strerror(error));
+        return CA_SOCKET_OPERATION_FAILED;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "connect socket success [%s:%u]",
+              session->sep.endpoint.addr, session->sep.endpoint.port);
+    session->state = CONNECTED;
+    return CAFlushSendQueue(session);
+}
+
+/**
+ * Close a session that failed, reporting the data still queued on it.
+ * g_mutexObjectList must be held by the caller.
+ */
+static void CAEpollDropSession(CATCPSessionInfo_t *session)
+{
+#ifdef __WITH_TLS__
+    if (CONNECTED == session->state
+        && CA_STATUS_OK != CAcloseSslConnection(&session->sep.endpoint))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to close TLS session");
+    }
+#endif
+    CAReportSendQueueFailure(session);
+    CARemoveSession(session);
+    CADisconnectTCPSession(session);
+}
+
+static void CAEpollSessionReturned(CASocketFd_t fd, uint32_t events)
+{
+    oc_mutex_lock(g_mutexObjectList);
+    CATCPSessionInfo_t *session = CAFindSessionByFd(fd);
+    if (!session)
+    {
+        oc_mutex_unlock(g_mutexObjectList);
+        return;
+    }
+
+    CAResult_t res = CA_STATUS_OK;
+    bool connected = false;
+    CAEndpoint_t endpoint = session->sep.endpoint;
+    bool isClient = session->isClient;
+    if (CONNECTING == session->state)
+    {
+        if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+        {
+            res = CACompleteConnect(session);
+            connected = (CA_STATUS_OK == res);
+        }
+    }
+    else
+    {
+        if (events & EPOLLOUT)
+        {
+            res = CAFlushSendQueue(session);
+        }
+        if (CA_STATUS_OK == res && (events & (EPOLLIN | EPOLLERR | EPOLLHUP)))
+        {
+            res = CAReceiveMessage(session);
+        }
+    }
+
+    //disconnect session and clean-up data if any error occurs
+    if (CA_STATUS_OK != res)
+    {
+        CAEpollDropSession(session);
+    }
+    else if (!session->sendQueue && (events & EPOLLOUT))
+    {
+        // nothing left to write, stop watching for writability.
+        CAEpollWatchSession(session, EPOLL_CTL_MOD);
+    }
+    oc_mutex_unlock(g_mutexObjectList);
+
+    // pass the connection information to CA Common Layer.
+    if (connected && g_connectionCallback)
+    {
+        g_connectionCallback(&endpoint, true, isClient);
+    }
+}
+
+static void CAEpollFindReadyMessage()
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int timeout = caglobals.tcp.selectTimeout < 0 ? -1 : caglobals.tcp.selectTimeout * 1000;
+
+    int ret = epoll_wait(g_epollFd, events, EPOLL_MAX_EVENTS, timeout);
+
+    if (caglobals.tcp.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+
+    if (0 > ret)
+    {
+        if (EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; i < ret && !caglobals.tcp.terminate; i++)
+    {
+        CASocketFd_t fd = events[i].data.fd;
+        if (fd == caglobals.tcp.ipv4.fd)
+        {
+            CAAcceptConnection(CA_IPV4, &caglobals.tcp.ipv4);
+        }
+        else if (fd == caglobals.tcp.ipv4s.fd)
+        {
+            CAAcceptConnection(CA_IPV4 | CA_SECURE, &caglobals.tcp.ipv4s);
+        }
+        else if (fd == caglobals.tcp.ipv6.fd)
+        {
+            CAAcceptConnection(CA_IPV6, &caglobals.tcp.ipv6);
+        }
+        else if (fd == caglobals.tcp.ipv6s.fd)
+        {
+            CAAcceptConnection(CA_IPV6 | CA_SECURE, &caglobals.tcp.ipv6s);
+        }
+        else if (fd == caglobals.tcp.connectionFds[0] || fd == caglobals.tcp.shutdownFds[0])
+        {
+            char buf[MAX_ADDR_STR_SIZE_CA] = {0};
+            ssize_t len = read(fd, buf, sizeof (buf));
+            (void)len;
+        }
+        else
+        {
+            CAEpollSessionReturned(fd, events[i].events);
+        }
+    }
+}
+#endif // TCP_USE_EPOLL
+
 #else // if defined(WSA_WAIT_EVENT_0)
 
 /**
@@ -534,27 +1089,21 @@ static void CASocketEventReturned(CASocketFd_t s, long networkEvents)
     if (FD_READ & networkEvents)
     {
         oc_mutex_lock(g_mutexObjectList);
-        CATCPSessionInfo_t *session = NULL;
-        CATCPSessionInfo_t *tmp = NULL;
-        LL_FOREACH_SAFE(g_sessionList, session, tmp)
+        CATCPSessionInfo_t *session = CAFindSessionByFd(s);
+        if (session)
         {
-            if (session && (session->fd == s))
+            CAResult_t res = CAReceiveMessage(session);
+            //disconnect session and clean-up data if any error occurs
+            if (res != CA_STATUS_OK)
             {
-                CAResult_t res = CAReceiveMessage(session);
-                //disconnect session and clean-up data if any error occurs
-                if (res != CA_STATUS_OK)
-                {
 #ifdef __WITH_TLS__
-                    if (CA_STATUS_OK != CAcloseSslConnection(&session->sep.endpoint))
-                    {
-                        OIC_LOG(ERROR, TAG, "Failed to close TLS session");
-                    }
-#endif
-                    LL_DELETE(g_sessionList, session);
-                    CADisconnectTCPSession(session);
-                    oc_mutex_unlock(g_mutexObjectList);
-                    return;
+                if (CA_STATUS_OK != CAcloseSslConnection(&session->sep.endpoint))
+                {
+                    OIC_LOG(ERROR, TAG, "Failed to close TLS session");
                 }
+#endif
+                CARemoveSession(session);
+                CADisconnectTCPSession(session);
             }
         }
         oc_mutex_unlock(g_mutexObjectList);
@@ -595,7 +1144,27 @@ static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
                             svritem->sep.endpoint.addr, &svritem->sep.endpoint.port);
 
         oc_mutex_lock(g_mutexObjectList);
-        LL_APPEND(g_sessionList, svritem);
+#ifdef TCP_USE_EPOLL
+        if (-1 != g_epollFd)
+        {
+            if (!CASetNonBlocking(sockfd) || !CAEpollWatchSession(svritem, EPOLL_CTL_ADD))
+            {
+                oc_mutex_unlock(g_mutexObjectList);
+                OC_CLOSE_SOCKET(sockfd);
+                OICFree(svritem);
+                return;
+            }
+        }
+#endif
+        if (!CAAddSession(svritem))
+        {
+            oc_mutex_unlock(g_mutexObjectList);
+            OC_CLOSE_SOCKET(sockfd);
+            OICFree(svritem);
+            return;
+        }
+        // the receive thread owns the session once the lock is released.
+        CAEndpoint_t endpoint = svritem->sep.endpoint;
         oc_mutex_unlock(g_mutexObjectList);
 
         CHECKFD(sockfd);
@@ -603,7 +1172,7 @@ static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
         // pass the connection information to CA Common Layer.
         if (g_connectionCallback)
         {
-            g_connectionCallback(&(svritem->sep.endpoint), true, svritem->isClient);
+            g_connectionCallback(&endpoint, true, false);
         }
     }
 }
@@ -771,18 +1340,19 @@ static CAResult_t CAReceiveMessage(CATCPSessionInfo_t *svritem)
             {
                 OIC_LOG_V(ERROR, TAG, "total tls length is too big (buffer size : %u)",
                                     sizeof(svritem->tlsdata));
-                if (CA_STATUS_OK != CAcloseSslConnection(&svritem->sep.endpoint))
-                {
-                    OIC_LOG(ERROR, TAG, "Failed to close TLS session");
-                }
-                CASearchAndDeleteTCPSession(&(svritem->sep.endpoint));
+                // the caller closes the TLS session and disconnects.
                 return CA_RECEIVE_FAILED;
             }
             nbRead = tlsLength - svritem->tlsLen;
         }
 
         len = recv(svritem->fd, (char*)svritem->tlsdata + svritem->tlsLen, (int)nbRead, 0);
-        if (len < 0)
+        if (len < 0 && (EAGAIN == errno || EWOULDBLOCK == errno))
+        {
+            // non-blocking socket with nothing to read yet.
+            res = CA_STATUS_OK;
+        }
+        else if (len < 0)
         {
             OIC_LOG_V(ERROR, TAG, "recv failed %s", strerror(errno));
             res = CA_RECEIVE_FAILED;
@@ -814,7 +1384,12 @@ static CAResult_t CAReceiveMessage(CATCPSessionInfo_t *svritem)
 
         // svritem->tlsdata can also be used as receiving buffer in case of raw tcp
         len = recv(svritem->fd, (char*)svritem->tlsdata, sizeof(svritem->tlsdata), 0);
-        if (len < 0)
+        if (len < 0 && (EAGAIN == errno || EWOULDBLOCK == errno))
+        {
+            // non-blocking socket with nothing to read yet.
+            res = CA_STATUS_OK;
+        }
+        else if (len < 0)
         {
             OIC_LOG_V(ERROR, TAG, "recv failed %s", strerror(errno));
             res = CA_RECEIVE_FAILED;
@@ -870,9 +1445,17 @@ static void CAWakeUpForReadFdsUpdate()
 }
 #endif
 
-static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem)
+/**
+ * Create the socket of a session and connect it.
+ * In epoll mode the receive thread may complete the connect and free the session as soon
+ * as it watches the socket, so the socket is returned in sockFd for the caller to use.
+ */
+static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem,
+                                    CASocketFd_t *sockFd, bool *connected)
 {
     VERIFY_NON_NULL(svritem, TAG, "svritem is NULL");
+    *sockFd = OC_INVALID_SOCKET;
+    *connected = false;
 
     OIC_LOG_V(DEBUG, TAG, "try to connect with [%s:%u]",
               svritem->sep.endpoint.addr, svritem->sep.endpoint.port);
@@ -884,7 +1467,15 @@ static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem)
         OIC_LOG_V(ERROR, TAG, "create socket failed: %s", strerror(errno));
         return CA_SOCKET_OPERATION_FAILED;
     }
+    oc_mutex_lock(g_mutexObjectList);
     svritem->fd = fd;
+    bool indexed = CAIndexSessionFd(svritem);
+    oc_mutex_unlock(g_mutexObjectList);
+    if (!indexed)
+    {
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    *sockFd = fd;
 
     // #2. convert address from string to binary.
     struct sockaddr_storage sa = { .ss_family = (short)family };
@@ -907,6 +1498,41 @@ static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem)
         socklen = sizeof(struct sockaddr_in);
     }
 
+#ifdef TCP_USE_EPOLL
+    // #4. start a non-blocking connect, the receive thread completes it.
+    if (-1 != g_epollFd)
+    {
+        if (!CASetNonBlocking(fd))
+        {
+            return CA_SOCKET_OPERATION_FAILED;
+        }
+
+        oc_mutex_lock(g_mutexObjectList);
+        if (connect(fd, (struct sockaddr *)&sa, socklen) < 0)
+        {
+            if (EINPROGRESS != errno)
+            {
+                oc_mutex_unlock(g_mutexObjectList);
+                OIC_LOG_V(ERROR, TAG, "failed to connect socket, %s", strerror(errno));
+                CALogSendStateInfo(svritem->sep.endpoint.adapter, svritem->sep.endpoint.addr,
+                                   svritem->sep.endpoint.port, 0, false, strerror(errno));
+                return CA_SOCKET_OPERATION_FAILED;
+            }
+            OIC_LOG(DEBUG, TAG, "connect socket in progress");
+        }
+        else
+        {
+            OIC_LOG(DEBUG, TAG, "connect socket success");
+            svritem->state = CONNECTED;
+            *connected = true;
+        }
+        bool watched = CAEpollWatchSession(svritem, EPOLL_CTL_ADD);
+        oc_mutex_unlock(g_mutexObjectList);
+
+        return watched ? CA_STATUS_OK : CA_SOCKET_OPERATION_FAILED;
+    }
+#endif
+
     // #4. connect to remote server device.
     if (connect(fd, (struct sockaddr *)&sa, socklen) < 0)
     {
@@ -918,6 +1544,7 @@ static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem)
 
     OIC_LOG(DEBUG, TAG, "connect socket success");
     svritem->state = CONNECTED;
+    *connected = true;
     CHECKFD(svritem->fd);
 #if !defined(WSA_WAIT_EVENT_0)
     ssize_t len = CAWakeUpForReadFdsUpdate(svritem->sep.endpoint.addr);
@@ -1121,6 +1748,11 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     CHECKFD(caglobals.tcp.connectionFds[1]);
 #endif
 
+#ifdef TCP_USE_EPOLL
+    // wait on the sockets above with epoll, falling back to select on failure
+    CAEpollInitialize();
+#endif
+
     caglobals.tcp.terminate = false;
     res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
     if (CA_STATUS_OK != res)
@@ -1184,6 +1816,9 @@ void CATCPStopServer()
     close(caglobals.tcp.shutdownFds[0]);
     caglobals.tcp.shutdownFds[0] = OC_INVALID_SOCKET;
 #endif
+#ifdef TCP_USE_EPOLL
+    CAEpollTerminate();
+#endif
 
     // mutex unlock
     oc_mutex_unlock(g_mutexObjectList);
@@ -1243,11 +1878,111 @@ size_t CACheckPayloadLengthFromHeader(const void *data, size_t dlen)
     return payloadLen;
 }
 
+#ifdef TCP_USE_EPOLL
+/**
+ * Send data on a non-blocking session. Whatever the socket does not accept
+ * immediately, or everything while the session is still connecting, is queued
+ * and written by the receive thread once the socket becomes writable.
+ */
+static ssize_t sendDataQueued(const CAEndpoint_t *endpoint, const void *data,
+                              size_t dlen, const char *fam)
+{
+    // #1. find a session info from list.
+    oc_mutex_lock(g_mutexObjectList);
+    CATCPSessionInfo_t *session = CAFindSession(endpoint);
+    oc_mutex_unlock(g_mutexObjectList);
+    if (!session)
+    {
+        // if there is no connection info, connect to remote device.
+        if (OC_INVALID_SOCKET == CAConnectTCPSession(endpoint))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create tcp session object");
+            return -1;
+        }
+    }
+
+    oc_mutex_lock(g_mutexObjectList);
+    session = CAFindSession(endpoint);
+    if (!session)
+    {
+        oc_mutex_unlock(g_mutexObjectList);
+        OIC_LOG(ERROR, TAG, "tcp session was closed");
+        return -1;
+    }
+
+    // #2. send data to remote device, keeping the order of queued data.
+    size_t sentLen = 0;
+    if (CONNECTED == session->state && !session->sendQueue)
+    {
+        while (sentLen < dlen)
+        {
+            ssize_t len = send(session->fd, (const char *)data + sentLen, dlen - sentLen, 0);
+            if (-1 == len)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                if (EAGAIN == errno || EWOULDBLOCK == errno)
+                {
+                    break;
+                }
+                oc_mutex_unlock(g_mutexObjectList);
+                OIC_LOG_V(ERROR, TAG, "unicast %stcp sendTo failed: %s", fam, strerror(errno));
+                CALogSendStateInfo(endpoint->adapter, endpoint->addr, endpoint->port,
+                                   len, false, strerror(errno));
+                return -1;
+            }
+            sentLen += len;
+        }
+    }
+
+    // #3. queue the rest until the socket is writable.
+    if (sentLen < dlen)
+    {
+        // watch for writability first, so that a failure leaves this data to the caller.
+        if (!CAEpollControl(EPOLL_CTL_MOD, session->fd, EPOLLIN | EPOLLOUT))
+        {
+            // nothing would ever write the queue.
+            CAEpollDropSession(session);
+            oc_mutex_unlock(g_mutexObjectList);
+            CALogSendStateInfo(endpoint->adapter, endpoint->addr, endpoint->port,
+                               -1, false, "epoll_ctl failure");
+            return -1;
+        }
+        if (CA_STATUS_OK != CAQueueSendData(session, (const char *)data + sentLen, dlen - sentLen))
+        {
+            oc_mutex_unlock(g_mutexObjectList);
+            CALogSendStateInfo(endpoint->adapter, endpoint->addr, endpoint->port,
+                               -1, false, "send queue failure");
+            return -1;
+        }
+        OIC_LOG_V(DEBUG, TAG, "queued %" PRIuPTR " bytes", dlen - sentLen);
+    }
+    oc_mutex_unlock(g_mutexObjectList);
+
+#ifndef TB_LOG
+    (void)fam;
+#endif
+    OIC_LOG_V(INFO, TAG, "unicast %stcp sendTo is successful: %" PRIuPTR " bytes", fam, dlen);
+    CALogSendStateInfo(endpoint->adapter, endpoint->addr, endpoint->port,
+                       dlen, true, NULL);
+    return dlen;
+}
+#endif
+
 static ssize_t sendData(const CAEndpoint_t *endpoint, const void *data,
                         size_t dlen, const char *fam)
 {
     OIC_LOG_V(INFO, TAG, "The length of data that needs to be sent is %" PRIuPTR " bytes", dlen);
 
+#ifdef TCP_USE_EPOLL
+    if (-1 != g_epollFd)
+    {
+        return sendDataQueued(endpoint, data, dlen, fam);
+    }
+#endif
+
     // #1. find a session info from list.
     CASocketFd_t sockFd = CAGetSocketFDFromEndpoint(endpoint);
     if (OC_INVALID_SOCKET == sockFd)
@@ -1434,28 +2169,42 @@ CASocketFd_t CAConnectTCPSession(const CAEndpoint_t *endpoint)
         return OC_INVALID_SOCKET;
     }
     svritem->sep.endpoint = *endpoint;
+    svritem->fd = OC_INVALID_SOCKET;
     svritem->state = CONNECTING;
     svritem->isClient = true;
 
     // #2. add TCP connection info to list
     oc_mutex_lock(g_mutexObjectList);
-    LL_APPEND(g_sessionList, svritem);
+    if (!CAAddSession(svritem))
+    {
+        oc_mutex_unlock(g_mutexObjectList);
+        OICFree(svritem);
+        return OC_INVALID_SOCKET;
+    }
     oc_mutex_unlock(g_mutexObjectList);
 
     // #3. create the socket and connect to TCP server
-    int family = (svritem->sep.endpoint.flags & CA_IPV6) ? AF_INET6 : AF_INET;
-    if (CA_STATUS_OK != CATCPCreateSocket(family, svritem))
+    int family = (endpoint->flags & CA_IPV6) ? AF_INET6 : AF_INET;
+    CASocketFd_t fd = OC_INVALID_SOCKET;
+    bool connected = false;
+    if (CA_STATUS_OK != CATCPCreateSocket(family, svritem, &fd, &connected))
     {
+        oc_mutex_lock(g_mutexObjectList);
+        CARemoveSession(svritem);
+        CADisconnectTCPSession(svritem);
+        oc_mutex_unlock(g_mutexObjectList);
         return OC_INVALID_SOCKET;
     }
 
     // #4. pass the connection information to CA Common Layer.
-    if (g_connectionCallback)
+    // a non-blocking connect still in progress is reported by the receive thread,
+    // which may have freed svritem already.
+    if (g_connectionCallback && connected)
     {
-        g_connectionCallback(&(svritem->sep.endpoint), true, svritem->isClient);
+        g_connectionCallback(endpoint, true, true);
     }
 
-    return svritem->fd;
+    return fd;
 }
 
 CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *removedData)
@@ -1467,6 +2216,12 @@ CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *removedData)
     // close the socket and remove session info in list.
     if (removedData->fd != OC_INVALID_SOCKET)
     {
+#ifdef TCP_USE_EPOLL
+        if (-1 != g_epollFd)
+        {
+            epoll_ctl(g_epollFd, EPOLL_CTL_DEL, removedData->fd, NULL);
+        }
+#endif
         shutdown(removedData->fd, SHUT_RDWR);
         OC_CLOSE_SOCKET(removedData->fd);
         removedData->fd = OC_INVALID_SOCKET;
@@ -1482,6 +2237,9 @@ CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *removedData)
     }
     OICFree(removedData->data);
     removedData->data = NULL;
+#ifdef TCP_USE_EPOLL
+    CAClearSendQueue(removedData);
+#endif
 
     OICFree(removedData);
     removedData = NULL;
@@ -1499,13 +2257,15 @@ void CATCPDisconnectAll()
     {
         if (session)
         {
-            LL_DELETE(g_sessionList, session);
+            CARemoveSession(session);
             // disconnect session from remote device.
             CADisconnectTCPSession(session);
         }
     }
 
     g_sessionList = NULL;
+    g_sessionIndex = NULL;
+    g_sessionFdIndex = NULL;
     oc_mutex_unlock(g_mutexObjectList);
 
 #ifdef __WITH_TLS__
@@ -1521,17 +2281,11 @@ CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint
     OIC_LOG_V(DEBUG, TAG, "Looking for [%s:%d]", endpoint->addr, endpoint->port);
 
     // get connection info from list
-    CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
+    CATCPSessionInfo_t *session = CAFindSession(endpoint);
+    if (session)
     {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            return session;
-        }
+        OIC_LOG(DEBUG, TAG, "Found in session list");
+        return session;
     }
 
     OIC_LOG(DEBUG, TAG, "Session not found");
@@ -1546,18 +2300,13 @@ CASocketFd_t CAGetSocketFDFromEndpoint(const CAEndpoint_t *endpoint)
 
     // get connection info from list.
     oc_mutex_lock(g_mutexObjectList);
-    CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
+    CATCPSessionInfo_t *session = CAFindSession(endpoint);
+    if (session)
     {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            oc_mutex_unlock(g_mutexObjectList);
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            return session->fd;
-        }
+        CASocketFd_t fd = session->fd;
+        oc_mutex_unlock(g_mutexObjectList);
+        OIC_LOG(DEBUG, TAG, "Found in session list");
+        return fd;
     }
 
     oc_mutex_unlock(g_mutexObjectList);
@@ -1572,23 +2321,15 @@ CAResult_t CASearchAndDeleteTCPSession(const CAEndpoint_t *endpoint)
     OIC_LOG_V(DEBUG, TAG, "Looking for [%s:%d]", endpoint->addr, endpoint->port);
 
     // get connection info from list
-    CATCPSessionInfo_t *session = NULL;
-    CATCPSessionInfo_t *tmp = NULL;
-
     oc_mutex_lock(g_mutexObjectList);
-    LL_FOREACH_SAFE(g_sessionList, session, tmp)
+    CATCPSessionInfo_t *session = CAFindSession(endpoint);
+    if (session)
     {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            LL_DELETE(g_sessionList, session);
-            CADisconnectTCPSession(session);
-            oc_mutex_unlock(g_mutexObjectList);
-            return CA_STATUS_OK;
-        }
+        OIC_LOG(DEBUG, TAG, "Found in session list");
+        CARemoveSession(session);
+        CADisconnectTCPSession(session);
+        oc_mutex_unlock(g_mutexObjectList);
+        return CA_STATUS_OK;
     }
     oc_mutex_unlock(g_mutexObjectList);
 
@@ -0,0 +1,177 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include "gtest/gtest.h"
+
+#include "caduplicatecache.h"
+#include "oic_string.h"
+
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+
+#define TEST_LIFETIME_MS    (200)
+#define TEST_MAX_ENTRIES    (4)
+
+class CADuplicateCacheF : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(CA_STATUS_OK,
+                  CADuplicateCacheInitialize(&cache, TEST_LIFETIME_MS, TEST_MAX_ENTRIES));
+        memset(token, 0x5a, sizeof(token));
+    }
+
+    virtual void TearDown()
+    {
+        CADuplicateCacheDestroy(&cache);
+    }
+
+    static CAEndpoint_t Endpoint(int flags, const char *addr, uint16_t port)
+    {
+        CAEndpoint_t ep;
+        memset(&ep, 0, sizeof(ep));
+        ep.adapter = CA_ADAPTER_IP;
+        ep.flags = (CATransportFlags_t) flags;
+        ep.ifindex = 2;
+        OICStrcpy(ep.addr, sizeof(ep.addr), addr);
+        ep.port = port;
+        return ep;
+    }
+
+    bool Drop(const CAEndpoint_t &ep, uint16_t id)
+    {
+        return CADuplicateCacheCheck(&cache, &ep, id, token, sizeof(token));
+    }
+
+    CADuplicateStats_t Stats()
+    {
+        CADuplicateStats_t stats;
+        CADuplicateCacheGetStats(&cache, &stats);
+        return stats;
+    }
+
+    CADuplicateCache_t cache;
+    char token[8];
+};
+
+TEST_F(CADuplicateCacheF, RetransmissionIsDropped)
+{
+    CAEndpoint_t ep = Endpoint(CA_IPV6, "fe80::1", 5683);
+
+    EXPECT_FALSE(Drop(ep, 1));
+    EXPECT_TRUE(Drop(ep, 1));
+    EXPECT_TRUE(Drop(ep, 1));
+    EXPECT_FALSE(Drop(ep, 2));
+
+    CADuplicateStats_t stats = Stats();
+    EXPECT_EQ(2u, stats.entries);
+    EXPECT_EQ(2u, stats.duplicates);
+}
+
+TEST_F(CADuplicateCacheF, OtherSenderOfSameFamilyIsNotDropped)
+{
+    CAEndpoint_t first = Endpoint(CA_IPV4, "192.168.0.1", 5683);
+    CAEndpoint_t otherAddr = Endpoint(CA_IPV4, "192.168.0.2", 5683);
+    CAEndpoint_t otherPort = Endpoint(CA_IPV4, "192.168.0.1", 5684);
+
+    EXPECT_FALSE(Drop(first, 1));
+    EXPECT_FALSE(Drop(otherAddr, 1));
+    EXPECT_FALSE(Drop(otherPort, 1));
+    EXPECT_TRUE(Drop(otherPort, 1));
+    EXPECT_EQ(1u, Stats().duplicates);
+}
+
+TEST_F(CADuplicateCacheF, DuplicateExpiresAfterLifetime)
+{
+    CAEndpoint_t ep = Endpoint(CA_IPV6, "fe80::1", 5683);
+
+    EXPECT_FALSE(Drop(ep, 1));
+    EXPECT_TRUE(Drop(ep, 1));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_LIFETIME_MS + 100));
+
+    EXPECT_FALSE(Drop(ep, 1));
+    EXPECT_EQ(1u, Stats().entries);
+    EXPECT_TRUE(Drop(ep, 1));
+    EXPECT_EQ(0u, Stats().evicted);
+}
+
+TEST_F(CADuplicateCacheF, OldestEntryIsEvicted)
+{
+    CAEndpoint_t ep = Endpoint(CA_IPV6, "fe80::1", 5683);
+
+    for (uint16_t id = 0; id < TEST_MAX_ENTRIES; id++)
+    {
+        EXPECT_FALSE(Drop(ep, id));
+    }
+    CADuplicateStats_t stats = Stats();
+    EXPECT_EQ((uint32_t) TEST_MAX_ENTRIES, stats.entries);
+    EXPECT_EQ(0u, stats.evicted);
+
+    EXPECT_FALSE(Drop(ep, TEST_MAX_ENTRIES));
+    stats = Stats();
+    EXPECT_EQ((uint32_t) TEST_MAX_ENTRIES, stats.entries);
+    EXPECT_EQ(1u, stats.evicted);
+
+    // the oldest request is forgotten, the newer ones are still remembered
+    EXPECT_TRUE(Drop(ep, TEST_MAX_ENTRIES));
+    EXPECT_TRUE(Drop(ep, 1));
+    EXPECT_FALSE(Drop(ep, 0));
+    EXPECT_EQ(2u, Stats().evicted);
+}
+
+TEST_F(CADuplicateCacheF, MulticastCopyOverOtherFamilyIsDropped)
+{
+    CAEndpoint_t ipv6 = Endpoint(CA_IPV6 | CA_MULTICAST, "fe80::1", 50001);
+    CAEndpoint_t ipv4 = Endpoint(CA_IPV4 | CA_MULTICAST, "192.168.0.1", 50002);
+
+    EXPECT_FALSE(Drop(ipv6, 1));
+    EXPECT_TRUE(Drop(ipv4, 1));
+    EXPECT_TRUE(Drop(ipv4, 1));
+    EXPECT_TRUE(Drop(ipv6, 1));
+
+    // the copy named the sender of its family, another sender of that family is not dropped
+    CAEndpoint_t otherIpv4 = Endpoint(CA_IPV4 | CA_MULTICAST, "192.168.0.2", 50002);
+    EXPECT_FALSE(Drop(otherIpv4, 1));
+}
+
+TEST_F(CADuplicateCacheF, UnicastFromOtherFamilyIsNotDropped)
+{
+    CAEndpoint_t ipv6 = Endpoint(CA_IPV6, "fe80::1", 50001);
+    CAEndpoint_t ipv4 = Endpoint(CA_IPV4, "192.168.0.1", 50002);
+
+    EXPECT_FALSE(Drop(ipv6, 1));
+    EXPECT_FALSE(Drop(ipv4, 1));
+    EXPECT_TRUE(Drop(ipv4, 1));
+    EXPECT_EQ(1u, Stats().duplicates);
+}
+
+TEST_F(CADuplicateCacheF, TcpIsNotChecked)
+{
+    CAEndpoint_t ep = Endpoint(CA_IPV4, "192.168.0.1", 5683);
+    ep.adapter = CA_ADAPTER_TCP;
+
+    EXPECT_FALSE(Drop(ep, 0));
+    EXPECT_FALSE(Drop(ep, 0));
+    EXPECT_EQ(0u, Stats().entries);
+}
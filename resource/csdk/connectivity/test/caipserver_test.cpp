@@ -0,0 +1,220 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include "gtest/gtest.h"
+
+#include "caipinterface.h"
+#include "cathreadpool.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct ReceivedPacket
+{
+    CAEndpoint_t endpoint;
+    std::string data;
+};
+
+static std::mutex g_receivedMutex;
+static std::condition_variable g_receivedCond;
+static std::vector<ReceivedPacket> g_received;
+static std::shared_future<void> g_release;
+
+static void PacketReceived(const CASecureEndpoint_t *sep, const void *data, size_t dataLength)
+{
+    // hold the receive thread on the first datagram so the others queue up on the socket.
+    bool first = false;
+    {
+        std::lock_guard<std::mutex> lock(g_receivedMutex);
+        ReceivedPacket packet = { sep->endpoint, std::string((const char *) data, dataLength) };
+        g_received.push_back(packet);
+        first = (1 == g_received.size());
+        g_receivedCond.notify_all();
+    }
+    if (first && g_release.valid())
+    {
+        g_release.wait_for(std::chrono::seconds(5));
+    }
+}
+
+class CAIPServerF : public testing::Test {
+public:
+    CAIPServerF() :
+      testing::Test(),
+      pool(NULL),
+      released(false),
+      senderFd(-1),
+      senderPort(0)
+  {
+  }
+
+protected:
+    virtual void SetUp()
+    {
+        g_received.clear();
+        g_release = release.get_future().share();
+
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &pool));
+
+        caglobals.ip.u6.fd = OC_INVALID_SOCKET;
+        caglobals.ip.u6s.fd = OC_INVALID_SOCKET;
+        caglobals.ip.u4.fd = OC_INVALID_SOCKET;
+        caglobals.ip.u4s.fd = OC_INVALID_SOCKET;
+        caglobals.ip.m6.fd = OC_INVALID_SOCKET;
+        caglobals.ip.m6s.fd = OC_INVALID_SOCKET;
+        caglobals.ip.m4.fd = OC_INVALID_SOCKET;
+        caglobals.ip.m4s.fd = OC_INVALID_SOCKET;
+        caglobals.ip.u6.port = 0;
+        caglobals.ip.u6s.port = 0;
+        caglobals.ip.u4.port = 0;
+        caglobals.ip.u4s.port = 0;
+        caglobals.ip.m6.port = 0;
+        caglobals.ip.m6s.port = 0;
+        caglobals.ip.m4.port = 0;
+        caglobals.ip.m4s.port = 0;
+        caglobals.ip.ipv6enabled = false;
+        caglobals.ip.ipv4enabled = true;
+        caglobals.ip.started = false;
+        caglobals.ip.terminate = false;
+
+        CAIPSetPacketReceiveCallback(PacketReceived);
+        ASSERT_EQ(CA_STATUS_OK, CAIPStartServer(pool));
+        ASSERT_NE(0, caglobals.ip.u4.port);
+
+        senderFd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        ASSERT_NE(-1, senderFd);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(0, bind(senderFd, (struct sockaddr *) &addr, sizeof(addr)));
+        socklen_t len = sizeof(addr);
+        ASSERT_EQ(0, getsockname(senderFd, (struct sockaddr *) &addr, &len));
+        senderPort = ntohs(addr.sin_port);
+    }
+
+    virtual void TearDown()
+    {
+        Release();
+        CAIPStopServer();
+        ca_thread_pool_free(pool);
+        CADeInitializeIPGlobals();
+        CAIPSetPacketReceiveCallback(NULL);
+        if (-1 != senderFd)
+        {
+            close(senderFd);
+        }
+        g_release = std::shared_future<void>();
+    }
+
+    void Release()
+    {
+        if (!released)
+        {
+            released = true;
+            release.set_value();
+        }
+    }
+
+    bool SendTo(uint16_t port, const std::string &data)
+    {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        return (ssize_t) data.size() == sendto(senderFd, data.data(), data.size(), 0,
+                                               (struct sockaddr *) &addr, sizeof(addr));
+    }
+
+    bool WaitReceived(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(g_receivedMutex);
+        return g_receivedCond.wait_for(lock, std::chrono::seconds(5),
+                                       [count]{ return g_received.size() >= count; });
+    }
+
+    static std::string Payload(size_t index)
+    {
+        // datagrams of different sizes, so a length mixed up within a batch shows.
+        std::string data = std::to_string(index) + ":";
+        data.append(index % 97, (char) ('a' + index % 26));
+        return data;
+    }
+
+    ca_thread_pool_t pool;
+    std::promise<void> release;
+    bool released;
+    int senderFd;
+    uint16_t senderPort;
+};
+
+TEST_F(CAIPServerF, QueuedDatagramsAreAllReceivedInOrder)
+{
+    // several times the receive batch, so the socket is drained over multiple batches.
+    const size_t count = 53;
+
+    ASSERT_TRUE(SendTo(caglobals.ip.u4.port, Payload(0)));
+    ASSERT_TRUE(WaitReceived(1));
+    for (size_t i = 1; i < count; i++)
+    {
+        ASSERT_TRUE(SendTo(caglobals.ip.u4.port, Payload(i)));
+    }
+    Release();
+
+    ASSERT_TRUE(WaitReceived(count));
+
+    std::lock_guard<std::mutex> lock(g_receivedMutex);
+    ASSERT_EQ(count, g_received.size());
+    for (size_t i = 0; i < count; i++)
+    {
+        EXPECT_EQ(Payload(i), g_received[i].data);
+        EXPECT_EQ(CA_ADAPTER_IP, g_received[i].endpoint.adapter);
+        EXPECT_TRUE(0 != (g_received[i].endpoint.flags & CA_IPV4));
+        EXPECT_STREQ("127.0.0.1", g_received[i].endpoint.addr);
+        EXPECT_EQ(senderPort, g_received[i].endpoint.port);
+    }
+}
+
+TEST_F(CAIPServerF, DatagramAfterDrainIsReceived)
+{
+    // a drained edge-triggered socket must report the next datagram again.
+    Release();
+    for (size_t i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(SendTo(caglobals.ip.u4.port, Payload(i)));
+        ASSERT_TRUE(WaitReceived(i + 1));
+    }
+
+    std::lock_guard<std::mutex> lock(g_receivedMutex);
+    ASSERT_EQ(3u, g_received.size());
+    EXPECT_EQ(Payload(2), g_received[2].data);
+}
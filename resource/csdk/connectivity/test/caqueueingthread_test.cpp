@@ -0,0 +1,227 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "caqueueingthread.h"
+
+#include "oic_malloc.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static int g_lastValue[4];
+static std::atomic<int> g_handled;
+static std::atomic<bool> g_outOfOrder;
+
+static void CountingTask(void *data)
+{
+    int value = *(int *) data;
+    int producer = value / 100000;
+    if (value != g_lastValue[producer] + 1)
+    {
+        g_outOfOrder = true;
+    }
+    g_lastValue[producer] = value;
+    g_handled++;
+}
+
+static bool IsOddValue(void *data, uint32_t size, void *ctx)
+{
+    (void) size;
+    (void) ctx;
+    return 0 != (*(int *) data % 2);
+}
+
+class CAQueueingThreadF : public testing::Test {
+public:
+    CAQueueingThreadF() :
+      testing::Test(),
+      pool(NULL)
+  {
+  }
+
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadInitialize(&queue, pool, CountingTask, NULL));
+    }
+
+    virtual void TearDown()
+    {
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadDestroy(&queue));
+        ca_thread_pool_free(pool);
+    }
+
+    void AddValue(int value)
+    {
+        int *data = (int *) OICMalloc(sizeof(int));
+        ASSERT_TRUE(data != NULL);
+        *data = value;
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&queue, data, sizeof(int)));
+    }
+
+    ca_thread_pool_t pool;
+    CAQueueingThread_t queue;
+};
+
+TEST_F(CAQueueingThreadF, GetDataInOrderPastRingSize)
+{
+    const int count = CA_QUEUEING_THREAD_RING_SIZE * 2 + 10;
+    for (int i = 1; i <= count; i++)
+    {
+        AddValue(i);
+    }
+
+    CAQueueingThreadStats_t stats;
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&queue, &stats));
+    EXPECT_EQ(static_cast<uint32_t>(count), stats.depth);
+    EXPECT_EQ(static_cast<uint32_t>(count), stats.maxDepth);
+    EXPECT_EQ(static_cast<uint64_t>(count - CA_QUEUEING_THREAD_RING_SIZE), stats.overflowed);
+
+    void *data = NULL;
+    uint32_t size = 0;
+    for (int i = 1; i <= count; i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetData(&queue, &data, &size));
+        EXPECT_EQ(sizeof(int), size);
+        EXPECT_EQ(i, *(int *) data);
+        OICFree(data);
+    }
+    EXPECT_EQ(CA_STATUS_FAILED, CAQueueingThreadGetData(&queue, &data, &size));
+
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&queue, &stats));
+    EXPECT_EQ(0u, stats.depth);
+    EXPECT_EQ(static_cast<uint64_t>(count), stats.dequeued);
+}
+
+TEST_F(CAQueueingThreadF, ClearContextData)
+{
+    const int count = CA_QUEUEING_THREAD_RING_SIZE + 10;
+    for (int i = 1; i <= count; i++)
+    {
+        AddValue(i);
+    }
+
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CAQueueingThreadClearContextData(&queue, NULL, NULL));
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadClearContextData(&queue, IsOddValue, NULL));
+
+    void *data = NULL;
+    uint32_t size = 0;
+    for (int i = 2; i <= count; i += 2)
+    {
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetData(&queue, &data, &size));
+        EXPECT_EQ(i, *(int *) data);
+        OICFree(data);
+    }
+    EXPECT_EQ(CA_STATUS_FAILED, CAQueueingThreadGetData(&queue, &data, &size));
+}
+
+TEST_F(CAQueueingThreadF, MultipleProducersKeepOrder)
+{
+    const int producers = 4;
+    const int perProducer = 5000;
+    for (int p = 0; p < producers; p++)
+    {
+        g_lastValue[p] = p * 100000;
+    }
+    g_handled = 0;
+    g_outOfOrder = false;
+
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadStart(&queue));
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.push_back(std::thread([this, p, perProducer]()
+        {
+            for (int i = 1; i <= perProducer; i++)
+            {
+                AddValue(p * 100000 + i);
+            }
+        }));
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int i = 0; i < 1000 && g_handled < producers * perProducer; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadStop(&queue));
+
+    EXPECT_EQ(producers * perProducer, g_handled);
+    EXPECT_FALSE(g_outOfOrder);
+}
+
+TEST_F(CAQueueingThreadF, WaitDataReturnsOnData)
+{
+    std::thread producer([this]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        AddValue(1);
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadWaitData(&queue, 10 * 1000 * 1000));
+    auto waited = std::chrono::steady_clock::now() - start;
+    producer.join();
+    EXPECT_LT(waited, std::chrono::seconds(5));
+
+    void *data = NULL;
+    uint32_t size = 0;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetData(&queue, &data, &size));
+    EXPECT_EQ(1, *(int *) data);
+    OICFree(data);
+
+    // queued data makes the wait return at once.
+    AddValue(2);
+    start = std::chrono::steady_clock::now();
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadWaitData(&queue, 10 * 1000 * 1000));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST_F(CAQueueingThreadF, WaitDataTimesOutAndWakesUp)
+{
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadWaitData(&queue, 20 * 1000));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(15));
+
+    // a wake up before the wait is not lost.
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadWakeUp(&queue));
+    start = std::chrono::steady_clock::now();
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadWaitData(&queue, 10 * 1000 * 1000));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+
+    std::thread waker([this]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CAQueueingThreadWakeUp(&queue);
+    });
+    start = std::chrono::steady_clock::now();
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadWaitData(&queue, 10 * 1000 * 1000));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    waker.join();
+}
@@ -0,0 +1,235 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "caretransmission.h"
+#include "caprotocolmessage.h"
+
+#include "oic_malloc.h"
+
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct SentMessage
+{
+    uint16_t messageId;
+    Clock::time_point time;
+};
+
+static std::mutex g_sentMutex;
+static std::condition_variable g_sentCond;
+static std::vector<SentMessage> g_sent;
+static std::vector<uint16_t> g_timedOut;
+
+static CAResult_t RecordSend(const CAEndpoint_t *endpoint, const void *pdu, uint32_t size,
+                             CADataType_t dataType)
+{
+    (void) endpoint;
+    (void) dataType;
+    SentMessage sent = { CAGetMessageIdFromPduBinaryData(pdu, size), Clock::now() };
+    std::lock_guard<std::mutex> lock(g_sentMutex);
+    g_sent.push_back(sent);
+    g_sentCond.notify_all();
+    return CA_STATUS_OK;
+}
+
+static void RecordTimeout(const CAEndpoint_t *endpoint, const void *pdu, uint32_t size)
+{
+    (void) endpoint;
+    std::lock_guard<std::mutex> lock(g_sentMutex);
+    g_timedOut.push_back(CAGetMessageIdFromPduBinaryData(pdu, size));
+    g_sentCond.notify_all();
+}
+
+class CARetransmissionF : public testing::Test {
+public:
+    CARetransmissionF() :
+      testing::Test(),
+      pool(NULL)
+  {
+  }
+
+protected:
+    virtual void SetUp()
+    {
+        g_sent.clear();
+        g_timedOut.clear();
+
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+
+        // a single retransmission keeps the tests short.
+        CARetransmissionConfig_t config;
+        config.supportType = (CATransportAdapter_t) DEFAULT_RETRANSMISSION_TYPE;
+        config.tryingCount = 1;
+        ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitialize(&context, pool, RecordSend,
+                                                           RecordTimeout, &config));
+        ASSERT_EQ(CA_STATUS_OK, CARetransmissionStart(&context));
+
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_IP;
+        endpoint.flags = CA_IPV4;
+        strncpy(endpoint.addr, "192.168.0.1", sizeof(endpoint.addr));
+        endpoint.port = 5683;
+    }
+
+    virtual void TearDown()
+    {
+        CARetransmissionStop(&context);
+        CARetransmissionDestroy(&context);
+        ca_thread_pool_free(pool);
+    }
+
+    static std::vector<uint8_t> Pdu(CAMessageType_t type, uint8_t code, uint16_t messageId)
+    {
+        std::vector<uint8_t> pdu(sizeof(coap_hdr_t));
+        coap_hdr_t *hdr = (coap_hdr_t *) pdu.data();
+        hdr->version = COAP_DEFAULT_VERSION;
+        hdr->type = type;
+        hdr->token_length = 0;
+        hdr->code = code;
+        hdr->id = messageId;
+        return pdu;
+    }
+
+    CAResult_t Send(uint16_t messageId)
+    {
+        std::vector<uint8_t> pdu = Pdu(CA_MSG_CONFIRM, COAP_REQUEST_GET, messageId);
+        return CARetransmissionSentData(&context, &endpoint, CA_REQUEST_DATA,
+                                        pdu.data(), (uint32_t) pdu.size());
+    }
+
+    CAResult_t Receive(CAMessageType_t type, uint16_t messageId, void **retransmissionPdu)
+    {
+        std::vector<uint8_t> pdu = Pdu(type, 0, messageId);
+        return CARetransmissionReceivedData(&context, &endpoint, pdu.data(),
+                                            (uint32_t) pdu.size(), retransmissionPdu);
+    }
+
+    bool WaitTimedOut(size_t count, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(g_sentMutex);
+        return g_sentCond.wait_for(lock, timeout, [count]{ return g_timedOut.size() >= count; });
+    }
+
+    CARetransmissionStats_t Stats()
+    {
+        CARetransmissionStats_t stats;
+        memset(&stats, 0, sizeof(stats));
+        CARetransmissionGetStats(&context, &stats);
+        return stats;
+    }
+
+    ca_thread_pool_t pool;
+    CARetransmission_t context;
+    CAEndpoint_t endpoint;
+};
+
+TEST_F(CARetransmissionF, RetransmitsInDeadlineOrderAfterAckTimeout)
+{
+    // the ACK timeout is between 2 and 3 seconds, so the second message is always due later.
+    Clock::time_point firstSent = Clock::now();
+    ASSERT_EQ(CA_STATUS_OK, Send(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    Clock::time_point secondSent = Clock::now();
+    ASSERT_EQ(CA_STATUS_OK, Send(11));
+    EXPECT_EQ(2u, Stats().queueDepth);
+
+    ASSERT_TRUE(WaitTimedOut(2, std::chrono::seconds(5)));
+
+    CARetransmissionStats_t stats = Stats();
+    EXPECT_EQ(2u, stats.retransmitCount);
+    EXPECT_EQ(2u, stats.timeoutCount);
+    EXPECT_EQ(0u, stats.queueDepth);
+
+    std::lock_guard<std::mutex> lock(g_sentMutex);
+    ASSERT_EQ(2u, g_sent.size());
+    EXPECT_EQ(10, g_sent[0].messageId);
+    EXPECT_EQ(11, g_sent[1].messageId);
+
+    std::chrono::milliseconds firstDelay = std::chrono::duration_cast<std::chrono::milliseconds>(
+            g_sent[0].time - firstSent);
+    std::chrono::milliseconds secondDelay = std::chrono::duration_cast<std::chrono::milliseconds>(
+            g_sent[1].time - secondSent);
+    EXPECT_LE(DEFAULT_ACK_TIMEOUT_SEC * 1000, firstDelay.count());
+    EXPECT_GT(DEFAULT_ACK_TIMEOUT_SEC * 1500 + 500, firstDelay.count());
+    EXPECT_LE(DEFAULT_ACK_TIMEOUT_SEC * 1000, secondDelay.count());
+    EXPECT_GT(DEFAULT_ACK_TIMEOUT_SEC * 1500 + 500, secondDelay.count());
+
+    ASSERT_EQ(2u, g_timedOut.size());
+    EXPECT_EQ(10, g_timedOut[0]);
+    EXPECT_EQ(11, g_timedOut[1]);
+}
+
+TEST_F(CARetransmissionF, AckAndResetRemovePendingMessage)
+{
+    ASSERT_EQ(CA_STATUS_OK, Send(20));
+    ASSERT_EQ(CA_STATUS_OK, Send(21));
+    ASSERT_EQ(CA_STATUS_OK, Send(22));
+    EXPECT_EQ(CA_STATUS_FAILED, Send(21));
+    EXPECT_EQ(3u, Stats().queueDepth);
+
+    // an empty ACK hands back the pending request and removes it from the middle of the heap.
+    void *retransmissionPdu = NULL;
+    EXPECT_EQ(CA_STATUS_OK, Receive(CA_MSG_ACKNOWLEDGE, 21, &retransmissionPdu));
+    ASSERT_TRUE(NULL != retransmissionPdu);
+    EXPECT_EQ(21, CAGetMessageIdFromPduBinaryData(retransmissionPdu, sizeof(coap_hdr_t)));
+    OICFree(retransmissionPdu);
+    EXPECT_EQ(2u, Stats().queueDepth);
+
+    retransmissionPdu = NULL;
+    EXPECT_EQ(CA_STATUS_OK, Receive(CA_MSG_RESET, 22, &retransmissionPdu));
+    OICFree(retransmissionPdu);
+    EXPECT_EQ(1u, Stats().queueDepth);
+
+    // unknown message IDs leave the queue alone.
+    retransmissionPdu = NULL;
+    EXPECT_EQ(CA_STATUS_OK, Receive(CA_MSG_ACKNOWLEDGE, 23, &retransmissionPdu));
+    EXPECT_TRUE(NULL == retransmissionPdu);
+    EXPECT_EQ(1u, Stats().queueDepth);
+
+    ASSERT_TRUE(WaitTimedOut(1, std::chrono::seconds(4)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    EXPECT_EQ(0u, Stats().queueDepth);
+
+    std::lock_guard<std::mutex> lock(g_sentMutex);
+    ASSERT_EQ(1u, g_sent.size());
+    EXPECT_EQ(20, g_sent[0].messageId);
+    ASSERT_EQ(1u, g_timedOut.size());
+    EXPECT_EQ(20, g_timedOut[0]);
+}
+
+TEST_F(CARetransmissionF, NonConfirmableIsNotQueued)
+{
+    std::vector<uint8_t> pdu = Pdu(CA_MSG_NONCONFIRM, COAP_REQUEST_GET, 30);
+    EXPECT_EQ(CA_NOT_SUPPORTED, CARetransmissionSentData(&context, &endpoint, CA_REQUEST_DATA,
+                                                         pdu.data(), (uint32_t) pdu.size()));
+
+    endpoint.adapter = CA_ADAPTER_TCP;
+    EXPECT_EQ(CA_NOT_SUPPORTED, Send(31));
+    EXPECT_EQ(0u, Stats().queueDepth);
+}
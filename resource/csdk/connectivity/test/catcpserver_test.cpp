@@ -0,0 +1,234 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include "gtest/gtest.h"
+
+#include "catcpinterface.h"
+#include "cathreadpool.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static std::mutex g_connMutex;
+static std::condition_variable g_connCond;
+static bool g_connected = false;
+static bool g_connectedIsClient = false;
+static uint16_t g_connectedPort = 0;
+static bool g_lockFreeInCallback = false;
+
+static void ConnectionChanged(const CAEndpoint_t *endpoint, bool isConnected, bool isClient)
+{
+    if (!isConnected)
+    {
+        return;
+    }
+
+    // the session list must be usable from the callback, another thread looks the session up.
+    CAEndpoint_t copy = *endpoint;
+    std::shared_ptr<std::promise<void>> lookedUp = std::make_shared<std::promise<void>>();
+    std::future<void> lookup = lookedUp->get_future();
+    std::thread([copy, lookedUp]
+    {
+        CAGetSocketFDFromEndpoint(&copy);
+        lookedUp->set_value();
+    }).detach();
+    bool lockFree = (std::future_status::ready == lookup.wait_for(std::chrono::seconds(2)));
+
+    std::lock_guard<std::mutex> lock(g_connMutex);
+    g_connected = true;
+    g_connectedIsClient = isClient;
+    g_connectedPort = endpoint->port;
+    g_lockFreeInCallback = lockFree;
+    g_connCond.notify_all();
+}
+
+class CATCPServerF : public testing::Test {
+public:
+    CATCPServerF() :
+      testing::Test(),
+      pool(NULL),
+      listenFd(-1),
+      port(0)
+  {
+  }
+
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &pool));
+
+        caglobals.tcp.ipv4.fd = OC_INVALID_SOCKET;
+        caglobals.tcp.ipv4s.fd = OC_INVALID_SOCKET;
+        caglobals.tcp.ipv6.fd = OC_INVALID_SOCKET;
+        caglobals.tcp.ipv6s.fd = OC_INVALID_SOCKET;
+        caglobals.tcp.ipv4.port = 0;
+        caglobals.tcp.ipv4s.port = 0;
+        caglobals.tcp.ipv6.port = 0;
+        caglobals.tcp.ipv6s.port = 0;
+        caglobals.tcp.selectTimeout = 1;
+        caglobals.tcp.listenBacklog = 3;
+        caglobals.tcp.terminate = false;
+
+        g_connected = false;
+        CATCPSetConnectionChangedCallback(ConnectionChanged);
+        ASSERT_EQ(CA_STATUS_OK, CATCPStartServer(pool));
+
+        // peer that accepts the connections of the adapter.
+        listenFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        ASSERT_NE(-1, listenFd);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(0, bind(listenFd, (struct sockaddr *) &addr, sizeof(addr)));
+        ASSERT_EQ(0, listen(listenFd, 1));
+        socklen_t len = sizeof(addr);
+        ASSERT_EQ(0, getsockname(listenFd, (struct sockaddr *) &addr, &len));
+        port = ntohs(addr.sin_port);
+
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_TCP;
+        endpoint.flags = CA_IPV4;
+        strncpy(endpoint.addr, "127.0.0.1", sizeof(endpoint.addr));
+        endpoint.port = port;
+    }
+
+    virtual void TearDown()
+    {
+        CASearchAndDeleteTCPSession(&endpoint);
+        CATCPStopServer();
+        CATCPSetConnectionChangedCallback(NULL);
+        if (-1 != listenFd)
+        {
+            close(listenFd);
+        }
+        ca_thread_pool_free(pool);
+    }
+
+    bool WaitConnected()
+    {
+        std::unique_lock<std::mutex> lock(g_connMutex);
+        return g_connCond.wait_for(lock, std::chrono::seconds(5), []{ return g_connected; });
+    }
+
+    int AcceptPeer()
+    {
+        int fd = accept(listenFd, NULL, NULL);
+        if (-1 != fd)
+        {
+            struct timeval timeout = { 5, 0 };
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        }
+        return fd;
+    }
+
+    ca_thread_pool_t pool;
+    int listenFd;
+    uint16_t port;
+    CAEndpoint_t endpoint;
+};
+
+TEST_F(CATCPServerF, ConnectIsReportedOutsideSessionLock)
+{
+    CASocketFd_t fd = CAConnectTCPSession(&endpoint);
+    ASSERT_NE(OC_INVALID_SOCKET, fd);
+
+    ASSERT_TRUE(WaitConnected());
+    EXPECT_TRUE(g_connectedIsClient);
+    EXPECT_EQ(port, g_connectedPort);
+    EXPECT_TRUE(g_lockFreeInCallback);
+    EXPECT_EQ(fd, CAGetSocketFDFromEndpoint(&endpoint));
+
+    int peer = AcceptPeer();
+    EXPECT_NE(-1, peer);
+    close(peer);
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+TEST_F(CATCPServerF, SendQueueIsCappedAndFlushedInOrder)
+{
+    const size_t chunkSize = 64 * 1024;
+    const size_t maxTotal = 64 * 1024 * 1024;
+    std::vector<unsigned char> chunk(chunkSize);
+
+    // the first send connects, the peer does not read until the queue of the session is full.
+    size_t total = 0;
+    ssize_t sent = 0;
+    int peer = -1;
+    while (total < maxTotal)
+    {
+        for (size_t i = 0; i < chunkSize; i++)
+        {
+            chunk[i] = (unsigned char) ((total + i) % 251);
+        }
+        sent = CATCPSendData(&endpoint, chunk.data(), chunkSize);
+        if (0 > sent)
+        {
+            break;
+        }
+        ASSERT_EQ((ssize_t) chunkSize, sent);
+        total += chunkSize;
+
+        if (-1 == peer)
+        {
+            peer = AcceptPeer();
+            ASSERT_NE(-1, peer);
+        }
+    }
+    ASSERT_NE(-1, peer);
+    EXPECT_GT(0, sent);
+    EXPECT_GT(maxTotal, total);
+    EXPECT_LT(1024u * 1024u - chunkSize, total);
+
+    // everything accepted before the queue was full arrives, in order.
+    std::vector<unsigned char> buffer(chunkSize);
+    size_t received = 0;
+    bool inOrder = true;
+    while (received < total)
+    {
+        ssize_t len = recv(peer, buffer.data(), buffer.size(), 0);
+        if (0 >= len)
+        {
+            break;
+        }
+        for (ssize_t i = 0; i < len; i++)
+        {
+            inOrder = inOrder && (buffer[i] == (unsigned char) ((received + i) % 251));
+        }
+        received += len;
+    }
+    EXPECT_EQ(total, received);
+    EXPECT_TRUE(inOrder);
+    close(peer);
+}
+#endif
@@ -48,6 +48,9 @@
 #define GetCASecureEndpointData GetCASecureEndpointDataTest
 #define SetCASecureEndpointAttribute SetCASecureEndpointAttributeTest
 #define GetCASecureEndpointAttributes GetCASecureEndpointAttributesTest
+#define CAsetSslSessionCacheConfig CAsetSslSessionCacheConfigTest
+#define CAgetSslHandshakeStats CAgetSslHandshakeStatsTest
+#define CAinvalidateSslPkixInfo CAinvalidateSslPkixInfoTest
 
 #include "../src/adapter_util/ca_adapter_net_ssl.c"
 
@@ -1886,7 +1889,6 @@ static void * test0CAinitiateSslHandshake(void * arg)
     g_sslContextMutex = oc_mutex_new_recursive();
     oc_mutex_lock(g_sslContextMutex);
     g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
-    g_caSslContext->peerList = u_arraylist_create();
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
     mbedtls_ctr_drbg_seed(&g_caSslContext->rnd, mbedtls_entropy_func_clutch,
@@ -2905,6 +2907,184 @@ TEST(TLSAdapter, Test_10)
     EXPECT_EQ(0, ret);
 }
 
+/* **************************
+ *
+ *
+ * CAsetSslSessionCacheConfig test
+ *
+ *
+ * *************************/
+
+// CAsetSslSessionCacheConfig(), CAgetSslHandshakeStats()
+TEST(TLSAdapter, Test_12)
+{
+    CASslHandshakeStats_t stats;
+    EXPECT_EQ(CA_STATUS_NOT_INITIALIZED, CAgetSslHandshakeStats(&stats));
+
+    // Applied when the adapter is initialized
+    EXPECT_EQ(CA_STATUS_OK, CAsetSslSessionCacheConfig(3600, 10));
+    ASSERT_EQ(CA_STATUS_OK, CAinitSslAdapter());
+    EXPECT_EQ(3600, g_caSslContext->sessionCache.timeout);
+    EXPECT_EQ(10, g_caSslContext->sessionCache.max_entries);
+    EXPECT_EQ(3600u, g_caSslContext->ticketCtx.ticket_lifetime);
+
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CAgetSslHandshakeStats(NULL));
+    EXPECT_EQ(CA_STATUS_OK, CAgetSslHandshakeStats(&stats));
+    EXPECT_EQ(0u, stats.fullHandshakes);
+    EXPECT_EQ(0u, stats.resumedHandshakes);
+
+    // Applied to the running adapter
+    EXPECT_EQ(CA_STATUS_OK, CAsetSslSessionCacheConfig(0, 10));
+    EXPECT_EQ(0u, g_caSslContext->ticketCtx.ticket_lifetime);
+    EXPECT_FALSE(IsResumptionEnabled());
+    EXPECT_EQ(CA_STATUS_OK, CAsetSslSessionCacheConfig(SSL_SESSION_LIFETIME,
+                                                       SSL_SESSION_CACHE_SIZE));
+    EXPECT_TRUE(IsResumptionEnabled());
+
+    CAdeinitSslAdapter();
+}
+
+/* **************************
+ *
+ *
+ * InitPKIX cache test
+ *
+ *
+ * *************************/
+
+static int g_pkixInfoCalls = 0;
+static bool g_pkixInfoWithoutOwnCert = false;
+
+static void infoCallback_that_counts_calls(PkiInfo_t * inf)
+{
+    g_pkixInfoCalls++;
+    infoCallback_that_loads_x509(inf);
+    if (g_pkixInfoWithoutOwnCert)
+    {
+        OICFree(inf->crt.data);
+        inf->crt.data = NULL;
+        inf->crt.len = 0;
+    }
+}
+
+// InitPKIX(), CAinvalidateSslPkixInfo()
+TEST(TLSAdapter, Test_13)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAinitSslAdapter());
+    CAsetPkixInfoCallback(infoCallback_that_counts_calls);
+    g_pkixInfoCalls = 0;
+
+    // Parsed once, shared by the handshakes of both transports
+    oc_mutex_lock(g_sslContextMutex);
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_TCP));
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_TCP));
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_IP));
+    EXPECT_EQ(1, g_pkixInfoCalls);
+    EXPECT_TRUE(g_caSslContext->ownCertLoaded);
+    oc_mutex_unlock(g_sslContextMutex);
+
+    // Parsed again once the credentials changed
+    CAinvalidateSslPkixInfo();
+    oc_mutex_lock(g_sslContextMutex);
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_TCP));
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_IP));
+    EXPECT_EQ(2, g_pkixInfoCalls);
+
+    // The re-parsed certificate replaces the configured one
+    ASSERT_TRUE(NULL != g_caSslContext->serverTlsConf.key_cert);
+    EXPECT_TRUE(NULL == g_caSslContext->serverTlsConf.key_cert->next);
+    ASSERT_TRUE(NULL != g_caSslContext->clientDtlsConf.key_cert);
+    EXPECT_TRUE(NULL == g_caSslContext->clientDtlsConf.key_cert->next);
+    oc_mutex_unlock(g_sslContextMutex);
+
+    // Each transport drops the own certificate the next time it is used
+    g_pkixInfoWithoutOwnCert = true;
+    CAinvalidateSslPkixInfo();
+    oc_mutex_lock(g_sslContextMutex);
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_TCP));
+    EXPECT_EQ(3, g_pkixInfoCalls);
+    EXPECT_FALSE(g_caSslContext->ownCertLoaded);
+    EXPECT_TRUE(NULL == g_caSslContext->serverTlsConf.key_cert);
+    EXPECT_TRUE(NULL != g_caSslContext->serverDtlsConf.key_cert);
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_IP));
+    EXPECT_EQ(3, g_pkixInfoCalls);
+    EXPECT_TRUE(NULL == g_caSslContext->serverDtlsConf.key_cert);
+    EXPECT_TRUE(NULL == g_caSslContext->clientDtlsConf.key_cert);
+    oc_mutex_unlock(g_sslContextMutex);
+    g_pkixInfoWithoutOwnCert = false;
+
+    CAdeinitSslAdapter();
+}
+
+/* **************************
+ *
+ *
+ * Peer table test
+ *
+ *
+ * *************************/
+
+// AddSslPeer(), GetSslPeer(), RemovePeerFromList()
+TEST(TLSAdapter, Test_PeerTable)
+{
+    const int peerCount = 200;
+    CAEndpoint_t endpoint = {};
+
+    ASSERT_EQ(CA_STATUS_OK, CAinitSslAdapter());
+    oc_mutex_lock(g_sslContextMutex);
+
+    // Enough peers for the table to grow its buckets several times
+    endpoint.adapter = CA_ADAPTER_TCP;
+    strncpy(endpoint.addr, "192.168.1.1", sizeof(endpoint.addr) - 1);
+    for (int i = 0; i < peerCount; i++)
+    {
+        endpoint.port = (uint16_t)(5000 + i);
+        SslEndPoint_t *tep = NewSslEndPoint(&endpoint, &g_caSslContext->clientTlsConf);
+        ASSERT_TRUE(NULL != tep);
+        ASSERT_TRUE(AddSslPeer(tep));
+    }
+    EXPECT_EQ((unsigned int)peerCount, HASH_COUNT(g_caSslContext->peerTable));
+
+    for (int i = 0; i < peerCount; i++)
+    {
+        endpoint.port = (uint16_t)(5000 + i);
+        SslEndPoint_t *tep = GetSslPeer(&endpoint);
+        ASSERT_TRUE(NULL != tep);
+        EXPECT_EQ(endpoint.port, tep->sep.endpoint.port);
+    }
+    endpoint.port = (uint16_t)(5000 + peerCount);
+    EXPECT_TRUE(NULL == GetSslPeer(&endpoint));
+
+    // The port is not part of the key of BLE peers
+    CAEndpoint_t blePeer = {};
+    blePeer.adapter = CA_ADAPTER_GATT_BTLE;
+    strncpy(blePeer.addr, "00:11:22:33:44:55", sizeof(blePeer.addr) - 1);
+    blePeer.port = 1;
+    SslEndPoint_t *bleTep = NewSslEndPoint(&blePeer, &g_caSslContext->clientTlsConf);
+    ASSERT_TRUE(NULL != bleTep);
+    ASSERT_TRUE(AddSslPeer(bleTep));
+    blePeer.port = 2;
+    EXPECT_EQ(bleTep, GetSslPeer(&blePeer));
+
+    // Removing a peer leaves the others in place
+    for (int i = 0; i < peerCount; i += 2)
+    {
+        endpoint.port = (uint16_t)(5000 + i);
+        RemovePeerFromList(&endpoint);
+    }
+    EXPECT_EQ((unsigned int)(peerCount / 2 + 1), HASH_COUNT(g_caSslContext->peerTable));
+    for (int i = 0; i < peerCount; i++)
+    {
+        endpoint.port = (uint16_t)(5000 + i);
+        EXPECT_EQ(i % 2 != 0, NULL != GetSslPeer(&endpoint));
+    }
+
+    oc_mutex_unlock(g_sslContextMutex);
+
+    // The remaining peers are deleted with the adapter
+    CAdeinitSslAdapter();
+}
+
 // This test has a bug in it (IOT-1848):
 //  server() listens only on IPv6 on Windows (because IPV6_V6ONLY defaults
 //  to true) and socketConnect() is hard coded to try only IPv4.
@@ -2952,7 +3132,6 @@ TEST(TLSAdapter, Test_11)
     g_sslContextMutex = oc_mutex_new_recursive();
     oc_mutex_lock(g_sslContextMutex);
     g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
-    g_caSslContext->peerList = u_arraylist_create();
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
     mbedtls_ctr_drbg_seed(&g_caSslContext->rnd, mbedtls_entropy_func_clutch,
@@ -1440,7 +1440,9 @@ typedef enum
     /** The payload is an OCDiagnosticPayload */
     PAYLOAD_TYPE_DIAGNOSTIC,
     /** The payload is an OCIntrospectionPayload */
-    PAYLOAD_TYPE_INTROSPECTION
+    PAYLOAD_TYPE_INTROSPECTION,
+    /** The payload is an OCEncodedRepPayload */
+    PAYLOAD_TYPE_ENCODED_REPRESENTATION
 } OCPayloadType;
 
 /**
@@ -1527,6 +1529,8 @@ typedef struct OCRepPayload
     OCStringLL* interfaces;
     OCRepPayloadValue* values;
     struct OCRepPayload* next;
+    /** Internal: values hashed by name, maintained by the OCRepPayload functions. */
+    struct OCRepPayloadValueIndex* valueIndex;
 } OCRepPayload;
 
 // used inside a resource payload
@@ -1612,6 +1616,16 @@ typedef struct
     OCByteString cborPayload;
 } OCIntrospectionPayload;
 
+/**
+ * Representation that is already encoded to CBOR, e.g. by the C++ API.  It is sent as is,
+ * without building an OCRepPayload first.
+ */
+typedef struct
+{
+    OCPayload base;
+    OCByteString cborPayload;
+} OCEncodedRepPayload;
+
 /**
  * Incoming requests handled by the server. Requests are passed in as a parameter to the
  * OCEntityHandler callback API.
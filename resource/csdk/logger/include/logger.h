@@ -155,6 +155,34 @@ void OCLogBuffer(int level, const char* tag, const uint8_t* buffer, size_t buffe
      */
     void OCLogShutdown();
 
+    /**
+     * Write log messages on a background thread instead of the calling thread.  The
+     * calling thread only formats the message into a queue, which does not take a lock;
+     * messages which do not fit in the queue are dropped and counted.  Strings longer
+     * than 2 * MAX_LOG_V_BUFFER_SIZE are truncated while the background thread runs.
+     * Only supported where pthreads are available, elsewhere logging stays synchronous.
+     *
+     * @param queueSize - number of messages the queue holds, rounded up to a power of two.
+     *                    The queue is created by the first call and kept until exit.
+     *
+     * @return true if messages are written by the background thread.
+     */
+    bool OCLogStartAsync(size_t queueSize);
+
+    /**
+     * Write out the queued messages and stop the background thread started by
+     * OCLogStartAsync().  Called by OCLogShutdown().
+     */
+    void OCLogStopAsync();
+
+    /**
+     * Get the number of messages dropped because the queue of the background thread
+     * was full.
+     *
+     * @return number of dropped messages.
+     */
+    uint32_t OCLogGetDroppedCount();
+
     /**
      * Output a variable argument list log string with the specified priority level.
      * Only defined for Linux and Android
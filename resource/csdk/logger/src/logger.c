@@ -51,6 +51,15 @@
 #include <windows.h>
 #endif
 
+// Messages can be written by a background thread where pthreads and the GCC atomic
+// builtins are available.
+#if defined(HAVE_PTHREAD_H) && defined(__GNUC__) && !defined(__TIZEN__) && !defined(ARDUINO)
+#define OC_LOG_ASYNC
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#endif
+
 #include "logger.h"
 #include "string.h"
 #include "logger_types.h"
@@ -118,6 +127,46 @@ static oc_log_level LEVEL_XTABLE[] = {OC_LOG_DEBUG, OC_LOG_INFO,
     {"DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
 #endif
 
+#if defined(OC_LOG_ASYNC)
+// Size of the message text kept by a queued record; longer messages are truncated.
+#define ASYNC_RECORD_DATA_SIZE (2 * MAX_LOG_V_BUFFER_SIZE)
+#define ASYNC_RECORD_TAG_SIZE (64)
+
+/**
+ * Message queued for the background thread.  Records live in a bounded ring which any
+ * thread may add to without locking (see ReserveRecord()); only the background thread
+ * takes them out.
+ */
+typedef struct
+{
+    size_t sequence;                    // ring position the record is free or ready for
+    int level;
+    bool isBuffer;                      // data holds raw bytes for OCLogBuffer()
+    size_t length;
+    int min;
+    int sec;
+    int ms;
+    char tag[ASYNC_RECORD_TAG_SIZE];
+    char data[ASYNC_RECORD_DATA_SIZE];
+} AsyncLogRecord;
+
+// The ring is allocated by the first OCLogStartAsync() and kept for the process lifetime,
+// so a thread still adding a record while the logger stops never touches freed memory.
+static AsyncLogRecord *g_asyncRing = NULL;
+static size_t g_asyncMask = 0;
+static size_t g_asyncHead = 0;          // next position to reserve, shared by the writers
+static size_t g_asyncTail = 0;          // next position to write out, background thread only
+static bool g_asyncRunning = false;
+static int32_t g_asyncWriters = 0;      // threads between checking g_asyncRunning and publishing
+static uint32_t g_asyncDropped = 0;
+
+static pthread_t g_asyncThread;
+static pthread_mutex_t g_asyncMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_asyncCond = PTHREAD_COND_INITIALIZER;
+static bool g_asyncWaiting = false;     // background thread is, or is about to be, waiting
+static bool g_asyncStop = false;
+#endif
+
 /**
  * Checks if a message should be logged, based on its priority level, and removes
  * the OC_LOG_PRIVATE_DATA bit if the message should be logged.
@@ -149,6 +198,292 @@ static bool AdjustAndVerifyLogLevel(int* level)
     return true;
 }
 
+#if !defined(ARDUINO) && !defined(__TIZEN__)
+/**
+ * Get the wall clock time shown in front of a log message.
+ */
+static void GetLogTime(int *min, int *sec, int *ms)
+{
+    *min = 0;
+    *sec = 0;
+    *ms = 0;
+#if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
+    struct timespec when = { .tv_sec = 0, .tv_nsec = 0 };
+    clockid_t clk = CLOCK_REALTIME;
+#ifdef CLOCK_REALTIME_COARSE
+    clk = CLOCK_REALTIME_COARSE;
+#endif
+    if (!clock_gettime(clk, &when))
+    {
+        *min = (when.tv_sec / 60) % 60;
+        *sec = when.tv_sec % 60;
+        *ms = when.tv_nsec / 1000000;
+    }
+#elif defined(_WIN32)
+    SYSTEMTIME systemTime = {0};
+    GetLocalTime(&systemTime);
+    *min = (int)systemTime.wMinute;
+    *sec = (int)systemTime.wSecond;
+    *ms  = (int)systemTime.wMilliseconds;
+#else
+    struct timeval now;
+    if (!gettimeofday(&now, NULL))
+    {
+        *min = (now.tv_sec / 60) % 60;
+        *sec = now.tv_sec % 60;
+        *ms = now.tv_usec * 1000;
+    }
+#endif
+}
+
+/**
+ * Write a log string, which already passed the level checks, to the configured output.
+ *
+ * @param level  - One of DEBUG, INFO, WARNING, ERROR, or FATAL
+ * @param tag    - Module name
+ * @param min    - minute the message was logged at
+ * @param sec    - second the message was logged at
+ * @param ms     - millisecond the message was logged at
+ * @param logStr - log string
+ */
+static void WriteLog(int level, const char *tag, int min, int sec, int ms, const char *logStr)
+{
+#ifdef __ANDROID__
+    (void) min;
+    (void) sec;
+    (void) ms;
+#ifdef ADB_SHELL
+    printf("%s: %s: %s\n", LEVEL[level], tag, logStr);
+#else
+    __android_log_write(LEVEL[level], tag, logStr);
+#endif
+
+#else
+    if (logCtx && logCtx->write_level)
+    {
+        logCtx->write_level(logCtx, LEVEL_XTABLE[level], logStr);
+
+    }
+    else
+    {
+        printf("%02d:%02d.%03d %s: %s: %s\n", min, sec, ms, LEVEL[level], tag, logStr);
+    }
+#endif
+}
+
+/**
+ * Write the contents of the specified buffer in hex, 16 bytes per line.
+ */
+static void WriteLogBuffer(int level, const char *tag, int min, int sec, int ms,
+                           const uint8_t *buffer, size_t bufferSize)
+{
+    // No idea why the static initialization won't work here, it seems the compiler is convinced
+    // that this is a variable-sized object.
+    char lineBuffer[LINE_BUFFER_SIZE];
+    memset(lineBuffer, 0, sizeof lineBuffer);
+    size_t lineIndex = 0;
+    for (size_t i = 0; i < bufferSize; i++)
+    {
+        // Format the buffer data into a line
+        snprintf(&lineBuffer[lineIndex * 3], sizeof(lineBuffer) - lineIndex * 3, "%02X ", buffer[i]);
+        lineIndex++;
+        // Output 16 values per line
+        if (((i + 1) % 16) == 0)
+        {
+            WriteLog(level, tag, min, sec, ms, lineBuffer);
+            memset(lineBuffer, 0, sizeof lineBuffer);
+            lineIndex = 0;
+        }
+    }
+    // Output last values in the line, if any
+    if (bufferSize % 16)
+    {
+        WriteLog(level, tag, min, sec, ms, lineBuffer);
+    }
+}
+#endif
+
+#if defined(OC_LOG_ASYNC)
+/**
+ * Reserve the next free record of the ring.  This is the bounded queue of D. Vyukov: each
+ * record's sequence tells whether it is free for the writer reserving position pos
+ * (sequence == pos) or still holds a message the background thread has not written out.
+ *
+ * @param pos[out] - position of the reserved record, to publish it with.
+ *
+ * @return the record, or NULL if the ring is full.
+ */
+static AsyncLogRecord *ReserveRecord(size_t *pos)
+{
+    size_t head = __atomic_load_n(&g_asyncHead, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        AsyncLogRecord *record = &g_asyncRing[head & g_asyncMask];
+        size_t sequence = __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)head;
+        if (0 == diff)
+        {
+            if (__atomic_compare_exchange_n(&g_asyncHead, &head, head + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                *pos = head;
+                return record;
+            }
+        }
+        else if (diff < 0)
+        {
+            return NULL;
+        }
+        else
+        {
+            head = __atomic_load_n(&g_asyncHead, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * Queue a message for the background thread.
+ *
+ * @param level    - One of DEBUG, INFO, WARNING, ERROR, or FATAL
+ * @param tag      - Module name
+ * @param isBuffer - data is a buffer to write in hex rather than a string
+ * @param data     - string or buffer
+ * @param length   - length of data, without the null termination of a string
+ *
+ * @return true if the message was queued or dropped, false if the background thread is not
+ *         running and the caller writes the message itself.
+ */
+static bool AsyncLog(int level, const char *tag, bool isBuffer, const void *data, size_t length)
+{
+    bool handled = false;
+    __atomic_add_fetch(&g_asyncWriters, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g_asyncRunning, __ATOMIC_SEQ_CST))
+    {
+        handled = true;
+        const uint8_t *bytes = (const uint8_t *)data;
+        do
+        {
+            size_t pos;
+            AsyncLogRecord *record = ReserveRecord(&pos);
+            if (!record)
+            {
+                __atomic_add_fetch(&g_asyncDropped, 1, __ATOMIC_RELAXED);
+                break;
+            }
+
+            size_t size = isBuffer ? sizeof(record->data) : sizeof(record->data) - 1;
+            record->length = (length < size) ? length : size;
+            memcpy(record->data, bytes, record->length);
+            if (!isBuffer)
+            {
+                record->data[record->length] = '\0';
+            }
+            record->level = level;
+            record->isBuffer = isBuffer;
+            strncpy(record->tag, tag, sizeof(record->tag) - 1);
+            record->tag[sizeof(record->tag) - 1] = '\0';
+            GetLogTime(&record->min, &record->sec, &record->ms);
+            __atomic_store_n(&record->sequence, pos + 1, __ATOMIC_RELEASE);
+
+            // Buffers take as many records as they need, strings are truncated.
+            bytes += record->length;
+            length = isBuffer ? length - record->length : 0;
+        } while (length);
+
+        if (__atomic_load_n(&g_asyncWaiting, __ATOMIC_SEQ_CST))
+        {
+            pthread_mutex_lock(&g_asyncMutex);
+            pthread_cond_signal(&g_asyncCond);
+            pthread_mutex_unlock(&g_asyncMutex);
+        }
+    }
+    __atomic_sub_fetch(&g_asyncWriters, 1, __ATOMIC_SEQ_CST);
+    return handled;
+}
+
+/**
+ * Write out the queued messages.  Only called by the background thread, or once it is
+ * joined.
+ *
+ * @return true if any message was written.
+ */
+static bool DrainRecords()
+{
+    bool drained = false;
+    for (;;)
+    {
+        AsyncLogRecord *record = &g_asyncRing[g_asyncTail & g_asyncMask];
+        size_t sequence = __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE);
+        if (sequence != g_asyncTail + 1)
+        {
+            break;
+        }
+
+        if (record->isBuffer)
+        {
+            WriteLogBuffer(record->level, record->tag, record->min, record->sec, record->ms,
+                           (const uint8_t *)record->data, record->length);
+        }
+        else
+        {
+            WriteLog(record->level, record->tag, record->min, record->sec, record->ms,
+                     record->data);
+        }
+        __atomic_store_n(&record->sequence, g_asyncTail + g_asyncMask + 1, __ATOMIC_RELEASE);
+        g_asyncTail++;
+        drained = true;
+    }
+    return drained;
+}
+
+static bool IsRingEmpty()
+{
+    AsyncLogRecord *record = &g_asyncRing[g_asyncTail & g_asyncMask];
+    return __atomic_load_n(&record->sequence, __ATOMIC_SEQ_CST) != g_asyncTail + 1;
+}
+
+static void *AsyncLogThread(void *arg)
+{
+    (void) arg;
+    uint32_t reportedDropped = __atomic_load_n(&g_asyncDropped, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        DrainRecords();
+
+        uint32_t dropped = __atomic_load_n(&g_asyncDropped, __ATOMIC_RELAXED);
+        if (dropped != reportedDropped)
+        {
+            char message[64];
+            snprintf(message, sizeof(message), "%u log messages dropped",
+                     (unsigned int)(dropped - reportedDropped));
+            int min, sec, ms;
+            GetLogTime(&min, &sec, &ms);
+            WriteLog(WARNING, "OIC_LOGGER", min, sec, ms, message);
+            reportedDropped = dropped;
+        }
+
+        // Writers only signal while g_asyncWaiting is set, which is checked after they
+        // publish, so a message published before the wait is seen by IsRingEmpty().
+        pthread_mutex_lock(&g_asyncMutex);
+        __atomic_store_n(&g_asyncWaiting, true, __ATOMIC_SEQ_CST);
+        if (!g_asyncStop && IsRingEmpty())
+        {
+            pthread_cond_wait(&g_asyncCond, &g_asyncMutex);
+        }
+        __atomic_store_n(&g_asyncWaiting, false, __ATOMIC_SEQ_CST);
+        bool stop = g_asyncStop;
+        pthread_mutex_unlock(&g_asyncMutex);
+
+        if (stop)
+        {
+            DrainRecords();
+            break;
+        }
+    }
+    return NULL;
+}
+#endif
+
 #ifndef ARDUINO
 
 /**
@@ -171,6 +506,7 @@ void OCLogBuffer(int level, const char* tag, const uint8_t* buffer, size_t buffe
         return;
     }
 
+#ifdef __TIZEN__
     // No idea why the static initialization won't work here, it seems the compiler is convinced
     // that this is a variable-sized object.
     char lineBuffer[LINE_BUFFER_SIZE];
@@ -194,6 +530,31 @@ void OCLogBuffer(int level, const char* tag, const uint8_t* buffer, size_t buffe
     {
         OCLogv(level, tag, "%s", lineBuffer);
     }
+#else
+    switch(level)
+    {
+        case DEBUG_LITE:
+            level = DEBUG;
+            break;
+        case INFO_LITE:
+            level = INFO;
+            break;
+        default:
+            break;
+    }
+
+#if defined(OC_LOG_ASYNC)
+    // The hex formatting is left to the background thread too.
+    if (AsyncLog(level, tag, true, buffer, bufferSize))
+    {
+        return;
+    }
+#endif
+
+    int min, sec, ms;
+    GetLogTime(&min, &sec, &ms);
+    WriteLogBuffer(level, tag, min, sec, ms, buffer, bufferSize);
+#endif
 }
 
 void OCSetLogLevel(LogLevel level, bool hidePrivateLogEntries)
@@ -213,8 +574,82 @@ void OCLogInit()
 
 }
 
+bool OCLogStartAsync(size_t queueSize)
+{
+#if defined(OC_LOG_ASYNC)
+    if (__atomic_load_n(&g_asyncRunning, __ATOMIC_SEQ_CST))
+    {
+        return true;
+    }
+
+    if (!g_asyncRing)
+    {
+        size_t capacity = 2;
+        while (capacity < queueSize && capacity <= (SIZE_MAX >> 1))
+        {
+            capacity <<= 1;
+        }
+        g_asyncRing = (AsyncLogRecord *)calloc(capacity, sizeof(AsyncLogRecord));
+        if (!g_asyncRing)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < capacity; i++)
+        {
+            g_asyncRing[i].sequence = i;
+        }
+        g_asyncMask = capacity - 1;
+    }
+
+    g_asyncStop = false;
+    if (pthread_create(&g_asyncThread, NULL, AsyncLogThread, NULL))
+    {
+        return false;
+    }
+    __atomic_store_n(&g_asyncRunning, true, __ATOMIC_SEQ_CST);
+    return true;
+#else
+    (void) queueSize;
+    return false;
+#endif
+}
+
+void OCLogStopAsync()
+{
+#if defined(OC_LOG_ASYNC)
+    if (!__atomic_load_n(&g_asyncRunning, __ATOMIC_SEQ_CST))
+    {
+        return;
+    }
+
+    // New messages are written synchronously from here on; wait for the writers which
+    // are still adding records so the background thread writes those out before it exits.
+    __atomic_store_n(&g_asyncRunning, false, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&g_asyncWriters, __ATOMIC_SEQ_CST))
+    {
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&g_asyncMutex);
+    g_asyncStop = true;
+    pthread_cond_signal(&g_asyncCond);
+    pthread_mutex_unlock(&g_asyncMutex);
+    pthread_join(g_asyncThread, NULL);
+#endif
+}
+
+uint32_t OCLogGetDroppedCount()
+{
+#if defined(OC_LOG_ASYNC)
+    return __atomic_load_n(&g_asyncDropped, __ATOMIC_RELAXED);
+#else
+    return 0;
+#endif
+}
+
 void OCLogShutdown()
 {
+    OCLogStopAsync();
 #if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)
     if (logCtx && logCtx->destroy)
     {
@@ -282,56 +717,17 @@ void OCLog(int level, const char * tag, const char * logStr)
             break;
     }
 
-   #ifdef __ANDROID__
-
-   #ifdef ADB_SHELL
-       printf("%s: %s: %s\n", LEVEL[level], tag, logStr);
-   #else
-       __android_log_write(LEVEL[level], tag, logStr);
-   #endif
-
-   #else
-       if (logCtx && logCtx->write_level)
-       {
-           logCtx->write_level(logCtx, LEVEL_XTABLE[level], logStr);
-
-       }
-       else
-       {
-           int min = 0;
-           int sec = 0;
-           int ms = 0;
-   #if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
-           struct timespec when = { .tv_sec = 0, .tv_nsec = 0 };
-           clockid_t clk = CLOCK_REALTIME;
-   #ifdef CLOCK_REALTIME_COARSE
-           clk = CLOCK_REALTIME_COARSE;
-   #endif
-           if (!clock_gettime(clk, &when))
-           {
-               min = (when.tv_sec / 60) % 60;
-               sec = when.tv_sec % 60;
-               ms = when.tv_nsec / 1000000;
-           }
-   #elif defined(_WIN32)
-           SYSTEMTIME systemTime = {0};
-           GetLocalTime(&systemTime);
-           min = (int)systemTime.wMinute;
-           sec = (int)systemTime.wSecond;
-           ms  = (int)systemTime.wMilliseconds;
-   #else
-           struct timeval now;
-           if (!gettimeofday(&now, NULL))
-           {
-               min = (now.tv_sec / 60) % 60;
-               sec = now.tv_sec % 60;
-               ms = now.tv_usec * 1000;
-           }
-   #endif
-           printf("%02d:%02d.%03d %s: %s: %s\n", min, sec, ms, LEVEL[level], tag, logStr);
-       }
-   #endif
-   }
+#if defined(OC_LOG_ASYNC)
+    if (AsyncLog(level, tag, false, logStr, strlen(logStr)))
+    {
+        return;
+    }
+#endif
+
+    int min, sec, ms;
+    GetLogTime(&min, &sec, &ms);
+    WriteLog(level, tag, min, sec, ms, logStr);
+}
 #endif //__TIZEN__
 #endif //ARDUINO
 #ifdef ARDUINO
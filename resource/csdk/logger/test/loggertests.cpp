@@ -36,6 +36,9 @@ extern "C" {
 
 #include <iostream>
 #include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
 using namespace std;
 
 
@@ -364,3 +367,57 @@ TEST(LoggerTest, LogBuffer) {
         EXPECT_STREQ(stdFileMD5, testFileMD5);
     }
 }
+
+//-----------------------------------------------------------------------------
+// Collects the lines written through a custom log context
+//-----------------------------------------------------------------------------
+static std::vector<std::string> loggedLines;
+
+static size_t collectLine(oc_log_ctx_t *ctx, const int level, const char *msg) {
+    (void) ctx;
+    (void) level;
+    loggedLines.push_back(msg);
+    return strlen(msg);
+}
+
+TEST(LoggerTest, AsyncKeepsOrderPerThread) {
+    oc_log_ctx_t ctx;
+    memset(&ctx, 0, sizeof ctx);
+    ctx.write_level = collectLine;
+    OCLogConfig(&ctx);
+    loggedLines.clear();
+
+    ASSERT_TRUE(OCLogStartAsync(4096));
+    const int threads = 4;
+    const int perThread = 500;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; t++) {
+        writers.push_back(std::thread([t, perThread]() {
+            for (int i = 0; i < perThread; i++) {
+                OIC_LOG_V(INFO, "AsyncLog", "%d %d", t, i);
+            }
+        }));
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    uint8_t buffer[40] = {0};
+    OIC_LOG_BUFFER(INFO, "AsyncLog", buffer, sizeof buffer);
+    // stopping writes out everything still queued.
+    OCLogStopAsync();
+    OCLogConfig(NULL);
+
+    EXPECT_EQ(0u, OCLogGetDroppedCount());
+    ASSERT_EQ((size_t)(threads * perThread + 3), loggedLines.size());
+    int next[threads] = {0};
+    for (int i = 0; i < threads * perThread; i++) {
+        int t = -1;
+        int value = -1;
+        ASSERT_EQ(2, sscanf(loggedLines[i].c_str(), "%d %d", &t, &value));
+        ASSERT_TRUE(t >= 0 && t < threads);
+        EXPECT_EQ(next[t]++, value);
+    }
+    EXPECT_EQ(std::string("00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 "),
+              loggedLines[threads * perThread]);
+    EXPECT_EQ(std::string("00 00 00 00 00 00 00 00 "), loggedLines.back());
+}
@@ -30,6 +30,9 @@ extern "C" {
 /**
  * Opens the RD publish database.
  *
+ * The connection is kept open between calls.  It is reopened when the storage file name was
+ * changed or the file was deleted or replaced since it was opened.
+ *
  * @return ::OC_STACK_OK in case of success or else other value.
  */
 OCStackResult OC_CALL OCRDDatabaseInit();
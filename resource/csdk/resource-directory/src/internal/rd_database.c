@@ -36,6 +36,9 @@
 
 static sqlite3 *gRDDB = NULL;
 
+/* Storage file name gRDDB was opened with. */
+static char *gRDDBFilename = NULL;
+
 #define CHECK_DATABASE_INIT \
     if (!gRDDB) \
     { \
@@ -86,6 +89,125 @@ static sqlite3 *gRDDB = NULL;
     "FOREIGN KEY("XSTR(LINK_ID)") REFERENCES RD_DEVICE_LINK_LIST("XSTR(OC_RSRVD_INS)") " \
     "ON DELETE CASCADE);"
 
+/*
+ * Indexes for the lookups by device, by link and by rt/if value.  The link indexes also serve
+ * the cascading deletes, which otherwise scan the child tables for every deleted link.
+ */
+#define RD_INDEXES \
+    "CREATE INDEX IF NOT EXISTS RD_DEVICE_LINK_LIST_DEVICE ON " \
+    "RD_DEVICE_LINK_LIST(DEVICE_ID," XSTR(OC_RSRVD_HREF) ");" \
+    "CREATE INDEX IF NOT EXISTS RD_LINK_RT_LINK ON RD_LINK_RT(LINK_ID," XSTR(OC_RSRVD_RESOURCE_TYPE) ");" \
+    "CREATE INDEX IF NOT EXISTS RD_LINK_RT_VALUE ON RD_LINK_RT(" XSTR(OC_RSRVD_RESOURCE_TYPE) ",LINK_ID);" \
+    "CREATE INDEX IF NOT EXISTS RD_LINK_IF_LINK ON RD_LINK_IF(LINK_ID," XSTR(OC_RSRVD_INTERFACE) ");" \
+    "CREATE INDEX IF NOT EXISTS RD_LINK_IF_VALUE ON RD_LINK_IF(" XSTR(OC_RSRVD_INTERFACE) ",LINK_ID);" \
+    "CREATE INDEX IF NOT EXISTS RD_LINK_EP_LINK ON " \
+    "RD_LINK_EP(LINK_ID," XSTR(OC_RSRVD_ENDPOINT) "," XSTR(OC_RSRVD_PRIORITY) ");"
+
+/* Statements prepared once per connection, see getStatement(). */
+typedef enum
+{
+    RD_DELETE_RT = 0,
+    RD_INSERT_RT,
+    RD_DELETE_IF,
+    RD_INSERT_IF,
+    RD_DELETE_EP,
+    RD_INSERT_EP,
+    RD_INSERT_LINK,
+    RD_UPDATE_LINK,
+    RD_SELECT_LINK,
+    RD_INSERT_DEVICE,
+    RD_UPDATE_DEVICE,
+    RD_SELECT_DEVICE,
+    RD_DELETE_DEVICE,
+    RD_DELETE_LINK,
+    RD_STATEMENT_COUNT
+} RDStatement;
+
+static const char *gRDStatementSql[RD_STATEMENT_COUNT] =
+{
+    "DELETE FROM RD_LINK_RT WHERE LINK_ID=@id",
+    "INSERT INTO RD_LINK_RT VALUES(@resourceType, @id)",
+    "DELETE FROM RD_LINK_IF WHERE LINK_ID=@id",
+    "INSERT INTO RD_LINK_IF VALUES(@interfaceType, @id)",
+    "DELETE FROM RD_LINK_EP WHERE LINK_ID=@id",
+    "INSERT INTO RD_LINK_EP VALUES(@ep, @pri, @id)",
+    "INSERT OR IGNORE INTO RD_DEVICE_LINK_LIST (ins, href, DEVICE_ID) "
+        "VALUES((SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri),@uri,@id)",
+    "UPDATE RD_DEVICE_LINK_LIST SET anchor=@anchor,bm=@bm WHERE DEVICE_ID=@id AND href=@uri",
+    "SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri",
+    "INSERT OR IGNORE INTO RD_DEVICE_LIST (ID, di, ttl) "
+        "VALUES ((SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId), @deviceId, @ttl)",
+    "UPDATE RD_DEVICE_LIST SET ttl=@ttl WHERE di=@deviceId",
+    "SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId",
+    "DELETE FROM RD_DEVICE_LIST WHERE di=@deviceId",
+    "DELETE FROM RD_DEVICE_LINK_LIST "
+        "WHERE ins=@ins AND DEVICE_ID=(SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId)"
+};
+
+static sqlite3_stmt *gRDStatements[RD_STATEMENT_COUNT];
+
+/*
+ * Returns the statement prepared on the current connection, preparing it on first use.
+ * The statement is reset and its parameters cleared; callers reset it again once they are
+ * done stepping it so it does not hold the transaction open.
+ */
+static int getStatement(RDStatement id, sqlite3_stmt **stmt)
+{
+    int res = SQLITE_OK;
+    if (!gRDStatements[id])
+    {
+        res = sqlite3_prepare_v2(gRDDB, gRDStatementSql[id], -1, &gRDStatements[id], NULL);
+    }
+    else
+    {
+        sqlite3_reset(gRDStatements[id]);
+        res = sqlite3_clear_bindings(gRDStatements[id]);
+    }
+    *stmt = gRDStatements[id];
+    return res;
+}
+
+static void finalizeStatements()
+{
+    for (size_t i = 0; i < RD_STATEMENT_COUNT; i++)
+    {
+        sqlite3_finalize(gRDStatements[i]);
+        gRDStatements[i] = NULL;
+    }
+}
+
+/*
+ * Whether the open connection no longer refers to the storage file, because another file name
+ * was set or the file was deleted or replaced since it was opened.
+ */
+static bool databaseFileChanged()
+{
+    if (!gRDDBFilename || 0 != strcmp(gRDDBFilename, OCRDDatabaseGetStorageFilename()))
+    {
+        return true;
+    }
+    int moved = 0;
+    if (SQLITE_OK != sqlite3_file_control(gRDDB, "main", SQLITE_FCNTL_HAS_MOVED, &moved))
+    {
+        /* Not supported by the VFS, e.g. on Windows where an open file cannot be deleted. */
+        return false;
+    }
+    return (0 != moved);
+}
+
+static int closeDatabase()
+{
+    finalizeStatements();
+    int res = sqlite3_close(gRDDB);
+    if (SQLITE_OK == res)
+    {
+        gRDDB = NULL;
+        OICFree(gRDDBFilename);
+        gRDDBFilename = NULL;
+    }
+    return res;
+}
+
 static void errorCallback(void *arg, int errCode, const char *errMsg)
 {
     OC_UNUSED(arg);
@@ -112,6 +234,7 @@ static bool stringArgumentsWithinBounds(const char** arguments, size_t count)
     return true;
 }
 
+/* Called within the storeLinkPayload savepoint, which is rolled back on error. */
 static int storeResourceTypes(char **resourceTypes, size_t size, sqlite3_int64 rowid)
 {
     int res = 1;
@@ -120,28 +243,20 @@ static int storeResourceTypes(char **resourceTypes, size_t size, sqlite3_int64 r
         return res;
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeResourceTypes", NULL, NULL, NULL));
-
-    static const char deleteRT[] = "DELETE FROM RD_LINK_RT WHERE LINK_ID=@id";
-    static const char insertRT[] = "INSERT INTO RD_LINK_RT VALUES(@resourceType, @id)";
-    int deleteRTSize = (int)sizeof(deleteRT);
-    int insertRTSize = (int)sizeof(insertRT);
-
     sqlite3_stmt *stmt = NULL;
 
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, deleteRT, deleteRTSize, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_DELETE_RT, &stmt));
     VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
     res = sqlite3_step(stmt);
     if (SQLITE_DONE != res)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
+    VERIFY_SQLITE(sqlite3_reset(stmt));
 
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertRT, insertRTSize, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_INSERT_RT, &stmt));
         if (resourceTypes[i])
         {
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
@@ -153,22 +268,17 @@ static int storeResourceTypes(char **resourceTypes, size_t size, sqlite3_int64 r
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
+        VERIFY_SQLITE(sqlite3_reset(stmt));
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "RELEASE storeResourceTypes", NULL, NULL, NULL));
     res = SQLITE_OK;
 
 exit:
-    sqlite3_finalize(stmt);
-    if (SQLITE_OK != res)
-    {
-        sqlite3_exec(gRDDB, "ROLLBACK TO storeResourceTypes", NULL, NULL, NULL);
-    }
+    sqlite3_reset(stmt);
     return res;
 }
 
+/* Called within the storeLinkPayload savepoint, which is rolled back on error. */
 static int storeInterfaces(char **interfaces, size_t size, sqlite3_int64 rowid)
 {
     int res = 1;
@@ -178,26 +288,18 @@ static int storeInterfaces(char **interfaces, size_t size, sqlite3_int64 rowid)
         return res;
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeInterfaces", NULL, NULL, NULL));
-
-    static const char deleteIF[] = "DELETE FROM RD_LINK_IF WHERE LINK_ID=@id";
-    static const char insertIF[] = "INSERT INTO RD_LINK_IF VALUES(@interfaceType, @id)";
-    int deleteIFLength = (int)sizeof(deleteIF);
-    int insertIFLength = (int)sizeof(insertIF);
-
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, deleteIF, deleteIFLength, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_DELETE_IF, &stmt));
     VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
     res = sqlite3_step(stmt);
     if (SQLITE_DONE != res)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
+    VERIFY_SQLITE(sqlite3_reset(stmt));
 
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertIF, insertIFLength, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_INSERT_IF, &stmt));
         if (interfaces[i])
         {
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
@@ -209,48 +311,35 @@ static int storeInterfaces(char **interfaces, size_t size, sqlite3_int64 rowid)
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
+        VERIFY_SQLITE(sqlite3_reset(stmt));
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "RELEASE storeInterfaces", NULL, NULL, NULL));
     res = SQLITE_OK;
 
 exit:
-    sqlite3_finalize(stmt);
-    if (SQLITE_OK != res)
-    {
-        sqlite3_exec(gRDDB, "ROLLBACK TO storeInterfaces", NULL, NULL, NULL);
-    }
+    sqlite3_reset(stmt);
     return res;
 }
 
+/* Called within the storeLinkPayload savepoint, which is rolled back on error. */
 static int storeEndpoints(OCRepPayload **eps, size_t size, sqlite3_int64 rowid)
 {
     int res;
     char *ep = NULL;
-
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeEndpoints", NULL, NULL, NULL));
-    static const char deleteEp[] = "DELETE FROM RD_LINK_EP WHERE LINK_ID=@id";
-    static const char insertEp[] = "INSERT INTO RD_LINK_EP VALUES(@ep, @pri, @id)";
-    int deleteEpLength = (int)sizeof(deleteEp);
-    int insertEpLength = (int)sizeof(insertEp);
-
     sqlite3_stmt *stmt = NULL;
 
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, deleteEp, deleteEpLength, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_DELETE_EP, &stmt));
     VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
     res = sqlite3_step(stmt);
     if (SQLITE_DONE != res)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
+    VERIFY_SQLITE(sqlite3_reset(stmt));
 
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertEp, insertEpLength, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_INSERT_EP, &stmt));
         if (OCRepPayloadGetPropString(eps[i], OC_RSRVD_ENDPOINT, &ep))
         {
             if (!stringArgumentWithinBounds(ep))
@@ -271,22 +360,16 @@ static int storeEndpoints(OCRepPayload **eps, size_t size, sqlite3_int64 rowid)
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
+        VERIFY_SQLITE(sqlite3_reset(stmt));
         OICFree(ep);
         ep = NULL;
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "RELEASE storeEndpoints", NULL, NULL, NULL));
     res = SQLITE_OK;
 
 exit:
+    sqlite3_reset(stmt);
     OICFree(ep);
-    sqlite3_finalize(stmt);
-    if (SQLITE_OK != res)
-    {
-        sqlite3_exec(gRDDB, "ROLLBACK TO storeInterfaces", NULL, NULL, NULL);
-    }
     return res;
 }
 
@@ -323,19 +406,11 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
         OCRepPayload** eps = NULL;
         size_t epsDim[MAX_REP_ARRAY_DEPTH] = {0};
 
-        static const char insertDeviceLLList[] = "INSERT OR IGNORE INTO RD_DEVICE_LINK_LIST (ins, href, DEVICE_ID) "
-            "VALUES((SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri),@uri,@id)";
-        static const char updateDeviceLLList[] = "UPDATE RD_DEVICE_LINK_LIST SET anchor=@anchor,bm=@bm "
-            "WHERE DEVICE_ID=@id AND href=@uri";
-        int insertDeviceLLListSize = (int)sizeof(insertDeviceLLList);
-        int updateDeviceLLListSize = (int)sizeof(updateDeviceLLList);
-
         for (size_t i = 0; (SQLITE_OK == res) && (i < links->arr.dimensions[0]); i++)
         {
             VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeLinkPayload", NULL, NULL, NULL));
 
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertDeviceLLList,
-                            insertDeviceLLListSize, &stmt, NULL));
+            VERIFY_SQLITE(getStatement(RD_INSERT_LINK, &stmt));
 
             OCRepPayload *link = links->arr.objArray[i];
             VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
@@ -353,11 +428,10 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
             {
                 goto exit;
             }
-            VERIFY_SQLITE(sqlite3_finalize(stmt));
+            VERIFY_SQLITE(sqlite3_reset(stmt));
             stmt = NULL;
 
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, updateDeviceLLList,
-                            updateDeviceLLListSize, &stmt, NULL));
+            VERIFY_SQLITE(getStatement(RD_UPDATE_LINK, &stmt));
             VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
             if (uri)
             {
@@ -386,13 +460,10 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
             {
                 goto exit;
             }
-            VERIFY_SQLITE(sqlite3_finalize(stmt));
+            VERIFY_SQLITE(sqlite3_reset(stmt));
             stmt = NULL;
 
-            static const char input[] = "SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri";
-            int inputSize = (int)sizeof(input);
-
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+            VERIFY_SQLITE(getStatement(RD_SELECT_LINK, &stmt));
             VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
             if (uri)
             {
@@ -403,7 +474,7 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
             if (res == SQLITE_ROW || res == SQLITE_DONE)
             {
                 sqlite3_int64 ins = sqlite3_column_int64(stmt, 0);
-                VERIFY_SQLITE(sqlite3_finalize(stmt));
+                VERIFY_SQLITE(sqlite3_reset(stmt));
                 stmt = NULL;
                 if (!OCRepPayloadSetPropInt(link, OC_RSRVD_INS, ins))
                 {
@@ -419,7 +490,7 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
             }
             else
             {
-                VERIFY_SQLITE(sqlite3_finalize(stmt));
+                VERIFY_SQLITE(sqlite3_reset(stmt));
                 stmt = NULL;
             }
 
@@ -460,7 +531,7 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
             anchor = NULL;
             OICFree(uri);
             uri = NULL;
-            sqlite3_finalize(stmt);
+            sqlite3_reset(stmt);
             stmt = NULL;
             if (SQLITE_OK != res)
             {
@@ -485,15 +556,11 @@ static int storeResources(OCRepPayload *payload)
     OCRepPayloadGetPropInt(payload, OC_RSRVD_DEVICE_TTL, &ttl);
 
     int res;
+    sqlite3_stmt *stmt = NULL;
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
 
     /* INSERT OR IGNORE then UPDATE to update or insert the row without triggering the cascading deletes */
-    sqlite3_stmt *stmt = NULL;
-    static const char insertDeviceList[] = "INSERT OR IGNORE INTO RD_DEVICE_LIST (ID, di, ttl) "
-        "VALUES ((SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId), @deviceId, @ttl)";
-    int insertDeviceListSize = (int)sizeof(insertDeviceList);
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertDeviceList, insertDeviceListSize,
-                    &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_INSERT_DEVICE, &stmt));
     if (deviceId)
     {
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
@@ -508,13 +575,10 @@ static int storeResources(OCRepPayload *payload)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
+    VERIFY_SQLITE(sqlite3_reset(stmt));
     stmt = NULL;
 
-    static const char updateDeviceList[] = "UPDATE RD_DEVICE_LIST SET ttl=@ttl WHERE di=@deviceId";
-    int updateDeviceListSize = (int)sizeof(updateDeviceList);
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, updateDeviceList, updateDeviceListSize,
-                    &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_UPDATE_DEVICE, &stmt));
     if (deviceId)
     {
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
@@ -529,14 +593,11 @@ static int storeResources(OCRepPayload *payload)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
+    VERIFY_SQLITE(sqlite3_reset(stmt));
     stmt = NULL;
 
     /* Store the rest of the payload */
-    static const char input[] = "SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId";
-    int inputSize = (int)sizeof(input);
-
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_SELECT_DEVICE, &stmt));
     if (deviceId)
     {
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
@@ -546,13 +607,13 @@ static int storeResources(OCRepPayload *payload)
     if (res == SQLITE_ROW || res == SQLITE_DONE)
     {
         sqlite3_int64 rowid = sqlite3_column_int64(stmt, 0);
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
+        VERIFY_SQLITE(sqlite3_reset(stmt));
         stmt = NULL;
         VERIFY_SQLITE(storeLinkPayload(payload, rowid));
     }
     else
     {
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
+        VERIFY_SQLITE(sqlite3_reset(stmt));
         stmt = NULL;
     }
 
@@ -560,7 +621,7 @@ static int storeResources(OCRepPayload *payload)
     res = SQLITE_OK;
 
 exit:
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     OICFree(deviceId);
     if (SQLITE_OK != res)
     {
@@ -569,9 +630,8 @@ exit:
     return res;
 }
 
-static int deleteResources(const char *deviceId, const uint8_t *instanceIds, uint8_t nInstanceIds)
+static int deleteResources(const char *deviceId, const int64_t *instanceIds, uint16_t nInstanceIds)
 {
-    char *delResource = NULL;
     if (!stringArgumentWithinBounds(deviceId))
     {
         OIC_LOG_V(ERROR, TAG, "Query longer than %d: \n%s", INT_MAX, deviceId);
@@ -579,66 +639,46 @@ static int deleteResources(const char *deviceId, const uint8_t *instanceIds, uin
     }
 
     int res;
+    sqlite3_stmt *stmt = NULL;
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
 
-    sqlite3_stmt *stmt = NULL;
     if (!instanceIds || !nInstanceIds)
     {
-        static const char delDevice[] = "DELETE FROM RD_DEVICE_LIST WHERE di=@deviceId";
-        int delDeviceSize = (int)sizeof(delDevice);
-
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delDevice, delDeviceSize, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_DELETE_DEVICE, &stmt));
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
                                         deviceId, (int)strlen(deviceId), SQLITE_STATIC));
-    }
-    else
-    {
-        static const char pre[] = "DELETE FROM RD_DEVICE_LINK_LIST "
-            "WHERE ins IN ("
-            "SELECT RD_DEVICE_LINK_LIST.ins FROM RD_DEVICE_LINK_LIST "
-            "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-            "WHERE RD_DEVICE_LIST.di=@deviceId AND RD_DEVICE_LINK_LIST.ins IN (";
-        size_t inLen = nInstanceIds + (nInstanceIds - 1);
-        static const char post[] = "))";
-        size_t delResourceSize = sizeof(pre) + inLen + (sizeof(post) - 1);
-        delResource = OICCalloc(delResourceSize, 1);
-        if (!delResource)
+        res = sqlite3_step(stmt);
+        if (SQLITE_DONE != res)
         {
-            res = SQLITE_NOMEM;
             goto exit;
         }
-        OICStrcat(delResource, delResourceSize, pre);
-        OICStrcat(delResource, delResourceSize, "?");
-        for (uint16_t i = 1; i < nInstanceIds; ++i)
-        {
-            OICStrcat(delResource, delResourceSize, ",?");
-        }
-        OICStrcat(delResource, delResourceSize, post);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delResource, (int)delResourceSize,
-                        &stmt, NULL));
-        VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
-                        deviceId, (int)strlen(deviceId), SQLITE_STATIC));
-        assert(sqlite3_bind_parameter_index(stmt, "@deviceId") == 1);
+        VERIFY_SQLITE(sqlite3_reset(stmt));
+        stmt = NULL;
+    }
+    else
+    {
         for (uint16_t i = 0; i < nInstanceIds; ++i)
         {
-            VERIFY_SQLITE(sqlite3_bind_int64(stmt, 2 + i, instanceIds[i]));
+            VERIFY_SQLITE(getStatement(RD_DELETE_LINK, &stmt));
+            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
+                            deviceId, (int)strlen(deviceId), SQLITE_STATIC));
+            VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@ins"),
+                            instanceIds[i]));
+            res = sqlite3_step(stmt);
+            if (SQLITE_DONE != res)
+            {
+                goto exit;
+            }
+            VERIFY_SQLITE(sqlite3_reset(stmt));
+            stmt = NULL;
         }
     }
 
-    res = sqlite3_step(stmt);
-    if (SQLITE_DONE != res)
-    {
-        goto exit;
-    }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
-
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
     res = SQLITE_OK;
 
 exit:
-    OICFree(delResource);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (SQLITE_OK != res)
     {
         sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
@@ -648,6 +688,24 @@ exit:
 
 OCStackResult OC_CALL OCRDDatabaseInit()
 {
+    if (gRDDB)
+    {
+        if (!databaseFileChanged())
+        {
+            /* Keep the connection and the statements prepared on it. */
+            return OC_STACK_OK;
+        }
+        /*
+         * Close before opening the new file, so that its WAL is not mistaken for the one of
+         * the old file when they share a name.
+         */
+        OIC_LOG(DEBUG, TAG, "RD database file changed, reopening it.");
+        if (SQLITE_OK != closeDatabase())
+        {
+            return OC_STACK_ERROR;
+        }
+    }
+
     if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
     {
         OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
@@ -660,6 +718,8 @@ OCStackResult OC_CALL OCRDDatabaseInit()
     {
         OIC_LOG(DEBUG, TAG, "RD database file did not open, as no table exists.");
         OIC_LOG(DEBUG, TAG, "RD creating new table.");
+        sqlite3_close(gRDDB);
+        gRDDB = NULL;
         VERIFY_SQLITE(sqlite3_open_v2(OCRDDatabaseGetStorageFilename(), &gRDDB,
                         SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL));
 
@@ -683,6 +743,13 @@ OCStackResult OC_CALL OCRDDatabaseInit()
 
     if (SQLITE_OK == res)
     {
+        /* Also adds the indexes to databases created before they existed. */
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_INDEXES, NULL, NULL, NULL));
+
+        /* Lets the discovery connection read while a publish is being written. */
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL));
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL));
+
         VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, "PRAGMA foreign_keys = ON;", -1, &stmt, NULL));
         res = sqlite3_step(stmt);
         if (SQLITE_DONE != res)
@@ -691,6 +758,13 @@ OCStackResult OC_CALL OCRDDatabaseInit()
         }
         VERIFY_SQLITE(sqlite3_finalize(stmt));
         stmt = NULL;
+
+        gRDDBFilename = OICStrdup(OCRDDatabaseGetStorageFilename());
+        if (!gRDDBFilename)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to copy the RD database file name.");
+            res = SQLITE_NOMEM;
+        }
     }
 
 exit:
@@ -711,8 +785,7 @@ OCStackResult OC_CALL OCRDDatabaseClose()
 {
     CHECK_DATABASE_INIT;
     int res;
-    VERIFY_SQLITE(sqlite3_close(gRDDB));
-    gRDDB = NULL;
+    VERIFY_SQLITE(closeDatabase());
 exit:
     return (SQLITE_OK == res) ? OC_STACK_OK : OC_STACK_ERROR;
 }
@@ -726,8 +799,8 @@ exit:
     return (SQLITE_OK == res) ? OC_STACK_OK : OC_STACK_ERROR;
 }
 
-OCStackResult OC_CALL OCRDDatabaseDeleteResources(const char *deviceId, const uint8_t *instanceIds,
-        uint8_t nInstanceIds)
+OCStackResult OC_CALL OCRDDatabaseDeleteResources(const char *deviceId, const int64_t *instanceIds,
+        uint16_t nInstanceIds)
 {
     CHECK_DATABASE_INIT;
     int res;
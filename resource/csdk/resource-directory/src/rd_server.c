@@ -360,6 +360,9 @@ OCStackResult OC_CALL OCRDStop()
       OIC_LOG(ERROR, TAG, "Resource Directory resource not deleted.");
     }
 
+    /* The database stays open between requests; it may never have been opened. */
+    OCRDDatabaseClose();
+
     return result;
 }
 
@@ -447,3 +447,102 @@ TEST_F(RDDatabaseTests, DeleteResourcesDevice)
     OCPayloadDestroy((OCPayload *)payloads[0]);
     OCPayloadDestroy((OCPayload *)payloads[1]);
 }
+
+TEST_F(RDDatabaseTests, DiscoverResourceTypeAcrossDevices)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    const char *deviceIds[2] =
+    {
+        "7a960f46-a52e-4837-bd83-460b1a6dd56b",
+        "983656a7-c7e5-49c2-a201-edbeb7606fb5",
+    };
+    OCRepPayload *payloads[2];
+    payloads[0] = CreateResources(deviceIds[0]);
+    ASSERT_TRUE(NULL != payloads[0]) << "CreateResources failed!";
+    payloads[1] = CreateResources(deviceIds[1]);
+    ASSERT_TRUE(NULL != payloads[1]) << "CreateResources failed!";
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(payloads[0]));
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(payloads[1]));
+
+    OCDiscoveryPayload *discPayload = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadCreate(OC_RSRVD_INTERFACE_LL, "core.light",
+            &discPayload));
+    int found[2] = { 0, 0 };
+    for (OCDiscoveryPayload *payload = discPayload; payload; payload = payload->next)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            if (!strcmp(deviceIds[i], payload->sid))
+            {
+                ++found[i];
+                ASSERT_TRUE(NULL != payload->resources);
+                EXPECT_STREQ("/a/light", payload->resources->uri);
+                EXPECT_STREQ("core.light", payload->resources->types->value);
+                EXPECT_TRUE(payload->resources->next == NULL);
+                EndpointsVerify(payload->resources->eps);
+            }
+        }
+    }
+    EXPECT_EQ(1, found[0]);
+    EXPECT_EQ(1, found[1]);
+    OCDiscoveryPayloadDestroy(discPayload);
+    discPayload = NULL;
+
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCRDDatabaseDiscoveryPayloadCreate(NULL, "core.unknown",
+            &discPayload));
+    EXPECT_TRUE(discPayload == NULL);
+
+    OCPayloadDestroy((OCPayload *)payloads[0]);
+    OCPayloadDestroy((OCPayload *)payloads[1]);
+}
+
+TEST_F(RDDatabaseTests, ReplaceDatabaseFile)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    const char *deviceIds[2] =
+    {
+        "7a960f46-a52e-4837-bd83-460b1a6dd56b",
+        "983656a7-c7e5-49c2-a201-edbeb7606fb5",
+    };
+    OCRepPayload *payloads[2];
+    payloads[0] = CreateResources(deviceIds[0]);
+    ASSERT_TRUE(NULL != payloads[0]) << "CreateResources failed!";
+    payloads[1] = CreateResources(deviceIds[1]);
+    ASSERT_TRUE(NULL != payloads[1]) << "CreateResources failed!";
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(payloads[0]));
+
+    // The open connection follows the file that replaces the deleted one
+    remove("RD.db");
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseInit());
+    OCDiscoveryPayload *discPayload = NULL;
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCRDDatabaseDiscoveryPayloadCreate(NULL, "core.light",
+            &discPayload));
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(payloads[1]));
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadCreate(OC_RSRVD_INTERFACE_LL, "core.light",
+            &discPayload));
+    ASSERT_TRUE(NULL != discPayload);
+    EXPECT_STREQ(deviceIds[1], discPayload->sid);
+    EXPECT_TRUE(discPayload->next == NULL);
+    OCDiscoveryPayloadDestroy(discPayload);
+
+    OCPayloadDestroy((OCPayload *)payloads[0]);
+    OCPayloadDestroy((OCPayload *)payloads[1]);
+}
+
+TEST_F(RDDatabaseTests, DiscoverWithoutPublishConnection)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    const char *deviceId = "7a960f46-a52e-4837-bd83-460b1a6dd56b";
+    OCRepPayload *repPayload = CreateResources(deviceId);
+    ASSERT_TRUE(NULL != repPayload) << "CreateResources failed!";
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(repPayload));
+
+    // Discovery opens the WAL database on its own once the publish connection is closed
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseClose());
+    OCDiscoveryPayload *discPayload = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadCreate(NULL, "core.light", &discPayload));
+    OCDiscoveryPayloadDestroy(discPayload);
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseInit());
+
+    OCPayloadDestroy((OCPayload *)repPayload);
+}
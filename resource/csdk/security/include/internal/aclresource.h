@@ -78,6 +78,14 @@ const OicSecAce_t* GetACLResourceDataByRoles(const OicSecRole_t *roles, size_t r
  */
 const OicSecAce_t* GetACLResourceDataByConntype(const OicSecConntype_t conntype, OicSecAce_t **savePtr);
 
+/**
+ * Get a number that changes whenever the ACL changes.  Used to invalidate data derived
+ * from the ACL, such as cached access decisions.
+ *
+ * @return current generation of the ACL, never 0.
+ */
+uint32_t GetACLGeneration(void);
+
 /**
  * This function converts ACL data into CBOR format.
  *
@@ -124,6 +124,20 @@ OicSecCred_t * GenerateCredential(const OicUuid_t* subject, OicSecCredType_t cre
  */
 OCStackResult AddCredential(OicSecCred_t * cred);
 
+/**
+ * This function adds a list of new creds to the credential list, updating the
+ * persistent storage once.
+ *
+ * @note Each cred of the list gets its own credId. The function takes ownership
+ * of the whole list, creds that are not added (e.g. duplicates) are freed.
+ *
+ * @param creds is the list of new credentials.
+ *
+ * @return ::OC_STACK_OK, all creds are valid and persistent storage gets updated.
+ * ::OC_STACK_ERROR, a cred is invalid or fails to update persistent storage.
+ */
+OCStackResult AddCredentials(OicSecCred_t * creds);
+
 /**
  * Function to remove credentials from the SVR DB for the given subject UUID.
  * If multiple credentials exist for the UUID, they will all be removed.
@@ -136,6 +150,19 @@ OCStackResult AddCredential(OicSecCred_t * cred);
  */
 OCStackResult RemoveCredential(const OicUuid_t *subject);
 
+/**
+ * Function to remove the credentials of several subjects from the SVR DB,
+ * updating the persistent storage once.
+ *
+ * @param subjects is the array of Credential Subjects to be deleted.
+ * @param count is the number of entries in @p subjects.
+ *
+ * @return ::OC_STACK_RESOURCE_DELETED if credentials were removed, or
+ * if there are no credentials with the given UUIDs.  An error is returned if
+ * removing credentials failed.
+ */
+OCStackResult RemoveCredentials(const OicUuid_t *subjects, size_t count);
+
 /**
  * Function to remove the credential from SVR DB.
  *
@@ -40,6 +40,12 @@ OCStackResult ReadDatabaseFromPS(const char *databaseName, const char *resourceN
 /**
  * This method updates the database in PS
  *
+ * The update is usually appended to the database.  Once the appended updates outgrow the
+ * rest of the database, the whole database is rewritten instead, in place through the
+ * persistent storage handlers, which offer no way to replace a file atomically.  If the
+ * process or device stops during that rewrite, the database can be left empty or partially
+ * written and its resources are lost.
+ *
  * @param databaseName  is the name of the database to access through persistent storage.
  * @param resourceName  is the name of the resource that will be updated.
  * @param payload       is the pointer to memory where the CBOR payload is located.
@@ -78,6 +84,8 @@ OCStackResult GetSecureVirtualDatabaseFromPS(const char *resourceName, uint8_t *
 /**
  * This method updates the Secure Virtual Database in PS
  *
+ * See UpdateResourceInPS() for when the database is rewritten.
+ *
  * @param resourceName  is the name of the secure resource that will be updated.
  * @param payload       is the pointer to memory where the CBOR payload is located.
  * @param size          is the size of the CBOR payload.
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 
 #include "utlist.h"
+#include <coap/uthash.h>
 #include "ocstack.h"
 #include "octypes.h"
 #include "ocserverrequest.h"
@@ -50,6 +51,10 @@
 
 #include "security_internals.h"
 
+/* AddToAclIndex() fails on out of memory in HASH_ADD, the ACL is searched linearly then. */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
+
 #define TAG  "OIC_SRM_ACL"
 #define NUMBER_OF_SEC_PROV_RSCS 3
 #define NUMBER_OF_DEFAULT_SEC_RSCS 2
@@ -70,6 +75,305 @@ static OicSecAcl_t *gAcl = NULL;
 static OCResourceHandle gAclHandle = NULL;
 static OCResourceHandle gAcl2Handle = NULL;
 
+/**
+ * Subject of the ACEs grouped in an entry of the ACL index.  Unused bytes are zero so
+ * that the whole structure can be used as the hash key.
+ */
+typedef struct
+{
+    OicSecAceSubjectType type;
+    union
+    {
+        OicUuid_t uuid;
+        OicSecRole_t role;
+        OicSecConntype_t conntype;
+    } subject;
+} AclIndexKey_t;
+
+/** ACEs of one subject, in ACL order. */
+typedef struct
+{
+    AclIndexKey_t key;
+    const OicSecAce_t **aces;
+    size_t *positions;
+    size_t count;
+    UT_hash_handle hh;
+} AclIndexEntry_t;
+
+/** Position of an ACE in the ACL. */
+typedef struct
+{
+    const OicSecAce_t *ace;
+    size_t position;
+    UT_hash_handle hh;
+} AclIndexPosition_t;
+
+/** ACEs of gAcl hashed by subject, built on first use after a change of the ACL. */
+static AclIndexEntry_t *gAclIndex = NULL;
+static AclIndexPosition_t *gAclIndexPositions = NULL;
+
+/** Incremented whenever the ACL changes. */
+static uint32_t gAclGeneration = 1;
+
+/** gAcl, its first ACE and gAclGeneration when gAclIndex was built. */
+static const OicSecAcl_t *gAclIndexAcl = NULL;
+static const OicSecAce_t *gAclIndexHead = NULL;
+static uint32_t gAclIndexGeneration = 0;
+
+/**
+ * Record a change of the ACL, so that the ACL index and the decisions of the policy
+ * engine are rebuilt on their next use.
+ */
+static void AclChanged(void)
+{
+    gAclGeneration++;
+    if (0 == gAclGeneration)
+    {
+        gAclGeneration = 1;
+    }
+}
+
+uint32_t GetACLGeneration(void)
+{
+    return gAclGeneration;
+}
+
+static void FreeAclIndex(void)
+{
+    AclIndexEntry_t *entry = NULL;
+    AclIndexEntry_t *tmpEntry = NULL;
+    HASH_ITER(hh, gAclIndex, entry, tmpEntry)
+    {
+        HASH_DELETE(hh, gAclIndex, entry);
+        OICFree(entry->aces);
+        OICFree(entry->positions);
+        OICFree(entry);
+    }
+
+    AclIndexPosition_t *position = NULL;
+    AclIndexPosition_t *tmpPosition = NULL;
+    HASH_ITER(hh, gAclIndexPositions, position, tmpPosition)
+    {
+        HASH_DELETE(hh, gAclIndexPositions, position);
+        OICFree(position);
+    }
+
+    gAclIndexAcl = NULL;
+    gAclIndexHead = NULL;
+    gAclIndexGeneration = 0;
+}
+
+static bool GetAclIndexKey(const OicSecAce_t *ace, AclIndexKey_t *key)
+{
+    memset(key, 0, sizeof(*key));
+    key->type = ace->subjectType;
+    switch (ace->subjectType)
+    {
+        case OicSecAceUuidSubject:
+            memcpy(&key->subject.uuid, &ace->subjectuuid, sizeof(key->subject.uuid));
+            return true;
+        case OicSecAceRoleSubject:
+            OICStrcpy(key->subject.role.id, sizeof(key->subject.role.id), ace->subjectRole.id);
+            OICStrcpy(key->subject.role.authority, sizeof(key->subject.role.authority),
+                      ace->subjectRole.authority);
+            return true;
+        case OicSecAceConntypeSubject:
+            key->subject.conntype = ace->subjectConn;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool AddToAclIndex(const OicSecAce_t *ace, size_t position)
+{
+    AclIndexKey_t key;
+    AclIndexEntry_t *entry = NULL;
+
+    AclIndexPosition_t *acePosition =
+        (AclIndexPosition_t *)OICCalloc(1, sizeof(AclIndexPosition_t));
+    if (NULL == acePosition)
+    {
+        return false;
+    }
+    acePosition->ace = ace;
+    acePosition->position = position;
+    HASH_ADD_PTR(gAclIndexPositions, ace, acePosition);
+
+    if (!GetAclIndexKey(ace, &key))
+    {
+        return true;
+    }
+
+    HASH_FIND(hh, gAclIndex, &key, sizeof(key), entry);
+    if (NULL == entry)
+    {
+        entry = (AclIndexEntry_t *)OICCalloc(1, sizeof(AclIndexEntry_t));
+        if (NULL == entry)
+        {
+            return false;
+        }
+        entry->key = key;
+        HASH_ADD(hh, gAclIndex, key, sizeof(entry->key), entry);
+    }
+
+    const OicSecAce_t **aces = (const OicSecAce_t **)OICRealloc((void *)entry->aces,
+        (entry->count + 1) * sizeof(*entry->aces));
+    if (NULL == aces)
+    {
+        return false;
+    }
+    entry->aces = aces;
+    size_t *positions = (size_t *)OICRealloc(entry->positions,
+        (entry->count + 1) * sizeof(*entry->positions));
+    if (NULL == positions)
+    {
+        return false;
+    }
+    entry->positions = positions;
+    entry->aces[entry->count] = ace;
+    entry->positions[entry->count] = position;
+    entry->count++;
+    return true;
+
+uthash_oom:
+    // The callers free the whole index, only the failed add needs undoing.
+    if (NULL == entry)
+    {
+        if (NULL == acePosition->hh.tbl || NULL == acePosition->hh.tbl->buckets)
+        {
+            uthash_free(acePosition->hh.tbl, sizeof(UT_hash_table));
+            gAclIndexPositions = NULL;
+        }
+        else
+        {
+            HASH_DELETE(hh, gAclIndexPositions, acePosition);
+        }
+        OICFree(acePosition);
+    }
+    else
+    {
+        if (NULL == entry->hh.tbl || NULL == entry->hh.tbl->buckets)
+        {
+            uthash_free(entry->hh.tbl, sizeof(UT_hash_table));
+            gAclIndex = NULL;
+        }
+        else
+        {
+            HASH_DELETE(hh, gAclIndex, entry);
+        }
+        OICFree(entry);
+    }
+    return false;
+}
+
+/**
+ * Build the ACL index if the ACL changed since it was last built.
+ *
+ * @return true if the index matches gAcl, false if it could not be built.
+ */
+static bool UpdateAclIndex(void)
+{
+    if ((gAclIndexGeneration == gAclGeneration) && (gAclIndexAcl == gAcl) &&
+        (NULL != gAcl) && (gAclIndexHead == gAcl->aces))
+    {
+        return true;
+    }
+
+    FreeAclIndex();
+    if (NULL == gAcl)
+    {
+        return false;
+    }
+
+    const OicSecAce_t *ace = NULL;
+    size_t position = 0;
+    LL_FOREACH(gAcl->aces, ace)
+    {
+        if (!AddToAclIndex(ace, position++))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to build the ACL index");
+            FreeAclIndex();
+            return false;
+        }
+    }
+
+    gAclIndexAcl = gAcl;
+    gAclIndexHead = gAcl->aces;
+    gAclIndexGeneration = gAclGeneration;
+    return true;
+}
+
+/**
+ * Find the first ACE of an index entry at or after a position in the ACL.
+ *
+ * @return index in entry->aces of the ACE, or entry->count if there is none.
+ */
+static size_t GetNextInAclIndex(const AclIndexEntry_t *entry, size_t start)
+{
+    size_t low = 0;
+    size_t high = entry->count;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (entry->positions[mid] < start)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * Get the ACL position to resume an ACE search from.
+ *
+ * @return false if *savePtr is not an ACE of the ACL anymore.
+ */
+static bool GetAclIndexStart(OicSecAce_t * const *savePtr, size_t *start)
+{
+    *start = 0;
+    if (NULL != *savePtr)
+    {
+        AclIndexPosition_t *position = NULL;
+        const OicSecAce_t *ace = *savePtr;
+        HASH_FIND_PTR(gAclIndexPositions, &ace, position);
+        if (NULL == position)
+        {
+            return false;
+        }
+        *start = position->position + 1;
+    }
+    return true;
+}
+
+static const OicSecAce_t* FindInAclIndex(const AclIndexKey_t *key, OicSecAce_t **savePtr)
+{
+    AclIndexEntry_t *entry = NULL;
+    size_t start = 0;
+
+    if (UpdateAclIndex() && GetAclIndexStart(savePtr, &start))
+    {
+        HASH_FIND(hh, gAclIndex, key, sizeof(*key), entry);
+        if (NULL != entry)
+        {
+            size_t i = GetNextInAclIndex(entry, start);
+            if (i < entry->count)
+            {
+                *savePtr = (OicSecAce_t *)entry->aces[i];
+                return entry->aces[i];
+            }
+        }
+    }
+
+    // Cleanup in case no ACE is found
+    *savePtr = NULL;
+    return NULL;
+}
+
 void FreeRsrc(OicSecRsrc_t *rsrc)
 {
     //Clean each member of resource
@@ -2141,6 +2445,8 @@ OCStackResult RemoveACE(const OicUuid_t *subject, const char *resource)
 
     if (deleteFlag)
     {
+        AclChanged();
+
         // In case of unit test do not update persistant storage.
         if (memcmp(subject->id, &WILDCARD_SUBJECT_B64_ID, sizeof(subject->id)) == 0)
         {
@@ -2498,6 +2804,7 @@ static OCStackResult RemoveAllAce(void)
             LL_DELETE(gAcl->aces, aceItem);
             FreeACE(aceItem);
         }
+        AclChanged();
 
         //Generate empty ACL payload
         ret = AclToCBORPayload(gAcl, OIC_SEC_ACL_V2, &payload, &size);
@@ -2524,6 +2831,7 @@ static OCStackResult RemoveAllAce(void)
                 {
                     DeleteACLList(gAcl);
                     gAcl = originAcl;
+                    AclChanged();
                 }
                 else
                 {
@@ -2723,6 +3031,7 @@ static OCEntityHandlerResult HandleACLPostRequest(const OCEntityHandlerRequest *
                         OIC_LOG(DEBUG, TAG, "Prepending new ACE:");
                         OIC_LOG_ACE(DEBUG, insertAce);
                         LL_PREPEND(gAcl->aces, insertAce);
+                        AclChanged();
                     }
                     else
                     {
@@ -2921,6 +3230,7 @@ static OCStackResult CreateACLResource()
 OCStackResult SetDefaultACL(OicSecAcl_t *acl)
 {
     gAcl = acl;
+    AclChanged();
     return OC_STACK_OK;
 }
 
@@ -3136,6 +3446,7 @@ OCStackResult InitACLResource()
         // TODO Needs to update persistent storage
     }
     VERIFY_NOT_NULL(TAG, gAcl, FATAL);
+    AclChanged();
 
     // Instantiate 'oic.sec.acl'
     ret = CreateACLResource();
@@ -3155,19 +3466,18 @@ OCStackResult DeInitACLResource()
     OCStackResult ret2 = OCDeleteResource(gAcl2Handle);
     gAcl2Handle = NULL;
 
+    FreeAclIndex();
     if (gAcl)
     {
         DeleteACLList(gAcl);
         gAcl = NULL;
+        AclChanged();
     }
     return (OC_STACK_OK != ret) ? ret : ret2;
 }
 
 const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **savePtr)
 {
-    OicSecAce_t *ace = NULL;
-    OicSecAce_t *begin = NULL;
-
     if (NULL == subjectId || NULL == savePtr || NULL == gAcl)
     {
         return NULL;
@@ -3178,51 +3488,24 @@ const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **
 
     /*
      * savePtr MUST point to NULL if this is the 'first' call to retrieve ACL for
-     * subjectID.
+     * subjectID.  On a 'successive' call the search resumes after the ACE it points to.
      */
-    if (NULL == *savePtr)
-    {
-        begin = gAcl->aces;
-    }
-    else
-    {
-        /*
-         * If this is a 'successive' call, search for location pointed by
-         * savePtr and assign 'begin' to the next ACL after it in the linked
-         * list and start searching from there.
-         */
-        LL_FOREACH(gAcl->aces, ace)
-        {
-            if (ace == *savePtr)
-            {
-                begin = ace->next;
-            }
-        }
-    }
+    AclIndexKey_t key;
+    memset(&key, 0, sizeof(key));
+    key.type = OicSecAceUuidSubject;
+    memcpy(&key.subject.uuid, subjectId, sizeof(key.subject.uuid));
 
-    // Find the next ACL corresponding to the 'subjectID' and return it.
-    LL_FOREACH(begin, ace)
+    const OicSecAce_t *ace = FindInAclIndex(&key, savePtr);
+    if (NULL != ace)
     {
-        if ((OicSecAceUuidSubject == ace->subjectType) &&
-            (0 == memcmp(&(ace->subjectuuid), subjectId, sizeof(OicUuid_t))))
-        {
-            OIC_LOG(DEBUG, TAG, "GetACLResourceData: found matching ACE:");
-            OIC_LOG_ACE(DEBUG, ace);
-            *savePtr = ace;
-            return ace;
-        }
+        OIC_LOG(DEBUG, TAG, "GetACLResourceData: found matching ACE:");
+        OIC_LOG_ACE(DEBUG, ace);
     }
-
-    // Cleanup in case no ACL is found
-    *savePtr = NULL;
-    return NULL;
+    return ace;
 }
 
 const OicSecAce_t* GetACLResourceDataByRoles(const OicSecRole_t *roles, size_t roleCount, OicSecAce_t **savePtr)
 {
-    OicSecAce_t *ace = NULL;
-    OicSecAce_t *begin = NULL;
-
     if ((NULL == savePtr) || (NULL == gAcl))
     {
         OIC_LOG(ERROR, TAG, "Invalid parameters to GetACLResourceDataByRoles");
@@ -3237,55 +3520,46 @@ const OicSecAce_t* GetACLResourceDataByRoles(const OicSecRole_t *roles, size_t r
 
     /*
      * savePtr MUST point to NULL if this is the 'first' call to retrieve ACL for
-     * subjectID.
+     * subjectID.  On a 'successive' call the search resumes after the ACE it points to.
      */
-    if (NULL == *savePtr)
-    {
-        begin = gAcl->aces;
-    }
-    else
-    {
-        /*
-         * If this is a 'successive' call, search for location pointed by
-         * savePtr and assign 'begin' to the next ACL after it in the linked
-         * list and start searching from there.
-         */
-        LL_FOREACH(gAcl->aces, ace)
-        {
-            if (ace == *savePtr)
-            {
-                begin = ace->next;
-            }
-        }
-    }
+    size_t start = 0;
+    const OicSecAce_t *found = NULL;
+    size_t foundPosition = 0;
 
-    // Find the next ACL corresponding to the 'roleID' and return it.
-    LL_FOREACH(begin, ace)
+    if (UpdateAclIndex() && GetAclIndexStart(savePtr, &start))
     {
-        if (OicSecAceRoleSubject == ace->subjectType)
+        // Find the next ACE, in ACL order, corresponding to any of the roles.
+        for (size_t i = 0; i < roleCount; i++)
         {
-            for (size_t i = 0; i < roleCount; i++)
+            AclIndexKey_t key;
+            AclIndexEntry_t *entry = NULL;
+            memset(&key, 0, sizeof(key));
+            key.type = OicSecAceRoleSubject;
+            OICStrcpy(key.subject.role.id, sizeof(key.subject.role.id), roles[i].id);
+            OICStrcpy(key.subject.role.authority, sizeof(key.subject.role.authority),
+                      roles[i].authority);
+
+            HASH_FIND(hh, gAclIndex, &key, sizeof(key), entry);
+            if (NULL != entry)
             {
-                if ((0 == strcmp(ace->subjectRole.id, roles[i].id) &&
-                    (0 == strcmp(ace->subjectRole.authority, roles[i].authority))))
+                size_t next = GetNextInAclIndex(entry, start);
+                if ((next < entry->count) &&
+                    ((NULL == found) || (entry->positions[next] < foundPosition)))
                 {
-                    *savePtr = ace;
-                    return ace;
+                    found = entry->aces[next];
+                    foundPosition = entry->positions[next];
                 }
             }
         }
     }
 
-    // Cleanup in case no ACL is found
-    *savePtr = NULL;
-    return NULL;
+    // Also clears savePtr in case no ACE is found
+    *savePtr = (OicSecAce_t *)found;
+    return found;
 }
 
 const OicSecAce_t* GetACLResourceDataByConntype(const OicSecConntype_t conntype, OicSecAce_t **savePtr)
 {
-    OicSecAce_t *ace = NULL;
-    OicSecAce_t *begin = NULL;
-
     OIC_LOG_V(DEBUG, TAG, "IN: %s(%d)", __func__, conntype);
 
     if ((NULL == savePtr) || (NULL == gAcl))
@@ -3295,43 +3569,17 @@ const OicSecAce_t* GetACLResourceDataByConntype(const OicSecConntype_t conntype,
     }
 
     // savePtr MUST point to NULL if this is the 'first' call to retrieve ACL.
-    if (NULL == *savePtr)
-    {
-        begin = gAcl->aces;
-    }
-    else
-    {
-        // If this is a 'successive' call, search for location pointed by
-        // savePtr and assign 'begin' to the next ACE after it in the linked
-        // list and start searching from there.
-        LL_FOREACH(gAcl->aces, ace)
-        {
-            if (ace == *savePtr)
-            {
-                begin = ace->next;
-            }
-        }
-    }
-
-    // Find the next ACE corresponding to the conntype, and return it.
-    LL_FOREACH(begin, ace)
-    {
-        if (OicSecAceConntypeSubject == ace->subjectType)
-        {
-            if (conntype == ace->subjectConn)
-            {
-                *savePtr = ace;
-                return ace;
-            }
-        }
-    }
+    // On a 'successive' call the search resumes after the ACE it points to.
+    AclIndexKey_t key;
+    memset(&key, 0, sizeof(key));
+    key.type = OicSecAceConntypeSubject;
+    key.subject.conntype = conntype;
 
-    // Cleanup in case no ACE is found
-    *savePtr = NULL;
+    const OicSecAce_t *ace = FindInAclIndex(&key, savePtr);
 
     OIC_LOG_V(DEBUG, TAG, "OUT: %s(%d)", __func__, conntype);
 
-    return NULL;
+    return ace;
 }
 
 OCStackResult AppendACLObject(const OicSecAcl_t* acl)
@@ -3358,6 +3606,7 @@ OCStackResult AppendACLObject(const OicSecAcl_t* acl)
     {
         gAcl->aces = acl->aces;
     }
+    AclChanged();
 
     OIC_LOG_ACL(INFO, gAcl);
 
@@ -3601,6 +3850,7 @@ OCStackResult UpdateDefaultSecProvACE()
                     LL_DELETE(gAcl->aces, ace);
                     FreeACE(ace);
                     isRemoved = true;
+                    AclChanged();
                 }
             }
         }
@@ -3617,6 +3867,7 @@ OCStackResult UpdateDefaultSecProvACE()
             if (secDefaultAce)
             {
                 LL_APPEND(gAcl->aces, secDefaultAce);
+                AclChanged();
 
                 size_t size = 0;
                 uint8_t *payload = NULL;
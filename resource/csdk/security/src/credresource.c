@@ -43,6 +43,7 @@
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
 #include "utlist.h"
+#include <coap/uthash.h>
 #include "credresource.h"
 #include "doxmresource.h"
 #include "pstatresource.h"
@@ -73,6 +74,13 @@
 #include <mbedtls/pem.h>
 #endif
 
+/*
+ * AddToCredIndexEntry() undoes a HASH_ADD that ran out of memory, the credentials are then
+ * searched without the index.
+ */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
+
 #define TAG  "OIC_SRM_CREDL"
 
 #ifdef HAVE_WINDOWS_H
@@ -95,6 +103,32 @@ static const uint8_t ROLEID_MAP_SIZE = 1;
 static OicSecCred_t        *gCred = NULL;
 static OCResourceHandle    gCredHandle = NULL;
 
+/** Credentials of gCred sharing a key, in gCred order. */
+typedef struct CredIndexEntry
+{
+    uint8_t *key;                   /**< stored right after the entry. */
+    size_t keyLen;
+    OicSecCred_t **creds;
+    size_t count;
+    size_t capacity;
+    UT_hash_handle hh;
+} CredIndexEntry_t;
+
+/**
+ * gCred hashed by credId, subject, credType and credUsage. The index is kept up to date as
+ * credentials are added and removed, and rebuilt on first use after gCred was replaced.
+ */
+static CredIndexEntry_t *gCredIdIndex = NULL;
+static CredIndexEntry_t *gCredSubjectIndex = NULL;
+static CredIndexEntry_t *gCredTypeIndex = NULL;
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+static CredIndexEntry_t *gCredUsageIndex = NULL;
+#endif
+static bool gCredIndexValid = false;
+
+/** No credId below this one is free. */
+static uint16_t gCredIdHint = 1;
+
 typedef enum CredCompareResult{
     CRED_CMP_EQUAL = 0,
     CRED_CMP_NOT_EQUAL = 1,
@@ -343,6 +377,207 @@ static size_t OicSecCredCount(const OicSecCred_t *secCred)
     return size;
 }
 
+static void FreeCredIndexEntries(CredIndexEntry_t **index)
+{
+    CredIndexEntry_t *entry = NULL;
+    CredIndexEntry_t *tmpEntry = NULL;
+    HASH_ITER(hh, *index, entry, tmpEntry)
+    {
+        HASH_DELETE(hh, *index, entry);
+        OICFree(entry->creds);
+        OICFree(entry);
+    }
+}
+
+static void FreeCredIndex(void)
+{
+    FreeCredIndexEntries(&gCredIdIndex);
+    FreeCredIndexEntries(&gCredSubjectIndex);
+    FreeCredIndexEntries(&gCredTypeIndex);
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    FreeCredIndexEntries(&gCredUsageIndex);
+#endif
+    gCredIndexValid = false;
+}
+
+static bool AddToCredIndexEntry(CredIndexEntry_t **index, const void *key, size_t keyLen,
+                                OicSecCred_t *cred)
+{
+    CredIndexEntry_t *entry = NULL;
+    HASH_FIND(hh, *index, key, keyLen, entry);
+    if (NULL == entry)
+    {
+        entry = (CredIndexEntry_t *)OICCalloc(1, sizeof(CredIndexEntry_t) + keyLen);
+        if (NULL == entry)
+        {
+            return false;
+        }
+        entry->key = (uint8_t *)(entry + 1);
+        memcpy(entry->key, key, keyLen);
+        entry->keyLen = keyLen;
+        HASH_ADD_KEYPTR(hh, *index, entry->key, entry->keyLen, entry);
+    }
+
+    if (entry->count == entry->capacity)
+    {
+        size_t capacity = (0 == entry->capacity) ? 1 : 2 * entry->capacity;
+        OicSecCred_t **creds = (OicSecCred_t **)OICRealloc(entry->creds,
+            capacity * sizeof(*entry->creds));
+        if (NULL == creds)
+        {
+            return false;
+        }
+        entry->creds = creds;
+        entry->capacity = capacity;
+    }
+    entry->creds[entry->count++] = cred;
+    return true;
+
+uthash_oom:
+    if (NULL == entry->hh.tbl || NULL == entry->hh.tbl->buckets)
+    {
+        uthash_free(entry->hh.tbl, sizeof(UT_hash_table));
+        *index = NULL;
+    }
+    else
+    {
+        HASH_DELETE(hh, *index, entry);
+    }
+    OICFree(entry);
+    return false;
+}
+
+static void RemoveFromCredIndexEntry(CredIndexEntry_t **index, const void *key, size_t keyLen,
+                                     const OicSecCred_t *cred)
+{
+    CredIndexEntry_t *entry = NULL;
+    HASH_FIND(hh, *index, key, keyLen, entry);
+    if (NULL == entry)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < entry->count; i++)
+    {
+        if (entry->creds[i] == cred)
+        {
+            memmove(&entry->creds[i], &entry->creds[i + 1],
+                    (entry->count - i - 1) * sizeof(*entry->creds));
+            entry->count--;
+            break;
+        }
+    }
+
+    if (0 == entry->count)
+    {
+        HASH_DELETE(hh, *index, entry);
+        OICFree(entry->creds);
+        OICFree(entry);
+    }
+}
+
+static bool AddToCredIndex(OicSecCred_t *cred)
+{
+    if (!AddToCredIndexEntry(&gCredIdIndex, &cred->credId, sizeof(cred->credId), cred) ||
+        !AddToCredIndexEntry(&gCredSubjectIndex, cred->subject.id, sizeof(cred->subject.id), cred) ||
+        !AddToCredIndexEntry(&gCredTypeIndex, &cred->credType, sizeof(cred->credType), cred))
+    {
+        return false;
+    }
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    if ((NULL != cred->credUsage) &&
+        !AddToCredIndexEntry(&gCredUsageIndex, cred->credUsage, strlen(cred->credUsage), cred))
+    {
+        return false;
+    }
+#endif
+    return true;
+}
+
+/**
+ * Build the credential index if gCred was replaced since it was last built.
+ *
+ * @return true if the index matches gCred, false if it could not be built.
+ */
+static bool UpdateCredIndex(void)
+{
+    if (gCredIndexValid)
+    {
+        return true;
+    }
+
+    FreeCredIndex();
+    OicSecCred_t *cred = NULL;
+    LL_FOREACH(gCred, cred)
+    {
+        if (!AddToCredIndex(cred))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to build the credential index");
+            FreeCredIndex();
+            return false;
+        }
+    }
+    gCredIndexValid = true;
+    return true;
+}
+
+static const CredIndexEntry_t *FindInCredIndex(CredIndexEntry_t **index, const void *key,
+                                               size_t keyLen)
+{
+    CredIndexEntry_t *entry = NULL;
+    if (UpdateCredIndex())
+    {
+        HASH_FIND(hh, *index, key, keyLen, entry);
+    }
+    return entry;
+}
+
+/**
+ * Record that gCred was replaced as a whole.
+ */
+static void CredListReplaced(void)
+{
+    FreeCredIndex();
+    gCredIdHint = 1;
+}
+
+/**
+ * Record a credential appended to gCred.
+ */
+static void CredAdded(OicSecCred_t *cred)
+{
+    if (gCredIndexValid && !AddToCredIndex(cred))
+    {
+        OIC_LOG(WARNING, TAG, "Failed to index the credential, the index will be rebuilt");
+        FreeCredIndex();
+    }
+}
+
+/**
+ * Record a credential unlinked from gCred, before it is freed.
+ */
+static void CredRemoved(const OicSecCred_t *cred)
+{
+    if (gCredIndexValid)
+    {
+        RemoveFromCredIndexEntry(&gCredIdIndex, &cred->credId, sizeof(cred->credId), cred);
+        RemoveFromCredIndexEntry(&gCredSubjectIndex, cred->subject.id, sizeof(cred->subject.id),
+                                 cred);
+        RemoveFromCredIndexEntry(&gCredTypeIndex, &cred->credType, sizeof(cred->credType), cred);
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+        if (NULL != cred->credUsage)
+        {
+            RemoveFromCredIndexEntry(&gCredUsageIndex, cred->credUsage, strlen(cred->credUsage),
+                                     cred);
+        }
+#endif
+    }
+    if ((0 < cred->credId) && (cred->credId < gCredIdHint))
+    {
+        gCredIdHint = cred->credId;
+    }
+}
+
 static const char* EncodingValueToString(OicEncodingType_t encoding)
 {
     switch (encoding)
@@ -1437,6 +1672,11 @@ static bool UpdatePersistentStorage(const OicSecCred_t *cred)
     bool ret = false;
     OIC_LOG(DEBUG, TAG, "IN Cred UpdatePersistentStorage");
 
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    // The SSL adapter keeps the certificates and keys parsed from gCred until notified.
+    CAnotifyPkixInfoChanged();
+#endif
+
     // Convert Cred data into JSON for update to persistent storage
     if (cred)
     {
@@ -1525,64 +1765,25 @@ static bool UpdatePersistentStorage(const OicSecCred_t *cred)
 }
 
 /**
- * Compare function used LL_SORT for sorting credentials.
- *
- * @param first pointer to OicSecCred_t struct.
- * @param second  pointer to OicSecCred_t struct.
- *
- *@return -1, if credId of first is less than credId of second.
- * 0, if credId of first is equal to credId of second.
- * 1, if credId of first is greater than credId of second.
- */
-static int CmpCredId(const OicSecCred_t * first, const OicSecCred_t *second)
-{
-    if (first->credId < second->credId)
-    {
-        return -1;
-    }
-    else if (first->credId > second->credId)
-    {
-        return 1;
-    }
-    else
-        return 0;
-}
-
-/**
- * GetCredId goes through the cred list and returns the next
- * available credId. The next credId could be the credId that is
- * available due deletion of OicSecCred_t object or one more than
- * credId of last credential in the list.
+ * GetCredId returns the next available credId. The next credId could be
+ * the credId that is available due deletion of OicSecCred_t object or one
+ * more than the highest credId in use.
  *
  * @return next available credId if successful, else 0 for error.
  */
 static uint16_t GetCredId()
 {
-    //Sorts credential list in incremental order of credId
-    /** @todo: Remove pragma for VS2013 warning; Investigate fixing LL_SORT macro */
-#ifdef _MSC_VER
-#pragma warning(suppress:4133)
-    LL_SORT(gCred, CmpCredId);
-#else
-    LL_SORT(gCred, CmpCredId);
-#endif
-
-    OicSecCred_t *currentCred = NULL, *credTmp = NULL;
-    uint16_t nextCredId = 1;
+    uint16_t nextCredId = gCredIdHint;
 
-    LL_FOREACH_SAFE(gCred, currentCred, credTmp)
+    VERIFY_SUCCESS(TAG, UpdateCredIndex(), ERROR);
+    while ((nextCredId < UINT16_MAX) &&
+           (NULL != FindInCredIndex(&gCredIdIndex, &nextCredId, sizeof(nextCredId))))
     {
-        if (currentCred->credId == nextCredId)
-        {
-            nextCredId += 1;
-        }
-        else
-        {
-            break;
-        }
+        nextCredId += 1;
     }
 
     VERIFY_SUCCESS(TAG, nextCredId < UINT16_MAX, ERROR);
+    gCredIdHint = nextCredId;
     return nextCredId;
 
 exit:
@@ -1747,23 +1948,80 @@ static bool IsNewPreconfigPinCredential(OicSecCred_t * oldCred, OicSecCred_t * n
 }
 #endif //(__WITH_DTLS__ or __WITH_TLS__) and MULTIPLE_OWNER
 
-OCStackResult AddCredential(OicSecCred_t * newCred)
+/**
+ * Remove the credentials of a subject from gCred without updating the persistent storage.
+ *
+ * @return true if a credential was removed.
+ */
+static bool DeleteCredentialsOfSubject(const OicUuid_t *subject)
+{
+    OicSecCred_t *cred = NULL;
+    OicSecCred_t *tempCred = NULL;
+    bool deleteFlag = false;
+
+    LL_FOREACH_SAFE(gCred, cred, tempCred)
+    {
+        if (memcmp(cred->subject.id, subject->id, sizeof(subject->id)) == 0)
+        {
+            LL_DELETE(gCred, cred);
+            CredRemoved(cred);
+            FreeCred(cred);
+            deleteFlag = true;
+        }
+    }
+    return deleteFlag;
+}
+
+/**
+ * Remove the credentials with a credId from gCred without updating the persistent storage.
+ *
+ * @return true if a credential was removed.
+ */
+static bool DeleteCredentialsById(uint16_t credId)
+{
+    OicSecCred_t *cred = NULL;
+    OicSecCred_t *tempCred = NULL;
+    bool deleteFlag = false;
+
+    LL_FOREACH_SAFE(gCred, cred, tempCred)
+    {
+        if (cred->credId == credId)
+        {
+            OIC_LOG_V(DEBUG, TAG, "Credential(ID=%d) will be removed.", credId);
+
+            LL_DELETE(gCred, cred);
+            CredRemoved(cred);
+            FreeCred(cred);
+            deleteFlag = true;
+        }
+    }
+    return deleteFlag;
+}
+
+/**
+ * Append a credential to gCred without updating the persistent storage.
+ *
+ * @param newCred credential to append, a list is appended as a whole.
+ * @param[out] appended set to true if gCred took ownership of newCred.
+ *
+ * @return ::OC_STACK_OK unless newCred is not a valid credential.
+ */
+static OCStackResult AppendCredential(OicSecCred_t * newCred, bool *appended)
 {
     OCStackResult ret = OC_STACK_ERROR;
-    OicSecCred_t * temp = NULL;
     bool validFlag = true;
     OicUuid_t emptyOwner = { .id = {0} };
 #if ((defined(__WITH_DTLS__) || defined(__WITH_TLS__)) && defined(MULTIPLE_OWNER))
     uint16_t staleCredId = 0;
-#endif //(__WITH_DTLS__ or __WITH_TLS__) and MULTIPLE_OWNER  
-
-    OIC_LOG(DEBUG, TAG, "IN AddCredential");
+#endif //(__WITH_DTLS__ or __WITH_TLS__) and MULTIPLE_OWNER
 
+    *appended = false;
     VERIFY_SUCCESS(TAG, NULL != newCred, ERROR);
 
     // Assigning credId to the newCred
     newCred->credId = GetCredId();
     VERIFY_SUCCESS(TAG, true == IsValidCredential(newCred), ERROR);
+    ret = OC_STACK_OK;
 
     // The newCred is not valid if it is empty
     if (memcmp(&(newCred->subject), &emptyOwner, sizeof(OicUuid_t)) == 0)
@@ -1772,15 +2030,18 @@ OCStackResult AddCredential(OicSecCred_t * newCred)
     }
     else
     {
-        LL_FOREACH(gCred, temp)
+        // Only the credentials of the same subject can be equal to newCred.
+        const CredIndexEntry_t *entry = FindInCredIndex(&gCredSubjectIndex, newCred->subject.id,
+                                                        sizeof(newCred->subject.id));
+        for (size_t i = 0; (NULL != entry) && (i < entry->count); i++)
         {
+            OicSecCred_t *temp = entry->creds[i];
             CredCompareResult_t cmpRes = CompareCredential(temp, newCred);
             if(CRED_CMP_EQUAL == cmpRes)
             {
                 OIC_LOG_V(WARNING, TAG, "Detected same credential ID(%d)" \
                           "new credential's ID will be replaced.", temp->credId);
                 newCred->credId = temp->credId;
-                ret = OC_STACK_OK;
                 validFlag = false;
                 break;
             }
@@ -1788,21 +2049,24 @@ OCStackResult AddCredential(OicSecCred_t * newCred)
             if (CRED_CMP_ERROR == cmpRes)
             {
                 OIC_LOG_V(WARNING, TAG, "Credential skipped : %d", cmpRes);
-                ret = OC_STACK_ERROR;
                 validFlag = false;
                 break;
             }
+        }
 
 #if ((defined(__WITH_DTLS__) || defined(__WITH_TLS__)) && defined(MULTIPLE_OWNER))
-            // Devices can only have one Preconfigured Pin credential at any given time. Check
-            // to see if the new credential is an update to an existing Preconfigured Pin
-            // credential so that we can remove it later.
-            if (IsNewPreconfigPinCredential(temp, newCred))
+        // Devices can only have one Preconfigured Pin credential at any given time. Check
+        // to see if the new credential is an update to an existing Preconfigured Pin
+        // credential so that we can remove it later.
+        entry = FindInCredIndex(&gCredUsageIndex, PRECONFIG_PIN_CRED, strlen(PRECONFIG_PIN_CRED));
+        for (size_t i = 0; validFlag && (NULL != entry) && (i < entry->count); i++)
+        {
+            if (IsNewPreconfigPinCredential(entry->creds[i], newCred))
             {
-                staleCredId = temp->credId;
+                staleCredId = entry->creds[i]->credId;
             }
-#endif //(__WITH_DTLS__ or __WITH_TLS__) and MULTIPLE_OWNER
         }
+#endif //(__WITH_DTLS__ or __WITH_TLS__) and MULTIPLE_OWNER
     }
 
     // Append the new Cred to existing list if new Cred is valid
@@ -1812,8 +2076,7 @@ OCStackResult AddCredential(OicSecCred_t * newCred)
         // Remove the existing Preconfigured Pin credential if it exists
         if (0 != staleCredId)
         {
-            ret = RemoveCredentialByCredId(staleCredId);
-            if (OC_STACK_RESOURCE_DELETED == ret)
+            if (DeleteCredentialsById(staleCredId))
             {
                 // Use the old Preconfigured Pin cred id so that this acts as an update
                 newCred->credId = staleCredId;
@@ -1822,35 +2085,87 @@ OCStackResult AddCredential(OicSecCred_t * newCred)
 #endif //(__WITH_DTLS__ or __WITH_TLS__) and MULTIPLE_OWNER
 
         LL_APPEND(gCred, newCred);
+        for (OicSecCred_t *cred = newCred; NULL != cred; cred = cred->next)
+        {
+            CredAdded(cred);
+        }
+        *appended = true;
     }
     if (memcmp(&(newCred->rownerID), &emptyOwner, sizeof(OicUuid_t)) != 0)
     {
         memcpy(&(gCred->rownerID), &(newCred->rownerID), sizeof(OicUuid_t));
     }
-    if (UpdatePersistentStorage(gCred))
+
+exit:
+    return ret;
+}
+
+OCStackResult AddCredential(OicSecCred_t * newCred)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    bool appended = false;
+
+    OIC_LOG(DEBUG, TAG, "IN AddCredential");
+
+    if ((OC_STACK_OK == AppendCredential(newCred, &appended)) && UpdatePersistentStorage(gCred))
     {
         ret = OC_STACK_OK;
     }
 
-exit:
     OIC_LOG(DEBUG, TAG, "OUT AddCredential");
     return ret;
 }
 
-OCStackResult RemoveCredential(const OicUuid_t *subject)
+OCStackResult AddCredentials(OicSecCred_t * newCreds)
 {
-    OCStackResult ret = OC_STACK_RESOURCE_DELETED;
+    OCStackResult ret = OC_STACK_OK;
     OicSecCred_t *cred = NULL;
     OicSecCred_t *tempCred = NULL;
-    bool deleteFlag = false;
 
-    LL_FOREACH_SAFE(gCred, cred, tempCred)
+    OIC_LOG(DEBUG, TAG, "IN AddCredentials");
+
+    VERIFY_NOT_NULL_RETURN(TAG, newCreds, ERROR, OC_STACK_INVALID_PARAM);
+
+    LL_FOREACH_SAFE(newCreds, cred, tempCred)
     {
-        if (memcmp(cred->subject.id, subject->id, sizeof(subject->id)) == 0)
+        bool appended = false;
+        cred->next = NULL;
+        if (OC_STACK_OK != AppendCredential(cred, &appended))
+        {
+            ret = OC_STACK_ERROR;
+        }
+        if (!appended)
         {
-            LL_DELETE(gCred, cred);
             FreeCred(cred);
-            deleteFlag = 1;
+        }
+    }
+
+    if (!UpdatePersistentStorage(gCred))
+    {
+        ret = OC_STACK_ERROR;
+    }
+
+    OIC_LOG(DEBUG, TAG, "OUT AddCredentials");
+    return ret;
+}
+
+OCStackResult RemoveCredential(const OicUuid_t *subject)
+{
+    return RemoveCredentials(subject, 1);
+}
+
+OCStackResult RemoveCredentials(const OicUuid_t *subjects, size_t count)
+{
+    OCStackResult ret = OC_STACK_RESOURCE_DELETED;
+    bool deleteFlag = false;
+
+    VERIFY_NOT_NULL_RETURN(TAG, subjects, ERROR, OC_STACK_INVALID_PARAM);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (DeleteCredentialsOfSubject(&subjects[i]))
+        {
+            deleteFlag = true;
         }
     }
 
@@ -1862,15 +2177,11 @@ OCStackResult RemoveCredential(const OicUuid_t *subject)
         }
     }
     return ret;
-
 }
 
 OCStackResult RemoveCredentialByCredId(uint16_t credId)
 {
     OCStackResult ret = OC_STACK_ERROR;
-    OicSecCred_t *cred = NULL;
-    OicSecCred_t *tempCred = NULL;
-    bool deleteFlag = false;
 
     OIC_LOG(INFO, TAG, "IN RemoveCredentialByCredId");
 
@@ -1879,20 +2190,7 @@ OCStackResult RemoveCredentialByCredId(uint16_t credId)
         return OC_STACK_INVALID_PARAM;
     }
 
-
-    LL_FOREACH_SAFE(gCred, cred, tempCred)
-    {
-        if (cred->credId == credId)
-        {
-            OIC_LOG_V(DEBUG, TAG, "Credential(ID=%d) will be removed.", credId);
-
-            LL_DELETE(gCred, cred);
-            FreeCred(cred);
-            deleteFlag = true;
-        }
-    }
-
-    if (deleteFlag)
+    if (DeleteCredentialsById(credId))
     {
         if (UpdatePersistentStorage(gCred))
         {
@@ -1916,6 +2214,7 @@ OCStackResult RemoveAllCredentials(void)
 {
     DeleteCredList(gCred);
     gCred = GetCredDefault();
+    CredListReplaced();
 
     if (!UpdatePersistentStorage(gCred))
     {
@@ -2326,22 +2625,26 @@ static OCEntityHandlerResult HandlePostRequest(OCEntityHandlerRequest * ehReques
             else
             {
                 /*
-                 * If the post request credential has credId, it will be
-                 * discarded and the next available credId will be assigned
-                 * to it before getting appended to the existing credential
-                 * list and updating svr database.
+                 * If the post request credentials have credIds, they will be
+                 * discarded and the next available credIds will be assigned
+                 * to them before getting appended to the existing credential
+                 * list and updating svr database once.
                  */
-                ret = (OC_STACK_OK == AddCredential(cred))? OC_EH_CHANGED : OC_EH_ERROR;
+                ret = (OC_STACK_OK == AddCredentials(cred))? OC_EH_CHANGED : OC_EH_ERROR;
+                // AddCredentials took ownership of the credentials.
+                cred = NULL;
             }
         }
 #else //not __WITH_DTLS__
         /*
-         * If the post request credential has credId, it will be
-         * discarded and the next available credId will be assigned
-         * to it before getting appended to the existing credential
-         * list and updating svr database.
+         * If the post request credentials have credIds, they will be
+         * discarded and the next available credIds will be assigned
+         * to them before getting appended to the existing credential
+         * list and updating svr database once.
          */
-        ret = (OC_STACK_OK == AddCredential(cred))? OC_EH_CHANGED : OC_EH_ERROR;
+        ret = (OC_STACK_OK == AddCredentials(cred))? OC_EH_CHANGED : OC_EH_ERROR;
+        // AddCredentials took ownership of the credentials.
+        cred = NULL;
         OC_UNUSED(previousMsgId);
 #endif//__WITH_DTLS__
     }
@@ -2570,6 +2873,7 @@ OCStackResult InitCredResource()
     {
         gCred = GetCredDefault();
     }
+    CredListReplaced();
 
     if (gCred)
     {
@@ -2624,26 +2928,24 @@ OCStackResult DeInitCredResource()
     OCStackResult result = OCDeleteResource(gCredHandle);
     DeleteCredList(gCred);
     gCred = NULL;
+    CredListReplaced();
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    // Drop the parsed certificates and the sessions resumable with them.
+    CAnotifyPkixInfoChanged();
+#endif
     return result;
 }
 
 OicSecCred_t* GetCredResourceData(const OicUuid_t* subject)
 {
-    OicSecCred_t *cred = NULL;
-
    if ( NULL == subject)
     {
        return NULL;
     }
 
-    LL_FOREACH(gCred, cred)
-    {
-        if(memcmp(cred->subject.id, subject->id, sizeof(subject->id)) == 0)
-        {
-            return cred;
-        }
-    }
-    return NULL;
+    const CredIndexEntry_t *entry = FindInCredIndex(&gCredSubjectIndex, subject->id,
+                                                    sizeof(subject->id));
+    return (NULL != entry) ? entry->creds[0] : NULL;
 }
 
 const OicSecCred_t* GetCredList()
@@ -2654,69 +2956,67 @@ const OicSecCred_t* GetCredList()
 OicSecCred_t* GetCredEntryByCredId(const uint16_t credId)
 {
     OicSecCred_t *cred = NULL;
-    OicSecCred_t *tmpCred = NULL;
 
    if ( 1 > credId)
     {
        return NULL;
     }
 
-    LL_FOREACH(gCred, tmpCred)
+    const CredIndexEntry_t *entry = FindInCredIndex(&gCredIdIndex, &credId, sizeof(credId));
+    if (NULL != entry)
     {
-        if(tmpCred->credId == credId)
-        {
-            cred = (OicSecCred_t*)OICCalloc(1, sizeof(OicSecCred_t));
-            VERIFY_NOT_NULL(TAG, cred, ERROR);
+        const OicSecCred_t *tmpCred = entry->creds[0];
+        cred = (OicSecCred_t*)OICCalloc(1, sizeof(OicSecCred_t));
+        VERIFY_NOT_NULL(TAG, cred, ERROR);
 
-            // common
-            cred->next = NULL;
-            cred->credId = tmpCred->credId;
-            cred->credType = tmpCred->credType;
-            memcpy(cred->subject.id, tmpCred->subject.id , sizeof(cred->subject.id));
-            memcpy(cred->rownerID.id, tmpCred->rownerID.id , sizeof(cred->rownerID.id));
-            if (tmpCred->period)
-            {
-                cred->period = OICStrdup(tmpCred->period);
-            }
+        // common
+        cred->next = NULL;
+        cred->credId = tmpCred->credId;
+        cred->credType = tmpCred->credType;
+        memcpy(cred->subject.id, tmpCred->subject.id , sizeof(cred->subject.id));
+        memcpy(cred->rownerID.id, tmpCred->rownerID.id , sizeof(cred->rownerID.id));
+        if (tmpCred->period)
+        {
+            cred->period = OICStrdup(tmpCred->period);
+        }
 
-            // key data
-            if (tmpCred->privateData.data)
-            {
-                cred->privateData.data = (uint8_t *)OICCalloc(1, tmpCred->privateData.len);
-                VERIFY_NOT_NULL(TAG, cred->privateData.data, ERROR);
+        // key data
+        if (tmpCred->privateData.data)
+        {
+            cred->privateData.data = (uint8_t *)OICCalloc(1, tmpCred->privateData.len);
+            VERIFY_NOT_NULL(TAG, cred->privateData.data, ERROR);
 
-                memcpy(cred->privateData.data, tmpCred->privateData.data, tmpCred->privateData.len);
-                cred->privateData.len = tmpCred->privateData.len;
-                cred->privateData.encoding = tmpCred->privateData.encoding;
-            }
+            memcpy(cred->privateData.data, tmpCred->privateData.data, tmpCred->privateData.len);
+            cred->privateData.len = tmpCred->privateData.len;
+            cred->privateData.encoding = tmpCred->privateData.encoding;
+        }
 #if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
-            if (tmpCred->publicData.data)
-            {
-                cred->publicData.data = (uint8_t *)OICCalloc(1, tmpCred->publicData.len);
-                VERIFY_NOT_NULL(TAG, cred->publicData.data, ERROR);
+        if (tmpCred->publicData.data)
+        {
+            cred->publicData.data = (uint8_t *)OICCalloc(1, tmpCred->publicData.len);
+            VERIFY_NOT_NULL(TAG, cred->publicData.data, ERROR);
 
-                memcpy(cred->publicData.data, tmpCred->publicData.data, tmpCred->publicData.len);
-                cred->publicData.len = tmpCred->publicData.len;
-                cred->publicData.encoding = tmpCred->publicData.encoding;
-            }
-            if (tmpCred->optionalData.data)
-            {
-                cred->optionalData.data = (uint8_t *)OICCalloc(1, tmpCred->optionalData.len);
-                VERIFY_NOT_NULL(TAG, cred->optionalData.data, ERROR);
+            memcpy(cred->publicData.data, tmpCred->publicData.data, tmpCred->publicData.len);
+            cred->publicData.len = tmpCred->publicData.len;
+            cred->publicData.encoding = tmpCred->publicData.encoding;
+        }
+        if (tmpCred->optionalData.data)
+        {
+            cred->optionalData.data = (uint8_t *)OICCalloc(1, tmpCred->optionalData.len);
+            VERIFY_NOT_NULL(TAG, cred->optionalData.data, ERROR);
 
-                memcpy(cred->optionalData.data, tmpCred->optionalData.data, tmpCred->optionalData.len);
-                cred->optionalData.len = tmpCred->optionalData.len;
-                cred->optionalData.encoding = tmpCred->optionalData.encoding;
-                cred->optionalData.revstat= tmpCred->optionalData.revstat;
-            }
-            if (tmpCred->credUsage)
-            {
-                cred->credUsage = OICStrdup(tmpCred->credUsage);
-            }
+            memcpy(cred->optionalData.data, tmpCred->optionalData.data, tmpCred->optionalData.len);
+            cred->optionalData.len = tmpCred->optionalData.len;
+            cred->optionalData.encoding = tmpCred->optionalData.encoding;
+            cred->optionalData.revstat= tmpCred->optionalData.revstat;
+        }
+        if (tmpCred->credUsage)
+        {
+            cred->credUsage = OICStrdup(tmpCred->credUsage);
+        }
 #endif /* __WITH_DTLS__  or __WITH_TLS__*/
 
-            return cred;
-        }
+        return cred;
     }
 
 exit:
@@ -2761,9 +3061,11 @@ int32_t GetDtlsPskCredentials(CADtlsPskCredType_t type,
 
         case CA_DTLS_PSK_KEY:
             {
-                OicSecCred_t *cred = NULL;
-                LL_FOREACH(gCred, cred)
+                const CredIndexEntry_t *entry = FindInCredIndex(&gCredSubjectIndex, desc,
+                                                                desc_len);
+                for (size_t i = 0; (NULL != entry) && (i < entry->count); i++)
                 {
+                    OicSecCred_t *cred = entry->creds[i];
                     if (cred->credType != SYMMETRIC_PAIR_WISE_KEY)
                     {
                         continue;
@@ -3159,8 +3461,10 @@ static OCStackResult GetCaCert(ByteArray_t * crt, const char * usage, OicEncodin
     crt->len = 0;
     OicSecCred_t* temp = NULL;
 
-    LL_FOREACH(gCred, temp)
+    const CredIndexEntry_t *entry = FindInCredIndex(&gCredUsageIndex, usage, strlen(usage));
+    for (size_t i = 0; (NULL != entry) && (i < entry->count); i++)
     {
+        temp = entry->creds[i];
         if ((SIGNED_ASYMMETRIC_KEY == temp->credType) &&
             (temp->credUsage != NULL) &&
             (0 == strcmp(temp->credUsage, usage)) && (false == temp->optionalData.revstat))
@@ -3331,8 +3635,10 @@ OCStackResult GetAllRoleCerts(RoleCertChain_t ** output)
     *output = NULL;
 
     OicSecCred_t * temp = NULL;
-    LL_FOREACH(gCred, temp)
+    const CredIndexEntry_t *entry = FindInCredIndex(&gCredUsageIndex, ROLE_CERT, strlen(ROLE_CERT));
+    for (size_t i = 0; (NULL != entry) && (i < entry->count); i++)
     {
+        temp = entry->creds[i];
         if ((SIGNED_ASYMMETRIC_KEY == temp->credType) &&
             (temp->credUsage != NULL) &&
             (0 == strcmp(temp->credUsage, ROLE_CERT)))
@@ -3385,8 +3691,10 @@ void GetPemOwnCert(ByteArray_t * crt, const char * usage)
     }
     crt->len = 0;
     OicSecCred_t * temp = NULL;
-    LL_FOREACH(gCred, temp)
+    const CredIndexEntry_t *entry = FindInCredIndex(&gCredUsageIndex, usage, strlen(usage));
+    for (size_t i = 0; (NULL != entry) && (i < entry->count); i++)
     {
+        temp = entry->creds[i];
         if (SIGNED_ASYMMETRIC_KEY == temp->credType &&
             temp->credUsage != NULL &&
             0 == strcmp(temp->credUsage, usage))
@@ -3497,8 +3805,10 @@ void GetDerKey(ByteArray_t * key, const char * usage)
 
     OicSecCred_t * temp = NULL;
     key->len = 0;
-    LL_FOREACH(gCred, temp)
+    const CredIndexEntry_t *entry = FindInCredIndex(&gCredUsageIndex, usage, strlen(usage));
+    for (size_t i = 0; (NULL != entry) && (i < entry->count); i++)
     {
+        temp = entry->creds[i];
         if ((SIGNED_ASYMMETRIC_KEY == temp->credType || ASYMMETRIC_KEY == temp->credType) &&
             temp->privateData.len > 0 &&
             NULL != temp->credUsage &&
@@ -3586,51 +3896,44 @@ void InitCipherSuiteListInternal(bool * list, const char * usage, const char *de
         OIC_LOG_V(DEBUG, TAG, "Out %s", __func__);
         return;
     }
-    OicSecCred_t * temp = NULL;
-    LL_FOREACH(gCred, temp)
+    const OicSecCredType_t pinType = PIN_PASSWORD;
+    if (NULL != FindInCredIndex(&gCredTypeIndex, &pinType, sizeof(pinType)))
+    {
+        list[0] = true;
+        OIC_LOG(DEBUG, TAG, "PIN_PASSWORD found");
+    }
+
+    // Without a valid deviceId any pair-wise key enables PSK cipher suites.
+    const CredIndexEntry_t *entry = NULL;
+    OicUuid_t uuid;
+    if (NULL == deviceId || deviceId[0] == '\0' ||
+        OC_STACK_OK != ConvertStrToUuid(deviceId, &uuid))
     {
-        switch (temp->credType)
+        const OicSecCredType_t pskType = SYMMETRIC_PAIR_WISE_KEY;
+        entry = FindInCredIndex(&gCredTypeIndex, &pskType, sizeof(pskType));
+    }
+    else
+    {
+        entry = FindInCredIndex(&gCredSubjectIndex, uuid.id, sizeof(uuid.id));
+    }
+    for (size_t i = 0; (NULL != entry) && (i < entry->count); i++)
+    {
+        if (SYMMETRIC_PAIR_WISE_KEY == entry->creds[i]->credType)
         {
-            case PIN_PASSWORD:
-            {
-                list[0] = true;
-                OIC_LOG(DEBUG, TAG, "PIN_PASSWORD found");
-                break;
-            }
-            case SYMMETRIC_PAIR_WISE_KEY:
-            {
-                OicUuid_t uuid;
+            list[0] = true;
+            OIC_LOG(DEBUG, TAG, "SYMMETRIC_PAIR_WISE_KEY found");
+            break;
+        }
+    }
 
-                if (NULL == deviceId || deviceId[0] == '\0' ||
-                    OC_STACK_OK != ConvertStrToUuid(deviceId, &uuid) ||
-                    0 == memcmp(uuid.id, temp->subject.id, sizeof(uuid.id)))
-                {
-                    list[0] = true;
-                    OIC_LOG(DEBUG, TAG, "SYMMETRIC_PAIR_WISE_KEY found");
-                }
-                break;
-            }
-            case SIGNED_ASYMMETRIC_KEY:
-            {
-                if (NULL != temp->credUsage && 0 == strcmp(temp->credUsage, usage))
-                {
-                    list[1] = true;
-                    OIC_LOG_V(DEBUG, TAG, "SIGNED_ASYMMETRIC_KEY found for %s", usage);
-                }
-                break;
-            }
-            case SYMMETRIC_GROUP_KEY:
-            case ASYMMETRIC_KEY:
-            case ASYMMETRIC_ENCRYPTION_KEY:
-            {
-                OIC_LOG(WARNING, TAG, "Unsupported credential type for TLS.");
-                break;
-            }
-            default:
-            {
-                OIC_LOG(WARNING, TAG, "Unknown credential type for TLS.");
-                break;
-            }
+    entry = FindInCredIndex(&gCredUsageIndex, usage, strlen(usage));
+    for (size_t i = 0; (NULL != entry) && (i < entry->count); i++)
+    {
+        if (SIGNED_ASYMMETRIC_KEY == entry->creds[i]->credType)
+        {
+            list[1] = true;
+            OIC_LOG_V(DEBUG, TAG, "SIGNED_ASYMMETRIC_KEY found for %s", usage);
+            break;
         }
     }
     OIC_LOG_V(DEBUG, TAG, "Out %s", __func__);
@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "utlist.h"
+#include "cainterface.h"
 #include "crl_logging.h"
 #include "payload_logging.h"
 #include "psinterface.h"
@@ -487,7 +488,10 @@ OCStackResult UpdateCRLResource(OicSecCrl_t *crl)
         return res;
     }
 
-    return UpdateSecureResourceInPS(OIC_CBOR_CRL_NAME, payload, size);
+    res = UpdateSecureResourceInPS(OIC_CBOR_CRL_NAME, payload, size);
+    // The SSL adapter keeps the CRL parsed from the persistent storage until notified.
+    CAnotifyPkixInfoChanged();
+    return res;
 }
 
 static OCEntityHandlerResult HandleCRLPostRequest(const OCEntityHandlerRequest *ehRequest)
@@ -41,6 +41,26 @@
 
 #define TAG "OIC_SRM_PE"
 
+/** Number of access decisions remembered by the policy engine. */
+#define DECISION_CACHE_SIZE (16)
+
+/**
+ * Outcome of the conntype and subject ACE checks for a request.  Those checks depend on
+ * the ACL and the fields below only, unlike the role checks and the implicit accesses.
+ */
+typedef struct
+{
+    uint32_t aclGeneration;             // ACL generation of the decision, 0 if unused
+    OicUuid_t subjectUuid;
+    char resourceUri[MAX_URI_LENGTH + 1];
+    uint16_t requestedPermission;
+    bool secureChannel;
+    OicSecDiscoverable_t discoverable;
+    SRMAccessResponse_t responseVal;
+} CachedDecision_t;
+
+static CachedDecision_t gDecisionCache[DECISION_CACHE_SIZE];
+
 uint16_t GetPermissionFromCAMethod_t(const CAMethod_t method)
 {
     uint16_t perm = 0;
@@ -402,7 +422,57 @@ static bool IsResourceInAce(SRMRequestContext_t *context, const OicSecAce_t *ace
     return false;
 }
 
-static void ProcessMatchingACE(SRMRequestContext_t *context, const OicSecAce_t *currentAce)
+/**
+ * Get the decision cache slot of a request.  FNV-1a over the fields of the decision.
+ */
+static CachedDecision_t *GetDecisionCacheSlot(const SRMRequestContext_t *context)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *c = context->resourceUri; *c; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    for (size_t i = 0; i < sizeof(context->subjectUuid.id); i++)
+    {
+        hash = (hash ^ context->subjectUuid.id[i]) * 16777619u;
+    }
+    hash = (hash ^ context->requestedPermission) * 16777619u;
+    hash = (hash ^ (uint32_t)context->secureChannel) * 16777619u;
+    return &gDecisionCache[hash % DECISION_CACHE_SIZE];
+}
+
+static bool IsSameDecision(const CachedDecision_t *decision, const SRMRequestContext_t *context)
+{
+    return (decision->aclGeneration == GetACLGeneration()) &&
+           (decision->requestedPermission == context->requestedPermission) &&
+           (decision->secureChannel == context->secureChannel) &&
+           (decision->discoverable == context->discoverable) &&
+           UuidCmp(&decision->subjectUuid, &context->subjectUuid) &&
+           (0 == strcmp(decision->resourceUri, context->resourceUri));
+}
+
+static void CacheDecision(const SRMRequestContext_t *context)
+{
+    CachedDecision_t *decision = GetDecisionCacheSlot(context);
+    decision->aclGeneration = GetACLGeneration();
+    memcpy(&decision->subjectUuid, &context->subjectUuid, sizeof(decision->subjectUuid));
+    memcpy(decision->resourceUri, context->resourceUri, sizeof(decision->resourceUri));
+    decision->requestedPermission = context->requestedPermission;
+    decision->secureChannel = context->secureChannel;
+    decision->discoverable = context->discoverable;
+    decision->responseVal = context->responseVal;
+}
+
+/**
+ * Check an ACE matching the subject of the request.
+ *
+ * @param[in,out] context    Request being checked, its responseVal is updated.
+ * @param[in] currentAce     ACE to check.
+ * @param[out] timeBounded   Set to true if the decision depended on the validity period of
+ *                           the ACE, so it cannot be cached.  Left unchanged otherwise.
+ */
+static void ProcessMatchingACE(SRMRequestContext_t *context, const OicSecAce_t *currentAce,
+                               bool *timeBounded)
 {
     // Found the subject, so how about resource?
     OIC_LOG_V(DEBUG, TAG, "%s: found ACE matching subject.", __func__);
@@ -416,6 +486,10 @@ static void ProcessMatchingACE(SRMRequestContext_t *context, const OicSecAce_t *
 
         // Found the resource, so it's down to valid period & permission.
         context->responseVal = ACCESS_DENIED_INVALID_PERIOD;
+        if (NULL != currentAce->validities)
+        {
+            *timeBounded = true;
+        }
         if (IsAccessWithinValidTime(currentAce))
         {
             context->responseVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
@@ -429,20 +503,11 @@ static void ProcessMatchingACE(SRMRequestContext_t *context, const OicSecAce_t *
 }
 
 /**
- * Search for an ACE that matches the Resource URI, by conntype, subjectuuid, or roles.
- * For each matching ACE, check whether it grants permission.
- * If any ACE grants permission, set responseVal to ACCESS_GRANTED.
+ * Search for conntype and subject ACEs that match the Resource URI.
+ * If any of them grants permission, set responseVal to ACCESS_GRANTED.
  */
-static void ProcessAccessRequest(SRMRequestContext_t *context)
+static void ProcessConntypeAndSubjectAces(SRMRequestContext_t *context, bool *timeBounded)
 {
-    if (NULL == context)
-    {
-        OIC_LOG(ERROR, TAG, "ProcessAccessRequest(): context is NULL, returning.");
-        return;
-    }
-
-    OIC_LOG_V(DEBUG, TAG, "Entering %s(%s)", __func__, context->resourceUri);
-
     const OicSecAce_t *currentAce = NULL;
     OicSecAce_t *aceSavePtr = NULL;
 
@@ -467,7 +532,7 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
         {
             OIC_LOG_V(DEBUG, TAG, "%s: found conntype %s match; processing for access.",
                 __func__, (AUTH_CRYPT == conntype?"auth-crypt":"anon-clear"));
-            ProcessMatchingACE(context, currentAce);
+            ProcessMatchingACE(context, currentAce, timeBounded);
         }
         else
         {
@@ -487,7 +552,7 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
 
             if (NULL != currentAce)
             {
-                ProcessMatchingACE(context, currentAce);
+                ProcessMatchingACE(context, currentAce, timeBounded);
             }
             else
             {
@@ -496,13 +561,48 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
             }
         } while ((NULL != currentAce) && !IsAccessGranted(context->responseVal));
     }
+}
+
+/**
+ * Search for an ACE that matches the Resource URI, by conntype, subjectuuid, or roles.
+ * For each matching ACE, check whether it grants permission.
+ * If any ACE grants permission, set responseVal to ACCESS_GRANTED.
+ */
+static void ProcessAccessRequest(SRMRequestContext_t *context)
+{
+    if (NULL == context)
+    {
+        OIC_LOG(ERROR, TAG, "ProcessAccessRequest(): context is NULL, returning.");
+        return;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "Entering %s(%s)", __func__, context->resourceUri);
+
+    bool timeBounded = false;
+
+    CachedDecision_t *decision = GetDecisionCacheSlot(context);
+    if (IsSameDecision(decision, context))
+    {
+        OIC_LOG_V(DEBUG, TAG, "%s: using cached conntype and subject decision", __func__);
+        context->responseVal = decision->responseVal;
+    }
+    else
+    {
+        ProcessConntypeAndSubjectAces(context, &timeBounded);
+
+        // Decisions depending on the current time are not cached.
+        if (!timeBounded)
+        {
+            CacheDecision(context);
+        }
+    }
 
 #if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
     // If no subject ACE granted access, try role ACEs.
     if (!IsAccessGranted(context->responseVal))
     {
-        currentAce = NULL;
-        aceSavePtr = NULL;
+        const OicSecAce_t *currentAce = NULL;
+        OicSecAce_t *aceSavePtr = NULL;
         OicSecRole_t *roles = NULL;
         size_t roleCount = 0;
         OCStackResult res = GetEndpointRoles(context->endPoint, &roles, &roleCount);
@@ -518,7 +618,7 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
                 currentAce = GetACLResourceDataByRoles(roles, roleCount, &aceSavePtr);
                 if (NULL != currentAce)
                 {
-                    ProcessMatchingACE(context, currentAce);
+                    ProcessMatchingACE(context, currentAce, &timeBounded);
                 }
                 else
                 {
@@ -40,6 +40,8 @@
 #include "pstatresource.h"
 #include "doxmresource.h"
 #include "ocresourcehandler.h"
+#include "oic_string.h"
+#include "utlist.h"
 
 #define TAG  "OIC_SRM_PSI"
 
@@ -49,6 +51,12 @@
  */
 #define CBOR_ENCODING_SIZE_ADDITION 255
 
+/**
+ * Covers the length headers of a resource name and its payload while performing
+ * CBOR encoding.
+ */
+#define CBOR_ENTRY_SIZE_ADDITION 18
+
 /**
  * Virtual database buffer block size
  */
@@ -58,11 +66,405 @@
 const size_t DB_FILE_SIZE_BLOCK = 1023;
 #endif
 
-typedef enum _PSDatabase
+/**
+ * Number of databases whose journal sizes are remembered between updates.
+ */
+#define PS_JOURNAL_SLOTS 4
+
+/**
+ * Maximum length of a database name whose journal sizes are remembered.
+ */
+#define PS_JOURNAL_NAME_LENGTH 128
+
+/**
+ * The journal is compacted once it is larger than this many times the first map
+ * and larger than PS_JOURNAL_COMPACT_MIN_SIZE bytes.
+ */
+#define PS_JOURNAL_COMPACT_RATIO 4
+#define PS_JOURNAL_COMPACT_MIN_SIZE 4096
+
+/**
+ * A database in persistent storage is a sequence of CBOR maps from resource name
+ * to the CBOR payload of the resource.  The first map holds the database as of its
+ * last full write.  Every update appends a map with the single updated resource
+ * (a null value removes it), and the last value of a resource wins.
+ * A partially written map at the end is dropped when the database is read, and the
+ * next update compacts the database back into a single map.
+ *
+ * The sizes are a hint that saves reading the database on every update; they go
+ * stale only if the database is written through another process or handler.
+ */
+typedef struct PSJournal
+{
+    const OCPersistentStorage *ps;      /**< handler the database was accessed with. */
+    char name[PS_JOURNAL_NAME_LENGTH];  /**< name of the database. */
+    bool loaded;                        /**< the sizes below are known. */
+    bool torn;                          /**< the database ends in a partially written map. */
+    size_t baseSize;                    /**< size of the first map. */
+    size_t journalSize;                 /**< size of the maps appended after it. */
+} PSJournal;
+
+static PSJournal g_psJournals[PS_JOURNAL_SLOTS];
+static size_t g_psJournalNext = 0;
+
+/**
+ * A resource read from the database.
+ */
+typedef struct PSRecord PSRecord;
+struct PSRecord
+{
+    char *name;         /**< name of the resource. */
+    uint8_t *data;      /**< CBOR payload of the resource, NULL if it was removed. */
+    size_t size;        /**< size of data. */
+    PSRecord *next;
+};
+
+/**
+ * Gets the journal sizes remembered for a database.
+ *
+ * @param ps            is a pointer to OCPersistentStorage for the Virtual Resource(s).
+ * @param databaseName  is the name of the database to access through persistent storage.
+ * @param unlisted      is used when the name is too long to be remembered.
+ *
+ * @return the journal of the database, not loaded if it is seen for the first time.
+ */
+static PSJournal *GetJournal(const OCPersistentStorage *ps, const char *databaseName,
+                             PSJournal *unlisted)
+{
+    for (size_t i = 0; i < PS_JOURNAL_SLOTS; i++)
+    {
+        if ((ps == g_psJournals[i].ps) && (0 == strcmp(databaseName, g_psJournals[i].name)))
+        {
+            return &g_psJournals[i];
+        }
+    }
+
+    PSJournal *journal = unlisted;
+    if (strlen(databaseName) < PS_JOURNAL_NAME_LENGTH)
+    {
+        journal = &g_psJournals[g_psJournalNext++ % PS_JOURNAL_SLOTS];
+    }
+    memset(journal, 0, sizeof(PSJournal));
+    if (journal != unlisted)
+    {
+        journal->ps = ps;
+        OICStrcpy(journal->name, sizeof(journal->name), databaseName);
+    }
+    return journal;
+}
+
+/**
+ * Frees a list of records.
+ *
+ * @param records is the head of the list.
+ */
+static void FreeRecords(PSRecord *records)
+{
+    PSRecord *record = NULL;
+    PSRecord *tmp = NULL;
+    LL_FOREACH_SAFE(records, record, tmp)
+    {
+        LL_DELETE(records, record);
+        OICFree(record->name);
+        OICFree(record->data);
+        OICFree(record);
+    }
+}
+
+/**
+ * Merges records read later into a list of records, so the later value of a
+ * resource replaces the earlier one.
+ *
+ * @param records is the list to merge into.
+ * @param entries is the list merged, its records are moved to |records|.
+ */
+static void MergeRecords(PSRecord **records, PSRecord *entries)
+{
+    PSRecord *entry = NULL;
+    PSRecord *tmp = NULL;
+    LL_FOREACH_SAFE(entries, entry, tmp)
+    {
+        LL_DELETE(entries, entry);
+
+        PSRecord *record = *records;
+        while (record && strcmp(record->name, entry->name))
+        {
+            record = record->next;
+        }
+        if (record)
+        {
+            LL_REPLACE_ELEM(*records, record, entry);
+            record->next = NULL;
+            FreeRecords(record);
+        }
+        else
+        {
+            LL_APPEND(*records, entry);
+        }
+    }
+}
+
+/**
+ * Parses one resource of a database map.
+ *
+ * @param map       is the map iterator, moved past the resource.
+ * @param filter    is the only resource name to keep, NULL to keep all of them.
+ * @param keep      is false to only check the resource.
+ * @param entries   is the list the resource is appended to.
+ *
+ * @return ::CborNoError for Success, otherwise some error value
+ */
+static CborError ParseRecord(CborValue *map, const char *filter, bool keep, PSRecord **entries)
+{
+    char *name = NULL;
+    size_t len = 0;
+
+    if (!cbor_value_is_text_string(map))
+    {
+        return CborErrorIllegalType;
+    }
+    CborError cborFindResult = cbor_value_dup_text_string(map, &name, &len, map);
+    if ((CborNoError == cborFindResult) && keep && (!filter || (0 == strcmp(filter, name))))
+    {
+        PSRecord *record = (PSRecord *) OICCalloc(1, sizeof(PSRecord));
+        if (!record)
+        {
+            OICFree(name);
+            return CborErrorOutOfMemory;
+        }
+        record->name = name;
+        name = NULL;
+        LL_APPEND(*entries, record);
+
+        // any other value leaves |data| NULL, which removes the resource
+        if (cbor_value_is_byte_string(map))
+        {
+            cborFindResult = cbor_value_dup_byte_string(map, &record->data, &record->size, NULL);
+        }
+    }
+    if (CborNoError == cborFindResult)
+    {
+        cborFindResult = cbor_value_advance(map);
+    }
+    OICFree(name);
+    return cborFindResult;
+}
+
+/**
+ * Parses the maps of a database and merges their resources.
+ *
+ * @param data      is the database read from persistent storage.
+ * @param size      is the size of data.
+ * @param filter    is the only resource name to keep, NULL to keep all of them.
+ * @param records   is the list the resources are merged into, NULL to only check the database.
+ * @param journal   is updated with the sizes found in the database.
+ *
+ * @return ::CborNoError for Success, otherwise some error value
+ */
+static CborError ParseDatabase(const uint8_t *data, size_t size, const char *filter,
+                               PSRecord **records, PSJournal *journal)
+{
+    CborError cborFindResult = CborNoError;
+
+    journal->loaded = true;
+    journal->torn = false;
+    journal->baseSize = 0;
+    journal->journalSize = 0;
+    if (!data)
+    {
+        return CborNoError;
+    }
+
+    const uint8_t *ptr = data;
+    const uint8_t *end = data + size;
+
+    while (ptr < end)
+    {
+        PSRecord *entries = NULL;
+        CborParser parser;  // will be initialized in |cbor_parser_init|
+        CborValue cbor;     // will be initialized in |cbor_parser_init|
+        CborValue map;      // will be initialized in |cbor_value_enter_container|
+
+        cborFindResult = cbor_parser_init(ptr, end - ptr, 0, &parser, &cbor);
+        if ((CborNoError == cborFindResult) && !cbor_value_is_map(&cbor))
+        {
+            cborFindResult = CborErrorIllegalType;
+        }
+        if (CborNoError == cborFindResult)
+        {
+            cborFindResult = cbor_value_enter_container(&cbor, &map);
+        }
+        while ((CborNoError == cborFindResult) && !cbor_value_at_end(&map))
+        {
+            cborFindResult = ParseRecord(&map, filter, (NULL != records), &entries);
+        }
+        if (CborNoError == cborFindResult)
+        {
+            cborFindResult = cbor_value_leave_container(&cbor, &map);
+        }
+
+        if (CborNoError != cborFindResult)
+        {
+            FreeRecords(entries);
+            journal->torn = true;
+            if ((ptr == data) || (CborErrorOutOfMemory == cborFindResult))
+            {
+                OIC_LOG_V(ERROR, TAG, "Failed Parsing Database: %s", cbor_error_string(cborFindResult));
+                return cborFindResult;
+            }
+            OIC_LOG_V(WARNING, TAG, "Dropping %" PRIuPTR " bytes of partially written database",
+                      (size_t) (end - ptr));
+            break;
+        }
+
+        if (records)
+        {
+            MergeRecords(records, entries);
+        }
+        const uint8_t *next = cbor_value_get_next_byte(&cbor);
+        if (ptr == data)
+        {
+            journal->baseSize = next - ptr;
+        }
+        else
+        {
+            journal->journalSize += next - ptr;
+        }
+        ptr = next;
+    }
+
+    return CborNoError;
+}
+
+/**
+ * Encodes resources as a database map.
+ *
+ * @note Caller of this method MUST use OICFree() method to release memory
+ *       referenced by the payload argument.
+ *
+ * @param records       is the list of resources to encode.
+ * @param withRemoved   is true to encode removed resources as null, false to leave them out.
+ * @param payload       is the pointer to the encoded map.
+ * @param size          is the size of the encoded map.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult EncodeRecords(const PSRecord *records, bool withRemoved,
+                                   uint8_t **payload, size_t *size)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    int64_t cborEncoderResult = CborNoError;
+    size_t allocSize = CBOR_ENCODING_SIZE_ADDITION;
+    size_t count = 0;
+    uint8_t *outPayload = NULL;
+    const PSRecord *record = NULL;
+
+    LL_FOREACH(records, record)
+    {
+        if (record->data || withRemoved)
+        {
+            allocSize += strlen(record->name) + record->size + CBOR_ENTRY_SIZE_ADDITION;
+            count++;
+        }
+    }
+
+    outPayload = (uint8_t *) OICCalloc(1, allocSize);
+    VERIFY_NOT_NULL(TAG, outPayload, ERROR);
+    CborEncoder encoder;  // will be initialized in |cbor_encoder_init|
+    cbor_encoder_init(&encoder, outPayload, allocSize, 0);
+    CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
+    // definite lengths let a partially written map be detected
+    cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, count);
+    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
+
+    LL_FOREACH(records, record)
+    {
+        if (record->data)
+        {
+            cborEncoderResult |= cbor_encode_text_string(&resource, record->name, strlen(record->name));
+            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
+            cborEncoderResult |= cbor_encode_byte_string(&resource, record->data, record->size);
+            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
+        }
+        else if (withRemoved)
+        {
+            cborEncoderResult |= cbor_encode_text_string(&resource, record->name, strlen(record->name));
+            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
+            cborEncoderResult |= cbor_encode_null(&resource);
+            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Null Value.");
+        }
+    }
+
+    cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
+    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Map.");
+    VERIFY_SUCCESS(TAG, CborNoError == cborEncoderResult, ERROR);
+
+    *size = cbor_encoder_get_buffer_size(&encoder, outPayload);
+    *payload = outPayload;
+    outPayload = NULL;
+    ret = OC_STACK_OK;
+
+exit:
+    OICFree(outPayload);
+    return ret;
+}
+
+/**
+ * Reads a whole database from persistent storage.
+ *
+ * @note Caller of this method MUST use OICFree() method to release memory
+ *       referenced by the data argument.
+ *
+ * @param ps            is a pointer to OCPersistentStorage for the Virtual Resource(s).
+ * @param databaseName  is the name of the database to access through persistent storage.
+ * @param data          is the pointer to the database contents, NULL if the database is empty.
+ * @param size          is the size of the database contents.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult ReadFileFromPS(const OCPersistentStorage *ps, const char *databaseName,
+                                    uint8_t **data, size_t *size)
 {
-    PS_DATABASE_SECURITY = 0,
-    PS_DATABASE_DEVICEPROPERTIES
-} PSDatabase;
+    OCStackResult ret = OC_STACK_NO_MEMORY;
+    uint8_t *buffer = NULL;
+    size_t capacity = 0;
+    size_t bytesRead = 0;
+
+    *data = NULL;
+    *size = 0;
+
+    FILE *fp = ps->open(databaseName, "rb");
+    if (!fp)
+    {
+        // a database that does not exist yet is empty
+        return OC_STACK_OK;
+    }
+
+    do
+    {
+        if (*size == capacity)
+        {
+            capacity += capacity ? capacity : DB_FILE_SIZE_BLOCK;
+            uint8_t *tmp = (uint8_t *) OICRealloc(buffer, capacity);
+            VERIFY_NOT_NULL(TAG, tmp, ERROR);
+            buffer = tmp;
+        }
+        bytesRead = ps->read(buffer + *size, 1, capacity - *size, fp);
+        *size += bytesRead;
+    } while (bytesRead);
+
+    if (*size)
+    {
+        *data = buffer;
+        buffer = NULL;
+    }
+    ret = OC_STACK_OK;
+
+exit:
+    ps->close(fp);
+    OICFree(buffer);
+    return ret;
+}
 
 /**
  * Writes CBOR payload to the specified database in persistent storage.
@@ -87,6 +489,10 @@ static OCStackResult WritePayloadToPS(const char *databaseName, uint8_t *payload
     OCPersistentStorage* ps = OCGetPersistentStorageHandler();
     if (ps)
     {
+        PSJournal unlisted;
+        PSJournal *journal = GetJournal(ps, databaseName, &unlisted);
+        journal->loaded = false;
+
         FILE *fp = ps->open(databaseName, "wb");
         if (fp)
         {
@@ -94,6 +500,10 @@ static OCStackResult WritePayloadToPS(const char *databaseName, uint8_t *payload
             if (size == numberItems)
             {
                 OIC_LOG_V(DEBUG, TAG, "Written %" PRIuPTR " bytes into %s", size, databaseName);
+                journal->loaded = true;
+                journal->torn = false;
+                journal->baseSize = size;
+                journal->journalSize = 0;
                 result = OC_STACK_OK;
             }
             else
@@ -112,34 +522,93 @@ static OCStackResult WritePayloadToPS(const char *databaseName, uint8_t *payload
 }
 
 /**
- * Gets the database size
+ * Appends a map of updated resources to the specified database in persistent storage.
  *
  * @param ps            is a pointer to OCPersistentStorage for the Virtual Resource(s).
  * @param databaseName  is the name of the database to access through persistent storage.
+ * @param record        is the CBOR map to append.
+ * @param size          is the size of record.
+ * @param journal       is the journal of the database.
  *
- * @return size_t - total size of the database
+ * @return ::OC_STACK_OK for Success, otherwise some error value
  */
-static size_t GetDatabaseSize(const OCPersistentStorage *ps, const char *databaseName)
+static OCStackResult AppendRecordToPS(const OCPersistentStorage *ps, const char *databaseName,
+                                      const uint8_t *record, size_t size, PSJournal *journal)
 {
-    if (!ps)
-    {
-        return 0;
-    }
-    size_t size = 0;
-    char buffer[DB_FILE_SIZE_BLOCK];  // can not initialize with declaration
-                                      // but maybe not needed to initialize
-    FILE *fp = ps->open(databaseName, "rb");
+    OCStackResult result = OC_STACK_ERROR;
+
+    FILE *fp = ps->open(databaseName, "ab");
     if (fp)
     {
-        size_t bytesRead = 0;
-        do
+        size_t numberItems = ps->write(record, 1, size, fp);
+        if (size == numberItems)
         {
-            bytesRead = ps->read(buffer, 1, DB_FILE_SIZE_BLOCK, fp);
-            size += bytesRead;
-        } while (bytesRead);
+            OIC_LOG_V(DEBUG, TAG, "Appended %" PRIuPTR " bytes to %s", size, databaseName);
+            journal->journalSize += size;
+            result = OC_STACK_OK;
+        }
+        else
+        {
+            OIC_LOG_V(ERROR, TAG, "Failed appending %" PRIuPTR " in %s", numberItems, databaseName);
+            journal->torn = true;
+        }
         ps->close(fp);
     }
-    return size;
+    else
+    {
+        OIC_LOG(ERROR, TAG, "File open for append failed.");
+    }
+
+    return result;
+}
+
+/**
+ * Rewrites the specified database as a single map with a map of updated
+ * resources merged in.
+ *
+ * The database is truncated and rewritten in place.  Writing a temporary file and renaming
+ * it is not possible: OCPersistentStorage has no rename handler, and open handlers may map
+ * any name, or a name sharing the database name as prefix, to the database itself.
+ *
+ * @param ps            is a pointer to OCPersistentStorage for the Virtual Resource(s).
+ * @param databaseName  is the name of the database to access through persistent storage.
+ * @param record        is the CBOR map of updated resources.
+ * @param size          is the size of record.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult CompactDatabaseInPS(const OCPersistentStorage *ps, const char *databaseName,
+                                         const uint8_t *record, size_t size)
+{
+    uint8_t *dbData = NULL;
+    size_t dbSize = 0;
+    uint8_t *outPayload = NULL;
+    size_t outSize = 0;
+    PSRecord *records = NULL;
+    PSJournal scratch;
+
+    OIC_LOG_V(DEBUG, TAG, "Compacting %s", databaseName);
+
+    OCStackResult ret = ReadFileFromPS(ps, databaseName, &dbData, &dbSize);
+    VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
+
+    // a database that can not be parsed is left alone rather than losing its resources
+    ret = OC_STACK_ERROR;
+    CborError cborFindResult = ParseDatabase(dbData, dbSize, NULL, &records, &scratch);
+    VERIFY_SUCCESS(TAG, (CborNoError == cborFindResult), ERROR);
+    cborFindResult = ParseDatabase(record, size, NULL, &records, &scratch);
+    VERIFY_SUCCESS(TAG, (CborNoError == cborFindResult), ERROR);
+
+    ret = EncodeRecords(records, false, &outPayload, &outSize);
+    VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
+
+    ret = WritePayloadToPS(databaseName, outPayload, outSize);
+
+exit:
+    FreeRecords(records);
+    OICFree(dbData);
+    OICFree(outPayload);
+    return ret;
 }
 
 /**
@@ -165,58 +634,57 @@ OCStackResult ReadDatabaseFromPS(const char *databaseName, const char *resourceN
         return OC_STACK_INVALID_PARAM;
     }
 
-    FILE *fp = NULL;
     uint8_t *fsData = NULL;
     size_t fileSize = 0;
+    PSRecord *records = NULL;
+    PSJournal unlisted;
     OCStackResult ret = OC_STACK_ERROR;
 
     OCPersistentStorage *ps = OCGetPersistentStorageHandler();
     VERIFY_NOT_NULL(TAG, ps, ERROR);
 
-    fileSize = GetDatabaseSize(ps, databaseName);
+    ret = ReadFileFromPS(ps, databaseName, &fsData, &fileSize);
+    VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
+    ret = OC_STACK_ERROR;
+
     OIC_LOG_V(DEBUG, TAG, "File Read Size: %" PRIuPTR, fileSize);
     if (fileSize)
     {
-        fsData = (uint8_t *) OICCalloc(1, fileSize);
-        VERIFY_NOT_NULL(TAG, fsData, ERROR);
+        PSJournal *journal = GetJournal(ps, databaseName, &unlisted);
+        CborError cborFindResult = ParseDatabase(fsData, fileSize, resourceName,
+                                                 resourceName ? &records : NULL, journal);
+        VERIFY_SUCCESS(TAG, (CborNoError == cborFindResult), ERROR);
 
-        fp = ps->open(databaseName, "rb");
-        VERIFY_NOT_NULL(TAG, fp, ERROR);
-        if (ps->read(fsData, 1, fileSize, fp) == fileSize)
+        if (resourceName)
         {
-            if (resourceName)
+            if (records && records->data)
             {
-                CborParser parser;  // will be initialized in |cbor_parser_init|
-                CborValue cbor;     // will be initialized in |cbor_parser_init|
-                cbor_parser_init(fsData, fileSize, 0, &parser, &cbor);
-                CborValue cborValue = {0};
-                CborError cborFindResult = cbor_value_map_find_value(&cbor, resourceName, &cborValue);
-                if (CborNoError == cborFindResult && cbor_value_is_byte_string(&cborValue))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&cborValue, data, size, NULL);
-                    VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
-                    ret = OC_STACK_OK;
-                }
-                // in case of |else (...)|, svr_data not found
-            }
-            // return everything in case resourceName is NULL
-            else
-            {
-                *size = fileSize;
-                *data = (uint8_t *) OICCalloc(1, fileSize);
-                VERIFY_NOT_NULL(TAG, *data, ERROR);
-                memcpy(*data, fsData, fileSize);
+                *data = records->data;
+                *size = records->size;
+                records->data = NULL;
                 ret = OC_STACK_OK;
             }
+            // in case of |else (...)|, svr_data not found
+        }
+        // return everything in case resourceName is NULL
+        else if (!journal->journalSize && !journal->torn)
+        {
+            *data = fsData;
+            *size = fileSize;
+            fsData = NULL;
+            ret = OC_STACK_OK;
+        }
+        else
+        {
+            cborFindResult = ParseDatabase(fsData, fileSize, NULL, &records, journal);
+            VERIFY_SUCCESS(TAG, (CborNoError == cborFindResult), ERROR);
+            ret = EncodeRecords(records, false, data, size);
         }
     }
     OIC_LOG(DEBUG, TAG, "ReadDatabaseFromPS OUT");
 
 exit:
-    if (fp)
-    {
-        ps->close(fp);
-    }
+    FreeRecords(records);
     OICFree(fsData);
     return ret;
 }
@@ -239,276 +707,49 @@ OCStackResult UpdateResourceInPS(const char *databaseName, const char *resourceN
         return OC_STACK_INVALID_PARAM;
     }
 
-    size_t dbSize = 0;
-    size_t outSize = 0;
-    uint8_t *dbData = NULL;
-    uint8_t *outPayload = NULL;
-
-    uint8_t *aclCbor = NULL;
-    uint8_t *pstatCbor = NULL;
-    uint8_t *doxmCbor = NULL;
-    uint8_t *amaclCbor = NULL;
-    uint8_t *credCbor = NULL;
-    uint8_t *pconfCbor = NULL;
-    uint8_t *resetPfCbor = NULL;
-    uint8_t *crlCbor = NULL;
-    uint8_t *dpCbor = NULL;
-
-    int64_t cborEncoderResult = CborNoError;
-    OCStackResult ret = ReadDatabaseFromPS(databaseName, NULL, &dbData, &dbSize);
-    if (dbData && dbSize)
-    {
-        PSDatabase database = PS_DATABASE_SECURITY;
-        size_t allocSize = 0;
-        size_t aclCborLen = 0;
-        size_t pstatCborLen = 0;
-        size_t doxmCborLen = 0;
-        size_t amaclCborLen = 0;
-        size_t credCborLen = 0;
-        size_t pconfCborLen = 0;
-        size_t resetPfCborLen = 0;
-        size_t crlCborLen = 0;
-        size_t dpCborLen = 0;
-
-        // Determine which database we are working with so we can scope our operations
-        if (0 == strcmp(OC_DEVICE_PROPS_FILE_NAME, databaseName))
-        {
-            database = PS_DATABASE_DEVICEPROPERTIES;
-        }
-
-        // Gets each secure virtual resource from persistent storage
-        // this local scoping intended, for destroying large cbor instances after use
-        {
-            CborParser parser;  // will be initialized in |cbor_parser_init|
-            CborValue cbor;     // will be initialized in |cbor_parser_init|
-            cbor_parser_init(dbData, dbSize, 0, &parser, &cbor);
-            CborValue curVal = {0};
-            CborError cborFindResult = CborNoError;
-
-            // Only search for and copy resources owned by the target database
-            if (PS_DATABASE_SECURITY == database)
-            {
-                // Security database
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_ACL_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &aclCbor, &aclCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding ACL Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_PSTAT_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &pstatCbor, &pstatCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding PSTAT Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_DOXM_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &doxmCbor, &doxmCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding DOXM Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_AMACL_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &amaclCbor, &amaclCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding AMACL Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRED_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &credCbor, &credCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding CRED Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_PCONF_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &pconfCbor, &pconfCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding PCONF Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_RESET_PF_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &resetPfCbor, &resetPfCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding Reset Profile Name Value.");
-                }
-                int64_t cborFindCrlResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRL_NAME, &curVal);
-                if ((CborNoError == cborFindCrlResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindCrlResult = cbor_value_dup_byte_string(&curVal, &crlCbor, &crlCborLen, NULL);
-                    if ((CborNoError != cborFindCrlResult) && (CborErrorOutOfMemory != cborFindCrlResult))
-                    {
-                        OIC_LOG(ERROR, TAG, "Failed Finding optional CRL Name Value.");
-                    }
-                    else
-                    {
-                        OIC_LOG(INFO, TAG, "Successfully Finding optional CRL Name Value.");
-                    }
-                }
-            }
-            else
-            {
-                // Device Properties database
-                cborFindResult = cbor_value_map_find_value(&cbor, OC_JSON_DEVICE_PROPS_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &dpCbor, &dpCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding Device Properties Name Value.");
-                }
-            }
-        }
-
-        // Updates the added |payload| with the existing secure virtual resource(s)
-        // this local scoping intended, for destroying large cbor instances after use
-        {
-            if (PS_DATABASE_SECURITY == database)
-            {
-                allocSize = aclCborLen + pstatCborLen + doxmCborLen + amaclCborLen
-                          + credCborLen + pconfCborLen + resetPfCborLen + crlCborLen
-                          + size + CBOR_ENCODING_SIZE_ADDITION;
-            }
-            else
-            {
-                allocSize = dpCborLen + size + CBOR_ENCODING_SIZE_ADDITION;
-            }
-
+    uint8_t *record = NULL;
+    size_t recordSize = 0;
+    PSJournal unlisted;
+    OCStackResult ret = OC_STACK_ERROR;
 
-            outPayload = (uint8_t *)OICCalloc(1, allocSize);
-            VERIFY_NOT_NULL(TAG, outPayload, ERROR);
-            CborEncoder encoder;  // will be initialized in |cbor_parser_init|
-            cbor_encoder_init(&encoder, outPayload, allocSize, 0);
-            CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
-            cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, CborIndefiniteLength);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
+    OCPersistentStorage *ps = OCGetPersistentStorageHandler();
+    VERIFY_NOT_NULL(TAG, ps, ERROR);
 
-            // Encode the updated payload and add it to our map so it will be stored in the database.
-            if (payload && size)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&resource, resourceName, strlen(resourceName));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
-                cborEncoderResult |= cbor_encode_byte_string(&resource, payload, size);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
-            }
+    // an update without payload removes the resource
+    PSRecord update = { (char *) resourceName, (payload && size) ? (uint8_t *) payload : NULL,
+                        size, NULL };
+    ret = EncodeRecords(&update, true, &record, &recordSize);
+    VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
 
-            // Check all of the resources from a particular database to see if we need to encode them. If the resource
-            // currently exists in the database and has not been updated then we need to encode it and add it to the
-            // map. If the resource has been updated then it was encoded and added to the map above so we skip it to
-            // avoid having duplicate entries for the resource in the database.
-            if (PS_DATABASE_SECURITY == database)
-            {
-                // Security database
-                if (strcmp(OIC_JSON_ACL_NAME, resourceName) && aclCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_ACL_NAME, strlen(OIC_JSON_ACL_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding ACL Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, aclCbor, aclCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding ACL Value.");
-                }
-                if (strcmp(OIC_JSON_PSTAT_NAME, resourceName) && pstatCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_PSTAT_NAME, strlen(OIC_JSON_PSTAT_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PSTAT Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, pstatCbor, pstatCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PSTAT Value.");
-                }
-                if (strcmp(OIC_JSON_DOXM_NAME, resourceName) && doxmCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_DOXM_NAME, strlen(OIC_JSON_DOXM_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Doxm Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, doxmCbor, doxmCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Doxm Value.");
-                }
-                if (strcmp(OIC_JSON_AMACL_NAME, resourceName) && amaclCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_AMACL_NAME, strlen(OIC_JSON_AMACL_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Amacl Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, amaclCbor, amaclCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Amacl Value.");
-                }
-                if (strcmp(OIC_JSON_CRED_NAME, resourceName) && credCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_CRED_NAME, strlen(OIC_JSON_CRED_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Cred Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, credCbor, credCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Cred Value.");
-                }
-                if (strcmp(OIC_JSON_PCONF_NAME, resourceName) && pconfCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_PCONF_NAME, strlen(OIC_JSON_PCONF_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Pconf Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, pconfCbor, pconfCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Pconf Value.");
-                }
-                if (strcmp(OIC_JSON_RESET_PF_NAME, resourceName) && resetPfCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_RESET_PF_NAME, strlen(OIC_JSON_RESET_PF_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Reset Profile Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, resetPfCbor, resetPfCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Reset Profile Value.");
-                }
-                if (strcmp(OIC_JSON_CRL_NAME, resourceName) && crlCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_CRL_NAME, strlen(OIC_JSON_CRL_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Crl Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, crlCbor, crlCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Crl Value.");
-                }
-            }
-            else
-            {
-                // Device Properties database
-                if (strcmp(OC_JSON_DEVICE_PROPS_NAME, resourceName) && dpCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OC_JSON_DEVICE_PROPS_NAME, strlen(OC_JSON_DEVICE_PROPS_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Device Properties Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, dpCbor, dpCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Device Properties Value.");
-                }
-            }
+    PSJournal *journal = GetJournal(ps, databaseName, &unlisted);
+    if (!journal->loaded)
+    {
+        uint8_t *dbData = NULL;
+        size_t dbSize = 0;
+        ret = ReadFileFromPS(ps, databaseName, &dbData, &dbSize);
+        VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
+        ParseDatabase(dbData, dbSize, NULL, NULL, journal);
+        OICFree(dbData);
+    }
 
-            cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
-            outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
-        }
+    size_t journalSize = journal->journalSize + recordSize;
+    ret = OC_STACK_ERROR;
+    if (journal->loaded && !journal->torn && journal->baseSize
+        && ((journalSize <= PS_JOURNAL_COMPACT_MIN_SIZE)
+            || (journalSize <= PS_JOURNAL_COMPACT_RATIO * journal->baseSize)))
+    {
+        ret = AppendRecordToPS(ps, databaseName, record, recordSize, journal);
     }
-    else if (payload && size)
+    if (OC_STACK_OK != ret)
     {
-        size_t allocSize = size + CBOR_ENCODING_SIZE_ADDITION;
-
-        outPayload = (uint8_t *)OICCalloc(1, allocSize);
-        VERIFY_NOT_NULL(TAG, outPayload, ERROR);
-        CborEncoder encoder;  // will be initialized in |cbor_parser_init|
-        cbor_encoder_init(&encoder, outPayload, allocSize, 0);
-        CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
-        cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, CborIndefiniteLength);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
-
-        cborEncoderResult |= cbor_encode_text_string(&resource, resourceName, strlen(resourceName));
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
-        cborEncoderResult |= cbor_encode_byte_string(&resource, payload, size);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
-
-        cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
-        outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
+        ret = CompactDatabaseInPS(ps, databaseName, record, recordSize);
     }
-
-    ret = WritePayloadToPS(databaseName, outPayload, outSize);
     VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
 
     OIC_LOG(DEBUG, TAG, "UpdateResourceInPS OUT");
 
 exit:
-    OICFree(dbData);
-    OICFree(outPayload);
-    OICFree(aclCbor);
-    OICFree(pstatCbor);
-    OICFree(doxmCbor);
-    OICFree(amaclCbor);
-    OICFree(credCbor);
-    OICFree(pconfCbor);
-    OICFree(resetPfCbor);
-    OICFree(crlCbor);
-    OICFree(dpCbor);
+    OICFree(record);
     return ret;
 }
 
@@ -417,6 +417,50 @@ TEST(ACLResourceTest, DefaultAclAllowsRolesAccess)
     DeInitACLResource();
 }
 
+TEST(ACLResourceTest, GetACLResourceDataAfterAclChange)
+{
+    OicSecAcl_t *acl = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    ASSERT_TRUE(NULL != acl);
+
+    // Two ACEs of the same subject, with a conntype ACE in between.
+    OicSecAce_t *aces[3] = { NULL, NULL, NULL };
+    for (size_t i = 0; i < 3; i++)
+    {
+        aces[i] = (OicSecAce_t *)OICCalloc(1, sizeof(OicSecAce_t));
+        ASSERT_TRUE(NULL != aces[i]);
+        aces[i]->permission = PERMISSION_READ;
+        LL_APPEND(acl->aces, aces[i]);
+    }
+    aces[0]->subjectType = OicSecAceUuidSubject;
+    memcpy(&aces[0]->subjectuuid, &WILDCARD_SUBJECT_B64_ID, sizeof(OicUuid_t));
+    EXPECT_TRUE(AddResourceToACE(aces[0], "/a/led", "oic.core", "oic.if.r"));
+    aces[1]->subjectType = OicSecAceConntypeSubject;
+    aces[1]->subjectConn = ANON_CLEAR;
+    EXPECT_TRUE(AddResourceToACE(aces[1], "/a/led", "oic.core", "oic.if.r"));
+    aces[2]->subjectType = OicSecAceUuidSubject;
+    memcpy(&aces[2]->subjectuuid, &WILDCARD_SUBJECT_B64_ID, sizeof(OicUuid_t));
+    EXPECT_TRUE(AddResourceToACE(aces[2], "/a/fan", "oic.core", "oic.if.r"));
+
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(acl));
+
+    OicSecAce_t *savePtr = NULL;
+    EXPECT_EQ(aces[0], GetACLResourceData(&WILDCARD_SUBJECT_B64_ID, &savePtr));
+    EXPECT_EQ(aces[2], GetACLResourceData(&WILDCARD_SUBJECT_B64_ID, &savePtr));
+    EXPECT_TRUE(NULL == GetACLResourceData(&WILDCARD_SUBJECT_B64_ID, &savePtr));
+    EXPECT_TRUE(NULL == savePtr);
+
+    // Removing an ACE has to be seen by the next search.
+    uint32_t generation = GetACLGeneration();
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveACE(&WILDCARD_SUBJECT_B64_ID, "/a/led"));
+    EXPECT_NE(generation, GetACLGeneration());
+
+    EXPECT_EQ(aces[2], GetACLResourceData(&WILDCARD_SUBJECT_B64_ID, &savePtr));
+    EXPECT_TRUE(NULL == GetACLResourceData(&WILDCARD_SUBJECT_B64_ID, &savePtr));
+    EXPECT_EQ(aces[1], GetACLResourceDataByConntype(ANON_CLEAR, &savePtr));
+
+    DeInitACLResource();
+}
+
 
 static OCStackResult populateAcl(OicSecAcl_t *acl,  int numRsrc)
 {
@@ -19,6 +19,8 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "gtest/gtest.h"
+#include <set>
+#include <vector>
 #include "ocpayload.h"
 #include "ocstack.h"
 #include "oic_malloc.h"
@@ -204,6 +206,73 @@ TEST(CredResourceTest, CredEntityHandlerDeleteTest)
     OCPayloadDestroy((OCPayload *)ehReq.payload);
 }
 
+TEST(CredResourceTest, AddAndRemoveCredentialsInBulk)
+{
+    static OCPersistentStorage ps =  OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+
+    OicUuid_t rownerId = {{0}};
+    OICStrcpy((char *)rownerId.id, sizeof(rownerId.id), "ownersIdBulk");
+    uint8_t privateKey[] = "My private Key11";
+    OicSecKey_t key = {privateKey, sizeof(privateKey), OIC_ENCODING_RAW};
+
+    const size_t count = 100;
+    std::vector<OicUuid_t> subjects(count);
+    OicSecCred_t *creds = NULL;
+    OicSecCred_t *last = NULL;
+    for (size_t i = 0; i < count; i++)
+    {
+        char subject[sizeof(subjects[i].id)] = {0};
+        snprintf(subject, sizeof(subject), "bulksubject%03u", (unsigned int)i);
+        memcpy(subjects[i].id, subject, sizeof(subjects[i].id));
+        OicSecCred_t *cred = GenerateCredential(&subjects[i], SYMMETRIC_PAIR_WISE_KEY, NULL,
+                                                &key, &rownerId, NULL);
+        ASSERT_TRUE(NULL != cred);
+        if (NULL == last)
+        {
+            creds = cred;
+        }
+        else
+        {
+            last->next = cred;
+        }
+        last = cred;
+    }
+    EXPECT_EQ(OC_STACK_OK, AddCredentials(creds));
+
+    // Every credential gets its own credId.
+    std::set<uint16_t> credIds;
+    for (size_t i = 0; i < count; i++)
+    {
+        OicSecCred_t *cred = GetCredResourceData(&subjects[i]);
+        ASSERT_TRUE(NULL != cred);
+        EXPECT_TRUE(credIds.insert(cred->credId).second);
+
+        OicSecCred_t *copy = GetCredEntryByCredId(cred->credId);
+        ASSERT_TRUE(NULL != copy);
+        EXPECT_EQ(0, memcmp(copy->subject.id, subjects[i].id, sizeof(subjects[i].id)));
+        DeleteCredList(copy);
+    }
+
+    // The credId of a removed credential is handed out again.
+    uint16_t freedCredId = GetCredResourceData(&subjects[count / 2])->credId;
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveCredential(&subjects[count / 2]));
+    EXPECT_TRUE(NULL == GetCredResourceData(&subjects[count / 2]));
+    EXPECT_TRUE(NULL == GetCredEntryByCredId(freedCredId));
+
+    OicSecCred_t *cred = GenerateCredential(&subjects[count / 2], SYMMETRIC_PAIR_WISE_KEY, NULL,
+                                            &key, &rownerId, NULL);
+    ASSERT_TRUE(NULL != cred);
+    EXPECT_EQ(OC_STACK_OK, AddCredential(cred));
+    EXPECT_EQ(freedCredId, cred->credId);
+
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveCredentials(subjects.data(), count));
+    for (size_t i = 0; i < count; i++)
+    {
+        EXPECT_TRUE(NULL == GetCredResourceData(&subjects[i]));
+    }
+}
+
 TEST(CredResourceTest, CredToCBORPayloadNULL)
 {
     int secureFlag = 0;
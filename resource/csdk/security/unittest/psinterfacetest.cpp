@@ -0,0 +1,204 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+#include <stdio.h>
+#include <string.h>
+#include "cbor.h"
+#include "ocstack.h"
+#include "ocpayload.h"
+#include "oic_malloc.h"
+#include "psinterface.h"
+#include "srmresourcestrings.h"
+#include "srmtestcommon.h"
+
+#define PS_TEST_DB_FILE_NAME "psinterface_test.dat"
+
+class PSInterfaceTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        SetPersistentHandler(&ps, true);
+        remove(PS_TEST_DB_FILE_NAME);
+    }
+
+    virtual void TearDown()
+    {
+        remove(PS_TEST_DB_FILE_NAME);
+    }
+
+    void Update(const char *name, const uint8_t *payload, size_t size)
+    {
+        EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DB_FILE_NAME, name, payload, size));
+    }
+
+    void ExpectResource(const char *name, const uint8_t *payload, size_t size)
+    {
+        uint8_t *data = NULL;
+        size_t dataSize = 0;
+        ASSERT_EQ(OC_STACK_OK, ReadDatabaseFromPS(PS_TEST_DB_FILE_NAME, name, &data, &dataSize));
+        EXPECT_EQ(size, dataSize);
+        EXPECT_EQ(0, memcmp(payload, data, size));
+        OICFree(data);
+    }
+
+    long FileSize()
+    {
+        FILE *fp = fopen(PS_TEST_DB_FILE_NAME, "rb");
+        if (!fp)
+        {
+            return 0;
+        }
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        fclose(fp);
+        return size;
+    }
+
+    OCPersistentStorage ps = OCPersistentStorage();
+    OCPersistentStorage otherPs = OCPersistentStorage();
+};
+
+static const uint8_t ACL1[] = { 0xA1, 0x01, 0x02 };
+static const uint8_t ACL2[] = { 0xA1, 0x03, 0x04, 0x05 };
+static const uint8_t CRED[] = { 0xA1, 0x06 };
+
+TEST_F(PSInterfaceTest, UpdatedResourcesReadBack)
+{
+    Update(OIC_JSON_ACL_NAME, ACL1, sizeof(ACL1));
+    Update(OIC_JSON_CRED_NAME, CRED, sizeof(CRED));
+    Update(OIC_JSON_ACL_NAME, ACL2, sizeof(ACL2));
+
+    ExpectResource(OIC_JSON_ACL_NAME, ACL2, sizeof(ACL2));
+    ExpectResource(OIC_JSON_CRED_NAME, CRED, sizeof(CRED));
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    EXPECT_EQ(OC_STACK_ERROR, ReadDatabaseFromPS(PS_TEST_DB_FILE_NAME, OIC_JSON_PSTAT_NAME,
+                                                 &data, &size));
+}
+
+TEST_F(PSInterfaceTest, WholeDatabaseHoldsLatestResources)
+{
+    Update(OIC_JSON_ACL_NAME, ACL1, sizeof(ACL1));
+    Update(OIC_JSON_CRED_NAME, CRED, sizeof(CRED));
+    Update(OIC_JSON_ACL_NAME, ACL2, sizeof(ACL2));
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    ASSERT_EQ(OC_STACK_OK, ReadDatabaseFromPS(PS_TEST_DB_FILE_NAME, NULL, &data, &size));
+
+    CborParser parser;
+    CborValue cbor;
+    CborValue map;
+    ASSERT_EQ(CborNoError, cbor_parser_init(data, size, 0, &parser, &cbor));
+    ASSERT_TRUE(cbor_value_is_map(&cbor));
+    size_t length = 0;
+    EXPECT_EQ(CborNoError, cbor_value_get_map_length(&cbor, &length));
+    EXPECT_EQ(2u, length);
+
+    ASSERT_EQ(CborNoError, cbor_value_map_find_value(&cbor, OIC_JSON_ACL_NAME, &map));
+    uint8_t *acl = NULL;
+    size_t aclSize = 0;
+    ASSERT_EQ(CborNoError, cbor_value_dup_byte_string(&map, &acl, &aclSize, NULL));
+    EXPECT_EQ(sizeof(ACL2), aclSize);
+    EXPECT_EQ(0, memcmp(ACL2, acl, aclSize));
+
+    OICFree(acl);
+    OICFree(data);
+}
+
+TEST_F(PSInterfaceTest, UpdateWithoutPayloadRemovesResource)
+{
+    Update(OIC_JSON_ACL_NAME, ACL1, sizeof(ACL1));
+    Update(OIC_JSON_CRED_NAME, CRED, sizeof(CRED));
+    Update(OIC_JSON_ACL_NAME, NULL, 0);
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    EXPECT_EQ(OC_STACK_ERROR, ReadDatabaseFromPS(PS_TEST_DB_FILE_NAME, OIC_JSON_ACL_NAME,
+                                                 &data, &size));
+    ExpectResource(OIC_JSON_CRED_NAME, CRED, sizeof(CRED));
+}
+
+TEST_F(PSInterfaceTest, PartiallyWrittenUpdateIsDropped)
+{
+    Update(OIC_JSON_ACL_NAME, ACL1, sizeof(ACL1));
+    Update(OIC_JSON_ACL_NAME, ACL2, sizeof(ACL2));
+
+    // map of one entry "acl" whose 64 byte payload was never written
+    const uint8_t torn[] = { 0xA1, 0x63, 'a', 'c', 'l', 0x58, 0x40, 0x01 };
+    FILE *fp = fopen(PS_TEST_DB_FILE_NAME, "ab");
+    ASSERT_TRUE(NULL != fp);
+    EXPECT_EQ(sizeof(torn), fwrite(torn, 1, sizeof(torn), fp));
+    fclose(fp);
+
+    ExpectResource(OIC_JSON_ACL_NAME, ACL2, sizeof(ACL2));
+
+    // the next update rewrites the database without the partial map
+    Update(OIC_JSON_CRED_NAME, CRED, sizeof(CRED));
+    ExpectResource(OIC_JSON_ACL_NAME, ACL2, sizeof(ACL2));
+    ExpectResource(OIC_JSON_CRED_NAME, CRED, sizeof(CRED));
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    ASSERT_EQ(OC_STACK_OK, ReadDatabaseFromPS(PS_TEST_DB_FILE_NAME, NULL, &data, &size));
+    EXPECT_EQ(FileSize(), (long) size);
+    OICFree(data);
+}
+
+TEST_F(PSInterfaceTest, UnparsableDatabaseIsNotReplaced)
+{
+    // map of one entry "acl" whose payload was never written
+    const uint8_t corrupt[] = { 0xA1, 0x63, 'a', 'c', 'l', 0x58, 0x40, 0x01 };
+    FILE *fp = fopen(PS_TEST_DB_FILE_NAME, "wb");
+    ASSERT_TRUE(NULL != fp);
+    EXPECT_EQ(sizeof(corrupt), fwrite(corrupt, 1, sizeof(corrupt), fp));
+    fclose(fp);
+
+    // a handler the database was not accessed with yet has to read it first
+    SetPersistentHandler(&otherPs, true);
+    EXPECT_NE(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DB_FILE_NAME, OIC_JSON_CRED_NAME,
+                                              CRED, sizeof(CRED)));
+    SetPersistentHandler(&ps, true);
+
+    uint8_t stored[sizeof(corrupt) + 1] = { 0 };
+    fp = fopen(PS_TEST_DB_FILE_NAME, "rb");
+    ASSERT_TRUE(NULL != fp);
+    EXPECT_EQ(sizeof(corrupt), fread(stored, 1, sizeof(stored), fp));
+    fclose(fp);
+    EXPECT_EQ(0, memcmp(corrupt, stored, sizeof(corrupt)));
+}
+
+TEST_F(PSInterfaceTest, ManyUpdatesAreCompacted)
+{
+    uint8_t cred[100] = { 0 };
+    for (int i = 0; i < 1000; i++)
+    {
+        cred[0] = (uint8_t) i;
+        Update(OIC_JSON_CRED_NAME, cred, sizeof(cred));
+    }
+    Update(OIC_JSON_ACL_NAME, ACL1, sizeof(ACL1));
+
+    ExpectResource(OIC_JSON_CRED_NAME, cred, sizeof(cred));
+    ExpectResource(OIC_JSON_ACL_NAME, ACL1, sizeof(ACL1));
+    EXPECT_GT(8192, FileSize());
+}
@@ -31,6 +31,7 @@
 #include "ocstack.h"
 #include "ocresource.h"
 #include "cacommon.h"
+#include <coap/uthash.h>
 
 
 #ifdef __cplusplus
@@ -125,11 +126,30 @@ typedef struct ClientCB {
     /** The TTL for this callback. Holds the time till when this callback can
      * still be used. TTL is set to 0 when the callback is for presence and observe.
      * Presence has ttl mechanism in the "presence" member of this struct and observes
-     * can be explicitly cancelled.*/
+     * can be explicitly cancelled.
+     * Use SetClientCBTTL() to change it once the callback has been added.*/
     uint32_t TTL;
 
     /** next node in this list.*/
     struct ClientCB    *next;
+
+    /** previous node in this list.*/
+    struct ClientCB    *prev;
+
+    /** handle for the callback index keyed by token.*/
+    UT_hash_handle hhToken;
+
+    /** handle for the callback index keyed by invocation handle.*/
+    UT_hash_handle hhHandle;
+
+    /** timer wheel slot holding this callback; only valid when TTL is not 0.*/
+    uint16_t timerSlot;
+
+    /** next node in the timer wheel slot.*/
+    struct ClientCB    *timerNext;
+
+    /** previous node in the timer wheel slot.*/
+    struct ClientCB    *timerPrev;
 } ClientCB;
 
 //TODO: Now ocstack is directly accessing the clientCB list to process presence.
@@ -194,6 +214,30 @@ void DeleteClientCB(ClientCB *cbNode);
  */
 void DeleteClientCBList();
 
+/**
+ * This method is used to remove the callback nodes whose TTL has expired.
+ * Only the timer wheel slots that elapsed since the previous call are visited.
+ */
+void DeleteTimedOutClientCB();
+
+/**
+ * This method is used to get the time until DeleteTimedOutClientCB() has a callback
+ * node to remove.  It may be earlier than the actual TTL, never later.
+ *
+ * @param[in]  maxTimeout           upper bound of the result in milliseconds.
+ *
+ * @return milliseconds until the next call of DeleteTimedOutClientCB() is due.
+ */
+uint32_t GetClientCBTimeout(uint32_t maxTimeout);
+
+/**
+ * This method is used to change the TTL of a callback node.
+ *
+ * @param[in]  cbNode               Address to client callback node.
+ * @param[in]  ttl                  time to live in coap_ticks for the callback, 0 for none.
+ */
+void SetClientCBTTL(ClientCB *cbNode, uint32_t ttl);
+
 /**
  * This method is used to search and retrieve a cb node in cbList using token.
  *
@@ -29,6 +29,7 @@
 #ifndef OC_OBSERVE_H
 #define OC_OBSERVE_H
 
+#include <coap/uthash.h>
 
 /** Maximum number of observers to reach */
 
@@ -89,9 +90,18 @@ typedef struct ResourceObserver
      * from remaining in the list of observers indefinitely.*/
     uint32_t TTL;
 
-    /** next node in this list.*/
+    /** next observer of the same resource.*/
     struct ResourceObserver *next;
 
+    /** previous observer of the same resource.*/
+    struct ResourceObserver *prev;
+
+    /** handle for the observer index keyed by token.*/
+    UT_hash_handle hhToken;
+
+    /** handle for the observer index keyed by observation identifier.*/
+    UT_hash_handle hhId;
+
     /** requested payload encoding format. */
     OCPayloadFormat acceptFormat;
 
@@ -151,6 +161,14 @@ OCStackResult SendListObserverNotification (OCResource * resource,
  */
 void DeleteObserverList();
 
+/**
+ * Delete all observers of a resource.
+ * Free memory that was allocated for the observers in the list.
+ *
+ * @param resource Observed resource.
+ */
+void DeleteObserversUsingResource(OCResource *resource);
+
 /**
  * Create a unique observation ID.
  *
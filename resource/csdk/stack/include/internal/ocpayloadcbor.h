@@ -34,6 +34,21 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadFormat format, OCP
 OCStackResult OCConvertPayload(OCPayload* payload, OCPayloadFormat format,
         uint8_t** outPayload, size_t* size);
 
+/**
+ * Encode a payload into a buffer owned by the caller, so that the buffer can be reused for
+ * the following payloads.  The buffer is replaced by a larger one if it is too small.
+ *
+ * @param payload       Payload to encode.
+ * @param format        Format of the encoded payload.
+ * @param buffer        Buffer to encode into, may point to NULL.  Freed with OICFree().
+ * @param bufferSize    Size of the buffer, updated when the buffer is replaced.
+ * @param size          Size of the encoded payload.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCConvertPayloadToBuffer(OCPayload *payload, OCPayloadFormat format,
+        uint8_t **buffer, size_t *bufferSize, size_t *size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,142 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the optional pool of worker threads that handles incoming requests.
+ *
+ * Requests are sharded by resource URI, so the requests for a given resource are handled
+ * one at a time and in the order they were received, while requests for different resources
+ * may run their entity handlers concurrently.  While the pool is running, the structures
+ * shared between workers are guarded by the locks declared here; when it is not running the
+ * locks are no-ops and requests are handled on the thread that receives them.
+ */
+
+#ifndef OC_REQUEST_DISPATCH_H_
+#define OC_REQUEST_DISPATCH_H_
+
+#include "ocstack.h"
+#include "cacommon.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Maximum number of request worker threads. */
+#define OC_MAX_REQUEST_WORKERS (32)
+
+/**
+ * Locks guarding the structures shared between request workers.
+ */
+typedef enum
+{
+    /** Registered resources, their types, interfaces, children and observers. */
+    OC_DISPATCH_LOCK_RESOURCES = 0,
+    /** Server request and server response trees. */
+    OC_DISPATCH_LOCK_SERVER_REQUESTS,
+    OC_DISPATCH_LOCK_COUNT
+} OCDispatchLock;
+
+/**
+ * Callback invoked by a worker to handle a request.
+ */
+typedef void (*OCRequestDispatchHandler)(const CAEndpoint_t *endPoint,
+                                         const CARequestInfo_t *requestInfo);
+
+/**
+ * Start the request workers.
+ *
+ * @param workerCount    Number of worker threads, between 1 and ::OC_MAX_REQUEST_WORKERS.
+ * @param handler        Callback that handles a request on a worker thread.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCRequestDispatchInitialize(uint8_t workerCount, OCRequestDispatchHandler handler);
+
+/**
+ * Stop the request workers and wait for them to exit.  Requests still queued are dropped,
+ * and requests submitted afterwards are refused so the caller handles them itself.
+ */
+void OCRequestDispatchStop();
+
+/**
+ * Release the locks and memory held by the dispatcher.  Must be called after
+ * OCRequestDispatchStop(), once no other thread can submit requests or take the locks.
+ */
+void OCRequestDispatchTerminate();
+
+/**
+ * Check whether requests are handled by the worker pool.
+ *
+ * @return true if the workers are running, false otherwise.
+ */
+bool OCRequestDispatchIsEnabled();
+
+/**
+ * Queue a request for the worker owning its resource.  The endpoint and request are copied.
+ *
+ * @param endPoint       Endpoint the request was received from.
+ * @param requestInfo    Received request.
+ *
+ * @return ::OC_STACK_OK if the request was queued, some other value if the caller has to
+ *         handle the request itself.
+ */
+OCStackResult OCRequestDispatchSubmit(const CAEndpoint_t *endPoint,
+                                      const CARequestInfo_t *requestInfo);
+
+/**
+ * Acquire one of the locks guarding shared stack structures.  Locks are recursive.
+ *
+ * @param lock    Lock to acquire.
+ */
+void OCDispatchLockAcquire(OCDispatchLock lock);
+
+/**
+ * Release a lock acquired with OCDispatchLockAcquire().
+ *
+ * @param lock    Lock to release.
+ */
+void OCDispatchLockRelease(OCDispatchLock lock);
+
+/**
+ * Wait until the worker owning a resource is not handling a request, and keep it from
+ * starting a new one until OCRequestDispatchResumeResource() is called.  Used before
+ * freeing a resource that may be in use by its worker.  Calling it from that worker itself
+ * does not block.  When called from another worker, that worker's own shard may be paused
+ * by other threads until this returns.
+ *
+ * @param uri    URI of the resource.
+ */
+void OCRequestDispatchPauseResource(const char *uri);
+
+/**
+ * Let the worker owning a resource resume handling requests.
+ *
+ * @param uri    URI of the resource.
+ */
+void OCRequestDispatchResumeResource(const char *uri);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // OC_REQUEST_DISPATCH_H_
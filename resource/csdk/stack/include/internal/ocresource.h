@@ -66,6 +66,8 @@ typedef struct PRESENCERESOURCE{
 
 struct rsrc_t;
 
+struct ResourceObserver;
+
 /**
  * following structure will be created in occollection.
  */
@@ -247,6 +249,9 @@ typedef struct OCResource {
 
     /** Resource endpoint type(s). */
     OCTpsSchemeFlags endpointType;
+
+    /** Observers of this resource; doubly linked list.*/
+    struct ResourceObserver *observersHead;
 } OCResource;
 
 
@@ -0,0 +1,140 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the internal index of the resources registered with the stack.
+ * The index is kept in sync with the headResource list and provides constant time lookup
+ * by URI and by handle, and the set of resources bound to a given resource type or interface.
+ */
+
+#ifndef OC_RESOURCE_INDEX_H_
+#define OC_RESOURCE_INDEX_H_
+
+#include "ocresource.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Add a resource to the index.  The resource URI must already be set.
+ *
+ * @param resource    Resource to add.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCResourceIndexAdd(OCResource *resource);
+
+/**
+ * Remove a resource, together with its resource types and interfaces, from the index.
+ *
+ * @param resource    Resource to remove.
+ */
+void OCResourceIndexRemove(OCResource *resource);
+
+/**
+ * Find a resource by URI.
+ *
+ * @param uri    URI of the resource.
+ *
+ * @return Pointer to the resource if found, NULL otherwise.
+ */
+OCResource *OCResourceIndexFindByUri(const char *uri);
+
+/**
+ * Check whether a resource handle refers to a registered resource.
+ *
+ * @param resource    Resource handle to check.
+ *
+ * @return true if the resource is registered, false otherwise.
+ */
+bool OCResourceIndexContains(const OCResource *resource);
+
+/**
+ * Get the number of registered resources.
+ *
+ * @return Number of resources in the index.
+ */
+size_t OCResourceIndexGetCount();
+
+/**
+ * Get a resource by its registration order.
+ *
+ * @param index    Position of the resource, 0 being the first resource created.
+ *
+ * @return Pointer to the resource if index is in range, NULL otherwise.
+ */
+OCResource *OCResourceIndexGetAt(size_t index);
+
+/**
+ * Record that a resource type has been bound to a resource.
+ *
+ * @param resource            Resource the type has been bound to.
+ * @param resourceTypeName    Name of the resource type.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCResourceIndexAddType(OCResource *resource, const char *resourceTypeName);
+
+/**
+ * Record that an interface has been bound to a resource.
+ *
+ * @param resource         Resource the interface has been bound to.
+ * @param interfaceName    Name of the interface.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCResourceIndexAddInterface(OCResource *resource, const char *interfaceName);
+
+/**
+ * Get the resources bound to a resource type.
+ *
+ * @param resourceTypeName    Name of the resource type.
+ * @param resources           [OUT] Array of resources; owned by the index and only valid
+ *                            until the next change to the registered resources.
+ *
+ * @return Number of entries in resources.
+ */
+size_t OCResourceIndexGetByType(const char *resourceTypeName, OCResource * const **resources);
+
+/**
+ * Get the resources bound to an interface.
+ *
+ * @param interfaceName    Name of the interface.
+ * @param resources        [OUT] Array of resources; owned by the index and only valid
+ *                         until the next change to the registered resources.
+ *
+ * @return Number of entries in resources.
+ */
+size_t OCResourceIndexGetByInterface(const char *interfaceName, OCResource * const **resources);
+
+/**
+ * Release all memory held by the index.
+ */
+void OCResourceIndexTerminate();
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // OC_RESOURCE_INDEX_H_
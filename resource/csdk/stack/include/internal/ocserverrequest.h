@@ -236,6 +236,11 @@ void DeleteServerRequest(OCServerRequest * serverRequest);
  */
 OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Free the buffer kept for encoding response payloads.
+ */
+void FreeServerResponseBuffer();
+
 /**
  * Handler function for sending a response from multiple resources, such as a collection.
  * Aggregates responses from multiple resource until all responses are received then sends the
@@ -71,6 +71,14 @@ OCStackResult TerminateKeepAlive(OCMode mode);
  */
 void ProcessKeepAlive();
 
+/**
+ * Get the time until ProcessKeepAlive() has a ping message to send or a connection to close.
+ *
+ * @param[in]   maxTimeout      upper bound of the result in milliseconds.
+ * @return  milliseconds until the next call of ProcessKeepAlive() is due.
+ */
+uint32_t GetKeepAliveTimeout(uint32_t maxTimeout);
+
 /**
  * This API will be called from RI layer whenever there is a request for KeepAlive.
  * Virtual Resource.
@@ -81,6 +89,19 @@ void ProcessKeepAlive();
 OCStackResult HandleKeepAliveRequest(OCServerRequest *request,
                                      const OCResource *resource);
 
+/**
+ * API to handle the Response payload.
+ * Adds the KeepAlive entry of a new remote endpoint and sends the first ping message,
+ * or reschedules the next ping message of a known remote endpoint.
+ * @param[in]   endPoint        RemoteEndpoint which sent the packet.
+ * @param[in]   responseCode    Received reseponse code.
+ * @param[in]   respPayload     Response payload.
+ * @return  ::OC_STACK_OK or Appropriate error code.
+ */
+OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
+                                      OCStackResult responseCode,
+                                      const OCRepPayload *respPayload);
+
 /**
  * API to handle the connected device for KeepAlive.
  * @param[in]   endpoint        Remote endpoint information.
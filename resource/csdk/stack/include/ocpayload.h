@@ -244,6 +244,9 @@ OCIntrospectionPayload* OC_CALL OCIntrospectionPayloadCreateFromCbor(const uint8
                                                              size_t size);
 void OC_CALL OCIntrospectionPayloadDestroy(OCIntrospectionPayload* payload);
 
+OCEncodedRepPayload* OC_CALL OCEncodedRepPayloadCreate(const uint8_t* cborData, size_t size);
+void OC_CALL OCEncodedRepPayloadDestroy(OCEncodedRepPayload* payload);
+
 #ifndef TCP_ADAPTER
 void OC_CALL OCDiscoveryPayloadAddResource(OCDiscoveryPayload* payload, const OCResource* res,
                                    uint16_t securePort);
@@ -130,6 +130,51 @@ OCStackResult OC_CALL OCStopMulticastServer();
  */
 OCStackResult OC_CALL OCProcess();
 
+/**
+ * This function returns the time until OCProcess has timed work to do, such as presence
+ * requests, callback expiry or keep alive pings, so that the main loop can wait instead of
+ * polling.  Must be called from the thread calling OCProcess, right after it.
+ *
+ * @return milliseconds until OCProcess should be called again, at most one second.
+ */
+uint32_t OC_CALL OCGetProcessTimeout();
+
+/**
+ * This function waits until a request or response is received for OCProcess to handle,
+ * OCProcessWakeUp is called or the timeout elapses.  Unlike OCProcess it may be called
+ * without holding the lock the application serializes the stack calls with.
+ *
+ * @param timeout     maximum time to wait in milliseconds, usually the value of
+ *                    OCGetProcessTimeout.
+ *
+ * @return ::OC_STACK_OK once OCProcess should be called, ::OC_STACK_NOTIMPL when this build
+ *         of the stack cannot wait and the caller has to poll OCProcess, some other value
+ *         upon failure.
+ */
+OCStackResult OC_CALL OCProcessWait(uint32_t timeout);
+
+/**
+ * This function makes a thread waiting in OCProcessWait return, e.g. to stop its main loop.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCProcessWakeUp();
+
+/**
+ * This function sets the number of worker threads that handle incoming requests.
+ * Requests are dispatched to the workers by resource URI, so the requests for one resource
+ * are handled in order while entity handlers of different resources may run concurrently.
+ * Requests for the resources implemented by the stack, such as the virtual, security and
+ * keepalive resources, are always handled on the thread that receives them.
+ * Must be called before OCInit; the default of 0 handles every request on the thread that
+ * receives it.
+ *
+ * @param workerCount     Number of request worker threads, 0 to disable the workers.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCSetRequestWorkerCount(uint8_t workerCount);
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -452,6 +497,7 @@ OCStackResult OC_CALL OCBindResourceHandler(OCResourceHandle handle,
 
 /**
  * This function gets the number of resources that have been created in the stack.
+ * The count saturates at UINT8_MAX, as ::OCGetResourceHandle takes an 8 bit index.
  *
  * @param numResources    Pointer to count variable.
  *
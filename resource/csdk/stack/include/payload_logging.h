@@ -319,6 +319,12 @@ INLINE_API void OCPayloadLogSecurity(LogLevel level, OCSecurityPayload* payload)
     }
 }
 
+INLINE_API void OCPayloadLogEncodedRep(LogLevel level, OCEncodedRepPayload* payload)
+{
+    OIC_LOG(level, PL_TAG, "Payload Type: Encoded Representation");
+    OIC_LOG_V(level, PL_TAG, "\tCBOR Size: %" PRIuPTR, payload->cborPayload.len);
+}
+
 INLINE_API void OCPayloadLog(LogLevel level, OCPayload* payload)
 {
     if(!payload)
@@ -340,6 +346,9 @@ INLINE_API void OCPayloadLog(LogLevel level, OCPayload* payload)
         case PAYLOAD_TYPE_SECURITY:
             OCPayloadLogSecurity(level, (OCSecurityPayload*)payload);
             break;
+        case PAYLOAD_TYPE_ENCODED_REPRESENTATION:
+            OCPayloadLogEncodedRep(level, (OCEncodedRepPayload*)payload);
+            break;
         default:
             OIC_LOG_V(level, PL_TAG, "Unknown Payload Type: %d", payload->type);
             break;
@@ -24,6 +24,7 @@
 #include "logger.h"
 #include "trace.h"
 #include "oic_malloc.h"
+#include "oic_time.h"
 #include <string.h>
 
 #ifdef HAVE_SYS_TIME_H
@@ -36,9 +37,19 @@
 #include "cacommon.h"
 #include "cainterface.h"
 
+/* uthash exits when it runs out of memory by default, IndexClientCB() fails instead. */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
+
 /// Module Name
 #define TAG "OIC_RI_CLIENTCB"
 
+/// Number of slots in the timer wheel of callbacks having a TTL
+#define CB_TIMER_WHEEL_SLOTS (256)
+
+/// Time covered by one slot of the timer wheel, in coap ticks
+#define CB_TIMER_WHEEL_RESOLUTION (COAP_TICKS_PER_SECOND)
+
 //-------------------------------------------------------------------------------------------------
 // Private variables
 //-------------------------------------------------------------------------------------------------
@@ -46,9 +57,104 @@
 //      This should be static variable after we make a presence feature separately.
 struct ClientCB *g_cbList = NULL;
 
+/// Callbacks keyed by token
+static struct ClientCB *g_cbTokenIndex = NULL;
+
+/// Callbacks keyed by invocation handle
+static struct ClientCB *g_cbHandleIndex = NULL;
+
+/// Callbacks having a TTL, bucketed by the wheel tick in which their TTL falls
+static struct ClientCB *g_cbTimerWheel[CB_TIMER_WHEEL_SLOTS];
+
+/// Next wheel tick to be processed by DeleteTimedOutClientCB
+static uint32_t g_cbTimerWheelTick = 0;
+
 //-------------------------------------------------------------------------------------------------
 // Local functions
 //-------------------------------------------------------------------------------------------------
+static void AddToTimerWheel(ClientCB * cbNode)
+{
+    assert(cbNode);
+
+    uint32_t tick = cbNode->TTL / CB_TIMER_WHEEL_RESOLUTION;
+    if (tick < g_cbTimerWheelTick)
+    {
+        // Already expired; make it part of the next processed slot.
+        tick = g_cbTimerWheelTick;
+    }
+
+    cbNode->timerSlot = (uint16_t)(tick % CB_TIMER_WHEEL_SLOTS);
+    cbNode->timerPrev = NULL;
+    cbNode->timerNext = g_cbTimerWheel[cbNode->timerSlot];
+    if (cbNode->timerNext)
+    {
+        cbNode->timerNext->timerPrev = cbNode;
+    }
+    g_cbTimerWheel[cbNode->timerSlot] = cbNode;
+}
+
+static void RemoveFromTimerWheel(ClientCB * cbNode)
+{
+    assert(cbNode);
+
+    if (cbNode->timerPrev)
+    {
+        cbNode->timerPrev->timerNext = cbNode->timerNext;
+    }
+    else
+    {
+        g_cbTimerWheel[cbNode->timerSlot] = cbNode->timerNext;
+    }
+    if (cbNode->timerNext)
+    {
+        cbNode->timerNext->timerPrev = cbNode->timerPrev;
+    }
+    cbNode->timerNext = NULL;
+    cbNode->timerPrev = NULL;
+}
+
+/**
+ * Add a callback to the token and handle indexes.
+ *
+ * @return false if an index could not grow, the callback is in neither index then.
+ */
+static bool IndexClientCB(ClientCB * cbNode)
+{
+    assert(cbNode);
+
+    bool tokenIndexed = false;
+    HASH_ADD_KEYPTR(hhToken, g_cbTokenIndex, cbNode->token, cbNode->tokenLength, cbNode);
+    tokenIndexed = true;
+    HASH_ADD(hhHandle, g_cbHandleIndex, handle, sizeof(OCDoHandle), cbNode);
+    return true;
+
+uthash_oom:
+    if (tokenIndexed)
+    {
+        if (NULL == cbNode->hhHandle.tbl || NULL == cbNode->hhHandle.tbl->buckets)
+        {
+            uthash_free(cbNode->hhHandle.tbl, sizeof(UT_hash_table));
+            g_cbHandleIndex = NULL;
+        }
+        else
+        {
+            HASH_DELETE(hhHandle, g_cbHandleIndex, cbNode);
+        }
+        HASH_DELETE(hhToken, g_cbTokenIndex, cbNode);
+    }
+    else if (NULL == cbNode->hhToken.tbl || NULL == cbNode->hhToken.tbl->buckets)
+    {
+        uthash_free(cbNode->hhToken.tbl, sizeof(UT_hash_table));
+        g_cbTokenIndex = NULL;
+    }
+    else
+    {
+        HASH_DELETE(hhToken, g_cbTokenIndex, cbNode);
+    }
+    OIC_LOG(ERROR, TAG, "Callback index allocation failed");
+    return false;
+}
+
 static void DeleteClientCBInternal(ClientCB * cbNode)
 {
     assert(cbNode);
@@ -59,7 +165,13 @@ static void DeleteClientCBInternal(ClientCB * cbNode)
     OIC_TRACE_BUFFER("OIC_RI_CLIENTCB:DeleteClientCB:token:",
                      (const uint8_t *)cbNode->token, cbNode->tokenLength);
 
-    LL_DELETE(g_cbList, cbNode);
+    DL_DELETE(g_cbList, cbNode);
+    HASH_DELETE(hhToken, g_cbTokenIndex, cbNode);
+    HASH_DELETE(hhHandle, g_cbHandleIndex, cbNode);
+    if (cbNode->TTL)
+    {
+        RemoveFromTimerWheel(cbNode);
+    }
     CADestroyToken(cbNode->token);
     OICFree(cbNode->devAddr);
     OICFree(cbNode->handle);
@@ -108,31 +220,6 @@ static void DeleteClientCBInternal(ClientCB * cbNode)
     OIC_TRACE_END();
 }
 
-/*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence or observe
- * callback with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
- */
-static void CheckAndDeleteTimedOutCB(ClientCB * cbNode)
-{
-    assert(cbNode);
-
-    if (cbNode->TTL == 0)
-    {
-        return;
-    }
-    coap_tick_t now;
-    coap_ticks(&now);
-
-    if (cbNode->TTL < now)
-    {
-        OIC_LOG(INFO, TAG, "Deleting timed-out callback");
-        DeleteClientCBInternal(cbNode);
-    }
-}
-
 #ifdef WITH_PRESENCE
 /**
  * Inserts a new resource type filter into this cb node.
@@ -271,11 +358,22 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
         {
             cbNode->TTL = ttl;
         }
+        if (!IndexClientCB(cbNode))
+        {
+            OICFree(cbNode->payload);
+            OICFree(cbNode->options);
+            OICFree(cbNode);
+            return OC_STACK_NO_MEMORY;
+        }
         cbNode->requestUri = requestUri;    // I own it now
         cbNode->devAddr = devAddr;          // I own it now
         OIC_LOG_V(INFO, TAG, "Added Callback for uri : %s", requestUri);
         OIC_TRACE_MARK(%s:AddClientCB:uri:%s, TAG, requestUri);
-        LL_APPEND(g_cbList, cbNode);
+        DL_APPEND(g_cbList, cbNode);
+        if (cbNode->TTL)
+        {
+            AddToTimerWheel(cbNode);
+        }
         *clientCB = cbNode;
     }
 #ifdef WITH_PRESENCE
@@ -322,18 +420,9 @@ exit:
 
 void DeleteClientCB(ClientCB * cbNode)
 {
-    if (cbNode)
+    if (cbNode && GetClientCBUsingHandle(cbNode->handle) == cbNode)
     {
-        ClientCB* out = NULL;
-        ClientCB* tmp = NULL;
-        LL_FOREACH_SAFE(g_cbList, out, tmp)
-        {
-            if (cbNode == out)
-            {
-                DeleteClientCBInternal(out);
-                break;
-            }
-        }
+        DeleteClientCBInternal(cbNode);
     }
 }
 
@@ -346,6 +435,91 @@ void DeleteClientCBList()
         DeleteClientCBInternal(out);
     }
     g_cbList = NULL;
+    g_cbTokenIndex = NULL;
+    g_cbHandleIndex = NULL;
+}
+
+void DeleteTimedOutClientCB()
+{
+    coap_tick_t now = 0;
+    coap_ticks(&now);
+
+    // Visit each slot whose tick has fully elapsed since the previous call, at most once.
+    uint32_t nowTick = (uint32_t)(now / CB_TIMER_WHEEL_RESOLUTION);
+    uint32_t elapsed = nowTick - g_cbTimerWheelTick;
+    if (elapsed > CB_TIMER_WHEEL_SLOTS)
+    {
+        elapsed = CB_TIMER_WHEEL_SLOTS;
+    }
+
+    for (uint32_t i = 0; i < elapsed; i++)
+    {
+        ClientCB *cbNode = g_cbTimerWheel[(g_cbTimerWheelTick + i) % CB_TIMER_WHEEL_SLOTS];
+        while (cbNode)
+        {
+            ClientCB *next = cbNode->timerNext;
+            // Nodes expiring in a later turn of the wheel share the slot and are kept.
+            if (cbNode->TTL < now)
+            {
+                OIC_LOG(INFO, TAG, "Deleting timed-out callback");
+                DeleteClientCBInternal(cbNode);
+            }
+            cbNode = next;
+        }
+    }
+    g_cbTimerWheelTick = nowTick;
+}
+
+uint32_t GetClientCBTimeout(uint32_t maxTimeout)
+{
+    coap_tick_t now = 0;
+    coap_ticks(&now);
+
+    // The nodes of a slot are removed once its tick has fully elapsed.
+    uint64_t maxTicks = ((uint64_t)maxTimeout * COAP_TICKS_PER_SECOND) / MS_PER_SEC;
+    uint32_t lastTick = (uint32_t)((now + maxTicks) / CB_TIMER_WHEEL_RESOLUTION);
+    uint32_t slots = lastTick - g_cbTimerWheelTick + 1;
+    if (slots > CB_TIMER_WHEEL_SLOTS)
+    {
+        slots = CB_TIMER_WHEEL_SLOTS;
+    }
+
+    for (uint32_t i = 0; i < slots; i++)
+    {
+        uint32_t tick = g_cbTimerWheelTick + i;
+        if (!g_cbTimerWheel[tick % CB_TIMER_WHEEL_SLOTS])
+        {
+            continue;
+        }
+
+        coap_tick_t due = ((coap_tick_t)tick + 1) * CB_TIMER_WHEEL_RESOLUTION;
+        if (due <= now)
+        {
+            return 0;
+        }
+        uint64_t timeout = ((uint64_t)(due - now) * MS_PER_SEC +
+                            COAP_TICKS_PER_SECOND - 1) / COAP_TICKS_PER_SECOND;
+        return (timeout < maxTimeout) ? (uint32_t)timeout : maxTimeout;
+    }
+    return maxTimeout;
+}
+
+void SetClientCBTTL(ClientCB *cbNode, uint32_t ttl)
+{
+    if (!cbNode)
+    {
+        return;
+    }
+
+    if (cbNode->TTL)
+    {
+        RemoveFromTimerWheel(cbNode);
+    }
+    cbNode->TTL = ttl;
+    if (cbNode->TTL)
+    {
+        AddToTimerWheel(cbNode);
+    }
 }
 
 ClientCB* GetClientCBUsingToken(const CAToken_t token,
@@ -361,17 +535,11 @@ ClientCB* GetClientCBUsingToken(const CAToken_t token,
     OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
 
     ClientCB* out = NULL;
-    ClientCB* tmp = NULL;
-    LL_FOREACH_SAFE(g_cbList, out, tmp)
+    HASH_FIND(hhToken, g_cbTokenIndex, token, tokenLength, out);
+    if (out)
     {
-        /* de-annotate below line if want to see all token in g_cbList */
-        //OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-        if (memcmp(out->token, token, tokenLength) == 0)
-        {
-            OIC_LOG(INFO, TAG, "Found in callback list");
-            return out;
-        }
-        CheckAndDeleteTimedOutCB(out);
+        OIC_LOG(INFO, TAG, "Found in callback list");
+        return out;
     }
 
     OIC_LOG(INFO, TAG, "Callback Not found!");
@@ -389,15 +557,11 @@ ClientCB* GetClientCBUsingHandle(const OCDoHandle handle)
     OIC_LOG(INFO, TAG,  "Looking for handle");
 
     ClientCB* out = NULL;
-    ClientCB* tmp = NULL;
-    LL_FOREACH_SAFE(g_cbList, out, tmp)
+    HASH_FIND(hhHandle, g_cbHandleIndex, &handle, sizeof(OCDoHandle), out);
+    if (out)
     {
-        if (out->handle == handle)
-        {
-            OIC_LOG(INFO, TAG, "Found in callback list");
-            return out;
-        }
-        CheckAndDeleteTimedOutCB(out);
+        OIC_LOG(INFO, TAG, "Found in callback list");
+        return out;
     }
 
     OIC_LOG(INFO, TAG, "Callback Not found!");
@@ -426,7 +590,6 @@ ClientCB* GetClientCBUsingUri(const char *requestUri)
             OIC_LOG(INFO, TAG, "Found in callback list");
             return out;
         }
-        CheckAndDeleteTimedOutCB(out);
     }
 
     OIC_LOG(INFO, TAG, "Callback Not found!");
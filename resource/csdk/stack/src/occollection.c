@@ -30,12 +30,24 @@
 #include "ocpayload.h"
 #include "ocstack.h"
 #include "ocstackinternal.h"
+#include "ocrequestdispatch.h"
 #include "oicgroup.h"
 #include "oic_string.h"
 #include "payload_logging.h"
 
 #define TAG "OIC_RI_COLLECTION"
 
+/**
+ * Member of a collection, copied out of the child list so that its entity handler can be
+ * called without holding the resource lock.
+ */
+typedef struct
+{
+    OCResource *resource;
+    OCEntityHandler entityHandler;
+    void *entityHandlerCallbackParam;
+} CollectionMember;
+
 static bool AddRTSBaslinePayload(OCRepPayload **linkArray, int size, OCRepPayload **colPayload)
 {
     size_t arraySize = 0;
@@ -129,6 +141,9 @@ static OCStackResult HandleLinkedListInterface(OCEntityHandlerRequest *ehRequest
         return OC_STACK_INVALID_PARAM;
     }
 
+    // The children, types and interfaces are read under the resource lock.  It is released
+    // before the response is sent.
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     uint8_t size = GetNumOfResourcesInCollection(collResource);
     OCRepPayload *colPayload = NULL;
     OCEntityHandlerResult ehResult = OC_EH_ERROR;
@@ -176,6 +191,7 @@ static OCStackResult HandleLinkedListInterface(OCEntityHandlerRequest *ehRequest
     }
 
 exit:
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
     if (ret == OC_STACK_OK)
     {
         ehResult = OC_EH_OK;
@@ -190,9 +206,10 @@ exit:
     return ret;
 }
 
-static OCStackResult HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
+static OCStackResult HandleBatchInterface(OCEntityHandlerRequest *ehRequest,
+                                         OCServerRequest *request)
 {
-    if (!ehRequest)
+    if (!ehRequest || !request)
     {
         return OC_STACK_INVALID_PARAM;
     }
@@ -201,52 +218,70 @@ static OCStackResult HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
     char *storeQuery = NULL;
     OCResource *collResource = (OCResource *)ehRequest->resource;
 
-    if (stackRet == OC_STACK_OK)
+    // The member handlers may call back into the stack, e.g. to delete a resource, which
+    // waits for other workers.  Call them with the resource lock released.
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    uint8_t numRes = GetNumOfResourcesInCollection(collResource);
+    CollectionMember *members = NULL;
+    if (numRes)
     {
-
-        if (collResource->rsrcChildResourcesHead)
+        members = (CollectionMember *)OICCalloc(numRes, sizeof(CollectionMember));
+        if (!members)
         {
-            storeQuery = ehRequest->query;
-            ehRequest->query = NULL;
-            OIC_LOG_V(DEBUG, TAG, "Query : %s", ehRequest->query);
+            OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+            OIC_LOG(ERROR, TAG, "Memory allocation failed!");
+            return OC_STACK_NO_MEMORY;
         }
+    }
+    uint8_t memberCount = 0;
+    for (OCChildResource *tempChildResource = collResource->rsrcChildResourcesHead;
+        tempChildResource && tempChildResource->rsrcResource;
+        tempChildResource = tempChildResource->next, memberCount++)
+    {
+        OCResource *tempRsrcResource = tempChildResource->rsrcResource;
+        members[memberCount].resource = tempRsrcResource;
+        members[memberCount].entityHandler = tempRsrcResource->entityHandler;
+        members[memberCount].entityHandlerCallbackParam =
+            tempRsrcResource->entityHandlerCallbackParam;
+    }
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+
+    request->numResponses = numRes;
+    request->ehResponseHandler = HandleAggregateResponse;
+
+    if (numRes)
+    {
+        storeQuery = ehRequest->query;
+        ehRequest->query = NULL;
+        OIC_LOG_V(DEBUG, TAG, "Query : %s", ehRequest->query);
+    }
 
-        uint8_t numRes = 0;
-        for (OCChildResource *tempChildResource = collResource->rsrcChildResourcesHead;
-            tempChildResource; tempChildResource = tempChildResource->next, numRes++)
+    for (uint8_t i = 0; i < memberCount; i++)
+    {
+        // Note that all entity handlers called through a collection
+        // will get the same pointer to ehRequest, the only difference
+        // is ehRequest->resource
+        ehRequest->resource = (OCResourceHandle) members[i].resource;
+        OCEntityHandlerResult ehResult = members[i].entityHandler(OC_REQUEST_FLAG,
+                                   ehRequest, members[i].entityHandlerCallbackParam);
+
+        // The default collection handler is returning as OK
+        if (stackRet != OC_STACK_SLOW_RESOURCE)
         {
-            OCResource* tempRsrcResource = tempChildResource->rsrcResource;
-            if (tempRsrcResource)
-            {
-                // Note that all entity handlers called through a collection
-                // will get the same pointer to ehRequest, the only difference
-                // is ehRequest->resource
-                ehRequest->resource = (OCResourceHandle) tempRsrcResource;
-                OCEntityHandlerResult ehResult = tempRsrcResource->entityHandler(OC_REQUEST_FLAG,
-                                           ehRequest, tempRsrcResource->entityHandlerCallbackParam);
-
-                // The default collection handler is returning as OK
-                if (stackRet != OC_STACK_SLOW_RESOURCE)
-                {
-                    stackRet = OC_STACK_OK;
-                }
-                // if a single resource is slow, then entire response will be treated
-                // as slow response
-                if (ehResult == OC_EH_SLOW)
-                {
-                    OIC_LOG(INFO, TAG, "This is a slow resource");
-                    ((OCServerRequest *)ehRequest->requestHandle)->slowFlag = 1;
-                    stackRet = EntityHandlerCodeToOCStackCode(ehResult);
-                }
-            }
-            else
-            {
-                break;
-            }
+            stackRet = OC_STACK_OK;
+        }
+        // if a single resource is slow, then entire response will be treated
+        // as slow response
+        if (ehResult == OC_EH_SLOW)
+        {
+            OIC_LOG(INFO, TAG, "This is a slow resource");
+            request->slowFlag = 1;
+            stackRet = EntityHandlerCodeToOCStackCode(ehResult);
         }
-        ehRequest->resource = (OCResourceHandle) collResource;
     }
+    ehRequest->resource = (OCResourceHandle) collResource;
     ehRequest->query = storeQuery;
+    OICFree(members);
     return stackRet;
 }
 
@@ -294,9 +329,7 @@ OCStackResult DefaultCollectionEntityHandler(OCEntityHandlerFlag flag, OCEntityH
         OCServerRequest *request = GetServerRequestUsingHandle((OCServerRequest *)ehRequest->requestHandle);
         if (request)
         {
-            request->numResponses = GetNumOfResourcesInCollection((OCResource *)ehRequest->resource);
-            request->ehResponseHandler = HandleAggregateResponse;
-            result = HandleBatchInterface(ehRequest);
+            result = HandleBatchInterface(ehRequest, request);
         }
     }
     else if (0 == strcmp(ifQueryParam, OC_RSRVD_INTERFACE_GROUP))
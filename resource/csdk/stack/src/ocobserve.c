@@ -29,12 +29,17 @@
 #include "oic_string.h"
 #include "ocpayload.h"
 #include "ocserverrequest.h"
+#include "ocrequestdispatch.h"
 #include "logger.h"
 
 #include <coap/utlist.h>
 #include <coap/pdu.h>
 #include <coap/coap.h>
 
+/* IndexObserver() undoes a HASH_ADD that ran out of memory and fails the registration. */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
+
 // Module Name
 #define MOD_NAME "ocobserve"
 
@@ -42,7 +47,41 @@
 
 #define VERIFY_NON_NULL(arg) { if (!arg) {OIC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
 
-static struct ResourceObserver * g_serverObsList = NULL;
+/** Observers keyed by token.  Every registered observer is in this index.*/
+static struct ResourceObserver * g_serverObsTokenIndex = NULL;
+
+/** Observers keyed by observation identifier.*/
+static struct ResourceObserver * g_serverObsIdIndex = NULL;
+
+/**
+ * Token of an observer, copied out of the observer list.
+ */
+typedef struct
+{
+    char token[CA_MAX_TOKEN_LEN];
+    uint8_t tokenLength;
+} ObserverToken_t;
+
+/**
+ * Check whether the observer is past its time to live.  Presence observers have a
+ * ttl set to 0 and never time out as they have their own mechanisms for timeouts.
+ *
+ * @param observer Observer to check.
+ *
+ * @return true if the observer needs a confirmable notification.
+ */
+static bool IsObserverTimedOut(const ResourceObserver *observer)
+{
+    if (observer->TTL == 0)
+    {
+        return false;
+    }
+
+    coap_tick_t now = 0;
+    coap_ticks(&now);
+    return (observer->TTL < now);
+}
+
 /**
  * Determine observe QOS based on the QOS of the request.
  * The qos passed as a parameter overrides what the client requested.
@@ -98,24 +137,42 @@ static OCQualityOfService DetermineObserverQoS(OCMethod method,
 
 /**
  * Create a get request and pass to entityhandler to notify specific observer.
+ * Must be called without the resource lock held, since the entity handler may call back
+ * into the stack.
  *
- * @param observer Observer that need to be notified.
+ * @param observeId Id of the observer that need to be notified.
+ * @param resPtr Resource observed by the observer.
+ * @param method RESTful method.
  * @param qos Quality of service of resource.
  *
  * @return ::OC_STACK_OK on success, some other value upon failure.
  */
-static OCStackResult SendObserveNotification(ResourceObserver *observer,
-                                             OCQualityOfService qos)
+static OCStackResult SendObserveNotification(OCObservationId observeId, OCResource *resPtr,
+                                             OCMethod method, OCQualityOfService qos)
 {
-    OCStackResult result = OC_STACK_ERROR;
+    OCStackResult result = OC_STACK_OBSERVER_NOT_FOUND;
     OCServerRequest * request = NULL;
 
-    result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                              0, observer->resource->sequenceNum, qos,
-                              observer->query, NULL, OC_FORMAT_UNDEFINED, NULL,
-                              observer->token, observer->tokenLength,
-                              observer->resUri, 0, observer->acceptFormat,
-                              observer->acceptVersion, &observer->devAddr);
+    // The server request keeps its own copy of the observer details.
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    ResourceObserver *observer = GetObserverUsingId(observeId);
+    if (observer && observer->resource == resPtr)
+    {
+        OCQualityOfService observerQos = DetermineObserverQoS(method, observer, qos);
+        if (IsObserverTimedOut(observer))
+        {
+            // Send confirmable notification message to observer.
+            OIC_LOG(INFO, TAG, "Sending High-QoS notification to observer");
+            observerQos = OC_HIGH_QOS;
+        }
+        result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+                                  0, observer->resource->sequenceNum, observerQos,
+                                  observer->query, NULL, OC_FORMAT_UNDEFINED, NULL,
+                                  observer->token, observer->tokenLength,
+                                  observer->resUri, 0, observer->acceptFormat,
+                                  observer->acceptVersion, &observer->devAddr);
+    }
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
     if (request)
     {
@@ -128,8 +185,15 @@ static OCStackResult SendObserveNotification(ResourceObserver *observer,
             if (result == OC_STACK_OK)
             {
                 result = ProcessRequest(resHandling, resource, request);
-                // Reset Observer TTL.
-                observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+
+                // Reset Observer TTL, unless the observer went away meanwhile.
+                OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+                observer = GetObserverUsingId(observeId);
+                if (observer && observer->resource == resPtr)
+                {
+                    observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                }
+                OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
             }
         }
     }
@@ -137,6 +201,51 @@ static OCStackResult SendObserveNotification(ResourceObserver *observer,
     return result;
 }
 
+/**
+ * Copy the ids of the observers of a resource, so they can be notified without holding
+ * the resource lock.
+ *
+ * @param resPtr Observed resource.
+ * @param obsIds Array of observer ids, to be freed by the caller.
+ * @param numObs Number of ids returned.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult GetObserverIdsOfResource(OCResource *resPtr, OCObservationId **obsIds,
+                                              size_t *numObs)
+{
+    ResourceObserver *resourceObserver = NULL;
+    OCObservationId *ids = NULL;
+    size_t count = 0;
+
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    DL_FOREACH(resPtr->observersHead, resourceObserver)
+    {
+        count++;
+    }
+    if (count)
+    {
+        ids = (OCObservationId *)OICMalloc(count * sizeof(OCObservationId));
+        if (ids)
+        {
+            size_t i = 0;
+            DL_FOREACH(resPtr->observersHead, resourceObserver)
+            {
+                ids[i++] = resourceObserver->observeId;
+            }
+        }
+    }
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+
+    if (count && !ids)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    *obsIds = ids;
+    *numObs = count;
+    return OC_STACK_OK;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr, uint32_t maxAge,
         OCPresenceTrigger trigger, OCResourceType *resourceType, OCQualityOfService qos)
@@ -152,74 +261,90 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     }
 
     OCStackResult result = OC_STACK_ERROR;
-    ResourceObserver * resourceObserver = g_serverObsList;
-    uint8_t numObs = 0;
-    OCServerRequest * request = NULL;
+    OCObservationId *obsIds = NULL;
+    size_t numObs = 0;
     bool observeErrorFlag = false;
 
-    // Find clients that are observing this resource
-    while (resourceObserver)
+    // Notify a snapshot of the observers, so the entity handlers run without the resource
+    // lock held and may use the stack API (e.g. delete the resource).
+    result = GetObserverIdsOfResource(resPtr, &obsIds, &numObs);
+    if (OC_STACK_OK != result)
+    {
+        return result;
+    }
+
+    for (size_t i = 0; i < numObs; i++)
     {
-        if (resourceObserver->resource == resPtr)
-        {
-            numObs++;
 #ifdef WITH_PRESENCE
-            if (method != OC_REST_PRESENCE)
-            {
+        if (method != OC_REST_PRESENCE)
+        {
 #endif
-                qos = DetermineObserverQoS(method, resourceObserver, qos);
-                result = SendObserveNotification(resourceObserver, qos);
+            result = SendObserveNotification(obsIds[i], resPtr, method, qos);
 #ifdef WITH_PRESENCE
-            }
-            else
+        }
+        else
+        {
+            OCEntityHandlerResponse ehResponse = {0};
+            OCServerRequest * request = NULL;
+            uint32_t sequenceNum = 0;
+
+            //This is effectively the implementation for the presence entity handler.
+            OIC_LOG(DEBUG, TAG, "This notification is for Presence");
+            result = OC_STACK_OBSERVER_NOT_FOUND;
+            OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+            ResourceObserver *resourceObserver = GetObserverUsingId(obsIds[i]);
+            if (resourceObserver && resourceObserver->resource == resPtr)
             {
-                OCEntityHandlerResponse ehResponse = {0};
-
-                //This is effectively the implementation for the presence entity handler.
-                OIC_LOG(DEBUG, TAG, "This notification is for Presence");
+                sequenceNum = resPtr->sequenceNum;
                 result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resPtr->sequenceNum, qos, resourceObserver->query,
+                        0, sequenceNum, qos, resourceObserver->query,
                         NULL, OC_FORMAT_UNDEFINED, NULL,
                         resourceObserver->token, resourceObserver->tokenLength,
                         resourceObserver->resUri, 0, resourceObserver->acceptFormat,
                         resourceObserver->acceptVersion, &resourceObserver->devAddr);
+                OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
+                        resourceObserver->resUri);
+            }
+            OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
-                if (result == OC_STACK_OK)
-                {
-                    OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
-                            resPtr->sequenceNum, maxAge, trigger,
-                            resourceType ? resourceType->resourcetypename : NULL);
+            if (result == OC_STACK_OK)
+            {
+                OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
+                        sequenceNum, maxAge, trigger,
+                        resourceType ? resourceType->resourcetypename : NULL);
 
-                    if (!presenceResBuf)
-                    {
-                        return OC_STACK_NO_MEMORY;
-                    }
+                if (!presenceResBuf)
+                {
+                    OICFree(obsIds);
+                    return OC_STACK_NO_MEMORY;
+                }
 
-                    if (result == OC_STACK_OK)
-                    {
-                        ehResponse.ehResult = OC_EH_OK;
-                        ehResponse.payload = (OCPayload*)presenceResBuf;
-                        ehResponse.persistentBufferFlag = 0;
-                        ehResponse.requestHandle = (OCRequestHandle) request;
-                        OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
-                                resourceObserver->resUri);
-                        result = OCDoResponse(&ehResponse);
-                    }
+                ehResponse.ehResult = OC_EH_OK;
+                ehResponse.payload = (OCPayload*)presenceResBuf;
+                ehResponse.persistentBufferFlag = 0;
+                ehResponse.requestHandle = (OCRequestHandle) request;
+                result = OCDoResponse(&ehResponse);
 
-                    OCPresencePayloadDestroy(presenceResBuf);
-                }
+                OCPresencePayloadDestroy(presenceResBuf);
             }
+        }
 #endif
 
-            // Since we are in a loop, set an error flag to indicate at least one error occurred.
-            if (result != OC_STACK_OK)
-            {
-                observeErrorFlag = true;
-            }
+        // The observer was removed after the snapshot was taken.
+        if (result == OC_STACK_OBSERVER_NOT_FOUND)
+        {
+            continue;
+        }
+
+        // Since we are in a loop, set an error flag to indicate at least one error occurred.
+        if (result != OC_STACK_OK)
+        {
+            observeErrorFlag = true;
         }
-        resourceObserver = resourceObserver->next;
     }
 
+    OICFree(obsIds);
+
     if (numObs == 0)
     {
         OIC_LOG(INFO, TAG, "Resource has no observers");
@@ -255,67 +380,77 @@ OCStackResult SendListObserverNotification (OCResource * resource,
     OIC_LOG(INFO, TAG, "Entering SendListObserverNotification");
     while(numIds)
     {
+        // Only look up the observer under the resource lock, the response is sent without it.
+        request = NULL;
+        result = OC_STACK_OBSERVER_NOT_FOUND;
+        OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
         observer = GetObserverUsingId (*obsIdList);
-        if (observer)
+        // Found observer - verify if it matches the resource handle
+        if (observer && observer->resource == resource)
         {
-            // Found observer - verify if it matches the resource handle
-            if (observer->resource == resource)
-            {
-                qos = DetermineObserverQoS(OC_REST_GET, observer, qos);
-
+            qos = DetermineObserverQoS(OC_REST_GET, observer, qos);
 
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resource->sequenceNum, qos, observer->query,
-                        NULL, OC_FORMAT_UNDEFINED, NULL, observer->token, observer->tokenLength,
-                        observer->resUri, 0, observer->acceptFormat,
-                        observer->acceptVersion, &observer->devAddr);
+            result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+                    0, resource->sequenceNum, qos, observer->query,
+                    NULL, OC_FORMAT_UNDEFINED, NULL, observer->token, observer->tokenLength,
+                    observer->resUri, 0, observer->acceptFormat,
+                    observer->acceptVersion, &observer->devAddr);
+        }
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
-                if (request)
+        if (request)
+        {
+            request->observeResult = OC_STACK_OK;
+            if (result == OC_STACK_OK)
+            {
+                OCEntityHandlerResponse ehResponse = {0};
+                ehResponse.ehResult = OC_EH_OK;
+                ehResponse.payload = (OCPayload*)OCRepPayloadCreate();
+                if (!ehResponse.payload)
+                {
+                    DeleteServerRequest(request);
+                    result = OC_STACK_NO_MEMORY;
+                }
+                else
                 {
-                    request->observeResult = OC_STACK_OK;
+                    memcpy(ehResponse.payload, payload, sizeof(*payload));
+                    ehResponse.persistentBufferFlag = 0;
+                    ehResponse.requestHandle = (OCRequestHandle) request;
+                    result = OCDoResponse(&ehResponse);
                     if (result == OC_STACK_OK)
                     {
-                        OCEntityHandlerResponse ehResponse = {0};
-                        ehResponse.ehResult = OC_EH_OK;
-                        ehResponse.payload = (OCPayload*)OCRepPayloadCreate();
-                        if (!ehResponse.payload)
-                        {
-                            DeleteServerRequest(request);
-                            continue;
-                        }
-                        memcpy(ehResponse.payload, payload, sizeof(*payload));
-                        ehResponse.persistentBufferFlag = 0;
-                        ehResponse.requestHandle = (OCRequestHandle) request;
-                        result = OCDoResponse(&ehResponse);
-                        if (result == OC_STACK_OK)
-                        {
-                            OIC_LOG_V(INFO, TAG, "Observer id %d notified.", *obsIdList);
-
-                            // Increment only if OCDoResponse is successful
-                            numSentNotification++;
-
-                            OICFree(ehResponse.payload);
-                        }
-                        else
-                        {
-                            OIC_LOG_V(INFO, TAG, "Error notifying observer id %d.", *obsIdList);
-                        }
-                        // Reset Observer TTL.
-                        observer->TTL =
-                                GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                        OIC_LOG_V(INFO, TAG, "Observer id %d notified.", *obsIdList);
+
+                        // Increment only if OCDoResponse is successful
+                        numSentNotification++;
+
+                        OICFree(ehResponse.payload);
                     }
                     else
                     {
-                        DeleteServerRequest(request);
+                        OIC_LOG_V(INFO, TAG, "Error notifying observer id %d.", *obsIdList);
                     }
-                }
-                // Since we are in a loop, set an error flag to indicate
-                // at least one error occurred.
-                if (result != OC_STACK_OK)
-                {
-                    observeErrorFlag = true;
+                    // Reset Observer TTL, unless the observer went away meanwhile.
+                    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+                    observer = GetObserverUsingId (*obsIdList);
+                    if (observer && observer->resource == resource)
+                    {
+                        observer->TTL =
+                                GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                    }
+                    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
                 }
             }
+            else
+            {
+                DeleteServerRequest(request);
+            }
+        }
+        // Since we are in a loop, set an error flag to indicate
+        // at least one error occurred.
+        if (result != OC_STACK_OK && result != OC_STACK_OBSERVER_NOT_FOUND)
+        {
+            observeErrorFlag = true;
         }
         obsIdList++;
         numIds--;
@@ -343,17 +478,20 @@ OCStackResult GenerateObserverId (OCObservationId *observationId)
     OIC_LOG(INFO, TAG, "Entering GenerateObserverId");
     VERIFY_NON_NULL (observationId);
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     do
     {
         if (!OCGetRandomBytes((uint8_t*)observationId, sizeof(OCObservationId)))
         {
             OIC_LOG(ERROR, TAG, "Failed to generate random observationId");
+            OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
             goto exit;
         }
 
         // Check if observation Id already exists
         resObs = GetObserverUsingId (*observationId);
     } while (NULL != resObs);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
     OIC_LOG_V(INFO, TAG, "GeneratedObservation ID is %u", *observationId);
 
@@ -362,6 +500,47 @@ exit:
     return OC_STACK_ERROR;
 }
 
+/*
+ * Add the observer to the token and observation identifier indexes.
+ * Returns false if an index could not grow, the observer is in neither index then.
+ * The resources lock must be held by the caller.
+ */
+static bool IndexObserver(ResourceObserver *obsNode)
+{
+    bool tokenIndexed = false;
+    HASH_ADD_KEYPTR (hhToken, g_serverObsTokenIndex, obsNode->token, obsNode->tokenLength,
+                     obsNode);
+    tokenIndexed = true;
+    HASH_ADD (hhId, g_serverObsIdIndex, observeId, sizeof(OCObservationId), obsNode);
+    return true;
+
+uthash_oom:
+    if (tokenIndexed)
+    {
+        if (NULL == obsNode->hhId.tbl || NULL == obsNode->hhId.tbl->buckets)
+        {
+            uthash_free(obsNode->hhId.tbl, sizeof(UT_hash_table));
+            g_serverObsIdIndex = NULL;
+        }
+        else
+        {
+            HASH_DELETE (hhId, g_serverObsIdIndex, obsNode);
+        }
+        HASH_DELETE (hhToken, g_serverObsTokenIndex, obsNode);
+    }
+    else if (NULL == obsNode->hhToken.tbl || NULL == obsNode->hhToken.tbl->buckets)
+    {
+        uthash_free(obsNode->hhToken.tbl, sizeof(UT_hash_table));
+        g_serverObsTokenIndex = NULL;
+    }
+    else
+    {
+        HASH_DELETE (hhToken, g_serverObsTokenIndex, obsNode);
+    }
+    OIC_LOG(ERROR, TAG, "Observer index allocation failed");
+    return false;
+}
+
 OCStackResult AddObserver (const char         *resUri,
                            const char         *query,
                            OCObservationId    obsId,
@@ -426,7 +605,14 @@ OCStackResult AddObserver (const char         *resUri,
             obsNode->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
         }
 
-        LL_APPEND (g_serverObsList, obsNode);
+        OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+        if (!IndexObserver(obsNode))
+        {
+            OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+            goto exit;
+        }
+        DL_APPEND (resHandle->observersHead, obsNode);
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
         return OC_STACK_OK;
     }
@@ -436,34 +622,27 @@ exit:
     {
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
+        OICFree(obsNode->token);
         OICFree(obsNode);
     }
     return OC_STACK_NO_MEMORY;
 }
 
 /*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence callback
- * with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
+ * Remove the observer from the resource observer list and the observer indexes,
+ * and free the memory that was allocated for it.
  */
-static void CheckTimedOutObserver(ResourceObserver* observer)
+static void DeleteObserver(ResourceObserver *obsNode)
 {
-    if (!observer || observer->TTL == 0)
-    {
-        return;
-    }
-
-    coap_tick_t now = 0;
-    coap_ticks(&now);
-
-    if (observer->TTL < now)
-    {
-        // Send confirmable notification message to observer.
-        OIC_LOG(INFO, TAG, "Sending High-QoS notification to observer");
-        SendObserveNotification(observer, OC_HIGH_QOS);
-    }
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    DL_DELETE (obsNode->resource->observersHead, obsNode);
+    HASH_DELETE (hhToken, g_serverObsTokenIndex, obsNode);
+    HASH_DELETE (hhId, g_serverObsIdIndex, obsNode);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    OICFree(obsNode->resUri);
+    OICFree(obsNode->query);
+    OICFree(obsNode->token);
+    OICFree(obsNode);
 }
 
 ResourceObserver* GetObserverUsingId (const OCObservationId observeId)
@@ -472,13 +651,12 @@ ResourceObserver* GetObserverUsingId (const OCObservationId observeId)
 
     if (observeId)
     {
-        LL_FOREACH (g_serverObsList, out)
+        OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+        HASH_FIND (hhId, g_serverObsIdIndex, &observeId, sizeof(OCObservationId), out);
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+        if (out)
         {
-            if (out->observeId == observeId)
-            {
-                return out;
-            }
-            CheckTimedOutObserver(out);
+            return out;
         }
     }
     OIC_LOG(INFO, TAG, "Observer node not found!!");
@@ -493,16 +671,13 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
 
         ResourceObserver *out = NULL;
-        LL_FOREACH (g_serverObsList, out)
+        OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+        HASH_FIND (hhToken, g_serverObsTokenIndex, token, tokenLength, out);
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+        if (out)
         {
-            /* de-annotate below line if want to see all token in cbList */
-            //OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if ((memcmp(out->token, token, tokenLength) == 0))
-            {
-                OIC_LOG(INFO, TAG, "Found in observer list");
-                return out;
-            }
-            CheckTimedOutObserver(out);
+            OIC_LOG(INFO, TAG, "Found in observer list");
+            return out;
         }
     }
     else
@@ -521,17 +696,15 @@ OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
         return OC_STACK_INVALID_PARAM;
     }
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     ResourceObserver *obsNode = GetObserverUsingToken (token, tokenLength);
     if (obsNode)
     {
         OIC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
-        LL_DELETE (g_serverObsList, obsNode);
-        OICFree(obsNode->resUri);
-        OICFree(obsNode->query);
-        OICFree(obsNode->token);
-        OICFree(obsNode);
+        DeleteObserver(obsNode);
     }
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
     // it is ok if we did not find the observer...
     return OC_STACK_OK;
 }
@@ -545,19 +718,41 @@ OCStackResult DeleteObserverUsingDevAddr(const OCDevAddr *devAddr)
 
     ResourceObserver *out = NULL;
     ResourceObserver *tmp = NULL;
-    LL_FOREACH_SAFE(g_serverObsList, out, tmp)
+    ObserverToken_t *tokens = NULL;
+    size_t count = 0;
+
+    // Collect the tokens first, the feedback calls the entity handlers without the lock.
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    size_t numObs = HASH_CNT(hhToken, g_serverObsTokenIndex);
+    if (numObs)
     {
-        if (out)
+        tokens = (ObserverToken_t *)OICCalloc(numObs, sizeof(ObserverToken_t));
+        if (!tokens)
         {
-            if ((strcmp(out->devAddr.addr, devAddr->addr) == 0)
-                    && out->devAddr.port == devAddr->port)
-            {
-                OIC_LOG_V(INFO, TAG, "deleting observer id  %u with %s:%u",
-                          out->observeId, out->devAddr.addr, out->devAddr.port);
-                OCStackFeedBack(out->token, out->tokenLength, OC_OBSERVER_NOT_INTERESTED);
-            }
+            OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+            return OC_STACK_NO_MEMORY;
         }
     }
+    HASH_ITER(hhToken, g_serverObsTokenIndex, out, tmp)
+    {
+        if ((strcmp(out->devAddr.addr, devAddr->addr) == 0)
+                && out->devAddr.port == devAddr->port
+                && out->tokenLength <= CA_MAX_TOKEN_LEN)
+        {
+            OIC_LOG_V(INFO, TAG, "deleting observer id  %u with %s:%u",
+                      out->observeId, out->devAddr.addr, out->devAddr.port);
+            memcpy(tokens[count].token, out->token, out->tokenLength);
+            tokens[count].tokenLength = out->tokenLength;
+            count++;
+        }
+    }
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        OCStackFeedBack(tokens[i].token, tokens[i].tokenLength, OC_OBSERVER_NOT_INTERESTED);
+    }
+    OICFree(tokens);
 
     return OC_STACK_OK;
 }
@@ -566,14 +761,32 @@ void DeleteObserverList()
 {
     ResourceObserver *out = NULL;
     ResourceObserver *tmp = NULL;
-    LL_FOREACH_SAFE (g_serverObsList, out, tmp)
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    HASH_ITER (hhToken, g_serverObsTokenIndex, out, tmp)
     {
-        if (out)
-        {
-            DeleteObserverUsingToken ((out->token), out->tokenLength);
-        }
+        DeleteObserver(out);
+    }
+    g_serverObsTokenIndex = NULL;
+    g_serverObsIdIndex = NULL;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+}
+
+void DeleteObserversUsingResource(OCResource *resource)
+{
+    if (!resource)
+    {
+        return;
+    }
+
+    ResourceObserver *out = NULL;
+    ResourceObserver *tmp = NULL;
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    DL_FOREACH_SAFE (resource->observersHead, out, tmp)
+    {
+        OIC_LOG_V(INFO, TAG, "deleting observer id  %u of %s", out->observeId, resource->uri);
+        DeleteObserver(out);
     }
-    g_serverObsList = NULL;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 }
 
 /*
@@ -34,11 +34,42 @@
 #include "logger.h"
 #include "ocendpoint.h"
 #include "cacommon.h"
+#include <coap/uthash.h>
+
+/*
+ * A value that cannot be hashed for lack of memory drops the index, OCRepPayloadIndexValue()
+ * undoes the partial add and the values are searched in order instead.
+ */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
 
 #define TAG "OIC_RI_PAYLOAD"
 #define CSV_SEPARATOR ','
 #define MASK_SECURE_FAMS (OC_FLAG_SECURE | OC_MASK_FAMS)
 
+// Number of values from which the values of a rep payload are hashed by name.
+#define REP_PAYLOAD_INDEX_THRESHOLD (8)
+
+typedef struct
+{
+    OCRepPayloadValue *value;
+    UT_hash_handle hh;
+} OCRepPayloadIndexEntry;
+
+/**
+ * Values of a rep payload hashed by name.  Values are only ever appended to a payload, so
+ * the index stays valid as long as the list starts with the same value, and values added
+ * after the last indexed one can be indexed on the next update.
+ */
+typedef struct OCRepPayloadValueIndex
+{
+    OCRepPayloadIndexEntry *entries;
+    /** First value of the payload when the index was built. */
+    OCRepPayloadValue *head;
+    /** Last indexed value. */
+    OCRepPayloadValue *tail;
+} OCRepPayloadValueIndex;
+
 static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val);
 
 void OC_CALL OCPayloadDestroy(OCPayload* payload)
@@ -68,6 +99,9 @@ void OC_CALL OCPayloadDestroy(OCPayload* payload)
         case PAYLOAD_TYPE_INTROSPECTION:
             OCIntrospectionPayloadDestroy((OCIntrospectionPayload*)payload);
             break;
+        case PAYLOAD_TYPE_ENCODED_REPRESENTATION:
+            OCEncodedRepPayloadDestroy((OCEncodedRepPayload*)payload);
+            break;
         default:
             OIC_LOG_V(ERROR, TAG, "Unsupported payload type in destroy: %d", payload->type);
             OICFree(payload);
@@ -105,6 +139,112 @@ void OC_CALL OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
     child->next = NULL;
 }
 
+static void OCRepPayloadFreeIndex(OCRepPayload* payload)
+{
+    OCRepPayloadValueIndex *index = payload->valueIndex;
+    if (!index)
+    {
+        return;
+    }
+
+    OCRepPayloadIndexEntry *entry = NULL;
+    OCRepPayloadIndexEntry *tmp = NULL;
+    HASH_ITER(hh, index->entries, entry, tmp)
+    {
+        HASH_DELETE(hh, index->entries, entry);
+        OICFree(entry);
+    }
+    OICFree(index);
+    payload->valueIndex = NULL;
+}
+
+static bool OCRepPayloadIndexValue(OCRepPayloadValueIndex* index, OCRepPayloadValue* value)
+{
+    OCRepPayloadIndexEntry *entry = NULL;
+    size_t nameLen = strlen(value->name);
+
+    // Like the list walk, lookups return the first value with a name.
+    HASH_FIND(hh, index->entries, value->name, nameLen, entry);
+    if (!entry)
+    {
+        entry = (OCRepPayloadIndexEntry *)OICCalloc(1, sizeof(OCRepPayloadIndexEntry));
+        if (!entry)
+        {
+            return false;
+        }
+        entry->value = value;
+        HASH_ADD_KEYPTR(hh, index->entries, value->name, nameLen, entry);
+    }
+    index->tail = value;
+    return true;
+
+uthash_oom:
+    if (NULL == entry->hh.tbl || NULL == entry->hh.tbl->buckets)
+    {
+        uthash_free(entry->hh.tbl, sizeof(UT_hash_table));
+        index->entries = NULL;
+    }
+    else
+    {
+        HASH_DELETE(hh, index->entries, entry);
+    }
+    OICFree(entry);
+    return false;
+}
+
+/**
+ * Get the index of the values of a payload, indexing the values appended since its last
+ * update.  The index is created once the payload has enough values.
+ *
+ * @return The index, or NULL if the values have to be searched in order.
+ */
+static OCRepPayloadValueIndex* OCRepPayloadUpdateIndex(OCRepPayload* payload)
+{
+    OCRepPayloadValueIndex *index = payload->valueIndex;
+    if (index && index->head != payload->values)
+    {
+        OCRepPayloadFreeIndex(payload);
+        index = NULL;
+    }
+
+    OCRepPayloadValue *val = NULL;
+    if (index)
+    {
+        val = index->tail->next;
+    }
+    else
+    {
+        size_t count = 0;
+        for (val = payload->values; val && count < REP_PAYLOAD_INDEX_THRESHOLD; val = val->next)
+        {
+            count++;
+        }
+        if (count < REP_PAYLOAD_INDEX_THRESHOLD)
+        {
+            return NULL;
+        }
+
+        index = (OCRepPayloadValueIndex *)OICCalloc(1, sizeof(OCRepPayloadValueIndex));
+        if (!index)
+        {
+            return NULL;
+        }
+        index->head = payload->values;
+        payload->valueIndex = index;
+        val = payload->values;
+    }
+
+    for (; val; val = val->next)
+    {
+        if (!OCRepPayloadIndexValue(index, val))
+        {
+            OCRepPayloadFreeIndex(payload);
+            return NULL;
+        }
+    }
+    return index;
+}
+
 static OCRepPayloadValue* OC_CALL OCRepPayloadFindValue(const OCRepPayload* payload, const char* name)
 {
     if (!payload || !name)
@@ -112,6 +252,15 @@ static OCRepPayloadValue* OC_CALL OCRepPayloadFindValue(const OCRepPayload* payl
         return NULL;
     }
 
+    // Getters don't update the index, so that a payload can be read from several threads.
+    const OCRepPayloadValueIndex *index = payload->valueIndex;
+    if (index && index->head == payload->values && !index->tail->next)
+    {
+        OCRepPayloadIndexEntry *entry = NULL;
+        HASH_FIND(hh, index->entries, name, strlen(name), entry);
+        return entry ? entry->value : NULL;
+    }
+
     OCRepPayloadValue* val = payload->values;
     while(val)
     {
@@ -290,15 +439,14 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
 
 static void OC_CALL OCFreeRepPayloadValue(OCRepPayloadValue* val)
 {
-    if (!val)
+    while (val)
     {
-        return;
+        OCRepPayloadValue *next = val->next;
+        OICFree(val->name);
+        OCFreeRepPayloadValueContents(val);
+        OICFree(val);
+        val = next;
     }
-
-    OICFree(val->name);
-    OCFreeRepPayloadValueContents(val);
-    OCFreeRepPayloadValue(val->next);
-    OICFree(val);
 }
 static OCRepPayloadValue* OC_CALL OCRepPayloadValueClone (OCRepPayloadValue* source)
 {
@@ -350,6 +498,38 @@ static OCRepPayloadValue* OC_CALL OCRepPayloadFindAndSetValue(OCRepPayload* payl
         return NULL;
     }
 
+    OCRepPayloadValueIndex *index = OCRepPayloadUpdateIndex(payload);
+    if (index)
+    {
+        OCRepPayloadIndexEntry *entry = NULL;
+        HASH_FIND(hh, index->entries, name, strlen(name), entry);
+        if (entry)
+        {
+            OCFreeRepPayloadValueContents(entry->value);
+            entry->value->type = type;
+            return entry->value;
+        }
+
+        OCRepPayloadValue *newVal = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
+        if (!newVal)
+        {
+            return NULL;
+        }
+        newVal->name = OICStrdup(name);
+        if (!newVal->name)
+        {
+            OICFree(newVal);
+            return NULL;
+        }
+        newVal->type = type;
+        index->tail->next = newVal;
+        if (!OCRepPayloadIndexValue(index, newVal))
+        {
+            OCRepPayloadFreeIndex(payload);
+        }
+        return newVal;
+    }
+
     OCRepPayloadValue* val = payload->values;
     if (val == NULL)
     {
@@ -1638,6 +1818,7 @@ void OC_CALL OCRepPayloadDestroy(OCRepPayload* payload)
     OICFree(payload->uri);
     OCFreeOCStringLL(payload->types);
     OCFreeOCStringLL(payload->interfaces);
+    OCRepPayloadFreeIndex(payload);
     OCFreeRepPayloadValue(payload->values);
     OCRepPayloadDestroy(payload->next);
     OICFree(payload);
@@ -1725,6 +1906,38 @@ void OC_CALL OCIntrospectionPayloadDestroy(OCIntrospectionPayload* payload)
     OICFree(payload);
 }
 
+OCEncodedRepPayload* OC_CALL OCEncodedRepPayloadCreate(const uint8_t* cborData, size_t size)
+{
+    OCEncodedRepPayload* payload = (OCEncodedRepPayload*)OICCalloc(1, sizeof(OCEncodedRepPayload));
+    if (!payload)
+    {
+        return NULL;
+    }
+
+    payload->base.type = PAYLOAD_TYPE_ENCODED_REPRESENTATION;
+    payload->cborPayload.bytes = (uint8_t*)OICMalloc(size);
+    if (!payload->cborPayload.bytes)
+    {
+        OICFree(payload);
+        return NULL;
+    }
+    memcpy(payload->cborPayload.bytes, cborData, size);
+    payload->cborPayload.len = size;
+
+    return payload;
+}
+
+void OC_CALL OCEncodedRepPayloadDestroy(OCEncodedRepPayload* payload)
+{
+    if (!payload)
+    {
+        return;
+    }
+
+    OICFree(payload->cborPayload.bytes);
+    OICFree(payload);
+}
+
 size_t OC_CALL OCDiscoveryPayloadGetResourceCount(OCDiscoveryPayload* payload)
 {
     size_t i = 0;
@@ -39,6 +39,15 @@
 // Arbitrarily chosen size that seems to contain the majority of packages
 #define INIT_SIZE (255)
 
+// Largest CBOR header of an item, one initial byte followed by a 64-bit argument.
+#define MAX_CBOR_HEADER_SIZE (9)
+
+// Predicted size of the encoded keys and fixed values of a discovery link and its policy.
+#define LINK_SIZE_HINT (64)
+
+// Predicted size of an encoded endpoint, its string and its priority.
+#define ENDPOINT_SIZE_HINT (80)
+
 // Discovery Links Map Length.
 #define LINKS_MAP_LEN (4)
 
@@ -60,6 +69,8 @@ static int64_t OCConvertSecurityPayload(OCSecurityPayload *payload, uint8_t *out
         size_t *size);
 static int64_t OCConvertIntrospectionPayload(OCIntrospectionPayload *payload, uint8_t *outPayload,
         size_t *size);
+static int64_t OCConvertEncodedRepPayload(OCEncodedRepPayload *payload, uint8_t *outPayload,
+        size_t *size);
 static int64_t OCConvertSingleRepPayloadValue(CborEncoder *parent, const OCRepPayloadValue *value);
 static int64_t OCConvertSingleRepPayload(CborEncoder *parent, const OCRepPayload *payload);
 static int64_t OCConvertArray(CborEncoder *parent, const OCRepPayloadValueArray *valArray);
@@ -68,9 +79,267 @@ static int64_t AddTextStringToMap(CborEncoder *map, const char *key, size_t keyl
         const char *value);
 static int64_t ConditionalAddTextStringToMap(CborEncoder *map, const char *key, size_t keylen,
         const char *value);
+static size_t GetRepMapSizeHint(const OCRepPayload *payload);
 
-OCStackResult OCConvertPayload(OCPayload* payload, OCPayloadFormat format,
-        uint8_t** outPayload, size_t* size)
+/**
+ * Size of the CBOR header of an item whose length or value is the given argument.
+ */
+static size_t GetCborHeaderSize(uint64_t argument)
+{
+    if (argument < 24)
+    {
+        return 1;
+    }
+    else if (argument <= UINT8_MAX)
+    {
+        return 2;
+    }
+    else if (argument <= UINT16_MAX)
+    {
+        return 3;
+    }
+    else if (argument <= UINT32_MAX)
+    {
+        return 5;
+    }
+    return MAX_CBOR_HEADER_SIZE;
+}
+
+static size_t GetTextStringSizeHint(const char *str)
+{
+    if (!str)
+    {
+        return 1;
+    }
+    size_t len = strlen(str);
+    return GetCborHeaderSize(len) + len;
+}
+
+static size_t GetStringLLSizeHint(const char *key, const OCStringLL *val)
+{
+    size_t count = 0;
+    size_t size = 0;
+    for (; val; val = val->next)
+    {
+        size += GetTextStringSizeHint(val->value);
+        ++count;
+    }
+    return count ? GetTextStringSizeHint(key) + GetCborHeaderSize(count) + size : 0;
+}
+
+static size_t GetArrayItemSizeHint(const OCRepPayloadValueArray *valArray, size_t index)
+{
+    switch (valArray->type)
+    {
+        case OCREP_PROP_INT:
+            return MAX_CBOR_HEADER_SIZE;
+        case OCREP_PROP_DOUBLE:
+            return MAX_CBOR_HEADER_SIZE;
+        case OCREP_PROP_BOOL:
+            return 1;
+        case OCREP_PROP_STRING:
+            return valArray->strArray ? GetTextStringSizeHint(valArray->strArray[index]) : 0;
+        case OCREP_PROP_BYTE_STRING:
+            return GetCborHeaderSize(valArray->ocByteStrArray[index].len) +
+                   valArray->ocByteStrArray[index].len;
+        case OCREP_PROP_OBJECT:
+            if (valArray->objArray && valArray->objArray[index])
+            {
+                return GetRepMapSizeHint(valArray->objArray[index]);
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static size_t GetArraySizeHint(const OCRepPayloadValueArray *valArray)
+{
+    size_t dim0 = valArray->dimensions[0];
+    size_t dim1 = valArray->dimensions[1] ? valArray->dimensions[1] : 1;
+    size_t dim2 = valArray->dimensions[2] ? valArray->dimensions[2] : 1;
+
+    // Headers of the outer array and of the nested arrays.
+    size_t size = GetCborHeaderSize(dim0);
+    if (valArray->dimensions[1])
+    {
+        size += dim0 * GetCborHeaderSize(dim1);
+    }
+    if (valArray->dimensions[2])
+    {
+        size += dim0 * dim1 * GetCborHeaderSize(dim2);
+    }
+
+    size_t count = dim0 * dim1 * dim2;
+    if (OCREP_PROP_INT == valArray->type || OCREP_PROP_DOUBLE == valArray->type)
+    {
+        return size + count * MAX_CBOR_HEADER_SIZE;
+    }
+    if (OCREP_PROP_BOOL == valArray->type)
+    {
+        return size + count;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        size += GetArrayItemSizeHint(valArray, i);
+    }
+    return size;
+}
+
+static size_t GetRepValueSizeHint(const OCRepPayloadValue *value)
+{
+    switch (value->type)
+    {
+        case OCREP_PROP_INT:
+            return GetCborHeaderSize((value->i < 0) ? (uint64_t)(-(value->i + 1)) :
+                                     (uint64_t)value->i);
+        case OCREP_PROP_DOUBLE:
+            return MAX_CBOR_HEADER_SIZE;
+        case OCREP_PROP_STRING:
+            return GetTextStringSizeHint(value->str);
+        case OCREP_PROP_BYTE_STRING:
+            return GetCborHeaderSize(value->ocByteStr.len) + value->ocByteStr.len;
+        case OCREP_PROP_OBJECT:
+            return value->obj ? GetRepMapSizeHint(value->obj) : 1;
+        case OCREP_PROP_ARRAY:
+            return GetArraySizeHint(&value->arr);
+        default:
+            return 1;
+    }
+}
+
+/**
+ * Predicted size of a rep map.  An upper bound, since the map is encoded as an
+ * indefinite length map or as a shorter array.
+ */
+static size_t GetRepMapSizeHint(const OCRepPayload *payload)
+{
+    size_t size = 2;
+    for (const OCRepPayloadValue *value = payload->values; value; value = value->next)
+    {
+        size += GetTextStringSizeHint(value->name) + GetRepValueSizeHint(value);
+    }
+    return size;
+}
+
+static size_t GetRepPayloadSizeHint(const OCRepPayload *payload)
+{
+    size_t arrayCount = 0;
+    size_t size = 0;
+    for (; payload; payload = payload->next)
+    {
+        size += GetRepMapSizeHint(payload);
+        if (payload->uri)
+        {
+            size += GetTextStringSizeHint(OC_RSRVD_HREF) + GetTextStringSizeHint(payload->uri);
+        }
+        size += GetStringLLSizeHint(OC_RSRVD_RESOURCE_TYPE, payload->types);
+        size += GetStringLLSizeHint(OC_RSRVD_INTERFACE, payload->interfaces);
+        arrayCount++;
+    }
+    return size + GetCborHeaderSize(arrayCount);
+}
+
+static size_t GetDiscoveryPayloadSizeHint(const OCDiscoveryPayload *payload,
+                                          OCPayloadFormat format)
+{
+    size_t size = MAX_CBOR_HEADER_SIZE;
+    for (; payload; payload = payload->next)
+    {
+        size_t sidSize = GetTextStringSizeHint(payload->sid);
+        size += 2 + GetTextStringSizeHint(OC_RSRVD_LINKS) + 2;
+        size += GetTextStringSizeHint(OC_RSRVD_DEVICE_NAME) + GetTextStringSizeHint(payload->name);
+        size += GetTextStringSizeHint(OC_RSRVD_DEVICE_ID) + sidSize;
+        size += GetStringLLSizeHint(OC_RSRVD_RESOURCE_TYPE, payload->type);
+        size += GetStringLLSizeHint(OC_RSRVD_INTERFACE, payload->iface);
+
+        for (const OCResourcePayload *resource = payload->resources; resource;
+             resource = resource->next)
+        {
+            // The href may be prefixed by an endpoint or by the anchor, which also has its
+            // own entry in the vnd.ocf format.
+            size_t linkSize = LINK_SIZE_HINT + GetTextStringSizeHint(resource->uri) +
+                              GetTextStringSizeHint(resource->rel) +
+                              GetTextStringSizeHint(resource->anchor) + 2 * sidSize +
+                              GetStringLLSizeHint(OC_RSRVD_RESOURCE_TYPE, resource->types) +
+                              GetStringLLSizeHint(OC_RSRVD_INTERFACE, resource->interfaces);
+
+            size_t epsCount = 0;
+            for (const OCEndpointPayload *ep = resource->eps; ep; ep = ep->next)
+            {
+                epsCount++;
+            }
+            if (OC_FORMAT_VND_OCF_CBOR == format)
+            {
+                // Endpoints are listed in the link.
+                size += linkSize + epsCount * ENDPOINT_SIZE_HINT;
+            }
+            else
+            {
+                // The link is repeated for each endpoint.
+                size += (epsCount ? epsCount : 1) * (linkSize + ENDPOINT_SIZE_HINT);
+            }
+        }
+    }
+    return size;
+}
+
+/**
+ * Predict the size of an encoded payload, so that it is usually encoded in a single pass.
+ * A prediction that is too small only costs a second pass.
+ */
+static size_t GetPayloadSizeHint(const OCPayload *payload, OCPayloadFormat format)
+{
+    size_t size = INIT_SIZE;
+    switch (payload->type)
+    {
+        case PAYLOAD_TYPE_DISCOVERY:
+            size = GetDiscoveryPayloadSizeHint((const OCDiscoveryPayload *)payload, format);
+            break;
+        case PAYLOAD_TYPE_REPRESENTATION:
+            size = GetRepPayloadSizeHint((const OCRepPayload *)payload);
+            break;
+        case PAYLOAD_TYPE_DIAGNOSTIC:
+            size = GetTextStringSizeHint(((const OCDiagnosticPayload *)payload)->message);
+            break;
+        case PAYLOAD_TYPE_SECURITY:
+            size = ((const OCSecurityPayload *)payload)->payloadSize;
+            break;
+        case PAYLOAD_TYPE_INTROSPECTION:
+            size = ((const OCIntrospectionPayload *)payload)->cborPayload.len;
+            break;
+        case PAYLOAD_TYPE_ENCODED_REPRESENTATION:
+            size = ((const OCEncodedRepPayload *)payload)->cborPayload.len;
+            break;
+        default:
+            break;
+    }
+    return size ? size : INIT_SIZE;
+}
+
+/**
+ * Make sure a payload buffer holds at least the given number of bytes.  Its content is
+ * not preserved.
+ */
+static bool ReservePayloadBuffer(uint8_t **buffer, size_t *bufferSize, size_t size)
+{
+    if (*buffer && *bufferSize >= size)
+    {
+        return true;
+    }
+    uint8_t *newBuffer = (uint8_t *)OICMalloc(size);
+    if (!newBuffer)
+    {
+        return false;
+    }
+    OICFree(*buffer);
+    *buffer = newBuffer;
+    *bufferSize = size;
+    return true;
+}
+
+OCStackResult OCConvertPayloadToBuffer(OCPayload *payload, OCPayloadFormat format,
+        uint8_t **buffer, size_t *bufferSize, size_t *size)
 {
     // TinyCbor Version 47a78569c0 or better on master is required for the re-allocation
     // strategy to work.  If you receive the following assertion error, please do a git-pull
@@ -79,69 +348,79 @@ OCStackResult OCConvertPayload(OCPayload* payload, OCPayloadFormat format,
     OC_STATIC_ASSERT(!CborNeedsUpdating, "tinycbor needs to be updated to at least 47a78569c0");
     #undef CborNeedsUpdating
 
-    OCStackResult ret = OC_STACK_INVALID_PARAM;
     int64_t err = CborErrorOutOfMemory;
-    uint8_t *out = NULL;
-    size_t curSize = INIT_SIZE;
 
     VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
-    VERIFY_PARAM_NON_NULL(TAG, outPayload, "OutPayload parameter is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, buffer, "buffer parameter is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, bufferSize, "bufferSize parameter is NULL");
     VERIFY_PARAM_NON_NULL(TAG, size, "size parameter is NULL");
 
     OIC_LOG_V(INFO, TAG, "Converting payload of type %d", payload->type);
-    if (PAYLOAD_TYPE_SECURITY == payload->type)
+
+    size_t curSize = GetPayloadSizeHint(payload, format);
+    for (;;)
     {
-        size_t securityPayloadSize = ((OCSecurityPayload *)payload)->payloadSize;
-        if (securityPayloadSize > 0)
+        if (!ReservePayloadBuffer(buffer, bufferSize, curSize))
         {
-            curSize = securityPayloadSize;
+            OIC_LOG(ERROR, TAG, "Failed to allocate payload");
+            return OC_STACK_NO_MEMORY;
         }
-    }
-    if (PAYLOAD_TYPE_INTROSPECTION == payload->type)
-    {
-        size_t introspectionPayloadSize = ((OCIntrospectionPayload *)payload)->cborPayload.len;
-        if (introspectionPayloadSize > 0)
+
+        // The encoder reports the exact size needed when the buffer is too small.
+        curSize = *bufferSize;
+        err = OCConvertPayloadHelper(payload, format, *buffer, &curSize);
+        if (CborErrorOutOfMemory != err)
         {
-            curSize = introspectionPayloadSize;
+            break;
         }
+        OIC_LOG_V(DEBUG, TAG, "Payload needs %zu bytes, re-encoding", curSize);
     }
 
-    ret = OC_STACK_NO_MEMORY;
-
-    for (;;)
+    if (err != CborNoError)
     {
-        out = (uint8_t *)OICCalloc(1, curSize);
-        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
-        err = OCConvertPayloadHelper(payload, format, out, &curSize);
+        //TODO: Proper conversion from CborError to OCStackResult.
+        return (OCStackResult)-err;
+    }
 
-        if (CborErrorOutOfMemory != err)
-        {
-            break;
-        }
+    *size = curSize;
+    OIC_LOG_V(DEBUG, TAG, "Payload Size: %zd Payload : ", *size);
+    OIC_LOG_BUFFER(DEBUG, TAG, *buffer, *size);
+    return OC_STACK_OK;
+
+exit:
+    return OC_STACK_INVALID_PARAM;
+}
+
+OCStackResult OCConvertPayload(OCPayload* payload, OCPayloadFormat format,
+        uint8_t** outPayload, size_t* size)
+{
+    OCStackResult ret = OC_STACK_INVALID_PARAM;
+    uint8_t *out = NULL;
+    size_t outSize = 0;
+    size_t curSize = 0;
+
+    VERIFY_PARAM_NON_NULL(TAG, outPayload, "OutPayload parameter is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, size, "size parameter is NULL");
 
-        OICFree(out);
+    ret = OCConvertPayloadToBuffer(payload, format, &out, &outSize, &curSize);
+    if (OC_STACK_OK != ret)
+    {
+        goto exit;
     }
 
-    if (err == CborNoError)
+    // Don't hand over the slack left by the size prediction.
+    if ((0 < curSize) && (curSize < outSize))
     {
-        if ((curSize < INIT_SIZE) &&
-            (PAYLOAD_TYPE_SECURITY != payload->type) &&
-            (PAYLOAD_TYPE_INTROSPECTION != payload->type))
+        uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
+        if (out2)
         {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
             out = out2;
         }
-
-        *size = curSize;
-        *outPayload = out;
-        OIC_LOG_V(DEBUG, TAG, "Payload Size: %zd Payload : ", *size);
-        OIC_LOG_BUFFER(DEBUG, TAG, *outPayload, *size);
-        return OC_STACK_OK;
     }
 
-    //TODO: Proper conversion from CborError to OCStackResult.
-    ret = (OCStackResult)-err;
+    *size = curSize;
+    *outPayload = out;
+    return OC_STACK_OK;
 
 exit:
     OICFree(out);
@@ -167,6 +446,8 @@ static int64_t OCConvertPayloadHelper(OCPayload* payload, OCPayloadFormat format
         case PAYLOAD_TYPE_INTROSPECTION:
             return OCConvertIntrospectionPayload((OCIntrospectionPayload*)payload,
                                                  outPayload, size);
+        case PAYLOAD_TYPE_ENCODED_REPRESENTATION:
+            return OCConvertEncodedRepPayload((OCEncodedRepPayload*)payload, outPayload, size);
         default:
             OIC_LOG_V(INFO, TAG, "ConvertPayload default %d", payload->type);
             return CborErrorUnknownType;
@@ -210,6 +491,15 @@ static int64_t OCConvertIntrospectionPayload(OCIntrospectionPayload *payload,
     return CborNoError;
 }
 
+static int64_t OCConvertEncodedRepPayload(OCEncodedRepPayload *payload, uint8_t *outPayload,
+        size_t *size)
+{
+    memcpy(outPayload, payload->cborPayload.bytes, payload->cborPayload.len);
+    *size = payload->cborPayload.len;
+
+    return CborNoError;
+}
+
 static int64_t OCStringLLJoin(CborEncoder *map, char *type, OCStringLL *val)
 {
     uint16_t count = 0;
@@ -0,0 +1,380 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ocrequestdispatch.h"
+#include "caremotehandler.h"
+#include "octhread.h"
+#include "oic_malloc.h"
+#include "logger.h"
+
+#define TAG "OIC_RI_DISPATCH"
+
+/**
+ * Request waiting for a worker.
+ */
+typedef struct OCRequestWorkItem
+{
+    CAEndpoint_t *endPoint;
+    CARequestInfo_t *requestInfo;
+    struct OCRequestWorkItem *next;
+} OCRequestWorkItem;
+
+/**
+ * Worker thread together with the queue of the requests it owns.
+ */
+typedef struct
+{
+    oc_thread thread;
+    /** Guards the queue and the stop flag. */
+    oc_mutex queueMutex;
+    oc_cond queueCond;
+    /**
+     * Held by the worker while it handles a request.  A thread holding the busy mutexes of
+     * several shards acquires them in index order.
+     */
+    oc_mutex busyMutex;
+    OCRequestWorkItem *head;
+    OCRequestWorkItem *tail;
+    bool stop;
+} OCRequestShard;
+
+/** Worker shards, indexed by the hash of the resource URI. */
+static OCRequestShard *g_shards = NULL;
+
+/** Number of entries in g_shards. */
+static uint8_t g_shardCount = 0;
+
+/** Callback handling the requests on the workers. */
+static OCRequestDispatchHandler g_requestHandler = NULL;
+
+/** Guards g_dispatchEnabled against concurrent submissions. */
+static oc_mutex g_submitMutex = NULL;
+
+/** Whether submitted requests are queued for the workers. */
+static bool g_dispatchEnabled = false;
+
+/** Locks guarding shared stack structures, NULL while the workers are not configured. */
+static oc_mutex g_locks[OC_DISPATCH_LOCK_COUNT] = { NULL };
+
+/**
+ * Hash the path of a resource URI, ignoring any query.  FNV-1a.
+ */
+static uint32_t HashResourcePath(const char *uri)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *c = uri; c && *c && '?' != *c; c++)
+    {
+        hash ^= (uint8_t)*c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static OCRequestShard *GetShard(const char *uri)
+{
+    return &g_shards[HashResourcePath(uri) % g_shardCount];
+}
+
+static void FreeWorkItem(OCRequestWorkItem *item)
+{
+    CADestroyRequestInfoInternal(item->requestInfo);
+    CAFreeEndpoint(item->endPoint);
+    OICFree(item);
+}
+
+static void *RequestWorkerThread(void *threadData)
+{
+    OCRequestShard *shard = (OCRequestShard *)threadData;
+
+    oc_mutex_lock(shard->queueMutex);
+    while (!shard->stop)
+    {
+        OCRequestWorkItem *item = shard->head;
+        if (!item)
+        {
+            oc_cond_wait(shard->queueCond, shard->queueMutex);
+            continue;
+        }
+        shard->head = item->next;
+        if (!shard->head)
+        {
+            shard->tail = NULL;
+        }
+        oc_mutex_unlock(shard->queueMutex);
+
+        oc_mutex_lock(shard->busyMutex);
+        g_requestHandler(item->endPoint, item->requestInfo);
+        oc_mutex_unlock(shard->busyMutex);
+        FreeWorkItem(item);
+
+        oc_mutex_lock(shard->queueMutex);
+    }
+    oc_mutex_unlock(shard->queueMutex);
+    return NULL;
+}
+
+static void DestroyShard(OCRequestShard *shard)
+{
+    OCRequestWorkItem *item = shard->head;
+    while (item)
+    {
+        OCRequestWorkItem *next = item->next;
+        FreeWorkItem(item);
+        item = next;
+    }
+    shard->head = NULL;
+    shard->tail = NULL;
+
+    oc_cond_free(shard->queueCond);
+    oc_mutex_free(shard->queueMutex);
+    oc_mutex_free(shard->busyMutex);
+    shard->queueCond = NULL;
+    shard->queueMutex = NULL;
+    shard->busyMutex = NULL;
+}
+
+OCStackResult OCRequestDispatchInitialize(uint8_t workerCount, OCRequestDispatchHandler handler)
+{
+    if (!handler || 0 == workerCount || workerCount > OC_MAX_REQUEST_WORKERS)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+    if (g_shards)
+    {
+        OIC_LOG(ERROR, TAG, "Request workers already initialized");
+        return OC_STACK_ERROR;
+    }
+
+    for (size_t i = 0; i < OC_DISPATCH_LOCK_COUNT; i++)
+    {
+        g_locks[i] = oc_mutex_new_recursive();
+        if (!g_locks[i])
+        {
+            goto error;
+        }
+    }
+    g_submitMutex = oc_mutex_new();
+    g_shards = (OCRequestShard *)OICCalloc(workerCount, sizeof(OCRequestShard));
+    if (!g_submitMutex || !g_shards)
+    {
+        goto error;
+    }
+    g_requestHandler = handler;
+
+    for (g_shardCount = 0; g_shardCount < workerCount; g_shardCount++)
+    {
+        OCRequestShard *shard = &g_shards[g_shardCount];
+        shard->queueMutex = oc_mutex_new();
+        shard->queueCond = oc_cond_new();
+        shard->busyMutex = oc_mutex_new_recursive();
+        if (!shard->queueMutex || !shard->queueCond || !shard->busyMutex ||
+            OC_THREAD_SUCCESS != oc_thread_new(&shard->thread, RequestWorkerThread, shard))
+        {
+            DestroyShard(shard);
+            goto error;
+        }
+    }
+
+    g_dispatchEnabled = true;
+    OIC_LOG_V(INFO, TAG, "Started %u request workers", workerCount);
+    return OC_STACK_OK;
+
+error:
+    OIC_LOG(ERROR, TAG, "Failed to start request workers");
+    OCRequestDispatchStop();
+    OCRequestDispatchTerminate();
+    return OC_STACK_ERROR;
+}
+
+void OCRequestDispatchStop()
+{
+    if (g_submitMutex)
+    {
+        oc_mutex_lock(g_submitMutex);
+        g_dispatchEnabled = false;
+        oc_mutex_unlock(g_submitMutex);
+    }
+
+    for (uint8_t i = 0; i < g_shardCount; i++)
+    {
+        OCRequestShard *shard = &g_shards[i];
+        if (!shard->thread)
+        {
+            continue;
+        }
+        oc_mutex_lock(shard->queueMutex);
+        shard->stop = true;
+        oc_cond_signal(shard->queueCond);
+        oc_mutex_unlock(shard->queueMutex);
+
+        oc_thread_wait(shard->thread);
+        oc_thread_free(shard->thread);
+        shard->thread = NULL;
+    }
+}
+
+void OCRequestDispatchTerminate()
+{
+    assert(!g_dispatchEnabled);
+
+    for (uint8_t i = 0; i < g_shardCount; i++)
+    {
+        DestroyShard(&g_shards[i]);
+    }
+    OICFree(g_shards);
+    g_shards = NULL;
+    g_shardCount = 0;
+    g_requestHandler = NULL;
+
+    oc_mutex_free(g_submitMutex);
+    g_submitMutex = NULL;
+    for (size_t i = 0; i < OC_DISPATCH_LOCK_COUNT; i++)
+    {
+        oc_mutex_free(g_locks[i]);
+        g_locks[i] = NULL;
+    }
+}
+
+bool OCRequestDispatchIsEnabled()
+{
+    return g_dispatchEnabled;
+}
+
+OCStackResult OCRequestDispatchSubmit(const CAEndpoint_t *endPoint,
+                                      const CARequestInfo_t *requestInfo)
+{
+    if (!endPoint || !requestInfo)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+    if (!g_submitMutex)
+    {
+        return OC_STACK_ERROR;
+    }
+
+    OCRequestWorkItem *item = (OCRequestWorkItem *)OICCalloc(1, sizeof(OCRequestWorkItem));
+    if (!item)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    item->endPoint = CACloneEndpoint(endPoint);
+    item->requestInfo = CACloneRequestInfo(requestInfo);
+    if (!item->endPoint || !item->requestInfo)
+    {
+        FreeWorkItem(item);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    OCStackResult result = OC_STACK_ERROR;
+    oc_mutex_lock(g_submitMutex);
+    if (g_dispatchEnabled)
+    {
+        OCRequestShard *shard = GetShard(requestInfo->info.resourceUri);
+        oc_mutex_lock(shard->queueMutex);
+        if (shard->tail)
+        {
+            shard->tail->next = item;
+        }
+        else
+        {
+            shard->head = item;
+        }
+        shard->tail = item;
+        oc_cond_signal(shard->queueCond);
+        oc_mutex_unlock(shard->queueMutex);
+        result = OC_STACK_OK;
+    }
+    oc_mutex_unlock(g_submitMutex);
+
+    if (OC_STACK_OK != result)
+    {
+        FreeWorkItem(item);
+    }
+    return result;
+}
+
+void OCDispatchLockAcquire(OCDispatchLock lock)
+{
+    if (lock < OC_DISPATCH_LOCK_COUNT && g_locks[lock])
+    {
+        oc_mutex_lock(g_locks[lock]);
+    }
+}
+
+void OCDispatchLockRelease(OCDispatchLock lock)
+{
+    if (lock < OC_DISPATCH_LOCK_COUNT && g_locks[lock])
+    {
+        oc_mutex_unlock(g_locks[lock]);
+    }
+}
+
+/**
+ * Find the shard whose worker is the calling thread.
+ *
+ * @return the shard, or NULL if the caller is not a request worker.
+ */
+static OCRequestShard *GetCurrentShard()
+{
+    for (uint8_t i = 0; i < g_shardCount; i++)
+    {
+        if (oc_thread_is_current(g_shards[i].thread))
+        {
+            return &g_shards[i];
+        }
+    }
+    return NULL;
+}
+
+void OCRequestDispatchPauseResource(const char *uri)
+{
+    if (!g_shardCount || !uri)
+    {
+        return;
+    }
+
+    OCRequestShard *shard = GetShard(uri);
+    OCRequestShard *current = GetCurrentShard();
+    if (current && current > shard)
+    {
+        // A worker pausing a shard with a lower index lets go of its own shard meanwhile,
+        // so two workers deleting each other's resources cannot deadlock.
+        oc_mutex_unlock(current->busyMutex);
+        oc_mutex_lock(shard->busyMutex);
+        oc_mutex_lock(current->busyMutex);
+    }
+    else
+    {
+        oc_mutex_lock(shard->busyMutex);
+    }
+}
+
+void OCRequestDispatchResumeResource(const char *uri)
+{
+    if (g_shardCount && uri)
+    {
+        oc_mutex_unlock(GetShard(uri)->busyMutex);
+    }
+}
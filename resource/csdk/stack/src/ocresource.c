@@ -39,6 +39,8 @@
 
 #include "ocresource.h"
 #include "ocresourcehandler.h"
+#include "ocresourceindex.h"
+#include "ocrequestdispatch.h"
 #include "ocobserve.h"
 #include "occollection.h"
 #include "oic_malloc.h"
@@ -1304,17 +1306,14 @@ OCResource *OC_CALL FindResourceByUri(const char* resourceUri)
         return NULL;
     }
 
-    OCResource * pointer = headResource;
-    while (pointer)
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    OCResource *pointer = OCResourceIndexFindByUri(resourceUri);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    if (!pointer)
     {
-        if (strcmp(resourceUri, pointer->uri) == 0)
-        {
-            return pointer;
-        }
-        pointer = pointer->next;
+        OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
     }
-    OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
-    return NULL;
+    return pointer;
 }
 
 OCStackResult CheckRequestsEndpoint(const OCDevAddr *reqDevAddr,
@@ -1349,15 +1348,14 @@ OCStackResult CheckRequestsEndpoint(const OCDevAddr *reqDevAddr,
     }
 }
 
-OCStackResult DetermineResourceHandling (const OCServerRequest *request,
-                                         ResourceHandling *handling,
-                                         OCResource **resource)
+/*
+ * Find the resource a request targets and how it is handled.  The caller holds the
+ * resource lock.
+ */
+static OCStackResult DetermineResourceHandlingLocked(const OCServerRequest *request,
+                                                     ResourceHandling *handling,
+                                                     OCResource **resource)
 {
-    if(!request || !handling || !resource)
-    {
-        return OC_STACK_INVALID_PARAM;
-    }
-
     OIC_LOG_V(INFO, TAG, "DetermineResourceHandling for %s", request->resourceUrl);
 
     // Check if virtual resource
@@ -1444,6 +1442,21 @@ OCStackResult DetermineResourceHandling (const OCServerRequest *request,
     }
 }
 
+OCStackResult DetermineResourceHandling (const OCServerRequest *request,
+                                         ResourceHandling *handling,
+                                         OCResource **resource)
+{
+    if(!request || !handling || !resource)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    OCStackResult result = DetermineResourceHandlingLocked(request, handling, resource);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    return result;
+}
+
 OCStackResult EntityHandlerCodeToOCStackCode(OCEntityHandlerResult ehResult)
 {
     OCStackResult result;
@@ -1593,6 +1606,32 @@ static bool includeThisResourceInResponse(OCResource *resource,
            resourceMatchesRTFilter(resource, resourceTypeFilter);
 }
 
+/*
+ * Use the resource index to narrow down the resources that have to be matched against the
+ * discovery filters.  When no filter allows narrowing, candidates is set to NULL and every
+ * registered resource is a candidate.
+ * Function returns the number of candidates.
+ */
+static size_t getDiscoveryCandidates(char *interfaceFilter, char *resourceTypeFilter,
+                                     OCResource * const **candidates)
+{
+    if (resourceTypeFilter && *resourceTypeFilter)
+    {
+        return OCResourceIndexGetByType(resourceTypeFilter, candidates);
+    }
+
+    // oic.if.ll and oic.if.baseline filters match any resource.
+    if (interfaceFilter && *interfaceFilter &&
+        0 != strcmp(OC_RSRVD_INTERFACE_LL, interfaceFilter) &&
+        0 != strcmp(OC_RSRVD_INTERFACE_DEFAULT, interfaceFilter))
+    {
+        return OCResourceIndexGetByInterface(interfaceFilter, candidates);
+    }
+
+    *candidates = NULL;
+    return OCResourceIndexGetCount();
+}
+
 static OCStackResult SendNonPersistantDiscoveryResponse(OCServerRequest *request,
                                 OCPayload *discoveryPayload, OCEntityHandlerResult ehResult)
 {
@@ -1943,8 +1982,13 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
 #ifdef MQ_BROKER
         prop = (OC_MQ_BROKER_URI == virtualUriInRequest) ? OC_MQ_BROKER : prop;
 #endif
-        for (; resource && discoveryResult == OC_STACK_OK; resource = resource->next)
+        OCResource * const *candidates = NULL;
+        size_t candidateCount = getDiscoveryCandidates(interfaceQuery, resourceTypeQuery,
+                                                       &candidates);
+        for (size_t i = 0; i < candidateCount && discoveryResult == OC_STACK_OK; i++)
         {
+            resource = candidates ? candidates[i] : OCResourceIndexGetAt(i);
+
             // This case will handle when no resource type and it is oic.if.ll.
             // Do not assume check if the query is ll
             if (!resourceTypeQuery &&
@@ -2173,11 +2217,14 @@ HandleResourceWithEntityHandler(OCServerRequest *request,
     {
         OIC_LOG(INFO, TAG, "Observation registration requested");
 
+        // Keep the observer lookup, identifier and registration atomic.
+        OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
         ResourceObserver *obs = GetObserverUsingToken (request->requestToken,
                                     request->tokenLength);
 
         if (obs)
         {
+            OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
             OIC_LOG (INFO, TAG, "Observer with this token already present");
             OIC_LOG (INFO, TAG, "Possibly re-transmitted CON OBS request");
             OIC_LOG (INFO, TAG, "Not adding observer. Not responding to client");
@@ -2192,13 +2239,15 @@ HandleResourceWithEntityHandler(OCServerRequest *request,
         }
 
         result = GenerateObserverId(&ehRequest.obsInfo.obsId);
-        VERIFY_SUCCESS(result);
-
-        result = AddObserver ((const char*)(request->resourceUrl),
-                (const char *)(request->query),
-                ehRequest.obsInfo.obsId, request->requestToken, request->tokenLength,
-                resource, request->qos, request->acceptFormat,
-                request->acceptVersion, &request->devAddr);
+        if (OC_STACK_OK == result)
+        {
+            result = AddObserver ((const char*)(request->resourceUrl),
+                    (const char *)(request->query),
+                    ehRequest.obsInfo.obsId, request->requestToken, request->tokenLength,
+                    resource, request->qos, request->acceptFormat,
+                    request->acceptVersion, &request->devAddr);
+        }
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
         if(result == OC_STACK_OK)
         {
@@ -2228,10 +2277,12 @@ HandleResourceWithEntityHandler(OCServerRequest *request,
     {
         OIC_LOG(INFO, TAG, "Deregistering observation requested");
 
+        OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
         resObs = GetObserverUsingToken (request->requestToken, request->tokenLength);
 
         if (NULL == resObs)
         {
+            OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
             // Stack does not contain this observation request
             // Either token is incorrect or observation list is corrupted
             result = OC_STACK_ERROR;
@@ -2241,6 +2292,7 @@ HandleResourceWithEntityHandler(OCServerRequest *request,
         ehFlag = (OCEntityHandlerFlag)(ehFlag | OC_OBSERVE_FLAG);
 
         result = DeleteObserverUsingToken (request->requestToken, request->tokenLength);
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
         if(result == OC_STACK_OK)
         {
@@ -2308,7 +2360,10 @@ ProcessRequest(ResourceHandling resHandling, OCResource *resource, OCServerReque
     {
         case OC_RESOURCE_VIRTUAL:
         {
+            // Virtual resources are built from the whole resource list.
+            OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
             ret = HandleVirtualResource (request, resource);
+            OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
             break;
         }
         case OC_RESOURCE_DEFAULT_DEVICE_ENTITYHANDLER:
@@ -2333,6 +2388,8 @@ ProcessRequest(ResourceHandling resHandling, OCResource *resource, OCServerReque
         }
         case OC_RESOURCE_COLLECTION_DEFAULT_ENTITYHANDLER:
         {
+            // Takes the resource lock itself, as the batch interface calls the entity
+            // handlers of the collection members.
             ret = HandleCollectionResourceDefaultEntityHandler (request, resource);
             break;
         }
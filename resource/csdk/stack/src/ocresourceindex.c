@@ -0,0 +1,373 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "ocresourceindex.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include <coap/uthash.h>
+
+/*
+ * Every function adding to an index has a uthash_oom label, undoing the partial add and
+ * returning OC_STACK_NO_MEMORY rather than letting uthash exit the process.
+ */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
+
+/** Initial capacity of the resource arrays kept by the index. */
+#define INITIAL_ARRAY_CAPACITY (8)
+
+/**
+ * Growable array of resource pointers.
+ */
+typedef struct
+{
+    OCResource **items;
+    size_t count;
+    size_t capacity;
+} OCResourceArray;
+
+/**
+ * Index entry for a registered resource, hashed both by URI and by handle.
+ */
+typedef struct
+{
+    OCResource *resource;
+    UT_hash_handle uriHh;
+    UT_hash_handle handleHh;
+} OCResourceIndexNode;
+
+/**
+ * Set of resources sharing a resource type or an interface name.
+ */
+typedef struct
+{
+    char *name;
+    OCResourceArray resources;
+    UT_hash_handle hh;
+} OCResourceIndexBucket;
+
+/** Registered resources, keyed by URI. */
+static OCResourceIndexNode *g_uriIndex = NULL;
+
+/** Registered resources, keyed by handle. */
+static OCResourceIndexNode *g_handleIndex = NULL;
+
+/** Registered resources, in creation order. */
+static OCResourceArray g_resources = { NULL, 0, 0 };
+
+/** Resources keyed by resource type name. */
+static OCResourceIndexBucket *g_typeIndex = NULL;
+
+/** Resources keyed by interface name. */
+static OCResourceIndexBucket *g_interfaceIndex = NULL;
+
+static bool ResourceArrayAppend(OCResourceArray *array, OCResource *resource)
+{
+    if (array->count == array->capacity)
+    {
+        size_t newCapacity = array->capacity ? (array->capacity * 2) : INITIAL_ARRAY_CAPACITY;
+        OCResource **items = (OCResource **)OICRealloc(array->items,
+                                                       newCapacity * sizeof(OCResource *));
+        if (!items)
+        {
+            return false;
+        }
+        array->items = items;
+        array->capacity = newCapacity;
+    }
+    array->items[array->count++] = resource;
+    return true;
+}
+
+static void ResourceArrayRemove(OCResourceArray *array, const OCResource *resource)
+{
+    for (size_t i = array->count; i > 0; --i)
+    {
+        if (array->items[i - 1] == resource)
+        {
+            memmove(&array->items[i - 1], &array->items[i],
+                    (array->count - i) * sizeof(OCResource *));
+            array->count--;
+            return;
+        }
+    }
+}
+
+static void BucketDelete(OCResourceIndexBucket **index, OCResourceIndexBucket *bucket)
+{
+    HASH_DELETE(hh, *index, bucket);
+    OICFree(bucket->resources.items);
+    OICFree(bucket->name);
+    OICFree(bucket);
+}
+
+static OCStackResult BucketAdd(OCResourceIndexBucket **index, OCResource *resource,
+                               const char *name)
+{
+    if (!resource || !name)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCResourceIndexBucket *bucket = NULL;
+    HASH_FIND(hh, *index, name, strlen(name), bucket);
+    if (!bucket)
+    {
+        bucket = (OCResourceIndexBucket *)OICCalloc(1, sizeof(OCResourceIndexBucket));
+        if (!bucket)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+        bucket->name = OICStrdup(name);
+        if (!bucket->name)
+        {
+            OICFree(bucket);
+            return OC_STACK_NO_MEMORY;
+        }
+        HASH_ADD_KEYPTR(hh, *index, bucket->name, strlen(bucket->name), bucket);
+    }
+
+    if (!ResourceArrayAppend(&bucket->resources, resource))
+    {
+        if (0 == bucket->resources.count)
+        {
+            BucketDelete(index, bucket);
+        }
+        return OC_STACK_NO_MEMORY;
+    }
+    return OC_STACK_OK;
+
+uthash_oom:
+    if (NULL == bucket->hh.tbl || NULL == bucket->hh.tbl->buckets)
+    {
+        uthash_free(bucket->hh.tbl, sizeof(UT_hash_table));
+        *index = NULL;
+    }
+    else
+    {
+        HASH_DELETE(hh, *index, bucket);
+    }
+    OICFree(bucket->name);
+    OICFree(bucket);
+    return OC_STACK_NO_MEMORY;
+}
+
+static void BucketRemove(OCResourceIndexBucket **index, const OCResource *resource,
+                         const char *name)
+{
+    if (!name)
+    {
+        return;
+    }
+
+    OCResourceIndexBucket *bucket = NULL;
+    HASH_FIND(hh, *index, name, strlen(name), bucket);
+    if (bucket)
+    {
+        ResourceArrayRemove(&bucket->resources, resource);
+        if (0 == bucket->resources.count)
+        {
+            BucketDelete(index, bucket);
+        }
+    }
+}
+
+static size_t BucketGet(OCResourceIndexBucket *index, const char *name,
+                        OCResource * const **resources)
+{
+    OCResourceIndexBucket *bucket = NULL;
+    if (name)
+    {
+        HASH_FIND(hh, index, name, strlen(name), bucket);
+    }
+    if (!bucket)
+    {
+        *resources = NULL;
+        return 0;
+    }
+    *resources = bucket->resources.items;
+    return bucket->resources.count;
+}
+
+static void BucketDeleteAll(OCResourceIndexBucket **index)
+{
+    OCResourceIndexBucket *bucket = NULL;
+    OCResourceIndexBucket *tmp = NULL;
+    HASH_ITER(hh, *index, bucket, tmp)
+    {
+        BucketDelete(index, bucket);
+    }
+}
+
+OCStackResult OCResourceIndexAdd(OCResource *resource)
+{
+    if (!resource || !resource->uri)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCResourceIndexNode *node = (OCResourceIndexNode *)OICCalloc(1, sizeof(OCResourceIndexNode));
+    if (!node)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    if (!ResourceArrayAppend(&g_resources, resource))
+    {
+        OICFree(node);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    node->resource = resource;
+    bool uriIndexed = false;
+    HASH_ADD_KEYPTR(uriHh, g_uriIndex, resource->uri, strlen(resource->uri), node);
+    uriIndexed = true;
+    HASH_ADD(handleHh, g_handleIndex, resource, sizeof(OCResource *), node);
+    return OC_STACK_OK;
+
+uthash_oom:
+    if (uriIndexed)
+    {
+        if (NULL == node->handleHh.tbl || NULL == node->handleHh.tbl->buckets)
+        {
+            uthash_free(node->handleHh.tbl, sizeof(UT_hash_table));
+            g_handleIndex = NULL;
+        }
+        else
+        {
+            HASH_DELETE(handleHh, g_handleIndex, node);
+        }
+        HASH_DELETE(uriHh, g_uriIndex, node);
+    }
+    else if (NULL == node->uriHh.tbl || NULL == node->uriHh.tbl->buckets)
+    {
+        uthash_free(node->uriHh.tbl, sizeof(UT_hash_table));
+        g_uriIndex = NULL;
+    }
+    else
+    {
+        HASH_DELETE(uriHh, g_uriIndex, node);
+    }
+    ResourceArrayRemove(&g_resources, resource);
+    OICFree(node);
+    return OC_STACK_NO_MEMORY;
+}
+
+void OCResourceIndexRemove(OCResource *resource)
+{
+    OCResourceIndexNode *node = NULL;
+    HASH_FIND(handleHh, g_handleIndex, &resource, sizeof(OCResource *), node);
+    if (!node)
+    {
+        return;
+    }
+
+    for (OCResourceType *rtPtr = resource->rsrcType; rtPtr; rtPtr = rtPtr->next)
+    {
+        BucketRemove(&g_typeIndex, resource, rtPtr->resourcetypename);
+    }
+    for (OCResourceInterface *ifPtr = resource->rsrcInterface; ifPtr; ifPtr = ifPtr->next)
+    {
+        BucketRemove(&g_interfaceIndex, resource, ifPtr->name);
+    }
+
+    ResourceArrayRemove(&g_resources, resource);
+    HASH_DELETE(uriHh, g_uriIndex, node);
+    HASH_DELETE(handleHh, g_handleIndex, node);
+    OICFree(node);
+}
+
+OCResource *OCResourceIndexFindByUri(const char *uri)
+{
+    if (!uri)
+    {
+        return NULL;
+    }
+
+    OCResourceIndexNode *node = NULL;
+    HASH_FIND(uriHh, g_uriIndex, uri, strlen(uri), node);
+    return node ? node->resource : NULL;
+}
+
+bool OCResourceIndexContains(const OCResource *resource)
+{
+    if (!resource)
+    {
+        return false;
+    }
+
+    OCResourceIndexNode *node = NULL;
+    HASH_FIND(handleHh, g_handleIndex, &resource, sizeof(OCResource *), node);
+    return (NULL != node);
+}
+
+size_t OCResourceIndexGetCount()
+{
+    return g_resources.count;
+}
+
+OCResource *OCResourceIndexGetAt(size_t index)
+{
+    return (index < g_resources.count) ? g_resources.items[index] : NULL;
+}
+
+OCStackResult OCResourceIndexAddType(OCResource *resource, const char *resourceTypeName)
+{
+    return BucketAdd(&g_typeIndex, resource, resourceTypeName);
+}
+
+OCStackResult OCResourceIndexAddInterface(OCResource *resource, const char *interfaceName)
+{
+    return BucketAdd(&g_interfaceIndex, resource, interfaceName);
+}
+
+size_t OCResourceIndexGetByType(const char *resourceTypeName, OCResource * const **resources)
+{
+    return BucketGet(g_typeIndex, resourceTypeName, resources);
+}
+
+size_t OCResourceIndexGetByInterface(const char *interfaceName, OCResource * const **resources)
+{
+    return BucketGet(g_interfaceIndex, interfaceName, resources);
+}
+
+void OCResourceIndexTerminate()
+{
+    OCResourceIndexNode *node = NULL;
+    OCResourceIndexNode *tmp = NULL;
+
+    HASH_ITER(uriHh, g_uriIndex, node, tmp)
+    {
+        HASH_DELETE(uriHh, g_uriIndex, node);
+        HASH_DELETE(handleHh, g_handleIndex, node);
+        OICFree(node);
+    }
+
+    BucketDeleteAll(&g_typeIndex);
+    BucketDeleteAll(&g_interfaceIndex);
+
+    OICFree(g_resources.items);
+    g_resources.items = NULL;
+    g_resources.count = 0;
+    g_resources.capacity = 0;
+}
@@ -24,6 +24,7 @@
 #include "ocserverrequest.h"
 #include "ocresourcehandler.h"
 #include "ocobserve.h"
+#include "ocrequestdispatch.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "ocpayload.h"
@@ -47,6 +48,9 @@
 // Module Name
 #define TAG "OIC_RI_SERVERREQUEST"
 
+// Largest encoding buffer kept for the next responses.
+#define MAX_RESPONSE_BUFFER_SIZE (4096)
+
 //-------------------------------------------------------------------------------------------------
 // Local functions for RB tree
 //-------------------------------------------------------------------------------------------------
@@ -73,9 +77,46 @@ RB_HEAD(ServerResponseTree, OCServerResponse) g_serverResponseTree =
                                                             RB_INITIALIZER(&g_serverResponseTree);
 RB_GENERATE(ServerResponseTree, OCServerResponse, entry, RBResponseTokenCmp)
 
+/** Buffer the response payloads are encoded into, NULL while a response uses it. */
+static uint8_t *g_responseBuffer = NULL;
+static size_t g_responseBufferSize = 0;
+
 //-------------------------------------------------------------------------------------------------
 // Local functions
 //-------------------------------------------------------------------------------------------------
+/**
+ * Take the response encoding buffer.  Responses sent concurrently by request workers get
+ * an empty buffer instead.
+ */
+static void TakeResponseBuffer(uint8_t **buffer, size_t *bufferSize)
+{
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_SERVER_REQUESTS);
+    *buffer = g_responseBuffer;
+    *bufferSize = g_responseBufferSize;
+    g_responseBuffer = NULL;
+    g_responseBufferSize = 0;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_SERVER_REQUESTS);
+}
+
+/**
+ * Give back a buffer taken with TakeResponseBuffer(), it is freed if it cannot be kept.
+ */
+static void ReleaseResponseBuffer(uint8_t *buffer, size_t bufferSize)
+{
+    if (buffer && bufferSize <= MAX_RESPONSE_BUFFER_SIZE)
+    {
+        OCDispatchLockAcquire(OC_DISPATCH_LOCK_SERVER_REQUESTS);
+        if (!g_responseBuffer)
+        {
+            g_responseBuffer = buffer;
+            g_responseBufferSize = bufferSize;
+            buffer = NULL;
+        }
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_SERVER_REQUESTS);
+    }
+    OICFree(buffer);
+}
+
 /**
  * Delete a server request from the server request list
  *
@@ -115,7 +156,9 @@ static OCStackResult AddServerResponse (OCServerResponse ** response, OCRequestH
 
     *response = serverResponse;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_SERVER_REQUESTS);
     RB_INSERT(ServerResponseTree, &g_serverResponseTree, serverResponse);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_SERVER_REQUESTS);
     OIC_LOG(INFO, TAG, "Server Response Added");
     return OC_STACK_OK;
 
@@ -143,7 +186,9 @@ static OCServerResponse * GetServerResponseUsingHandle (const OCServerRequest *
     OCServerResponse tmpFind, *out = NULL;
 
     tmpFind.requestHandle = (OCRequestHandle)handle;
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_SERVER_REQUESTS);
     out = RB_FIND(ServerResponseTree, &g_serverResponseTree, &tmpFind);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_SERVER_REQUESTS);
 
     if (!out)
     {
@@ -164,7 +209,9 @@ static void DeleteServerResponse (OCServerResponse * serverResponse)
 {
     if (serverResponse)
     {
+        OCDispatchLockAcquire(OC_DISPATCH_LOCK_SERVER_REQUESTS);
         RB_REMOVE(ServerResponseTree, &g_serverResponseTree, serverResponse);
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_SERVER_REQUESTS);
         OICFree(serverResponse);
         serverResponse = NULL;
         OIC_LOG(INFO, TAG, "Server Response Removed!!");
@@ -379,7 +426,9 @@ OCStackResult AddServerRequest (OCServerRequest ** request,
 
     *request = serverRequest;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_SERVER_REQUESTS);
     RB_INSERT(ServerRequestTree, &g_serverRequestTree, serverRequest);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_SERVER_REQUESTS);
     OIC_LOG(INFO, TAG, "Server Request Added");
     return OC_STACK_OK;
 
@@ -408,7 +457,9 @@ OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tok
 
     tmpFind.requestToken = token;
     tmpFind.tokenLength = tokenLength;
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_SERVER_REQUESTS);
     out = RB_FIND(ServerRequestTree, &g_serverRequestTree, &tmpFind);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_SERVER_REQUESTS);
 
     if (!out)
     {
@@ -436,12 +487,14 @@ void DeleteServerRequest(OCServerRequest * serverRequest)
     if (serverRequest)
     {
         OCServerRequest* out = NULL;
+        OCDispatchLockAcquire(OC_DISPATCH_LOCK_SERVER_REQUESTS);
         out = RB_FIND(ServerRequestTree, &g_serverRequestTree, serverRequest);
 
         if (out)
         {
             DeleteServerRequestInternal(out);
         }
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_SERVER_REQUESTS);
     }
 }
 
@@ -508,6 +561,8 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     }
 
     OCServerRequest *serverRequest = (OCServerRequest *)ehResponse->requestHandle;
+    uint8_t *payloadBuffer = NULL;
+    size_t payloadBufferSize = 0;
 
     CopyDevAddrToEndpoint(&serverRequest->devAddr, &responseEndpoint);
 
@@ -632,14 +687,19 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
                 // No preference set by the client, so default to CBOR then
             case OC_FORMAT_CBOR:
             case OC_FORMAT_VND_OCF_CBOR:
-                if((result = OCConvertPayload(ehResponse->payload, serverRequest->acceptFormat,
-                                &responseInfo.info.payload, &responseInfo.info.payloadSize))
+                // CA copies the payload, so the buffer is reused for the next responses.
+                TakeResponseBuffer(&payloadBuffer, &payloadBufferSize);
+                if((result = OCConvertPayloadToBuffer(ehResponse->payload,
+                                serverRequest->acceptFormat, &payloadBuffer, &payloadBufferSize,
+                                &responseInfo.info.payloadSize))
                         != OC_STACK_OK)
                 {
                     OIC_LOG(ERROR, TAG, "Error converting payload");
+                    ReleaseResponseBuffer(payloadBuffer, payloadBufferSize);
                     OICFree(responseInfo.info.options);
                     return result;
                 }
+                responseInfo.info.payload = payloadBuffer;
                 // Add CONTENT_FORMAT OPT if payload exist
                 if (ehResponse->payload->type != PAYLOAD_TYPE_DIAGNOSTIC &&
                         responseInfo.info.payloadSize > 0)
@@ -726,13 +786,20 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     result = OCSendResponse(&responseEndpoint, &responseInfo);
 #endif
 
-    OICFree(responseInfo.info.payload);
+    ReleaseResponseBuffer(payloadBuffer, payloadBufferSize);
     OICFree(responseInfo.info.options);
     //Delete the request
     DeleteServerRequest(serverRequest);
     return result;
 }
 
+void FreeServerResponseBuffer()
+{
+    OICFree(g_responseBuffer);
+    g_responseBuffer = NULL;
+    g_responseBufferSize = 0;
+}
+
 OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse)
 {
     if(!ehResponse || !ehResponse->payload)
@@ -763,14 +830,31 @@ OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse)
             VERIFY_NON_NULL(serverResponse);
         }
 
-        if(ehResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION)
+        OCRepPayload *newPayload = NULL;
+        if (ehResponse->payload->type == PAYLOAD_TYPE_ENCODED_REPRESENTATION)
+        {
+            // Representations already encoded to CBOR (e.g. by the C++ API) are parsed
+            // back so that they can be merged with the other fragments.
+            OCEncodedRepPayload *encoded = (OCEncodedRepPayload *)ehResponse->payload;
+            stackRet = OCParsePayload((OCPayload **)&newPayload, OC_FORMAT_CBOR,
+                                      PAYLOAD_TYPE_REPRESENTATION, encoded->cborPayload.bytes,
+                                      encoded->cborPayload.len);
+            if (OC_STACK_OK != stackRet)
+            {
+                OIC_LOG(ERROR, TAG, "Error parsing encoded payload fragment");
+                goto exit;
+            }
+        }
+        else if(ehResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION)
         {
             stackRet = OC_STACK_ERROR;
             OIC_LOG(ERROR, TAG, "Error adding payload, as it was the incorrect type");
             goto exit;
         }
-
-        OCRepPayload *newPayload = OCRepPayloadBatchClone((OCRepPayload *)ehResponse->payload);
+        else
+        {
+            newPayload = OCRepPayloadBatchClone((OCRepPayload *)ehResponse->payload);
+        }
 
         if(!serverResponse->payload)
         {
@@ -48,6 +48,8 @@
 #include "ocstack.h"
 #include "ocstackinternal.h"
 #include "ocresourcehandler.h"
+#include "ocresourceindex.h"
+#include "ocrequestdispatch.h"
 #include "occlientcb.h"
 #include "ocobserve.h"
 #include "ocrandom.h"
@@ -179,6 +181,9 @@ volatile int32_t g_ocStackStartStopThreadCount = 0;
 
 bool g_multicastServerStopped = false;
 
+// Number of request worker threads started by OCInit, 0 to handle requests inline
+static uint8_t g_requestWorkerCount = 0;
+
 //-----------------------------------------------------------------------------
 // Macros
 //-----------------------------------------------------------------------------
@@ -197,6 +202,12 @@ bool g_multicastServerStopped = false;
 
 #define MILLISECONDS_PER_SECOND   (1000)
 
+/// Longest time OCGetProcessTimeout() lets the caller wait before calling OCProcess again
+#define MAX_PROCESS_TIMEOUT_MS (1000)
+
+/// Time OCGetProcessTimeout() gives for the deadlines OCProcess could not handle yet
+#define RETRY_PROCESS_TIMEOUT_MS (10)
+
 // handle case that SCNd64 is not defined in arduino's inttypes.h
 #if defined(WITH_ARDUINO) && !defined(SCNd64)
 #define SCNd64 "lld"
@@ -220,17 +231,21 @@ static OCDoHandle GenerateInvocationHandle();
 static OCStackResult initResources();
 
 /**
- * Add a resource to the end of the linked list of resources.
+ * Add a resource to the end of the linked list of resources and to the resource index.
+ * The resource URI must be set before the resource is added.
  *
  * @param resource Resource to be added
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
  */
-static void insertResource(OCResource *resource);
+static OCStackResult insertResource(OCResource *resource);
 
 /**
- * Find a resource in the linked list of resources.
+ * Find a resource in the resource index.  Callers that use the resource afterwards hold
+ * the resource lock across the lookup, so the resource cannot be deleted meanwhile.
  *
  * @param resource Resource to be found.
- * @return Pointer to resource that was found in the linked list or NULL if the resource was not
+ * @return Pointer to resource that was found in the index or NULL if the resource was not
  *         found.
  */
 static OCResource *findResource(OCResource *resource);
@@ -244,8 +259,11 @@ static OCResource *findResource(OCResource *resource);
  *
  * @param resource Resource where resource type is to be inserted.
  * @param resourceType Resource type to be inserted.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.  On failure the
+ *         resourceType has not been inserted and is still owned by the caller.
  */
-static void insertResourceType(OCResource *resource,
+static OCStackResult insertResourceType(OCResource *resource,
         OCResourceType *resourceType);
 
 /**
@@ -267,8 +285,11 @@ static OCResourceType *findResourceTypeAtIndex(OCResourceHandle handle,
  *
  * @param resource Resource where resource interface is to be inserted.
  * @param resourceInterface Resource interface to be inserted.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.  On failure the
+ *         resourceInterface has not been inserted and is still owned by the caller.
  */
-static void insertResourceInterface(OCResource *resource,
+static OCStackResult insertResourceInterface(OCResource *resource,
         OCResourceInterface *resourceInterface);
 
 /**
@@ -695,52 +716,60 @@ static OCStackResult OCSendRequest(const CAEndpoint_t *object, CARequestInfo_t *
 
 // This internal function is called to update the stack with the status of
 // observers and communication failures
-OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t status)
+/*
+ * Entity handler to be told that the stack deregistered one of its observers.
+ */
+typedef struct
+{
+    OCEntityHandler entityHandler;
+    void *callbackParam;
+    OCDevAddr devAddr;
+    OCObservationId observeId;
+} ObserverDeregistration;
+
+/*
+ * Deregister an observer, and return the entity handler to notify once the lock is released.
+ */
+static OCStackResult DeregisterObserverLocked(ResourceObserver *observer, CAToken_t token,
+                                              uint8_t tokenLength, ObserverDeregistration *dereg)
+{
+    if (observer && observer->resource && observer->resource->entityHandler)
+    {
+        dereg->entityHandler = observer->resource->entityHandler;
+        dereg->callbackParam = observer->resource->entityHandlerCallbackParam;
+        dereg->devAddr = observer->devAddr;
+        dereg->observeId = observer->observeId;
+    }
+
+    OCStackResult result = DeleteObserverUsingToken(token, tokenLength);
+    if (result == OC_STACK_OK)
+    {
+        OIC_LOG(DEBUG, TAG, "Removed observer successfully");
+    }
+    else
+    {
+        result = OC_STACK_OK;
+        OIC_LOG(DEBUG, TAG, "Observer Removal failed");
+    }
+    return result;
+}
+
+/*
+ * Apply feedback about an observer.  The caller holds the resource lock, which also guards
+ * the observers, and calls the entity handler returned in dereg after releasing it.
+ */
+static OCStackResult ObserverFeedBackLocked(CAToken_t token, uint8_t tokenLength, uint8_t status,
+                                            ObserverDeregistration *dereg)
 {
     OCStackResult result = OC_STACK_ERROR;
     ResourceObserver * observer = NULL;
-    OCEntityHandlerRequest ehRequest = {0};
 
     switch(status)
     {
     case OC_OBSERVER_NOT_INTERESTED:
         OIC_LOG(DEBUG, TAG, "observer not interested in our notifications");
         observer = GetObserverUsingToken(token, tokenLength);
-        if (observer)
-        {
-            result = FormOCEntityHandlerRequest(&ehRequest,
-                                                (OCRequestHandle)NULL,
-                                                OC_REST_NOMETHOD,
-                                                &observer->devAddr,
-                                                (OCResourceHandle)NULL,
-                                                NULL,
-                                                PAYLOAD_TYPE_REPRESENTATION, OC_FORMAT_CBOR,
-                                                NULL, 0, 0, NULL,
-                                                OC_OBSERVE_DEREGISTER,
-                                                observer->observeId,
-                                                0);
-            if (result != OC_STACK_OK)
-            {
-                return result;
-            }
-
-            if (observer->resource && observer->resource->entityHandler)
-            {
-                observer->resource->entityHandler(OC_OBSERVE_FLAG, &ehRequest,
-                                                  observer->resource->entityHandlerCallbackParam);
-            }
-        }
-
-        result = DeleteObserverUsingToken(token, tokenLength);
-        if (result == OC_STACK_OK)
-        {
-            OIC_LOG(DEBUG, TAG, "Removed observer successfully");
-        }
-        else
-        {
-            result = OC_STACK_OK;
-            OIC_LOG(DEBUG, TAG, "Observer Removal failed");
-        }
+        result = DeregisterObserverLocked(observer, token, tokenLength, dereg);
         break;
 
     case OC_OBSERVER_STILL_INTERESTED:
@@ -765,38 +794,7 @@ OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t stat
         {
             if (observer->failedCommCount >= MAX_OBSERVER_FAILED_COMM)
             {
-                result = FormOCEntityHandlerRequest(&ehRequest,
-                                                    (OCRequestHandle)NULL,
-                                                    OC_REST_NOMETHOD,
-                                                    &observer->devAddr,
-                                                    (OCResourceHandle)NULL,
-                                                    NULL,
-                                                    PAYLOAD_TYPE_REPRESENTATION, OC_FORMAT_CBOR,
-                                                    NULL, 0, 0, NULL,
-                                                    OC_OBSERVE_DEREGISTER,
-                                                    observer->observeId,
-                                                    0);
-                if (result != OC_STACK_OK)
-                {
-                    return OC_STACK_ERROR;
-                }
-
-                if (observer->resource && observer->resource->entityHandler)
-                {
-                    observer->resource->entityHandler(OC_OBSERVE_FLAG, &ehRequest,
-                                        observer->resource->entityHandlerCallbackParam);
-                }
-
-                result = DeleteObserverUsingToken(token, tokenLength);
-                if (result == OC_STACK_OK)
-                {
-                    OIC_LOG(DEBUG, TAG, "Removed observer successfully");
-                }
-                else
-                {
-                    result = OC_STACK_OK;
-                    OIC_LOG(DEBUG, TAG, "Observer Removal failed");
-                }
+                result = DeregisterObserverLocked(observer, token, tokenLength, dereg);
             }
             else
             {
@@ -816,6 +814,38 @@ OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t stat
     return result;
 }
 
+OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t status)
+{
+    ObserverDeregistration dereg = { .entityHandler = NULL };
+
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    OCStackResult result = ObserverFeedBackLocked(token, tokenLength, status, &dereg);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+
+    // The entity handler runs without the lock, so it can call back into the stack.
+    if (dereg.entityHandler)
+    {
+        OCEntityHandlerRequest ehRequest = {0};
+        OCStackResult ehResult = FormOCEntityHandlerRequest(&ehRequest,
+                                                            (OCRequestHandle)NULL,
+                                                            OC_REST_NOMETHOD,
+                                                            &dereg.devAddr,
+                                                            (OCResourceHandle)NULL,
+                                                            NULL,
+                                                            PAYLOAD_TYPE_REPRESENTATION,
+                                                            OC_FORMAT_CBOR,
+                                                            NULL, 0, 0, NULL,
+                                                            OC_OBSERVE_DEREGISTER,
+                                                            dereg.observeId,
+                                                            0);
+        if (OC_STACK_OK == ehResult)
+        {
+            dereg.entityHandler(OC_OBSERVE_FLAG, &ehRequest, dereg.callbackParam);
+        }
+    }
+    return result;
+}
+
 OCStackResult CAResponseToOCStackResult(CAResponseResult_t caCode)
 {
     OCStackResult ret = OC_STACK_ERROR;
@@ -1987,8 +2017,8 @@ void OC_CALL OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo
                 else
                 {
                     // To keep discovery callbacks active.
-                    cbNode->TTL = GetTicks(MAX_CB_TIMEOUT_SECONDS *
-                                            MILLISECONDS_PER_SECOND);
+                    SetClientCBTTL(cbNode, GetTicks(MAX_CB_TIMEOUT_SECONDS *
+                                                    MILLISECONDS_PER_SECOND));
                 }
             }
 
@@ -2561,6 +2591,34 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     OIC_LOG(INFO, TAG, "Exit OCHandleRequests");
 }
 
+/*
+ * Check whether a request is for a resource implemented by the stack itself: the virtual
+ * resources and everything under /oic, such as the security and keepalive resources.
+ * Their handlers share state with OCProcess() and the security manager, so they are
+ * always handled on the thread that receives the request.
+ */
+static bool IsStackResourceRequest(const CARequestInfo_t *requestInfo)
+{
+    const char *uri = requestInfo->info.resourceUri;
+    if (!uri)
+    {
+        return true;
+    }
+
+    char path[MAX_URI_LENGTH] = { 0 };
+    size_t length = strcspn(uri, "?");
+    if (length >= sizeof(path))
+    {
+        // Not a stack resource, and rejected by OCHandleRequests() anyway.
+        return false;
+    }
+    memcpy(path, uri, length);
+
+    return (0 == strncmp(path, "/oic/", strlen("/oic/")))
+           || (OC_UNKNOWN_URI != GetTypeOfVirtualURI(path))
+           || SRMIsSecurityResourceURI(path);
+}
+
 //This function will be called back by CA layer when a request is received
 void HandleCARequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* requestInfo)
 {
@@ -2628,8 +2686,12 @@ void HandleCARequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
 #endif
 #endif
     {
-        // Normal handling of the packet
-        OCHandleRequests(endPoint, requestInfo);
+        // Normal handling of the packet, on the worker owning the resource if there are any
+        if (!OCRequestDispatchIsEnabled() || IsStackResourceRequest(requestInfo) ||
+            OC_STACK_OK != OCRequestDispatchSubmit(endPoint, requestInfo))
+        {
+            OCHandleRequests(endPoint, requestInfo);
+        }
     }
     OIC_LOG(INFO, TAG, "Exit HandleCARequests");
     OIC_TRACE_END();
@@ -2766,6 +2828,12 @@ OCStackResult OCInitializeInternal(OCMode mode, OCTransportFlags serverFlags,
     result = InitializeScheduleResourceList();
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
+    if (g_requestWorkerCount)
+    {
+        result = OCRequestDispatchInitialize(g_requestWorkerCount, OCHandleRequests);
+        VERIFY_SUCCESS(result, OC_STACK_OK);
+    }
+
     result = CAResultToOCResult(CAInitialize((CATransportAdapter_t)transportType));
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
@@ -2846,9 +2914,11 @@ exit:
     if(result != OC_STACK_OK)
     {
         OIC_LOG(ERROR, TAG, "Stack initialization error");
+        OCRequestDispatchStop();
         TerminateScheduleResourceList();
         deleteAllResources();
         CATerminate();
+        OCRequestDispatchTerminate();
         stackState = OC_STACK_UNINITIALIZED;
     }
     return result;
@@ -2914,6 +2984,8 @@ OCStackResult OCDeInitializeInternal()
         OIC_LOG(ERROR, TAG, "CAUnregisterNetworkMonitorHandler has failed");
     }
 
+    // Stop the request workers before the structures they use are freed
+    OCRequestDispatchStop();
     TerminateScheduleResourceList();
     // Remove all observers
     DeleteObserverList();
@@ -2923,6 +2995,8 @@ OCStackResult OCDeInitializeInternal()
     DeleteClientCBList();
     // Terminate connectivity-abstraction layer.
     CATerminate();
+    OCRequestDispatchTerminate();
+    FreeServerResponseBuffer();
 
 #if defined(TCP_ADAPTER) && defined(WITH_CLOUD)
     // Terminate the Connection Manager
@@ -3951,6 +4025,48 @@ exit:
 
     return result;
 }
+
+/**
+ * Time until OCProcessPresence() has a presence request to send or a callback to notify.
+ *
+ * @param maxTimeout     upper bound of the result in milliseconds.
+ * @return milliseconds until the next call of OCProcessPresence() is due.
+ */
+static uint32_t GetPresenceTimeout(uint32_t maxTimeout)
+{
+    uint32_t timeout = maxTimeout;
+    uint32_t now = GetTicks(0);
+    ClientCB* cbNode = NULL;
+
+    LL_FOREACH(g_cbList, cbNode)
+    {
+        if (OC_REST_PRESENCE != cbNode->method || !cbNode->presence)
+        {
+            continue;
+        }
+
+        if (cbNode->presence->TTLlevel > PresenceTimeOutSize)
+        {
+            // OCProcessPresence() stops at this node.
+            break;
+        }
+
+        if (cbNode->presence->TTLlevel == PresenceTimeOutSize ||
+            now >= cbNode->presence->timeOut[cbNode->presence->TTLlevel])
+        {
+            return 0;
+        }
+
+        uint64_t remaining = ((uint64_t)(cbNode->presence->timeOut[cbNode->presence->TTLlevel] -
+                               now) * MILLISECONDS_PER_SECOND + COAP_TICKS_PER_SECOND - 1) /
+                             COAP_TICKS_PER_SECOND;
+        if (remaining < timeout)
+        {
+            timeout = (uint32_t)remaining;
+        }
+    }
+    return timeout;
+}
 #endif // WITH_PRESENCE
 
 OCStackResult OC_CALL OCProcess()
@@ -3963,6 +4079,7 @@ OCStackResult OC_CALL OCProcess()
 #ifdef WITH_PRESENCE
     OCProcessPresence();
 #endif
+    DeleteTimedOutClientCB();
     CAHandleRequestResponse();
 
 #ifdef ROUTING_GATEWAY
@@ -3975,6 +4092,74 @@ OCStackResult OC_CALL OCProcess()
     return OC_STACK_OK;
 }
 
+uint32_t OC_CALL OCGetProcessTimeout()
+{
+    if (stackState == OC_STACK_UNINITIALIZED)
+    {
+        return 0;
+    }
+
+    // the routing manager timers are in seconds and are covered by the upper bound.
+    uint32_t timeout = GetClientCBTimeout(MAX_PROCESS_TIMEOUT_MS);
+#ifdef WITH_PRESENCE
+    timeout = GetPresenceTimeout(timeout);
+#endif
+#ifdef TCP_ADAPTER
+    timeout = GetKeepAliveTimeout(timeout);
+#endif
+
+    // a deadline that already passed is one OCProcess could not handle, retry it later.
+    return (0 == timeout) ? RETRY_PROCESS_TIMEOUT_MS : timeout;
+}
+
+OCStackResult OC_CALL OCProcessWait(uint32_t timeout)
+{
+    if (stackState == OC_STACK_UNINITIALIZED)
+    {
+        OIC_LOG(ERROR, TAG, "OCProcessWait has failed. ocstack is not initialized");
+        return OC_STACK_ERROR;
+    }
+
+    CAResult_t result = CAWaitRequestResponse(timeout);
+    if (CA_NOT_SUPPORTED == result)
+    {
+        return OC_STACK_NOTIMPL;
+    }
+    return CAResultToOCResult(result);
+}
+
+OCStackResult OC_CALL OCProcessWakeUp()
+{
+    if (stackState == OC_STACK_UNINITIALIZED)
+    {
+        return OC_STACK_ERROR;
+    }
+
+    CAResult_t result = CAWakeUpRequestResponse();
+    if (CA_NOT_SUPPORTED == result)
+    {
+        return OC_STACK_NOTIMPL;
+    }
+    return CAResultToOCResult(result);
+}
+
+OCStackResult OC_CALL OCSetRequestWorkerCount(uint8_t workerCount)
+{
+    if (workerCount > OC_MAX_REQUEST_WORKERS)
+    {
+        OIC_LOG_V(ERROR, TAG, "At most %d request workers are supported", OC_MAX_REQUEST_WORKERS);
+        return OC_STACK_INVALID_PARAM;
+    }
+    if (stackState == OC_STACK_INITIALIZED)
+    {
+        OIC_LOG(ERROR, TAG, "Request workers must be set before OCInit");
+        return OC_STACK_ERROR;
+    }
+
+    g_requestWorkerCount = workerCount;
+    return OC_STACK_OK;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult OC_CALL OCStartPresence(const uint32_t ttl)
 {
@@ -4169,22 +4354,16 @@ OCStackResult OC_CALL OCCreateResourceWithEp(OCResourceHandle *handle,
         return OC_STACK_INVALID_PARAM;
     }
 
-    // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
-    if (pointer)
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+
+    // Repeated URLs are not allowed.  If a repeat is found, exit with an error
+    if (OCResourceIndexFindByUri(uri))
     {
-        // At least one resources is in the resource list, so we need to search for
-        // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
-        while (pointer)
-        {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-            {
-                OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
-                return OC_STACK_INVALID_PARAM;
-            }
-            pointer = pointer->next;
-        }
+        OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+        return OC_STACK_INVALID_PARAM;
     }
+
     // Create the pointer and insert it into the resource list
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
     if (!pointer)
@@ -4194,14 +4373,22 @@ OCStackResult OC_CALL OCCreateResourceWithEp(OCResourceHandle *handle,
     }
     pointer->sequenceNum = OC_OFFSET_SEQUENCE_NUMBER;
 
-    insertResource(pointer);
-
     // Set the uri
     pointer->uri = OICStrdup(uri);
     if (!pointer->uri)
     {
-        result = OC_STACK_NO_MEMORY;
-        goto exit;
+        OICFree(pointer);
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    result = insertResource(pointer);
+    if (result != OC_STACK_OK)
+    {
+        OICFree(pointer->uri);
+        OICFree(pointer);
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+        return result;
     }
 
     // Set resource to nonsecure if caller did not specify
@@ -4269,6 +4456,7 @@ exit:
         // Deep delete of resource and other dynamic elements that it contains
         deleteResource(pointer);
     }
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
     return result;
 }
 
@@ -4291,17 +4479,31 @@ OCStackResult OC_CALL OCBindResource(
         return OC_STACK_INVALID_PARAM;
     }
 
+    // Do memory allocation for child resource
+    newChildResource = (OCChildResource *) OICCalloc(1, sizeof(OCChildResource));
+    if(!newChildResource)
+    {
+        OIC_LOG(ERROR, TAG, "Adding new child resource is failed due to memory allocation failure");
+        return OC_STACK_ERROR;
+    }
+
+    newChildResource->rsrcResource = (OCResource *) resourceHandle;
+    newChildResource->next = NULL;
+
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+
     // Use the handle to find the resource in the resource linked list
     resource = findResource((OCResource *) collectionHandle);
     if (!resource)
     {
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
         OIC_LOG(ERROR, TAG, "Collection handle not found");
+        OICFree(newChildResource);
         return OC_STACK_INVALID_PARAM;
     }
 
     // Look for an open slot to add add the child resource.
     // If found, add it and return success
-
     tempChildResource = resource->rsrcChildResourcesHead;
 
     while(resource->rsrcChildResourcesHead && tempChildResource->next)
@@ -4310,17 +4512,6 @@ OCStackResult OC_CALL OCBindResource(
         tempChildResource = tempChildResource->next;
     }
 
-    // Do memory allocation for child resource
-    newChildResource = (OCChildResource *) OICCalloc(1, sizeof(OCChildResource));
-    if(!newChildResource)
-    {
-        OIC_LOG(ERROR, TAG, "Adding new child resource is failed due to memory allocation failure");
-        return OC_STACK_ERROR;
-    }
-
-    newChildResource->rsrcResource = (OCResource *) resourceHandle;
-    newChildResource->next = NULL;
-
     if(!resource->rsrcChildResourcesHead)
     {
         resource->rsrcChildResourcesHead = newChildResource;
@@ -4329,6 +4520,8 @@ OCStackResult OC_CALL OCBindResource(
         tempChildResource->next = newChildResource;
     }
 
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+
     OIC_LOG(INFO, TAG, "resource bound");
 
 #ifdef WITH_PRESENCE
@@ -4362,10 +4555,13 @@ OCStackResult OC_CALL OCUnBindResource(
         return OC_STACK_INVALID_PARAM;
     }
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+
     // Use the handle to find the resource in the resource linked list
     resource = findResource((OCResource *) collectionHandle);
     if (!resource)
     {
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
         OIC_LOG(ERROR, TAG, "Collection handle not found");
         return OC_STACK_INVALID_PARAM;
     }
@@ -4375,6 +4571,7 @@ OCStackResult OC_CALL OCUnBindResource(
     if(!resource->rsrcChildResourcesHead)
     {
         OIC_LOG(INFO, TAG, "resource not found in collection");
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
         // Unable to add resourceHandle, so return error
         return OC_STACK_ERROR;
@@ -4407,6 +4604,7 @@ OCStackResult OC_CALL OCUnBindResource(
             }
 
             OIC_LOG(INFO, TAG, "resource unbound");
+            OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
             // Send notification when resource is unbounded successfully.
 #ifdef WITH_PRESENCE
@@ -4429,6 +4627,7 @@ OCStackResult OC_CALL OCUnBindResource(
     }
 
     OIC_LOG(INFO, TAG, "resource not found in collection");
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
     tempChildResource = NULL;
     tempLastChildResource = NULL;
@@ -4508,8 +4707,9 @@ OCStackResult BindResourceTypeToResource(OCResource* resource,
     pointer->resourcetypename = str;
     pointer->next = NULL;
 
-    insertResourceType(resource, pointer);
-    result = OC_STACK_OK;
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    result = insertResourceType(resource, pointer);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
 exit:
     if (result != OC_STACK_OK)
@@ -4554,9 +4754,9 @@ OCStackResult BindResourceInterfaceToResource(OCResource* resource,
     pointer->name = str;
 
     // Bind the resourceinterface to the resource
-    insertResourceInterface(resource, pointer);
-
-    result = OC_STACK_OK;
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    result = insertResourceInterface(resource, pointer);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
     exit:
     if (result != OC_STACK_OK)
@@ -4606,14 +4806,17 @@ OCStackResult OC_CALL OCBindResourceTypeToResource(OCResourceHandle handle,
     OCStackResult result = OC_STACK_ERROR;
     OCResource *resource = NULL;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) handle);
     if (!resource)
     {
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
         OIC_LOG(ERROR, TAG, "Resource not found");
         return OC_STACK_ERROR;
     }
 
     result = BindResourceTypeToResource(resource, resourceTypeName);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
 #ifdef WITH_PRESENCE
     if(presenceResource.handle)
@@ -4633,14 +4836,17 @@ OCStackResult OC_CALL OCBindResourceInterfaceToResource(OCResourceHandle handle,
     OCStackResult result = OC_STACK_ERROR;
     OCResource *resource = NULL;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) handle);
     if (!resource)
     {
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
         OIC_LOG(ERROR, TAG, "Resource not found");
         return OC_STACK_ERROR;
     }
 
     result = BindResourceInterfaceToResource(resource, resourceInterfaceName);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
 #ifdef WITH_PRESENCE
     if (presenceResource.handle)
@@ -4655,27 +4861,26 @@ OCStackResult OC_CALL OCBindResourceInterfaceToResource(OCResourceHandle handle,
 
 OCStackResult OC_CALL OCGetNumberOfResources(uint8_t *numResources)
 {
-    OCResource *pointer = headResource;
-
     VERIFY_NON_NULL(numResources, ERROR, OC_STACK_INVALID_PARAM);
-    *numResources = 0;
-    while (pointer)
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    size_t count = OCResourceIndexGetCount();
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    if (count > UINT8_MAX)
     {
-        *numResources = *numResources + 1;
-        pointer = pointer->next;
+        // OCGetResourceHandle() takes an 8 bit index.
+        OIC_LOG_V(WARNING, TAG, "%" PRIuPTR " resources, reporting %u", count, UINT8_MAX);
+        count = UINT8_MAX;
     }
+    *numResources = (uint8_t) count;
     return OC_STACK_OK;
 }
 
 OCResourceHandle OC_CALL OCGetResourceHandle(uint8_t index)
 {
-    OCResource *pointer = headResource;
-
-    for( uint8_t i = 0; i < index && pointer; ++i)
-    {
-        pointer = pointer->next;
-    }
-    return (OCResourceHandle) pointer;
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    OCResourceHandle handle = (OCResourceHandle) OCResourceIndexGetAt(index);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    return handle;
 }
 
 OCStackResult OC_CALL OCDeleteResource(OCResourceHandle handle)
@@ -4686,14 +4891,25 @@ OCStackResult OC_CALL OCDeleteResource(OCResourceHandle handle)
         return OC_STACK_INVALID_PARAM;
     }
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     OCResource *resource = findResource((OCResource *) handle);
+    char *uri = resource ? OICStrdup(resource->uri) : NULL;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
     if (resource == NULL)
     {
         OIC_LOG(ERROR, TAG, "Resource not found");
         return OC_STACK_NO_RESOURCE;
     }
 
-    if (deleteResource((OCResource *) handle) != OC_STACK_OK)
+    // Wait for the request worker that may be using the resource.
+    OCRequestDispatchPauseResource(uri);
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    OCStackResult result = deleteResource((OCResource *) handle);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    OCRequestDispatchResumeResource(uri);
+    OICFree(uri);
+
+    if (result != OC_STACK_OK)
     {
         OIC_LOG(ERROR, TAG, "Error deleting resource");
         return OC_STACK_ERROR;
@@ -4706,37 +4922,39 @@ const char *OC_CALL OCGetResourceUri(OCResourceHandle handle)
 {
     OCResource *resource = NULL;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) handle);
-    if (resource)
-    {
-        return resource->uri;
-    }
-    return (const char *) NULL;
+    const char *uri = resource ? resource->uri : NULL;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    return uri;
 }
 
 OCResourceProperty OC_CALL OCGetResourceProperties(OCResourceHandle handle)
 {
     OCResource *resource = NULL;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) handle);
-    if (resource)
-    {
-        return resource->resourceProperties;
-    }
-    return (OCResourceProperty)-1;
+    OCResourceProperty properties = resource ? resource->resourceProperties
+                                             : (OCResourceProperty)-1;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    return properties;
 }
 
 OCStackResult OC_CALL OCSetResourceProperties(OCResourceHandle handle, uint8_t resourceProperties)
 {
     OCResource *resource = NULL;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) handle);
     if (resource == NULL)
     {
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
         OIC_LOG(ERROR, TAG, "Resource not found");
         return OC_STACK_NO_RESOURCE;
     }
     resource->resourceProperties = (OCResourceProperty) (resource->resourceProperties | resourceProperties);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
     return OC_STACK_OK;
 }
 
@@ -4744,13 +4962,16 @@ OCStackResult OC_CALL OCClearResourceProperties(OCResourceHandle handle, uint8_t
 {
     OCResource *resource = NULL;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) handle);
     if (resource == NULL)
     {
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
         OIC_LOG(ERROR, TAG, "Resource not found");
         return OC_STACK_NO_RESOURCE;
     }
     resource->resourceProperties = (OCResourceProperty) (resource->resourceProperties & ~resourceProperties);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
     return OC_STACK_OK;
 }
 
@@ -4765,6 +4986,7 @@ OCStackResult OC_CALL OCGetNumberOfResourceTypes(OCResourceHandle handle,
 
     *numResourceTypes = 0;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) handle);
     if (resource)
     {
@@ -4775,6 +4997,7 @@ OCStackResult OC_CALL OCGetNumberOfResourceTypes(OCResourceHandle handle,
             pointer = pointer->next;
         }
     }
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
     return OC_STACK_OK;
 }
 
@@ -4782,12 +5005,11 @@ const char *OC_CALL OCGetResourceTypeName(OCResourceHandle handle, uint8_t index
 {
     OCResourceType *resourceType = NULL;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resourceType = findResourceTypeAtIndex(handle, index);
-    if (resourceType)
-    {
-        return resourceType->resourcetypename;
-    }
-    return (const char *) NULL;
+    const char *name = resourceType ? resourceType->resourcetypename : NULL;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    return name;
 }
 
 OCStackResult OC_CALL OCGetNumberOfResourceInterfaces(OCResourceHandle handle,
@@ -4800,6 +5022,7 @@ OCStackResult OC_CALL OCGetNumberOfResourceInterfaces(OCResourceHandle handle,
     VERIFY_NON_NULL(numResourceInterfaces, ERROR, OC_STACK_INVALID_PARAM);
 
     *numResourceInterfaces = 0;
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) handle);
     if (resource)
     {
@@ -4810,6 +5033,7 @@ OCStackResult OC_CALL OCGetNumberOfResourceInterfaces(OCResourceHandle handle,
             pointer = pointer->next;
         }
     }
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
     return OC_STACK_OK;
 }
 
@@ -4817,12 +5041,11 @@ const char *OC_CALL OCGetResourceInterfaceName(OCResourceHandle handle, uint8_t
 {
     OCResourceInterface *resourceInterface = NULL;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resourceInterface = findResourceInterfaceAtIndex(handle, index);
-    if (resourceInterface)
-    {
-        return resourceInterface->name;
-    }
-    return (const char *) NULL;
+    const char *name = resourceInterface ? resourceInterface->name : NULL;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    return name;
 }
 
 OCResourceHandle OC_CALL OCGetResourceHandleFromCollection(OCResourceHandle collectionHandle,
@@ -4832,9 +5055,11 @@ OCResourceHandle OC_CALL OCGetResourceHandleFromCollection(OCResourceHandle coll
     OCChildResource *tempChildResource = NULL;
     uint8_t num = 0;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) collectionHandle);
     if (!resource)
     {
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
         return NULL;
     }
 
@@ -4844,11 +5069,14 @@ OCResourceHandle OC_CALL OCGetResourceHandleFromCollection(OCResourceHandle coll
     {
         if( num == index )
         {
-            return tempChildResource->rsrcResource;
+            OCResourceHandle child = tempChildResource->rsrcResource;
+            OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+            return child;
         }
         num++;
         tempChildResource = tempChildResource->next;
     }
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
     // In this case, the number of resource handles in the collection exceeds the index
     tempChildResource = NULL;
@@ -4864,10 +5092,13 @@ OCStackResult OC_CALL OCBindResourceHandler(OCResourceHandle handle,
     // Validate parameters
     VERIFY_NON_NULL(handle, ERROR, OC_STACK_INVALID_PARAM);
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+
     // Use the handle to find the resource in the resource linked list
     resource = findResource((OCResource *)handle);
     if (!resource)
     {
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
         OIC_LOG(ERROR, TAG, "Resource not found");
         return OC_STACK_ERROR;
     }
@@ -4875,6 +5106,7 @@ OCStackResult OC_CALL OCBindResourceHandler(OCResourceHandle handle,
     // Bind the handler
     resource->entityHandler = entityHandler;
     resource->entityHandlerCallbackParam = callbackParam;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
 #ifdef WITH_PRESENCE
     if (presenceResource.handle)
@@ -4891,15 +5123,15 @@ OCEntityHandler OC_CALL OCGetResourceHandler(OCResourceHandle handle)
 {
     OCResource *resource = NULL;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *)handle);
+    OCEntityHandler entityHandler = resource ? resource->entityHandler : NULL;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
     if (!resource)
     {
         OIC_LOG(ERROR, TAG, "Resource not found");
-        return NULL;
     }
-
-    // Bind the handler
-    return resource->entityHandler;
+    return entityHandler;
 }
 
 void incrementSequenceNumber(OCResource * resPtr)
@@ -5283,8 +5515,15 @@ OCStackResult initResources()
     return result;
 }
 
-void insertResource(OCResource *resource)
+OCStackResult insertResource(OCResource *resource)
 {
+    OCStackResult result = OCResourceIndexAdd(resource);
+    if (result != OC_STACK_OK)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to index resource %s", resource->uri);
+        return result;
+    }
+
     if (!headResource)
     {
         headResource = resource;
@@ -5296,21 +5535,15 @@ void insertResource(OCResource *resource)
         tailResource = resource;
     }
     resource->next = NULL;
+    return OC_STACK_OK;
 }
 
 OCResource *findResource(OCResource *resource)
 {
-    OCResource *pointer = headResource;
-
-    while (pointer)
-    {
-        if (pointer == resource)
-        {
-            return resource;
-        }
-        pointer = pointer->next;
-    }
-    return NULL;
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    bool found = OCResourceIndexContains(resource);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    return found ? resource : NULL;
 }
 
 void deleteAllResources()
@@ -5346,6 +5579,7 @@ void deleteAllResources()
     deleteResource((OCResource *) presenceResource.handle);
     memset(&presenceResource, 0, sizeof(presenceResource));
 #endif // WITH_PRESENCE
+    OCResourceIndexTerminate();
 }
 
 OCStackResult deleteResource(OCResource *resource)
@@ -5360,6 +5594,11 @@ OCStackResult deleteResource(OCResource *resource)
 
     OIC_LOG_V (INFO, TAG, "Deleting resource %s", resource->uri);
 
+    if (!OCResourceIndexContains(resource))
+    {
+        return OC_STACK_ERROR;
+    }
+
     temp = headResource;
     while (temp)
     {
@@ -5403,6 +5642,8 @@ OCStackResult deleteResource(OCResource *resource)
                 prev->next = temp->next;
             }
 
+            DeleteObserversUsingResource(temp);
+            OCResourceIndexRemove(temp);
             deleteResourceElements(temp);
             OICFree(temp);
             temp = NULL;
@@ -5498,13 +5739,13 @@ void OCDeleteResourceAttributes(OCAttribute *rsrcAttributes)
     }
 }
 
-void insertResourceType(OCResource *resource, OCResourceType *resourceType)
+OCStackResult insertResourceType(OCResource *resource, OCResourceType *resourceType)
 {
     OCResourceType *pointer = NULL;
     OCResourceType *previous = NULL;
     if (!resource || !resourceType)
     {
-        return;
+        return OC_STACK_INVALID_PARAM;
     }
     // resource type list is empty.
     else if (!resource->rsrcType)
@@ -5522,7 +5763,7 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
                 OIC_LOG_V(INFO, TAG, "Type %s already exists", resourceType->resourcetypename);
                 OICFree(resourceType->resourcetypename);
                 OICFree(resourceType);
-                return;
+                return OC_STACK_OK;
             }
             previous = pointer;
             pointer = pointer->next;
@@ -5535,7 +5776,22 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
     }
     resourceType->next = NULL;
 
+    if (OCResourceIndexAddType(resource, resourceType->resourcetypename) != OC_STACK_OK)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to index type %s", resourceType->resourcetypename);
+        if (previous)
+        {
+            previous->next = NULL;
+        }
+        else
+        {
+            resource->rsrcType = NULL;
+        }
+        return OC_STACK_NO_MEMORY;
+    }
+
     OIC_LOG_V(INFO, TAG, "Added type %s to %s", resourceType->resourcetypename, resource->uri);
+    return OC_STACK_OK;
 }
 
 OCResourceType *findResourceTypeAtIndex(OCResourceHandle handle, uint8_t index)
@@ -5591,7 +5847,7 @@ OCResourceType *findResourceType(OCResourceType * resourceTypeList, const char *
  * If alredy present, 2nd arg is free'd.
  * Default interface will always be first if present.
  */
-void insertResourceInterface(OCResource *resource, OCResourceInterface *newInterface)
+OCStackResult insertResourceInterface(OCResource *resource, OCResourceInterface *newInterface)
 {
     OCResourceInterface *pointer = NULL;
     OCResourceInterface *previous = NULL;
@@ -5613,9 +5869,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
                                                                     OC_RSRVD_INTERFACE_DEFAULT);
             if (result != OC_STACK_OK)
             {
-                OICFree(newInterface->name);
-                OICFree(newInterface);
-                return;
+                return result;
             }
             if (*firstInterface)
             {
@@ -5630,7 +5884,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
         {
             OICFree(newInterface->name);
             OICFree(newInterface);
-            return;
+            return OC_STACK_OK;
         }
         // This code will not hit anymore, keeping
         else
@@ -5648,7 +5902,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
             {
                 OICFree(newInterface->name);
                 OICFree(newInterface);
-                return;
+                return OC_STACK_OK;
             }
             previous = pointer;
             pointer = pointer->next;
@@ -5659,6 +5913,21 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
             previous->next = newInterface;
         }
     }
+
+    if (OCResourceIndexAddInterface(resource, newInterface->name) != OC_STACK_OK)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to index interface %s", newInterface->name);
+        for (OCResourceInterface **link = firstInterface; *link; link = &((*link)->next))
+        {
+            if (*link == newInterface)
+            {
+                *link = newInterface->next;
+                break;
+            }
+        }
+        return OC_STACK_NO_MEMORY;
+    }
+    return OC_STACK_OK;
 }
 
 OCResourceInterface *findResourceInterfaceAtIndex(OCResourceHandle handle,
@@ -5907,14 +6176,17 @@ OCStackResult OC_CALL OCBindResourceInsToResource(OCResourceHandle handle, int64
 
     OCResource *resource = NULL;
 
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) handle);
     if (!resource)
     {
+        OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
         OIC_LOG(ERROR, TAG, "Resource not found");
         return OC_STACK_ERROR;
     }
 
     resource->ins = ins;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
 
     return OC_STACK_OK;
 }
@@ -6051,13 +6323,16 @@ OCStackResult OC_CALL OCGetResourceIns(OCResourceHandle handle, int64_t* ins)
     VERIFY_NON_NULL(handle, ERROR, OC_STACK_INVALID_PARAM);
     VERIFY_NON_NULL(ins, ERROR, OC_STACK_INVALID_PARAM);
 
+    OCStackResult result = OC_STACK_ERROR;
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
     resource = findResource((OCResource *) handle);
     if (resource)
     {
         *ins = resource->ins;
-        return OC_STACK_OK;
+        result = OC_STACK_OK;
     }
-    return OC_STACK_ERROR;
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    return result;
 }
 #endif // RD_CLIENT || RD_SERVER
 
@@ -6069,18 +6344,14 @@ OCResourceHandle OC_CALL OCGetResourceHandleAtUri(const char *uri)
         return NULL;
     }
 
-    OCResource *pointer = headResource;
-
-    while (pointer)
+    OCDispatchLockAcquire(OC_DISPATCH_LOCK_RESOURCES);
+    OCResource *pointer = OCResourceIndexFindByUri(uri);
+    OCDispatchLockRelease(OC_DISPATCH_LOCK_RESOURCES);
+    if (pointer)
     {
-        if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-        {
-            OIC_LOG_V(DEBUG, TAG, "Found Resource %s", uri);
-            return pointer;
-        }
-        pointer = pointer->next;
+        OIC_LOG_V(DEBUG, TAG, "Found Resource %s", uri);
     }
-    return NULL;
+    return pointer;
 }
 
 static OCStackResult SetHeaderOption(CAHeaderOption_t *caHdrOpt, size_t numOptions,
@@ -26,19 +26,24 @@
 #include "oic_string.h"
 #include "oic_time.h"
 #include "ocrandom.h"
-#include "uarraylist.h"
+#include <coap/uthash.h>
 #include "ocstackinternal.h"
 #include "ocpayloadcbor.h"
 #include "ocpayload.h"
 #include "ocresourcehandler.h"
 #include "logger.h"
 
+/* AddKeepAliveEntry() drops the new entry if the table cannot grow, instead of exiting. */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
+
 /**
  * Logging tag for module name.
  */
 #define TAG "OIC_RI_KEEPALIVE"
 
 static const uint64_t USECS_PER_SEC = 1000000;
+static const uint64_t USECS_PER_MSEC = 1000;
 
 //-----------------------------------------------------------------------------
 // Macros
@@ -77,6 +82,29 @@ static const uint64_t USECS_PER_SEC = 1000000;
  */
 #define DEFAULT_INTERVAL_COUNT  6
 
+/**
+ * Initial capacity of the KeepAlive deadline heap.
+ */
+#define KEEPALIVE_INITIAL_HEAP_CAPACITY 8
+
+/**
+ * Max number of ping messages sent in one ProcessKeepAlive() call.
+ * Remaining pings which are due are sent on the next call.
+ */
+#define KEEPALIVE_MAX_PINGS_PER_PROCESS 16
+
+/**
+ * Upper bound of the random offset by which a ping message is sent early,
+ * so that the pings to many remote endpoints are not synchronized. (10 seconds)
+ * The offset never exceeds a tenth of the ping interval.
+ */
+#define KEEPALIVE_MAX_JITTER_SEC 10
+
+/**
+ * Delay before retrying a ping message which could not be sent. (1 second)
+ */
+#define KEEPALIVE_RETRY_DELAY_SEC 1
+
 /**
  * KeepAlive key to parser Payload Table.
  */
@@ -98,15 +126,20 @@ static bool g_isKeepAliveInitialized = false;
 static OCResourceHandle g_keepAliveHandle = NULL;
 
 /**
- * KeepAlive table which holds connection interval.
+ * KeepAlive table key. remote endpoints are matched by address and port.
  */
-static u_arraylist_t *g_keepAliveConnectionTable = NULL;
+typedef struct
+{
+    char addr[MAX_ADDR_STR_SIZE_CA];    /**< remote address. */
+    uint16_t port;                      /**< remote port. */
+} KeepAliveKey_t;
 
 /**
  * KeepAlive table entries.
  */
 typedef struct
 {
+    KeepAliveKey_t key;             /**< hash key of remoteAddr. */
     OCMode mode;                    /**< host Mode of Operation. */
     CAEndpoint_t remoteAddr;        /**< destination Address. */
     int64_t interval;              /**< time interval for KeepAlive. in seconds.*/
@@ -115,8 +148,23 @@ typedef struct
     int64_t *intervalInfo;          /**< interval values for KeepAlive. */
     bool sentPingMsg;               /**< if oic client already sent ping message. */
     uint64_t timeStamp;             /**< last sent or received ping message. in microseconds. */
+    uint64_t deadline;              /**< next time the entry has to be processed. in microseconds. */
+    size_t heapIndex;               /**< position in the KeepAlive deadline heap. */
+    UT_hash_handle hh;
 } KeepAliveEntry_t;
 
+/**
+ * KeepAlive table which holds connection interval, hashed by remote endpoint.
+ */
+static KeepAliveEntry_t *g_keepAliveTable = NULL;
+
+/**
+ * KeepAlive entries ordered by deadline (binary min-heap).
+ */
+static KeepAliveEntry_t **g_keepAliveHeap = NULL;
+static size_t g_keepAliveHeapSize = 0;
+static size_t g_keepAliveHeapCapacity = 0;
+
 /**
  * Send disconnect message to remove connection.
  */
@@ -168,25 +216,21 @@ static OCEntityHandlerResult HandleKeepAliveGETRequest(OCServerRequest *request,
 static OCEntityHandlerResult HandleKeepAlivePOSTRequest(OCServerRequest *request,
                                                         const OCResource *resource);
 
-/**
- * API to handle the Response payload.
- * @param[in]   endpoint        RemoteEndpoint which sent the packet.
- * @param[in]   responseCode    Received reseponse code.
- * @param[in]   respPayload     Response payload.
- * @return  ::OC_STACK_OK or Appropriate error code.
- */
-OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
-                                      OCStackResult responseCode,
-                                      const OCRepPayload *respPayload);
 /**
  * Gets keepalive entry.
  * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
  *                          port, reference uri and transport type) to
  *                          which the ping message has to be sent.
- * @param[out]  index       index of array list.
  * @return  KeepAlive entry to send ping message.
  */
-static KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint, size_t *index);
+static KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint);
+
+/**
+ * Recalculate the deadline of keepalive entry and reorder the deadline heap.
+ * Must be called whenever timeStamp, sentPingMsg or interval of the entry changes.
+ * @param[in]   entry       KeepAlive entry.
+ */
+static void UpdateKeepAliveDeadline(KeepAliveEntry_t *entry);
 
 /**
  * Add keepalive entry.
@@ -257,17 +301,6 @@ OCStackResult InitializeKeepAlive(OCMode mode)
         }
     }
 
-    if (!g_keepAliveConnectionTable)
-    {
-        g_keepAliveConnectionTable = u_arraylist_create();
-        if (NULL == g_keepAliveConnectionTable)
-        {
-            OIC_LOG(ERROR, TAG, "Creating KeepAlive Table failed");
-            TerminateKeepAlive(mode);
-            return OC_STACK_ERROR;
-        }
-    }
-
     g_isKeepAliveInitialized = true;
 
     OIC_LOG(DEBUG, TAG, "InitializeKeepAlive OUT");
@@ -294,12 +327,20 @@ OCStackResult TerminateKeepAlive(OCMode mode)
         }
     }
 
-    if (NULL != g_keepAliveConnectionTable)
+    KeepAliveEntry_t *entry = NULL;
+    KeepAliveEntry_t *tmp = NULL;
+    HASH_ITER(hh, g_keepAliveTable, entry, tmp)
     {
-        u_arraylist_destroy(g_keepAliveConnectionTable);
-        g_keepAliveConnectionTable = NULL;
+        HASH_DEL(g_keepAliveTable, entry);
+        OICFree(entry->intervalInfo);
+        OICFree(entry);
     }
 
+    OICFree(g_keepAliveHeap);
+    g_keepAliveHeap = NULL;
+    g_keepAliveHeapSize = 0;
+    g_keepAliveHeapCapacity = 0;
+
     g_isKeepAliveInitialized = false;
 
     OIC_LOG(DEBUG, TAG, "TerminateKeepAlive OUT");
@@ -405,8 +446,7 @@ OCStackResult SendKeepAliveResponse(OCServerRequest *request,
     CAEndpoint_t endpoint = {.adapter = CA_DEFAULT_ADAPTER};
     CopyDevAddrToEndpoint(&request->devAddr, &endpoint);
 
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint);
     int64_t interval = (entry) ? entry->interval : 0;
 
     // Create KeepAlive payload to send response message.
@@ -457,8 +497,7 @@ OCEntityHandlerResult HandleKeepAlivePOSTRequest(OCServerRequest *request,
     CAEndpoint_t endpoint = { .adapter = CA_DEFAULT_ADAPTER };
     CopyDevAddrToEndpoint(&request->devAddr, &endpoint);
 
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint);
     if (!entry)
     {
         OIC_LOG(ERROR, TAG, "Received the first keepalive message from client");
@@ -480,6 +519,7 @@ OCEntityHandlerResult HandleKeepAlivePOSTRequest(OCServerRequest *request,
     entry->interval = interval;
     OIC_LOG_V(DEBUG, TAG, "Received interval is [%" PRId64 "]", entry->interval);
     entry->timeStamp = OICGetCurrentTime(TIME_IN_US);
+    UpdateKeepAliveDeadline(entry);
 
     OCPayloadDestroy(ocPayload);
 
@@ -495,8 +535,7 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
     OIC_LOG(DEBUG, TAG, "HandleKeepAliveResponse IN");
 
     // Get entry from KeepAlive table.
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endPoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endPoint);
     if (!entry)
     {
         // Receive response message about find /oic/ping request.
@@ -535,6 +574,7 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
     {
         // Set sentPingMsg values with false.
         entry->sentPingMsg = false;
+        UpdateKeepAliveDeadline(entry);
 
         // Check the received interval value.
         int64_t interval = 0;
@@ -546,6 +586,137 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
     return OC_STACK_OK;
 }
 
+static void KeepAliveHeapSwap(size_t i, size_t j)
+{
+    KeepAliveEntry_t *tmp = g_keepAliveHeap[i];
+    g_keepAliveHeap[i] = g_keepAliveHeap[j];
+    g_keepAliveHeap[j] = tmp;
+    g_keepAliveHeap[i]->heapIndex = i;
+    g_keepAliveHeap[j]->heapIndex = j;
+}
+
+static void KeepAliveHeapSiftUp(size_t index)
+{
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+        if (g_keepAliveHeap[parent]->deadline <= g_keepAliveHeap[index]->deadline)
+        {
+            break;
+        }
+        KeepAliveHeapSwap(parent, index);
+        index = parent;
+    }
+}
+
+static void KeepAliveHeapSiftDown(size_t index)
+{
+    for (;;)
+    {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+
+        if (left < g_keepAliveHeapSize
+            && g_keepAliveHeap[left]->deadline < g_keepAliveHeap[smallest]->deadline)
+        {
+            smallest = left;
+        }
+        if (right < g_keepAliveHeapSize
+            && g_keepAliveHeap[right]->deadline < g_keepAliveHeap[smallest]->deadline)
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        KeepAliveHeapSwap(index, smallest);
+        index = smallest;
+    }
+}
+
+static bool KeepAliveHeapPush(KeepAliveEntry_t *entry)
+{
+    if (g_keepAliveHeapSize == g_keepAliveHeapCapacity)
+    {
+        size_t newCapacity = g_keepAliveHeapCapacity ?
+                             (g_keepAliveHeapCapacity * 2) : KEEPALIVE_INITIAL_HEAP_CAPACITY;
+        KeepAliveEntry_t **heap = (KeepAliveEntry_t **) OICRealloc(
+                g_keepAliveHeap, newCapacity * sizeof(KeepAliveEntry_t *));
+        if (NULL == heap)
+        {
+            return false;
+        }
+        g_keepAliveHeap = heap;
+        g_keepAliveHeapCapacity = newCapacity;
+    }
+
+    entry->heapIndex = g_keepAliveHeapSize;
+    g_keepAliveHeap[g_keepAliveHeapSize++] = entry;
+    KeepAliveHeapSiftUp(entry->heapIndex);
+    return true;
+}
+
+static void KeepAliveHeapRemove(KeepAliveEntry_t *entry)
+{
+    size_t index = entry->heapIndex;
+    size_t last = --g_keepAliveHeapSize;
+
+    if (index != last)
+    {
+        KeepAliveHeapSwap(index, last);
+        KeepAliveHeapSiftUp(index);
+        KeepAliveHeapSiftDown(index);
+    }
+}
+
+static void MakeKeepAliveKey(KeepAliveKey_t *key, const CAEndpoint_t *endpoint)
+{
+    memset(key, 0, sizeof(*key));
+    OICStrcpy(key->addr, sizeof(key->addr), endpoint->addr);
+    key->port = endpoint->port;
+}
+
+void UpdateKeepAliveDeadline(KeepAliveEntry_t *entry)
+{
+    VERIFY_NON_NULL_NR(entry, FATAL);
+
+    uint64_t period = KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC;
+    if (OC_CLIENT == entry->mode && entry->sentPingMsg)
+    {
+        // waiting for the response of the ping message.
+        entry->deadline = entry->timeStamp + period;
+    }
+    else if (OC_CLIENT == entry->mode)
+    {
+        /*
+         * Send the next ping message up to KEEPALIVE_MAX_JITTER_SEC early, so that
+         * the pings to the remote endpoints connected at the same time drift apart.
+         * Sending early never lets the server-side interval expire.
+         */
+        period *= entry->interval;
+        uint64_t maxJitter = period / 10;
+        if (maxJitter > KEEPALIVE_MAX_JITTER_SEC * USECS_PER_SEC)
+        {
+            maxJitter = KEEPALIVE_MAX_JITTER_SEC * USECS_PER_SEC;
+        }
+        uint64_t jitter = OCGetRandomRange(0, (uint32_t)(maxJitter / USECS_PER_MSEC));
+        entry->deadline = entry->timeStamp + period - jitter * USECS_PER_MSEC;
+    }
+    else if (OC_SERVER == entry->mode)
+    {
+        entry->deadline = entry->timeStamp + period * entry->interval;
+    }
+    else
+    {
+        entry->deadline = UINT64_MAX;
+    }
+
+    KeepAliveHeapSiftUp(entry->heapIndex);
+    KeepAliveHeapSiftDown(entry->heapIndex);
+}
+
 void ProcessKeepAlive()
 {
     if (!g_isKeepAliveInitialized)
@@ -554,18 +725,13 @@ void ProcessKeepAlive()
         return;
     }
 
-    size_t len = u_arraylist_length(g_keepAliveConnectionTable);
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+    size_t sentPings = 0;
 
-    for (size_t i = 0; i < len; i++)
+    // Only the entries whose deadline has passed are visited, earliest first.
+    while (0 < g_keepAliveHeapSize && g_keepAliveHeap[0]->deadline <= currentTime)
     {
-        KeepAliveEntry_t *entry = (KeepAliveEntry_t *)u_arraylist_get(g_keepAliveConnectionTable,
-                                                                      i);
-        if (NULL == entry)
-        {
-            continue;
-        }
-
-        uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+        KeepAliveEntry_t *entry = g_keepAliveHeap[0];
         if (OC_CLIENT == entry->mode)
         {
             if (entry->sentPingMsg)
@@ -575,48 +741,69 @@ void ProcessKeepAlive()
                  * terminate the connection.
                  * In this case the timeStamp means last time sent ping message.
                  */
-                if ((KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC) <= currentTime - entry->timeStamp)
-                {
-                    OIC_LOG(DEBUG, TAG, "Client does not receive the response within 1 minutes.");
+                OIC_LOG(DEBUG, TAG, "Client does not receive the response within 1 minutes.");
 
-                    // Send message to disconnect session.
-                    SendDisconnectMessage(entry);
-                }
+                // Send message to disconnect session.
+                SendDisconnectMessage(entry);
             }
             else
             {
-                if ((entry->interval * KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC)
-                        <= currentTime - entry->timeStamp)
+                if (KEEPALIVE_MAX_PINGS_PER_PROCESS <= sentPings)
                 {
-                    // Increase interval value.
-                    IncreaseInterval(entry);
-
-                    OCStackResult result = SendPingMessage(entry);
-                    if (OC_STACK_OK != result)
-                    {
-                        OIC_LOG(ERROR, TAG, "Failed to send ping request");
-                        continue;
-                    }
+                    // The remaining pings are still due and are sent on the next call.
+                    OIC_LOG(DEBUG, TAG, "Ping messages are deferred to the next process");
+                    break;
+                }
+                sentPings++;
+
+                // Increase interval value.
+                IncreaseInterval(entry);
+
+                OCStackResult result = SendPingMessage(entry);
+                if (OC_STACK_OK != result)
+                {
+                    OIC_LOG(ERROR, TAG, "Failed to send ping request");
+                    entry->deadline = currentTime + KEEPALIVE_RETRY_DELAY_SEC * USECS_PER_SEC;
+                    KeepAliveHeapSiftDown(entry->heapIndex);
                 }
             }
         }
-        else if (OC_SERVER == entry->mode)
+        else
         {
             /*
              * If an OIC Server does not receive a PUT request to ping resource
              * within the specified interval time, terminate the connection.
              * In this case the timeStamp means last time received ping message.
              */
-            if ((entry->interval * KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC)
-                    <= currentTime - entry->timeStamp)
-            {
-                OIC_LOG(DEBUG, TAG, "Server does not receive a PUT request.");
-                SendDisconnectMessage(entry);
-            }
+            OIC_LOG(DEBUG, TAG, "Server does not receive a PUT request.");
+            SendDisconnectMessage(entry);
         }
     }
 }
 
+uint32_t GetKeepAliveTimeout(uint32_t maxTimeout)
+{
+    if (!g_isKeepAliveInitialized || 0 == g_keepAliveHeapSize)
+    {
+        return maxTimeout;
+    }
+
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+    uint64_t deadline = g_keepAliveHeap[0]->deadline;
+    if (deadline <= currentTime)
+    {
+        return 0;
+    }
+
+    uint64_t timeout = (uint64_t)maxTimeout * USECS_PER_MSEC;
+    if (deadline - currentTime < timeout)
+    {
+        timeout = deadline - currentTime;
+    }
+
+    return (uint32_t)((timeout + USECS_PER_MSEC - 1) / USECS_PER_MSEC);
+}
+
 void IncreaseInterval(KeepAliveEntry_t *entry)
 {
     VERIFY_NON_NULL_NR(entry, FATAL);
@@ -639,14 +826,16 @@ OCStackResult SendDisconnectMessage(const KeepAliveEntry_t *entry)
      * If CA get the empty message from RI, CA will disconnect a connection.
      */
 
-    OCStackResult result = RemoveKeepAliveEntry(&entry->remoteAddr);
+    // The entry is freed by RemoveKeepAliveEntry.
+    CAEndpoint_t remoteAddr = entry->remoteAddr;
+    OCStackResult result = RemoveKeepAliveEntry(&remoteAddr);
     if (result != OC_STACK_OK)
     {
         return result;
     }
 
     CARequestInfo_t requestInfo = { .method = CA_POST };
-    result = CASendRequest(&entry->remoteAddr, &requestInfo);
+    result = CASendRequest(&remoteAddr, &requestInfo);
     return CAResultToOCResult(result);
 }
 
@@ -672,6 +861,7 @@ OCStackResult SendPingMessage(KeepAliveEntry_t *entry)
     // Update timeStamp with time sent ping message for next ping message.
     entry->timeStamp = OICGetCurrentTime(TIME_IN_US);
     entry->sentPingMsg = true;
+    UpdateKeepAliveDeadline(entry);
 
     OIC_LOG_V(DEBUG, TAG, "Client sent ping message, interval [%" PRId64 "]", entry->interval);
 
@@ -698,35 +888,19 @@ OCStackApplicationResult PingRequestCallback(void* ctx, OCDoHandle handle,
     return OC_STACK_DELETE_TRANSACTION;
 }
 
-KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint, size_t *index)
+KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint)
 {
-    if (!g_keepAliveConnectionTable)
-    {
-        OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
-        return NULL;
-    }
-
-    size_t len = u_arraylist_length(g_keepAliveConnectionTable);
+    KeepAliveKey_t key;
+    MakeKeepAliveKey(&key, endpoint);
 
-    for (size_t i = 0; i < len; i++)
+    KeepAliveEntry_t *entry = NULL;
+    HASH_FIND(hh, g_keepAliveTable, &key, sizeof(key), entry);
+    if (entry)
     {
-        KeepAliveEntry_t *entry = (KeepAliveEntry_t *)u_arraylist_get(g_keepAliveConnectionTable,
-                                                                      i);
-        if (NULL == entry)
-        {
-            continue;
-        }
-
-        if (!strncmp(entry->remoteAddr.addr, endpoint->addr, sizeof(entry->remoteAddr.addr))
-                && (entry->remoteAddr.port == endpoint->port))
-        {
-            OIC_LOG(DEBUG, TAG, "Connection Info found in KeepAlive table");
-            *index = i;
-            return entry;
-        }
+        OIC_LOG(DEBUG, TAG, "Connection Info found in KeepAlive table");
     }
 
-    return NULL;
+    return entry;
 }
 
 KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
@@ -738,9 +912,9 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
         return NULL;
     }
 
-    if (!g_keepAliveConnectionTable)
+    if (!g_isKeepAliveInitialized)
     {
-        OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
+        OIC_LOG(ERROR, TAG, "KeepAlive not initialized");
         return NULL;
     }
 
@@ -754,11 +928,18 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
     entry->mode = mode;
     entry->timeStamp = OICGetCurrentTime(TIME_IN_US);
     entry->remoteAddr = *endpoint;
+    MakeKeepAliveKey(&entry->key, endpoint);
     entry->intervalSize = DEFAULT_INTERVAL_COUNT;
     entry->intervalInfo = intervalInfo;
     if (!entry->intervalInfo)
     {
         entry->intervalInfo = (int64_t*) OICMalloc(entry->intervalSize * sizeof(int64_t));
+        if (NULL == entry->intervalInfo)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to Malloc KeepAlive intervals");
+            OICFree(entry);
+            return NULL;
+        }
         for (size_t i = 0; i < entry->intervalSize; i++)
         {
             entry->intervalInfo[i] = KEEPALIVE_MIN_INTERVAL << i;
@@ -766,44 +947,57 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
     }
     entry->interval = entry->intervalInfo[0];
 
-    bool result = u_arraylist_add(g_keepAliveConnectionTable, (void *)entry);
-    if (!result)
+    if (!KeepAliveHeapPush(entry))
     {
-        OIC_LOG(ERROR, TAG, "Adding node to head failed");
+        OIC_LOG(ERROR, TAG, "Adding entry to deadline heap failed");
         OICFree(entry->intervalInfo);
         OICFree(entry);
         return NULL;
     }
+    UpdateKeepAliveDeadline(entry);
+    HASH_ADD(hh, g_keepAliveTable, key, sizeof(entry->key), entry);
 
     return entry;
+
+uthash_oom:
+    if (NULL == entry->hh.tbl || NULL == entry->hh.tbl->buckets)
+    {
+        // The table of the first entry could not be created.
+        uthash_free(entry->hh.tbl, sizeof(UT_hash_table));
+        g_keepAliveTable = NULL;
+    }
+    else
+    {
+        // The buckets could not be expanded, the entry was already linked in.
+        HASH_DEL(g_keepAliveTable, entry);
+    }
+    KeepAliveHeapRemove(entry);
+    OIC_LOG(ERROR, TAG, "Adding entry to keepalive table failed");
+    OICFree(entry->intervalInfo);
+    OICFree(entry);
+    return NULL;
 }
 
 OCStackResult RemoveKeepAliveEntry(const CAEndpoint_t *endpoint)
 {
     VERIFY_NON_NULL(endpoint, FATAL, OC_STACK_INVALID_PARAM);
 
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endpoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endpoint);
     if (!entry)
     {
         OIC_LOG(ERROR, TAG, "There is no entry in keepalive table.");
         return OC_STACK_ERROR;
     }
 
-    KeepAliveEntry_t *removedEntry = (KeepAliveEntry_t *)
-                                        u_arraylist_remove(g_keepAliveConnectionTable, index);
-    if (NULL == removedEntry)
-    {
-        OIC_LOG(ERROR, TAG, "Removed Entry is NULL");
-        return OC_STACK_ERROR;
-    }
+    HASH_DEL(g_keepAliveTable, entry);
+    KeepAliveHeapRemove(entry);
 
     OIC_LOG_V(DEBUG, TAG, "Remove Connection Info from KeepAlive table, "
-             "remote addr=%s port:%d", removedEntry->remoteAddr.addr,
-             removedEntry->remoteAddr.port);
+             "remote addr=%s port:%d", entry->remoteAddr.addr,
+             entry->remoteAddr.port);
 
     OICFree(entry->intervalInfo);
-    OICFree(removedEntry);
+    OICFree(entry);
 
     return OC_STACK_OK;
 }
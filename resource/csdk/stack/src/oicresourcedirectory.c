@@ -51,13 +51,13 @@ static const char *gRDPath = "RD.db";
 
 static sqlite3 *gRDDB = NULL;
 
-/* Column indices of RD_DEVICE_LINK_LIST table */
+/* Column indices of the RD_DISCOVERY_SELECT query */
 static const uint8_t ins_index = 0;
 static const uint8_t href_index = 1;
 static const uint8_t rel_index = 2;
 static const uint8_t anchor_index = 3;
 static const uint8_t bm_index = 4;
-static const uint8_t d_index = 5;
+static const uint8_t di_index = 5;
 
 /* Column indices of RD_LINK_RT table */
 static const uint8_t rt_value_index = 0;
@@ -132,24 +132,58 @@ exit:
     return result;
 }
 
-/* stmt is of form "SELECT * FROM RD_DEVICE_LINK_LIST ..." */
-static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDiscoveryPayload *discPayload)
+/*
+ * Links of the other devices, grouped by device.  The rt and if filters are IN lookups on the
+ * value indexes so every matching link is returned once.
+ */
+#define RD_DISCOVERY_SELECT \
+    "SELECT RD_DEVICE_LINK_LIST.ins,href,rel,anchor,bm,RD_DEVICE_LIST.di " \
+    "FROM RD_DEVICE_LINK_LIST " \
+    "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID " \
+    "WHERE RD_DEVICE_LIST.di<>@serverId"
+#define RD_DISCOVERY_RT \
+    " AND RD_DEVICE_LINK_LIST.ins IN (SELECT LINK_ID FROM RD_LINK_RT WHERE rt=@resourceType)"
+#define RD_DISCOVERY_IF \
+    " AND RD_DEVICE_LINK_LIST.ins IN (SELECT LINK_ID FROM RD_LINK_IF WHERE if=@interfaceType)"
+#define RD_DISCOVERY_ORDER \
+    " ORDER BY RD_DEVICE_LIST.ID,RD_DEVICE_LINK_LIST.ins"
+
+/* stmt is of form RD_DISCOVERY_SELECT ... RD_DISCOVERY_ORDER */
+static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDiscoveryPayload **discPayload)
 {
-    int res = sqlite3_step(stmt);
-    if (SQLITE_ROW != res)
-    {
-        return OC_STACK_NO_RESOURCE;
-    }
-
     OCStackResult result;
+    OCDiscoveryPayload **tail = discPayload;
     OCResourcePayload *resourcePayload = NULL;
     OCEndpointPayload *epPayload = NULL;
     sqlite3_stmt *stmtRT = NULL;
     sqlite3_stmt *stmtIF = NULL;
     sqlite3_stmt *stmtEP = NULL;
-    sqlite3_stmt *stmtDI = NULL;
-    while (SQLITE_ROW == res)
+
+    /* Prepared once and reset for each link; each is a seek on the LINK_ID index. */
+    const char rt[] = "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=@id";
+    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, rt, (int)sizeof(rt), &stmtRT, NULL));
+    const char itf[] = "SELECT if FROM RD_LINK_IF WHERE LINK_ID=@id";
+    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, itf, (int)sizeof(itf), &stmtIF, NULL));
+    const char ep[] = "SELECT ep,pri FROM RD_LINK_EP WHERE LINK_ID=@id";
+    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, ep, (int)sizeof(ep), &stmtEP, NULL));
+
+    int res;
+    while (SQLITE_ROW == (res = sqlite3_step(stmt)))
     {
+        const unsigned char *di = sqlite3_column_text(stmt, di_index);
+        if (!*tail || 0 != strcmp((*tail)->sid, (const char *)di))
+        {
+            if (*tail)
+            {
+                tail = &(*tail)->next;
+            }
+            OIC_LOG_V(DEBUG, TAG, " %s", di);
+            *tail = OCDiscoveryPayloadCreate();
+            VERIFY_NON_NULL(*tail);
+            (*tail)->sid = OICStrdup((const char *)di);
+            VERIFY_NON_NULL((*tail)->sid);
+        }
+
         resourcePayload = (OCResourcePayload *)OICCalloc(1, sizeof(OCResourcePayload));
         VERIFY_NON_NULL(resourcePayload);
 
@@ -158,8 +192,7 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDiscoveryPayloa
         const unsigned char *rel = sqlite3_column_text(stmt, rel_index);
         const unsigned char *anchor = sqlite3_column_text(stmt, anchor_index);
         sqlite3_int64 bitmap = sqlite3_column_int64(stmt, bm_index);
-        sqlite3_int64 deviceId = sqlite3_column_int64(stmt, d_index);
-        OIC_LOG_V(DEBUG, TAG, " %s %" PRId64, uri, (int64_t) deviceId);
+        OIC_LOG_V(DEBUG, TAG, " %s %" PRId64, uri, (int64_t) id);
 
         resourcePayload->uri = OICStrdup((char *)uri);
         VERIFY_NON_NULL(resourcePayload->uri)
@@ -174,9 +207,6 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDiscoveryPayloa
             VERIFY_NON_NULL(resourcePayload->anchor);
         }
 
-        const char rt[] = "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=@id";
-        int rtSize = (int)sizeof(rt);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, rt, rtSize, &stmtRT, NULL));
         VERIFY_SQLITE(sqlite3_bind_int64(stmtRT, sqlite3_bind_parameter_index(stmtRT, "@id"), id));
         while (SQLITE_ROW == sqlite3_step(stmtRT))
         {
@@ -187,12 +217,8 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDiscoveryPayloa
                 goto exit;
             }
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmtRT));
-        stmtRT = NULL;
+        VERIFY_SQLITE(sqlite3_reset(stmtRT));
 
-        const char itf[] = "SELECT if FROM RD_LINK_IF WHERE LINK_ID=@id";
-        int itfSize = (int)sizeof(itf);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, itf, itfSize, &stmtIF, NULL));
         VERIFY_SQLITE(sqlite3_bind_int64(stmtIF, sqlite3_bind_parameter_index(stmtIF, "@id"), id));
         while (SQLITE_ROW == sqlite3_step(stmtIF))
         {
@@ -203,15 +229,12 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDiscoveryPayloa
                 goto exit;
             }
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmtIF));
-        stmtIF = NULL;
+        VERIFY_SQLITE(sqlite3_reset(stmtIF));
 
         resourcePayload->bitmap = (uint8_t)(bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE));
 
-        const char ep[] = "SELECT ep,pri FROM RD_LINK_EP WHERE LINK_ID=@id";
-        int epSize = (int)sizeof(ep);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, ep, epSize, &stmtEP, NULL));
         VERIFY_SQLITE(sqlite3_bind_int64(stmtEP, sqlite3_bind_parameter_index(stmtEP, "@id"), id));
+        OCEndpointPayload **epTail = &resourcePayload->eps;
         while (SQLITE_ROW == sqlite3_step(stmtEP))
         {
             epPayload = (OCEndpointPayload *)OICCalloc(1, sizeof(OCEndpointPayload));
@@ -224,43 +247,19 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDiscoveryPayloa
             }
             sqlite3_int64 pri = sqlite3_column_int64(stmtEP, pri_value_index);
             epPayload->pri = (uint16_t)pri;
-            OCEndpointPayload **tmp = &resourcePayload->eps;
-            while (*tmp)
-            {
-                tmp = &(*tmp)->next;
-            }
-            *tmp = epPayload;
+            *epTail = epPayload;
+            epTail = &epPayload->next;
             epPayload = NULL;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmtEP));
-        stmtEP = NULL;
-
-        const char di[] = "SELECT di FROM RD_DEVICE_LIST "
-            "INNER JOIN RD_DEVICE_LINK_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID = RD_DEVICE_LIST.ID "
-            "WHERE RD_DEVICE_LINK_LIST.DEVICE_ID=@deviceId";
-        int diSize = (int)sizeof(di);
-        const uint8_t di_index = 0;
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, di, diSize, &stmtDI, NULL));
-        VERIFY_SQLITE(sqlite3_bind_int64(stmtDI, sqlite3_bind_parameter_index(stmtDI, "@deviceId"), deviceId));
-        res = sqlite3_step(stmtDI);
-        if (SQLITE_ROW == res || SQLITE_DONE == res)
-        {
-            const unsigned char *tempDi = sqlite3_column_text(stmtDI, di_index);
-            OIC_LOG_V(DEBUG, TAG, " %s", tempDi);
-            discPayload->sid = OICStrdup((char *)tempDi);
-            VERIFY_NON_NULL(discPayload->sid);
-        }
-        VERIFY_SQLITE(sqlite3_finalize(stmtDI));
-        stmtDI = NULL;
+        VERIFY_SQLITE(sqlite3_reset(stmtEP));
 
-        OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
+        OCDiscoveryPayloadAddNewResource(*tail, resourcePayload);
         resourcePayload = NULL;
-        res = sqlite3_step(stmt);
     }
+    VERIFY_SQLITE((SQLITE_DONE == res) ? SQLITE_OK : res);
     result = OC_STACK_OK;
 
 exit:
-    sqlite3_finalize(stmtDI);
     sqlite3_finalize(stmtEP);
     sqlite3_finalize(stmtIF);
     sqlite3_finalize(stmtRT);
@@ -269,108 +268,12 @@ exit:
     return result;
 }
 
-static OCStackResult CheckResources(const char *interfaceType, const char *resourceType,
-        OCDiscoveryPayload *discPayload)
-{
-    if (!interfaceType && !resourceType)
-    {
-        return OC_STACK_INVALID_QUERY;
-    }
-    if (!discPayload || !discPayload->sid)
-    {
-        return OC_STACK_INTERNAL_SERVER_ERROR;
-    }
-
-    size_t sidLength = strlen(discPayload->sid);
-    size_t resourceTypeLength = resourceType ? strlen(resourceType) : 0;
-    size_t interfaceTypeLength = interfaceType ? strlen(interfaceType) : 0;
-
-    if ((sidLength > INT_MAX) ||
-        (resourceTypeLength > INT_MAX) ||
-        (interfaceTypeLength > INT_MAX))
-    {
-        return OC_STACK_INVALID_QUERY;
-    }
-
-    OCStackResult result = OC_STACK_OK;
-    sqlite3_stmt *stmt = NULL;
-    if (resourceType)
-    {
-        if (!interfaceType || 0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
-                0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT))
-        {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di AND RD_LINK_RT.rt LIKE @resourceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
-                            resourceType, (int)resourceTypeLength, SQLITE_STATIC));
-        }
-        else
-        {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID "
-                                "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di "
-                                "AND RD_LINK_RT.rt LIKE @resourceType "
-                                "AND RD_LINK_IF.if LIKE @interfaceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
-                            resourceType, (int)resourceTypeLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
-                            interfaceType, (int)interfaceTypeLength, SQLITE_STATIC));
-        }
-        result = ResourcePayloadCreate(stmt, discPayload);
-    }
-    else if (interfaceType)
-    {
-        if (0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
-                0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT))
-        {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-        }
-        else
-        {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di AND RD_LINK_IF.if LIKE @interfaceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
-                            interfaceType, (int)interfaceTypeLength, SQLITE_STATIC));
-        }
-        result = ResourcePayloadCreate(stmt, discPayload);
-    }
-
-exit:
-    sqlite3_finalize(stmt);
-    return result;
-}
-
 OCStackResult OC_CALL OCRDDatabaseDiscoveryPayloadCreate(const char *interfaceType,
         const char *resourceType,
         OCDiscoveryPayload **payload)
 {
     OCStackResult result;
     OCDiscoveryPayload *head = NULL;
-    OCDiscoveryPayload **tail = &head;
     sqlite3_stmt *stmt = NULL;
 
     if (*payload)
@@ -388,43 +291,65 @@ OCStackResult OC_CALL OCRDDatabaseDiscoveryPayloadCreate(const char *interfaceTy
     {
         OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
     }
-    sqlite3_open_v2(OCRDDatabaseGetStorageFilename(), &gRDDB, SQLITE_OPEN_READONLY, NULL);
+    /*
+     * The publish side keeps the database in WAL mode.  A read-only connection cannot create
+     * the shared-memory file of the WAL, so it fails when no other connection has it open.
+     * Only queries are run on this connection; without SQLITE_OPEN_CREATE a missing database
+     * is still not created.
+     */
+    sqlite3_open_v2(OCRDDatabaseGetStorageFilename(), &gRDDB, SQLITE_OPEN_READWRITE, NULL);
     if (!gRDDB)
     {
         result = OC_STACK_ERROR;
         goto exit;
     }
 
+    if (!interfaceType && !resourceType)
+    {
+        result = OC_STACK_NO_RESOURCE;
+        goto exit;
+    }
+    if (interfaceType && (0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
+            0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT)))
+    {
+        interfaceType = NULL;
+    }
+    if ((resourceType && strlen(resourceType) > INT_MAX) ||
+        (interfaceType && strlen(interfaceType) > INT_MAX))
+    {
+        result = OC_STACK_INVALID_QUERY;
+        goto exit;
+    }
+
+    static const char *queries[] =
+    {
+        RD_DISCOVERY_SELECT RD_DISCOVERY_ORDER,
+        RD_DISCOVERY_SELECT RD_DISCOVERY_RT RD_DISCOVERY_ORDER,
+        RD_DISCOVERY_SELECT RD_DISCOVERY_IF RD_DISCOVERY_ORDER,
+        RD_DISCOVERY_SELECT RD_DISCOVERY_RT RD_DISCOVERY_IF RD_DISCOVERY_ORDER
+    };
+    const char *input = queries[(resourceType ? 1 : 0) | (interfaceType ? 2 : 0)];
+    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, -1, &stmt, NULL));
+
     const char *serverID = OCGetServerInstanceIDString();
-    const char input[] = "SELECT di FROM RD_DEVICE_LIST";
-    int inputSize = (int)sizeof(input);
-    const uint8_t di_index = 0;
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-    while (SQLITE_ROW == sqlite3_step(stmt))
+    VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@serverId"),
+                    serverID ? serverID : "", -1, SQLITE_STATIC));
+    if (resourceType)
     {
-        const unsigned char *di = sqlite3_column_text(stmt, di_index);
-        if (0 == strcmp((const char *)di, serverID))
-        {
-            continue;
-        }
-        *tail = OCDiscoveryPayloadCreate();
-        result = OC_STACK_INTERNAL_SERVER_ERROR;
-        VERIFY_NON_NULL(*tail);
-        (*tail)->sid = (char *)OICCalloc(1, UUID_STRING_SIZE);
-        VERIFY_NON_NULL((*tail)->sid);
-        memcpy((*tail)->sid, di, UUID_STRING_SIZE);
-        result = CheckResources(interfaceType, resourceType, *tail);
-        if (OC_STACK_OK == result)
-        {
-            tail = &(*tail)->next;
-        }
-        else
-        {
-            OCPayloadDestroy((OCPayload *) *tail);
-            *tail = NULL;
-        }
+        VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
+                        resourceType, (int)strlen(resourceType), SQLITE_STATIC));
+    }
+    if (interfaceType)
+    {
+        VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
+                        interfaceType, (int)strlen(interfaceType), SQLITE_STATIC));
+    }
+
+    result = ResourcePayloadCreate(stmt, &head);
+    if (OC_STACK_OK == result && !head)
+    {
+        result = OC_STACK_NO_RESOURCE;
     }
-    result = head ? OC_STACK_OK : OC_STACK_NO_RESOURCE;
 
 exit:
     if (OC_STACK_OK != result)
@@ -435,6 +360,7 @@ exit:
     *payload = head;
     sqlite3_finalize(stmt);
     sqlite3_close(gRDDB);
+    gRDDB = NULL;
     return result;
 }
 #endif
@@ -46,6 +46,7 @@ extern "C"
 #include <string.h>
 
 #include <iostream>
+#include <string>
 #include <stdint.h>
 
 #include "gtest_helper.h"
@@ -310,3 +311,149 @@ TEST(CborHeterogeneousArrayTest, ConvertParseTest)
     OICFree(payload_cbor);
     OCPayloadDestroy(payload_out);
 }
+
+TEST(CborBufferTest, ConvertPayloadToBufferTest)
+{
+    OCRepPayload *small = OCRepPayloadCreate();
+    ASSERT_TRUE(small != NULL);
+    EXPECT_TRUE(OCRepPayloadSetPropInt(small, "power", 10));
+
+    OCRepPayload *large = OCRepPayloadCreate();
+    ASSERT_TRUE(large != NULL);
+    std::string value(1000, 'x');
+    EXPECT_TRUE(OCRepPayloadSetPropString(large, "value", value.c_str()));
+    EXPECT_TRUE(OCRepPayloadSetPropDouble(large, "double", 1.5));
+
+    uint8_t *buffer = NULL;
+    size_t bufferSize = 0;
+    size_t size = 0;
+
+    // The buffer is allocated, then grown for the large payload.
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayloadToBuffer((OCPayload *)small, OC_FORMAT_CBOR,
+            &buffer, &bufferSize, &size));
+    ASSERT_TRUE(buffer != NULL);
+    EXPECT_LE(size, bufferSize);
+
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayloadToBuffer((OCPayload *)large, OC_FORMAT_CBOR,
+            &buffer, &bufferSize, &size));
+    EXPECT_LE(size, bufferSize);
+    EXPECT_LT((size_t)1000, size);
+
+    uint8_t *cbor = NULL;
+    size_t cborSize = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *)large, OC_FORMAT_CBOR, &cbor, &cborSize));
+    ASSERT_EQ(cborSize, size);
+    EXPECT_EQ(0, memcmp(cbor, buffer, size));
+    OICFree(cbor);
+
+    // The buffer is reused for a payload that fits.
+    uint8_t *previous = buffer;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayloadToBuffer((OCPayload *)small, OC_FORMAT_CBOR,
+            &buffer, &bufferSize, &size));
+    EXPECT_EQ(previous, buffer);
+
+    OCPayload *payload_out = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, OC_FORMAT_CBOR,
+            PAYLOAD_TYPE_REPRESENTATION, buffer, size));
+    int64_t power = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt((OCRepPayload *)payload_out, "power", &power));
+    EXPECT_EQ(10, power);
+
+    OCPayloadDestroy(payload_out);
+    OICFree(buffer);
+    OCRepPayloadDestroy(small);
+    OCRepPayloadDestroy(large);
+}
+
+TEST(CborRepPayloadTest, ManyPropertiesTest)
+{
+    const int64_t count = 100;
+    OCRepPayload *payload_in = OCRepPayloadCreate();
+    ASSERT_TRUE(payload_in != NULL);
+    for (int64_t i = 0; i < count; ++i)
+    {
+        std::string name = "property" + std::to_string(i);
+        EXPECT_TRUE(OCRepPayloadSetPropInt(payload_in, name.c_str(), i));
+    }
+    // Setting an existing property replaces its value in place.
+    EXPECT_TRUE(OCRepPayloadSetPropString(payload_in, "property50", "fifty"));
+    size_t valueCount = 0;
+    for (OCRepPayloadValue *value = payload_in->values; value; value = value->next)
+    {
+        ++valueCount;
+    }
+    EXPECT_EQ((size_t)count, valueCount);
+
+    OCRepPayload *clone = OCRepPayloadClone(payload_in);
+    ASSERT_TRUE(clone != NULL);
+    EXPECT_TRUE(OCRepPayloadSetPropBool(clone, "added", true));
+    EXPECT_FALSE(OCRepPayloadIsNull(clone, "added"));
+    EXPECT_TRUE(OCRepPayloadIsNull(payload_in, "added"));
+    OCRepPayloadDestroy(clone);
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *)payload_in, OC_FORMAT_CBOR,
+            &payload_cbor, &payload_cbor_size));
+    OCRepPayloadDestroy(payload_in);
+
+    OCPayload *payload_out = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, OC_FORMAT_CBOR,
+            PAYLOAD_TYPE_REPRESENTATION, payload_cbor, payload_cbor_size));
+    OICFree(payload_cbor);
+
+    for (int64_t i = count - 1; i >= 0; --i)
+    {
+        std::string name = "property" + std::to_string(i);
+        int64_t value = -1;
+        if (50 == i)
+        {
+            EXPECT_FALSE(OCRepPayloadGetPropInt((OCRepPayload *)payload_out, name.c_str(), &value));
+            continue;
+        }
+        EXPECT_TRUE(OCRepPayloadGetPropInt((OCRepPayload *)payload_out, name.c_str(), &value));
+        EXPECT_EQ(i, value);
+    }
+    char *str = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropString((OCRepPayload *)payload_out, "property50", &str));
+    EXPECT_STREQ("fifty", str);
+    OICFree(str);
+
+    OCPayloadDestroy(payload_out);
+}
+
+TEST(CborEncodedRepPayloadTest, ConvertSendsBytesAsIs)
+{
+    OCRepPayload *payload_in = OCRepPayloadCreate();
+    ASSERT_TRUE(payload_in != NULL);
+    EXPECT_TRUE(OCRepPayloadSetPropString(payload_in, "name", "value"));
+    EXPECT_TRUE(OCRepPayloadSetPropInt(payload_in, "count", 3));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *)payload_in, OC_FORMAT_CBOR,
+            &payload_cbor, &payload_cbor_size));
+    OCRepPayloadDestroy(payload_in);
+
+    OCEncodedRepPayload *encoded = OCEncodedRepPayloadCreate(payload_cbor, payload_cbor_size);
+    ASSERT_TRUE(encoded != NULL);
+    EXPECT_EQ(PAYLOAD_TYPE_ENCODED_REPRESENTATION, encoded->base.type);
+
+    uint8_t *encoded_cbor = NULL;
+    size_t encoded_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *)encoded, OC_FORMAT_CBOR,
+            &encoded_cbor, &encoded_cbor_size));
+    ASSERT_EQ(payload_cbor_size, encoded_cbor_size);
+    EXPECT_EQ(0, memcmp(payload_cbor, encoded_cbor, payload_cbor_size));
+    OCPayloadDestroy((OCPayload *)encoded);
+    OICFree(encoded_cbor);
+
+    OCPayload *payload_out = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, OC_FORMAT_CBOR,
+            PAYLOAD_TYPE_REPRESENTATION, payload_cbor, payload_cbor_size));
+    OICFree(payload_cbor);
+    int64_t count = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt((OCRepPayload *)payload_out, "count", &count));
+    EXPECT_EQ(3, count);
+    OCPayloadDestroy(payload_out);
+}
@@ -29,6 +29,8 @@ extern "C"
     #include "oic_string.h"
     #include "oic_time.h"
     #include "ocresourcehandler.h"
+    #include "ocrequestdispatch.h"
+    #include "oickeepalive.h"
 }
 
 #include "gtest/gtest.h"
@@ -49,6 +51,11 @@ extern "C"
 
 #include <iostream>
 #include <stdint.h>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "gtest_helper.h"
 
@@ -146,9 +153,186 @@ OCEntityHandlerResult entityHandler(OCEntityHandlerFlag /*flag*/,
     return OC_EH_OK;
 }
 
+/*
+ * State shared between the request worker tests and their entity handlers.
+ */
+struct RequestWorkerState
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<int> lastSequence;
+    int inFlight = 0;
+    int handled = 0;
+    bool overlapped = false;
+    bool outOfOrder = false;
+    bool release = false;
+};
+
+// Checks that requests for one resource are handled one at a time, in the order sent.
+OCEntityHandlerResult orderedEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest,
+        void *callbackParam)
+{
+    RequestWorkerState *state = (RequestWorkerState *)callbackParam;
+    int sender = -1;
+    int sequence = -1;
+    sscanf(entityHandlerRequest->query, "t=%d&n=%d", &sender, &sequence);
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->inFlight++)
+        {
+            state->overlapped = true;
+        }
+    }
+    std::this_thread::yield();
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->inFlight--;
+    if (sender < 0 || sender >= (int)state->lastSequence.size()
+        || state->lastSequence[sender] + 1 != sequence)
+    {
+        state->outOfOrder = true;
+    }
+    else
+    {
+        state->lastSequence[sender] = sequence;
+    }
+    state->handled++;
+    state->cond.notify_all();
+    return OC_EH_OK;
+}
+
+// Blocks until the test releases it.
+OCEntityHandlerResult blockingEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest * /*entityHandlerRequest*/,
+        void *callbackParam)
+{
+    RequestWorkerState *state = (RequestWorkerState *)callbackParam;
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->handled++;
+    state->cond.notify_all();
+    state->cond.wait(lock, [state]{ return state->release; });
+    return OC_EH_OK;
+}
+
+/*
+ * State shared by two entity handlers that delete each other's resource.
+ */
+struct CrossDeleteState
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    OCResourceHandle handles[2] = { NULL, NULL };
+    OCStackResult results[2] = { OC_STACK_ERROR, OC_STACK_ERROR };
+    int started = 0;
+    int done = 0;
+};
+
+struct CrossDeleteResource
+{
+    CrossDeleteState *state;
+    int index;
+};
+
+// Waits until both handlers run, then deletes the resource of the other one.
+OCEntityHandlerResult crossDeleteEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest * /*entityHandlerRequest*/,
+        void *callbackParam)
+{
+    CrossDeleteResource *resource = (CrossDeleteResource *)callbackParam;
+    CrossDeleteState *state = resource->state;
+    OCResourceHandle other;
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->started++;
+        state->cond.notify_all();
+        state->cond.wait(lock, [state]{ return 2 == state->started; });
+        other = state->handles[1 - resource->index];
+    }
+
+    OCStackResult result = OCDeleteResource(other);
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->results[resource->index] = result;
+    state->done++;
+    state->cond.notify_all();
+    return OC_EH_OK;
+}
+
+/*
+ * State of a collection member whose entity handler deletes another resource.
+ */
+struct MemberDeleteState
+{
+    OCResourceHandle victim = NULL;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool started = false;
+    bool done = false;
+    OCStackResult result = OC_STACK_ERROR;
+};
+
+// Blocks until released, then reads its own resource through the stack.
+OCEntityHandlerResult blockingReaderEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest,
+        void *callbackParam)
+{
+    blockingEntityHandler(OC_REQUEST_FLAG, entityHandlerRequest, callbackParam);
+    EXPECT_STREQ("/a/light", OCGetResourceUri(entityHandlerRequest->resource));
+    return OC_EH_OK;
+}
+
+// Deletes the victim resource while the collection request is being handled.
+OCEntityHandlerResult memberDeleteEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest * /*entityHandlerRequest*/,
+        void *callbackParam)
+{
+    MemberDeleteState *state = (MemberDeleteState *)callbackParam;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->started = true;
+        state->cond.notify_all();
+    }
+
+    OCStackResult result = OCDeleteResource(state->victim);
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->result = result;
+    state->done = true;
+    state->cond.notify_all();
+    return OC_EH_OK;
+}
+
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
+/*
+ * Queue a GET request from 127.0.0.1 for the request workers, as if it was received.
+ */
+OCStackResult SubmitWorkerRequest(const char *uri, uint16_t messageId)
+{
+    CAEndpoint_t endpoint = CAEndpoint_t();
+    endpoint.adapter = CA_ADAPTER_IP;
+    endpoint.flags = CA_IPV4;
+    OICStrcpy(endpoint.addr, sizeof(endpoint.addr), "127.0.0.1");
+    endpoint.port = 5683;
+
+    // Tokens must be unique, or the request is taken for a repeated one.
+    char token[CA_MAX_TOKEN_LEN] = { 't', 'e', 's', 't' };
+    memcpy(&token[4], &messageId, sizeof(messageId));
+
+    CARequestInfo_t requestInfo = CARequestInfo_t();
+    requestInfo.method = CA_GET;
+    requestInfo.info.type = CA_MSG_NONCONFIRM;
+    requestInfo.info.messageId = messageId;
+    requestInfo.info.token = token;
+    requestInfo.info.tokenLength = CA_MAX_TOKEN_LEN;
+    requestInfo.info.resourceUri = (CAURI_t)uri;
+
+    return OCRequestDispatchSubmit(&endpoint, &requestInfo);
+}
+
 void InitStack(OCMode mode)
 {
     OIC_LOG(INFO, TAG, "Entering InitStack");
@@ -303,6 +487,246 @@ TEST(StackStart, StackStartSuccessiveInits)
     EXPECT_EQ(0u, g_ocStackStartCount);
 }
 
+TEST(StackStart, SetRequestWorkerCount)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetRequestWorkerCount(255));
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(4));
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_SERVER));
+    EXPECT_EQ(OC_STACK_ERROR, OCSetRequestWorkerCount(2));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(0));
+}
+
+TEST(StackStart, CreateDeleteResourceWithRequestWorkers)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(2));
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_SERVER));
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handle, "core.brightled"));
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCDeleteResource(handle));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(0));
+}
+
+TEST(StackStart, RequestWorkersHandleRequestsInOrder)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    const int senders = 4;
+    const int perSender = 50;
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(4));
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_SERVER));
+
+    RequestWorkerState state;
+    state.lastSequence.assign(senders, 0);
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            orderedEntityHandler,
+                                            &state,
+                                            OC_DISCOVERABLE));
+
+    // Several threads send requests for the same resource at once.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < senders; t++)
+    {
+        threads.push_back(std::thread([t]()
+        {
+            for (int n = 1; n <= perSender; n++)
+            {
+                char uri[MAX_URI_LENGTH];
+                snprintf(uri, sizeof(uri), "/a/led?t=%d&n=%d", t, n);
+                EXPECT_EQ(OC_STACK_OK, SubmitWorkerRequest(uri, (uint16_t)(t * perSender + n)));
+            }
+        }));
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        EXPECT_TRUE(state.cond.wait_for(lock, std::chrono::seconds(3),
+                    [&state]{ return state.handled == senders * perSender; }));
+        EXPECT_FALSE(state.overlapped);
+        EXPECT_FALSE(state.outOfOrder);
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(0));
+}
+
+TEST(StackStart, DeleteResourceWhileHandlerRuns)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(2));
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_SERVER));
+
+    RequestWorkerState state;
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            blockingEntityHandler,
+                                            &state,
+                                            OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, SubmitWorkerRequest("/a/led", 1));
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        EXPECT_TRUE(state.cond.wait_for(lock, std::chrono::seconds(2),
+                    [&state]{ return 1 == state.handled; }));
+    }
+
+    // The resource is not freed while its entity handler is running.
+    std::promise<OCStackResult> deleted;
+    std::future<OCStackResult> deleteResult = deleted.get_future();
+    std::thread deleter([&deleted, handle]{ deleted.set_value(OCDeleteResource(handle)); });
+    EXPECT_EQ(std::future_status::timeout,
+              deleteResult.wait_for(std::chrono::milliseconds(200)));
+
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.release = true;
+        state.cond.notify_all();
+    }
+    deleter.join();
+    EXPECT_EQ(OC_STACK_OK, deleteResult.get());
+
+    // Requests for the deleted resource no longer reach its entity handler.
+    EXPECT_EQ(OC_STACK_OK, SubmitWorkerRequest("/a/led", 2));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        EXPECT_EQ(1, state.handled);
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(0));
+}
+
+TEST(StackStart, RequestWorkersDeleteEachOthersResources)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(2));
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_SERVER));
+
+    // With two workers, /a/led and /a/light are handled by different workers.
+    CrossDeleteState state;
+    CrossDeleteResource resources[2] = { { &state, 0 }, { &state, 1 } };
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&state.handles[0],
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            crossDeleteEntityHandler,
+                                            &resources[0],
+                                            OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&state.handles[1],
+                                            "core.light",
+                                            "core.rw",
+                                            "/a/light",
+                                            crossDeleteEntityHandler,
+                                            &resources[1],
+                                            OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, SubmitWorkerRequest("/a/led", 1));
+    EXPECT_EQ(OC_STACK_OK, SubmitWorkerRequest("/a/light", 2));
+
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        EXPECT_TRUE(state.cond.wait_for(lock, std::chrono::seconds(3),
+                    [&state]{ return 2 == state.done; }));
+        EXPECT_EQ(OC_STACK_OK, state.results[0]);
+        EXPECT_EQ(OC_STACK_OK, state.results[1]);
+    }
+    EXPECT_EQ(NULL, OCGetResourceHandleAtUri("/a/led"));
+    EXPECT_EQ(NULL, OCGetResourceHandleAtUri("/a/light"));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(0));
+}
+
+TEST(StackStart, CollectionMemberDeletesResourceOfAnotherWorker)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(2));
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_SERVER));
+
+    // /a/room and its member /a/fan are handled by one worker, /a/light by the other.
+    RequestWorkerState blocked;
+    MemberDeleteState member;
+    OCResourceHandle room;
+    OCResourceHandle fan;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&member.victim,
+                                            "core.light",
+                                            "core.rw",
+                                            "/a/light",
+                                            blockingReaderEntityHandler,
+                                            &blocked,
+                                            OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&room,
+                                            "core.room",
+                                            OC_RSRVD_INTERFACE_BATCH,
+                                            "/a/room",
+                                            NULL,
+                                            NULL,
+                                            OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&fan,
+                                            "core.fan",
+                                            "core.rw",
+                                            "/a/fan",
+                                            memberDeleteEntityHandler,
+                                            &member,
+                                            OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResource(room, fan));
+
+    EXPECT_EQ(OC_STACK_OK, SubmitWorkerRequest("/a/light", 1));
+    {
+        std::unique_lock<std::mutex> lock(blocked.mutex);
+        EXPECT_TRUE(blocked.cond.wait_for(lock, std::chrono::seconds(2),
+                    [&blocked]{ return 1 == blocked.handled; }));
+    }
+
+    // The member handler waits for /a/light while its collection request is handled.
+    EXPECT_EQ(OC_STACK_OK, SubmitWorkerRequest("/a/room?if=" OC_RSRVD_INTERFACE_BATCH, 2));
+    {
+        std::unique_lock<std::mutex> lock(member.mutex);
+        EXPECT_TRUE(member.cond.wait_for(lock, std::chrono::seconds(2),
+                    [&member]{ return member.started; }));
+    }
+
+    // The blocked handler still reaches the resource list, so the delete can complete.
+    {
+        std::lock_guard<std::mutex> lock(blocked.mutex);
+        blocked.release = true;
+        blocked.cond.notify_all();
+    }
+    {
+        std::unique_lock<std::mutex> lock(member.mutex);
+        EXPECT_TRUE(member.cond.wait_for(lock, std::chrono::seconds(3),
+                    [&member]{ return member.done; }));
+        EXPECT_EQ(OC_STACK_OK, member.result);
+    }
+    EXPECT_EQ(NULL, OCGetResourceHandleAtUri("/a/light"));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestWorkerCount(0));
+}
+
 TEST(StackStart, SetPlatformInfoValid)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -2330,6 +2754,52 @@ TEST(StackResourceAccess, DeleteMiddleResource)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResourceAccess, FindResourceByUri)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting FindResourceByUri test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle0;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle0,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led0",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    OCResourceHandle handle1;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led1",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    EXPECT_EQ(handle0, FindResourceByUri("/a/led0"));
+    EXPECT_EQ(handle1, FindResourceByUri("/a/led1"));
+    EXPECT_EQ(handle1, OCGetResourceHandleAtUri("/a/led1"));
+    EXPECT_EQ(NULL, FindResourceByUri("/a/led"));
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle0));
+    EXPECT_EQ(NULL, FindResourceByUri("/a/led0"));
+    EXPECT_EQ(handle1, FindResourceByUri("/a/led1"));
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCDeleteResource(handle0));
+
+    // The URI can be reused once the resource has been deleted.
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle0,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led0",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(handle0, FindResourceByUri("/a/led0"));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 // Visual Studio versions earlier than 2015 have bugs in is_pod and report the wrong answer.
 #if !defined(_MSC_VER) || (_MSC_VER >= 1900)
 TEST(PODTests, OCHeaderOption)
@@ -3298,3 +3768,112 @@ TEST(OCIpv6ScopeLevel, invalidAddressTest)
     EXPECT_EQ(OC_STACK_ERROR, OCGetIpv6AddrScope(invalidAddr3, &scopeLevel));
     EXPECT_EQ(OC_STACK_ERROR, OCGetIpv6AddrScope(invalidAddr4, &scopeLevel));
 }
+
+#ifdef TCP_ADAPTER
+static CAEndpoint_t KeepAliveEndpoint(uint16_t port)
+{
+    // Documentation address, so no connection can be made and the pings are never answered.
+    CAEndpoint_t endpoint = CAEndpoint_t();
+    endpoint.adapter = CA_ADAPTER_TCP;
+    endpoint.flags = CA_IPV4;
+    OICStrcpy(endpoint.addr, sizeof(endpoint.addr), "192.0.2.1");
+    endpoint.port = port;
+    return endpoint;
+}
+
+// Time until the first ping message is answered, or the connection is closed.
+static const uint32_t KEEPALIVE_RESPONSE_TIMEOUT_MS = 60 * 1000;
+
+// Time until the next ping message after a response, less up to 10 seconds of jitter.
+static const uint32_t KEEPALIVE_PING_INTERVAL_MS = 2 * 60 * 1000;
+
+TEST(StackKeepAlive, PingAndResponseRescheduleEntry)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    // Only the IP adapter is started, so the TCP ping messages are queued but never sent.
+    EXPECT_EQ(OC_STACK_OK, OCInit2(OC_CLIENT, OC_DEFAULT_FLAGS, OC_DEFAULT_FLAGS, OC_ADAPTER_IP));
+    EXPECT_EQ(UINT32_MAX, GetKeepAliveTimeout(UINT32_MAX));
+
+    // The response to the discovery of /oic/ping adds the entry and sends the first ping.
+    CAEndpoint_t first = KeepAliveEndpoint(5001);
+    EXPECT_EQ(OC_STACK_OK, HandleKeepAliveResponse(&first, OC_STACK_OK, NULL));
+    uint32_t timeout = GetKeepAliveTimeout(UINT32_MAX);
+    EXPECT_GE(KEEPALIVE_RESPONSE_TIMEOUT_MS, timeout);
+    EXPECT_LT(KEEPALIVE_RESPONSE_TIMEOUT_MS - 5000, timeout);
+
+    // The response to the ping moves the entry behind the next ping interval.
+    EXPECT_EQ(OC_STACK_OK, HandleKeepAliveResponse(&first, OC_STACK_OK, NULL));
+    timeout = GetKeepAliveTimeout(UINT32_MAX);
+    EXPECT_GE(KEEPALIVE_PING_INTERVAL_MS, timeout);
+    EXPECT_LT(KEEPALIVE_PING_INTERVAL_MS - 15000, timeout);
+
+    // A ping sent to another endpoint waits for its response ahead of the first entry.
+    CAEndpoint_t second = KeepAliveEndpoint(5002);
+    EXPECT_EQ(OC_STACK_OK, HandleKeepAliveResponse(&second, OC_STACK_OK, NULL));
+    timeout = GetKeepAliveTimeout(UINT32_MAX);
+    EXPECT_GE(KEEPALIVE_RESPONSE_TIMEOUT_MS, timeout);
+    EXPECT_LT(KEEPALIVE_RESPONSE_TIMEOUT_MS - 5000, timeout);
+
+    EXPECT_EQ(OC_STACK_OK, HandleKeepAliveResponse(&second, OC_STACK_OK, NULL));
+    timeout = GetKeepAliveTimeout(UINT32_MAX);
+    EXPECT_GE(KEEPALIVE_PING_INTERVAL_MS, timeout);
+    EXPECT_LT(KEEPALIVE_PING_INTERVAL_MS - 15000, timeout);
+
+    // The timeout never exceeds the bound given by the caller.
+    EXPECT_EQ(100u, GetKeepAliveTimeout(100));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackKeepAlive, RemoveQueuedEntries)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCInit2(OC_CLIENT, OC_DEFAULT_FLAGS, OC_DEFAULT_FLAGS, OC_ADAPTER_IP));
+
+    // Entries waiting for a ping response and entries waiting for the next ping alternate.
+    const uint16_t count = 7;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        CAEndpoint_t endpoint = KeepAliveEndpoint(5000 + i);
+        EXPECT_EQ(OC_STACK_OK, HandleKeepAliveResponse(&endpoint, OC_STACK_OK, NULL));
+        if (i % 2)
+        {
+            EXPECT_EQ(OC_STACK_OK, HandleKeepAliveResponse(&endpoint, OC_STACK_OK, NULL));
+        }
+    }
+
+    // Remove the entries waiting for a ping response from the head, the middle and the end.
+    const uint16_t waiting[] = { 0, 4, 6, 2 };
+    for (size_t i = 0; i < sizeof(waiting) / sizeof(waiting[0]); i++)
+    {
+        uint32_t timeout = GetKeepAliveTimeout(UINT32_MAX);
+        EXPECT_GE(KEEPALIVE_RESPONSE_TIMEOUT_MS, timeout);
+        EXPECT_LT(KEEPALIVE_RESPONSE_TIMEOUT_MS - 5000, timeout);
+
+        CAEndpoint_t endpoint = KeepAliveEndpoint(5000 + waiting[i]);
+        HandleKeepAliveConnCB(&endpoint, false, true);
+    }
+
+    // Only the entries waiting for the next ping are left.
+    for (uint16_t i = 1; i < count; i += 2)
+    {
+        uint32_t timeout = GetKeepAliveTimeout(UINT32_MAX);
+        EXPECT_GE(KEEPALIVE_PING_INTERVAL_MS, timeout);
+        EXPECT_LT(KEEPALIVE_PING_INTERVAL_MS - 15000, timeout);
+
+        CAEndpoint_t endpoint = KeepAliveEndpoint(5000 + i);
+        HandleKeepAliveConnCB(&endpoint, false, true);
+    }
+    EXPECT_EQ(UINT32_MAX, GetKeepAliveTimeout(UINT32_MAX));
+
+    // A removed entry is gone from the table, so a new response adds it again.
+    CAEndpoint_t endpoint = KeepAliveEndpoint(5003);
+    HandleKeepAliveConnCB(&endpoint, false, true);
+    EXPECT_EQ(OC_STACK_OK, HandleKeepAliveResponse(&endpoint, OC_STACK_OK, NULL));
+    uint32_t timeout = GetKeepAliveTimeout(UINT32_MAX);
+    EXPECT_GE(KEEPALIVE_RESPONSE_TIMEOUT_MS, timeout);
+    EXPECT_LT(KEEPALIVE_RESPONSE_TIMEOUT_MS - 5000, timeout);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+#endif
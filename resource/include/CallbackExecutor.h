@@ -0,0 +1,109 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef OC_CALLBACK_EXECUTOR_H_
+#define OC_CALLBACK_EXECUTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <OCApi.h>
+
+namespace OC
+{
+    /**
+     * Fixed set of threads running the client callbacks.  Every thread owns a bounded queue;
+     * callbacks posted with the same key go to the same thread, so they run in the order
+     * they were posted.
+     */
+    class CallbackExecutor
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        CallbackExecutor(uint16_t threadCount, size_t queueSize,
+                         CallbackOverflowPolicy overflowPolicy);
+
+        /**
+         * Runs the callbacks still queued and joins the threads.  When called from one of its
+         * own callbacks, the thread running it finishes the queue of its worker after the
+         * callback returned.
+         */
+        ~CallbackExecutor();
+
+        CallbackExecutor(const CallbackExecutor&) = delete;
+        CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+        /**
+         * Queue a callback.
+         *
+         * @param key     callbacks with the same non-null key run in order, nullptr for none.
+         * @param task    callback to run.
+         */
+        void post(const void* key, Task task);
+
+        CallbackStats getStats() const;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Item
+        {
+            Task task;
+            Clock::time_point enqueueTime;
+        };
+
+        struct Worker
+        {
+            std::thread thread;
+            std::mutex mutex;
+            std::condition_variable cond;
+            std::deque<Item> queue;
+            bool stop = false;
+        };
+
+        struct Stats
+        {
+            std::mutex mutex;
+            CallbackStats counters = CallbackStats();
+        };
+
+        Worker& getWorker(const void* key);
+        static void run(std::shared_ptr<Worker> worker, std::shared_ptr<Stats> stats);
+        void spawn(Task task);
+
+        // shared with the threads, which may outlive the executor.
+        std::vector<std::shared_ptr<Worker>> m_workers;
+        std::shared_ptr<Stats> m_stats;
+
+        size_t m_queueSize;
+        CallbackOverflowPolicy m_overflowPolicy;
+        std::atomic<size_t> m_nextWorker;
+    };
+}
+
+#endif
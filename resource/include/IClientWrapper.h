@@ -161,6 +161,8 @@ namespace OC
 
         virtual OCStackResult start() = 0;
 
+        virtual OCStackResult GetCallbackStats(CallbackStats& stats) = 0;
+
         virtual ~IClientWrapper(){}
     };
 }
@@ -33,27 +33,35 @@
 
 namespace OC
 {
+    class CallbackExecutor;
+
     namespace ClientCallbackContext
     {
         struct GetContext
         {
             GetCallback callback;
-            GetContext(GetCallback cb) : callback(cb){}
+            std::weak_ptr<CallbackExecutor> executor;
+            GetContext(GetCallback cb, std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct SetContext
         {
             PutCallback callback;
-            SetContext(PutCallback cb) : callback(cb){}
+            std::weak_ptr<CallbackExecutor> executor;
+            SetContext(PutCallback cb, std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct ListenContext
         {
             FindCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            std::weak_ptr<CallbackExecutor> executor;
 
-            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw,
+                          std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb), clientWrapper(cw), executor(ex){}
         };
 
         struct ListenErrorContext
@@ -61,19 +69,23 @@ namespace OC
             FindCallback callback;
             FindErrorCallback errorCallback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            std::weak_ptr<CallbackExecutor> executor;
 
             ListenErrorContext(FindCallback cb1, FindErrorCallback cb2,
-                               std::weak_ptr<IClientWrapper> cw)
-                : callback(cb1), errorCallback(cb2), clientWrapper(cw){}
+                               std::weak_ptr<IClientWrapper> cw,
+                               std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb1), errorCallback(cb2), clientWrapper(cw), executor(ex){}
         };
 
         struct ListenResListContext
         {
             FindResListCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            std::weak_ptr<CallbackExecutor> executor;
 
-            ListenResListContext(FindResListCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            ListenResListContext(FindResListCallback cb, std::weak_ptr<IClientWrapper> cw,
+                                 std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb), clientWrapper(cw), executor(ex){}
         };
 
         struct ListenResListWithErrorContext
@@ -81,42 +93,54 @@ namespace OC
             FindResListCallback callback;
             FindErrorCallback errorCallback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            std::weak_ptr<CallbackExecutor> executor;
 
             ListenResListWithErrorContext(FindResListCallback cb1, FindErrorCallback cb2,
-                               std::weak_ptr<IClientWrapper> cw)
-                : callback(cb1), errorCallback(cb2), clientWrapper(cw){}
+                               std::weak_ptr<IClientWrapper> cw,
+                               std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb1), errorCallback(cb2), clientWrapper(cw), executor(ex){}
         };
 
         struct DeviceListenContext
         {
             FindDeviceCallback callback;
             IClientWrapper::Ptr clientWrapper;
-            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw)
-                    : callback(cb), clientWrapper(cw){}
+            std::weak_ptr<CallbackExecutor> executor;
+            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw,
+                                std::weak_ptr<CallbackExecutor> ex)
+                    : callback(cb), clientWrapper(cw), executor(ex){}
         };
 
         struct SubscribePresenceContext
         {
             SubscribeCallback callback;
-            SubscribePresenceContext(SubscribeCallback cb) : callback(cb){}
+            std::weak_ptr<CallbackExecutor> executor;
+            SubscribePresenceContext(SubscribeCallback cb, std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct DeleteContext
         {
             DeleteCallback callback;
-            DeleteContext(DeleteCallback cb) : callback(cb){}
+            std::weak_ptr<CallbackExecutor> executor;
+            DeleteContext(DeleteCallback cb, std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct ObserveContext
         {
             ObserveCallback callback;
-            ObserveContext(ObserveCallback cb) : callback(cb){}
+            std::weak_ptr<CallbackExecutor> executor;
+            ObserveContext(ObserveCallback cb, std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct DirectPairingContext
         {
             DirectPairingCallback callback;
-            DirectPairingContext(DirectPairingCallback cb) : callback(cb){}
+            std::weak_ptr<CallbackExecutor> executor;
+            DirectPairingContext(DirectPairingCallback cb, std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
 
         };
 
@@ -125,8 +149,10 @@ namespace OC
         {
             MQTopicCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
-            MQTopicContext(MQTopicCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            std::weak_ptr<CallbackExecutor> executor;
+            MQTopicContext(MQTopicCallback cb, std::weak_ptr<IClientWrapper> cw,
+                           std::weak_ptr<CallbackExecutor> ex)
+                : callback(cb), clientWrapper(cw), executor(ex){}
         };
 #endif
     }
@@ -246,6 +272,8 @@ namespace OC
         virtual OCStackResult stop();
         virtual OCStackResult start();
 
+        virtual OCStackResult GetCallbackStats(CallbackStats& stats);
+
     private:
         void listeningFunc();
         std::string assembleSetResourceUri(std::string uri, const QueryParamsMap& queryParams);
@@ -257,6 +285,7 @@ namespace OC
         std::thread m_listeningThread;
         bool m_threadRun;
         std::weak_ptr<std::recursive_mutex> m_csdkLock;
+        std::shared_ptr<CallbackExecutor> m_callbackExecutor;
 
     private:
         PlatformConfig  m_cfg;
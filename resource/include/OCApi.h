@@ -132,6 +132,50 @@ namespace OC
         NaQos       = OC_NA_QOS
     };
 
+    /**
+     * What the client callback executor does with a callback when the queue of the worker
+     * thread it belongs to is full.  The callbacks are queued by the thread processing the
+     * stack, so they are never waited for.
+     */
+    enum class CallbackOverflowPolicy
+    {
+        /** Run the callback on a thread of its own, as without an executor. */
+        SpawnThread,
+
+        /** Discard the callback. */
+        DropNewest,
+
+        /** Discard the oldest callback waiting for the same worker thread. */
+        DropOldest
+    };
+
+    /**
+     * Counters of the client callback executor.
+     */
+    struct CallbackStats
+    {
+        /** Number of callbacks run by the worker threads. */
+        uint64_t executed;
+
+        /** Number of callbacks discarded by the overflow policy. */
+        uint64_t dropped;
+
+        /** Number of callbacks run on a thread of their own by the overflow policy. */
+        uint64_t spawned;
+
+        /** Number of callbacks waiting for a worker thread. */
+        size_t queued;
+
+        /** Largest number of callbacks that waited at once. */
+        size_t maxQueued;
+
+        /** Sum of the time the executed callbacks waited in the queue, in microseconds. */
+        uint64_t totalQueueLatencyUs;
+
+        /** Longest time an executed callback waited in the queue, in microseconds. */
+        uint64_t maxQueueLatencyUs;
+    };
+
     /**
      *  Data structure to provide the configuration.
      */
@@ -176,6 +220,26 @@ namespace OC
          */
         bool                       useLegacyCleanup;
 
+        /**
+         * Encode the representations of server responses and of client PUT/POST requests
+         * straight to CBOR instead of building an OCRepPayload tree first.  The encoded
+         * bytes are the same either way.  Set to false by default.
+         */
+        bool                       directEncoding;
+
+        /**
+         * Number of threads running the client callbacks.  The callbacks of one observation
+         * or presence subscription run in order on the same thread.  When 0, the default,
+         * every callback runs on a thread of its own.
+         */
+        uint16_t                   callbackThreads;
+
+        /** Maximum number of client callbacks waiting for the callback threads. */
+        size_t                     callbackQueueSize;
+
+        /** What to do with a client callback when the callback queue is full. */
+        CallbackOverflowPolicy     callbackOverflowPolicy;
+
         public:
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -189,7 +253,11 @@ namespace OC
                 port(0),
                 QoS(QualityOfService::NaQos),
                 ps(ps_),
-                useLegacyCleanup(false)
+                useLegacyCleanup(false),
+                directEncoding(false),
+                callbackThreads(0),
+                callbackQueueSize(1024),
+                callbackOverflowPolicy(CallbackOverflowPolicy::SpawnThread)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig()
@@ -202,7 +270,11 @@ namespace OC
                 port(0),
                 QoS(QualityOfService::NaQos),
                 ps(nullptr),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                directEncoding(false),
+                callbackThreads(0),
+                callbackQueueSize(1024),
+                callbackOverflowPolicy(CallbackOverflowPolicy::SpawnThread)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -220,7 +292,11 @@ namespace OC
                 port(0),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                directEncoding(false),
+                callbackThreads(0),
+                callbackQueueSize(1024),
+                callbackOverflowPolicy(CallbackOverflowPolicy::SpawnThread)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -238,7 +314,11 @@ namespace OC
                 port(port_),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                directEncoding(false),
+                callbackThreads(0),
+                callbackQueueSize(1024),
+                callbackOverflowPolicy(CallbackOverflowPolicy::SpawnThread)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -256,7 +336,11 @@ namespace OC
                 ipAddress(ipAddress_),
                 port(port_),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                directEncoding(false),
+                callbackThreads(0),
+                callbackQueueSize(1024),
+                callbackOverflowPolicy(CallbackOverflowPolicy::SpawnThread)
         {}
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -272,7 +356,11 @@ namespace OC
                 port(0),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                directEncoding(false),
+                callbackThreads(0),
+                callbackQueueSize(1024),
+                callbackOverflowPolicy(CallbackOverflowPolicy::SpawnThread)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -291,7 +379,11 @@ namespace OC
                 port(0),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                directEncoding(false),
+                callbackThreads(0),
+                callbackQueueSize(1024),
+                callbackOverflowPolicy(CallbackOverflowPolicy::SpawnThread)
         {}
 
     };
@@ -753,6 +753,17 @@ namespace OC
         OCStackResult doDirectPairing(std::shared_ptr<OCDirectPairing> peer, OCPrm_t pmSel,
                                      const std::string& pinNumber,
                                      DirectPairingCallback resultCallback);
+
+        /**
+         * Get the counters of the executor running the client callbacks, see
+         * PlatformConfig::callbackThreads.
+         *
+         * @param[out] stats counters of the callback executor.
+         *
+         * @return Returns ::OC_STACK_OK if success, ::OC_STACK_NOTIMPL when the client
+         *         callbacks do not run on an executor.
+         */
+        OCStackResult getCallbackStats(CallbackStats& stats);
 #ifdef WITH_CLOUD
         /**
          * Create an account manager object that can be used for doing request to account server.
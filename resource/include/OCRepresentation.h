@@ -65,6 +65,24 @@ namespace OC
 
             OCRepPayload* getPayload() const;
 
+            /**
+             * Encode the representations to CBOR without building the OCRepPayload
+             * tree returned by getPayload().  The bytes are the same as those produced
+             * by converting that tree with OCConvertPayload().
+             *
+             * @return The encoded representations, empty if there are none.
+             */
+            std::vector<uint8_t> getCborPayload() const;
+
+            /**
+             * Encode the representations with getCborPayload() and wrap the bytes in a
+             * payload the stack sends as is.
+             *
+             * @return The payload, to be freed with OCPayloadDestroy(), or nullptr if
+             *         there are no representations.
+             */
+            OCPayload* getEncodedPayload() const;
+
             const std::vector<OCRepresentation>& representations() const;
 
             void addRepresentation(const OCRepresentation& rep);
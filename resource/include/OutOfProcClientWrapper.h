@@ -42,6 +42,11 @@ namespace OC
             return OC_STACK_NOTIMPL;
         }
 
+        virtual OCStackResult GetCallbackStats(CallbackStats& /*stats*/)
+        {
+            return OC_STACK_NOTIMPL;
+        }
+
         virtual OCStackResult ListenForResource(const std::string& /*servUrl*/,
                                                 const std::string& /*rsrcType*/,
                                                 OCConnectivityType /*connType*/,
@@ -0,0 +1,201 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "CallbackExecutor.h"
+
+#include "logger.h"
+
+#define TAG "OIC_CALLBACK_EXECUTOR"
+
+namespace OC
+{
+    CallbackExecutor::CallbackExecutor(uint16_t threadCount, size_t queueSize,
+                                       CallbackOverflowPolicy overflowPolicy)
+        : m_stats(std::make_shared<Stats>()), m_queueSize(0), m_overflowPolicy(overflowPolicy),
+          m_nextWorker(0)
+    {
+        if (0 == threadCount)
+        {
+            threadCount = 1;
+        }
+
+        // the queue size is shared evenly by the threads.
+        m_queueSize = queueSize / threadCount;
+        if (0 == m_queueSize)
+        {
+            m_queueSize = 1;
+        }
+
+        for (uint16_t i = 0; i < threadCount; i++)
+        {
+            m_workers.push_back(std::make_shared<Worker>());
+        }
+        for (auto& worker : m_workers)
+        {
+            worker->thread = std::thread(&CallbackExecutor::run, worker, m_stats);
+        }
+    }
+
+    CallbackExecutor::~CallbackExecutor()
+    {
+        for (auto& worker : m_workers)
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->stop = true;
+            worker->cond.notify_one();
+        }
+
+        for (auto& worker : m_workers)
+        {
+            if (worker->thread.get_id() == std::this_thread::get_id())
+            {
+                // destroyed from one of its own callbacks, the thread keeps its worker alive.
+                worker->thread.detach();
+            }
+            else if (worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+        }
+    }
+
+    CallbackExecutor::Worker& CallbackExecutor::getWorker(const void* key)
+    {
+        size_t index;
+        if (key)
+        {
+            // Fibonacci hashing spreads the aligned addresses over the workers.
+            uint64_t hash = reinterpret_cast<uintptr_t>(key) * 0x9E3779B97F4A7C15ULL;
+            index = static_cast<size_t>(hash >> 32) % m_workers.size();
+        }
+        else
+        {
+            index = m_nextWorker++ % m_workers.size();
+        }
+        return *m_workers[index];
+    }
+
+    void CallbackExecutor::post(const void* key, Task task)
+    {
+        Worker& worker = getWorker(key);
+        bool overflow = false;
+        Task dropped;
+
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            overflow = worker.queue.size() >= m_queueSize;
+            if (overflow && CallbackOverflowPolicy::DropOldest == m_overflowPolicy)
+            {
+                dropped = std::move(worker.queue.front().task);
+                worker.queue.pop_front();
+            }
+            if (!overflow || CallbackOverflowPolicy::DropOldest == m_overflowPolicy)
+            {
+                worker.queue.push_back(Item{std::move(task), Clock::now()});
+                worker.cond.notify_one();
+            }
+
+            // counted before the worker can take the callback.
+            std::lock_guard<std::mutex> statsLock(m_stats->mutex);
+            CallbackStats& counters = m_stats->counters;
+            if (!overflow)
+            {
+                counters.queued++;
+                if (counters.queued > counters.maxQueued)
+                {
+                    counters.maxQueued = counters.queued;
+                }
+            }
+            else if (CallbackOverflowPolicy::SpawnThread == m_overflowPolicy)
+            {
+                counters.spawned++;
+            }
+            else
+            {
+                counters.dropped++;
+            }
+        }
+
+        if (overflow)
+        {
+            OIC_LOG(WARNING, TAG, "callback queue is full");
+            if (CallbackOverflowPolicy::SpawnThread == m_overflowPolicy)
+            {
+                spawn(std::move(task));
+            }
+        }
+    }
+
+    void CallbackExecutor::spawn(Task task)
+    {
+        std::thread exec(std::move(task));
+        exec.detach();
+    }
+
+    void CallbackExecutor::run(std::shared_ptr<Worker> worker, std::shared_ptr<Stats> stats)
+    {
+        std::unique_lock<std::mutex> lock(worker->mutex);
+        for (;;)
+        {
+            worker->cond.wait(lock, [&worker]{ return worker->stop || !worker->queue.empty(); });
+            if (worker->queue.empty())
+            {
+                // stopped and nothing left to run.
+                break;
+            }
+
+            Item item = std::move(worker->queue.front());
+            worker->queue.pop_front();
+            lock.unlock();
+
+            uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                                    Clock::now() - item.enqueueTime).count();
+            {
+                std::lock_guard<std::mutex> statsLock(stats->mutex);
+                CallbackStats& counters = stats->counters;
+                counters.queued--;
+                counters.executed++;
+                counters.totalQueueLatencyUs += latency;
+                if (latency > counters.maxQueueLatencyUs)
+                {
+                    counters.maxQueueLatencyUs = latency;
+                }
+            }
+
+            try
+            {
+                item.task();
+            }
+            catch (std::exception& e)
+            {
+                OIC_LOG_V(ERROR, TAG, "Exception in client callback: %s", e.what());
+            }
+            item.task = nullptr;
+
+            lock.lock();
+        }
+    }
+
+    CallbackStats CallbackExecutor::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_stats->mutex);
+        return m_stats->counters;
+    }
+}
@@ -21,6 +21,7 @@
 #include "iotivity_config.h"
 
 #include "InProcClientWrapper.h"
+#include "CallbackExecutor.h"
 #include "ocstack.h"
 
 #include "OCPlatform.h"
@@ -35,11 +36,37 @@ using namespace std;
 
 namespace OC
 {
+    /**
+     * Run a client callback on the callback executor, or on a thread of its own when
+     * no executor is configured.  The callbacks posted with the same key run in order.
+     */
+    static void executeCallback(const std::weak_ptr<CallbackExecutor>& executor,
+                                const void* key, CallbackExecutor::Task task)
+    {
+        auto callbackExecutor = executor.lock();
+        if (callbackExecutor)
+        {
+            callbackExecutor->post(key, std::move(task));
+        }
+        else
+        {
+            std::thread exec(std::move(task));
+            exec.detach();
+        }
+    }
+
     InProcClientWrapper::InProcClientWrapper(
         std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
             : m_threadRun(false), m_csdkLock(csdkLock),
               m_cfg { cfg }
     {
+        if (m_cfg.callbackThreads > 0)
+        {
+            m_callbackExecutor = std::make_shared<CallbackExecutor>(m_cfg.callbackThreads,
+                                                                    m_cfg.callbackQueueSize,
+                                                                    m_cfg.callbackOverflowPolicy);
+        }
+
         // if the config type is server, we ought to never get called.  If the config type
         // is both, we count on the server to run the thread and do the initialize
         start();
@@ -57,6 +84,17 @@ namespace OC
         }
     }
 
+    OCStackResult InProcClientWrapper::GetCallbackStats(CallbackStats& stats)
+    {
+        if (!m_callbackExecutor)
+        {
+            return OC_STACK_NOTIMPL;
+        }
+
+        stats = m_callbackExecutor->getStats();
+        return OC_STACK_OK;
+    }
+
     OCStackResult InProcClientWrapper::start()
     {
         OIC_LOG(INFO, TAG, "start");
@@ -79,6 +117,7 @@ namespace OC
         if (m_threadRun && m_listeningThread.joinable())
         {
             m_threadRun = false;
+            OCProcessWakeUp();
             m_listeningThread.join();
         }
         return OC_STACK_OK;
@@ -89,11 +128,13 @@ namespace OC
         while(m_threadRun)
         {
             OCStackResult result;
+            uint32_t timeout = 0;
             auto cLock = m_csdkLock.lock();
             if (cLock)
             {
                 std::lock_guard<std::recursive_mutex> lock(*cLock);
                 result = OCProcess();
+                timeout = OCGetProcessTimeout();
             }
             else
             {
@@ -105,8 +146,11 @@ namespace OC
                 // TODO: do something with result if failed?
             }
 
-            // To minimize CPU utilization we may wish to do this with sleep
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until there is something to process, or poll if the stack cannot wait.
+            if (result != OC_STACK_OK || OCProcessWait(timeout) != OC_STACK_OK)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -186,8 +230,7 @@ namespace OC
 
             for(auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                executeCallback(context->executor, nullptr, std::bind(context->callback, resource));
             }
         }
         catch (std::exception &e)
@@ -235,16 +278,15 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                executeCallback(context->executor, nullptr, std::bind(context->callback, resource));
             }
             return OC_STACK_KEEP_TRANSACTION;
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
         std::string resourceURI = clientResponse->resourceUri;
-        std::thread exec(context->errorCallback, resourceURI, result);
-        exec.detach();
+        executeCallback(context->executor, nullptr,
+                        std::bind(context->errorCallback, resourceURI, result));
         return OC_STACK_KEEP_TRANSACTION;
     }
 
@@ -264,7 +306,8 @@ namespace OC
         resourceUri << serviceUrl << resourceType;
 
         ClientCallbackContext::ListenContext* context =
-            new ClientCallbackContext::ListenContext(callback, shared_from_this());
+            new ClientCallbackContext::ListenContext(callback, shared_from_this(),
+                                                     m_callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(context),
         cbdata.cb      = listenCallback;
@@ -306,7 +349,8 @@ namespace OC
 
         ClientCallbackContext::ListenErrorContext* context =
             new ClientCallbackContext::ListenErrorContext(callback, errorCallback,
-                                                          shared_from_this());
+                                                          shared_from_this(),
+                                                          m_callbackExecutor);
         if (!context)
         {
             return OC_STACK_ERROR;
@@ -380,8 +424,8 @@ namespace OC
                                     reinterpret_cast<OCDiscoveryPayload*>(clientResponse->payload));
 
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-            std::thread exec(context->callback, container.Resources());
-            exec.detach();
+            executeCallback(context->executor, nullptr,
+                            std::bind(context->callback, container.Resources()));
         }
         catch (std::exception &e)
         {
@@ -408,7 +452,8 @@ namespace OC
         resourceUri << serviceUrl << resourceType;
 
         ClientCallbackContext::ListenResListContext* context =
-            new ClientCallbackContext::ListenResListContext(callback, shared_from_this());
+            new ClientCallbackContext::ListenResListContext(callback, shared_from_this(),
+                                                            m_callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(context),
         cbdata.cb      = listenResListCallback;
@@ -452,8 +497,8 @@ namespace OC
 
             //send the error callback
             std::string uri = clientResponse->resourceUri;
-            std::thread exec(context->errorCallback, uri, result);
-            exec.detach();
+            executeCallback(context->executor, nullptr,
+                            std::bind(context->errorCallback, uri, result));
             return OC_STACK_KEEP_TRANSACTION;
         }
 
@@ -479,8 +524,8 @@ namespace OC
                             reinterpret_cast<OCDiscoveryPayload*>(clientResponse->payload));
 
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-            std::thread exec(context->callback, container.Resources());
-            exec.detach();
+            executeCallback(context->executor, nullptr,
+                            std::bind(context->callback, container.Resources()));
         }
         catch (std::exception &e)
         {
@@ -509,7 +554,8 @@ namespace OC
 
         ClientCallbackContext::ListenResListWithErrorContext* context =
             new ClientCallbackContext::ListenResListWithErrorContext(callback, errorCallback,
-                                                          shared_from_this());
+                                                          shared_from_this(),
+                                                          m_callbackExecutor);
         if (!context)
         {
             return OC_STACK_ERROR;
@@ -558,9 +604,9 @@ namespace OC
                     << clientResponse->result
                     << std::flush;
 
-            std::thread exec(context->callback, clientResponse->result,
-                             resourceURI, nullptr);
-            exec.detach();
+            executeCallback(context->executor, nullptr,
+                            std::bind(context->callback, clientResponse->result, resourceURI,
+                                      nullptr));
 
             return OC_STACK_DELETE_TRANSACTION;
         }
@@ -581,9 +627,9 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, clientResponse->result,
-                                 resourceURI, resource);
-                exec.detach();
+                executeCallback(context->executor, nullptr,
+                                std::bind(context->callback, clientResponse->result, resourceURI,
+                                          resource));
             }
         }
         catch (std::exception &e)
@@ -610,7 +656,8 @@ namespace OC
         }
 
         ClientCallbackContext::MQTopicContext* context =
-            new ClientCallbackContext::MQTopicContext(callback, shared_from_this());
+            new ClientCallbackContext::MQTopicContext(callback, shared_from_this(),
+                                                      m_callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(context),
         cbdata.cb      = listenMQCallback;
@@ -654,8 +701,7 @@ namespace OC
         {
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
             OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
-            exec.detach();
+            executeCallback(context->executor, nullptr, std::bind(context->callback, rep));
         }
         catch(OC::OCException& e)
         {
@@ -682,7 +728,8 @@ namespace OC
         deviceUri << serviceUrl << deviceURI;
 
         ClientCallbackContext::DeviceListenContext* context =
-            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this());
+            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this(),
+                                                           m_callbackExecutor);
         OCCallbackData cbdata;
 
         cbdata.context = static_cast<void*>(context),
@@ -792,19 +839,15 @@ namespace OC
                                             createdUri);
                 for (auto resource : container.Resources())
                 {
-                    std::thread exec(context->callback, result,
-                                     createdUri,
-                                     resource);
-                    exec.detach();
+                    executeCallback(context->executor, nullptr,
+                                    std::bind(context->callback, result, createdUri, resource));
                 }
             }
             else
             {
                 OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-                std::thread exec(context->callback, result,
-                                 createdUri,
-                                 nullptr);
-                exec.detach();
+                executeCallback(context->executor, nullptr,
+                                std::bind(context->callback, result, createdUri, nullptr));
             }
         }
         catch (std::exception &e)
@@ -828,7 +871,8 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::MQTopicContext* ctx =
-                new ClientCallbackContext::MQTopicContext(callback, shared_from_this());
+                new ClientCallbackContext::MQTopicContext(callback, shared_from_this(),
+                                                      m_callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = createMQTopicCallback;
@@ -882,8 +926,8 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
-        exec.detach();
+        executeCallback(context->executor, nullptr,
+                        std::bind(context->callback, serverHeaderOptions, rep, result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -901,7 +945,7 @@ namespace OC
 
         OCStackResult result;
         ClientCallbackContext::GetContext* ctx =
-            new ClientCallbackContext::GetContext(callback);
+            new ClientCallbackContext::GetContext(callback, m_callbackExecutor);
 
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx);
@@ -958,8 +1002,8 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
-        exec.detach();
+        executeCallback(context->executor, nullptr,
+                        std::bind(context->callback, serverHeaderOptions, attrs, result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -1051,6 +1095,10 @@ namespace OC
             ocInfo.addRepresentation(r);
         }
 
+        if (m_cfg.directEncoding)
+        {
+            return ocInfo.getEncodedPayload();
+        }
         return reinterpret_cast<OCPayload*>(ocInfo.getPayload());
     }
 
@@ -1068,7 +1116,8 @@ namespace OC
         }
 
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = setResourceCallback;
@@ -1115,7 +1164,8 @@ namespace OC
         }
 
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = setResourceCallback;
@@ -1161,8 +1211,8 @@ namespace OC
         parseServerHeaderOptions(clientResponse, serverHeaderOptions);
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, clientResponse->result);
-        exec.detach();
+        executeCallback(context->executor, nullptr,
+                        std::bind(context->callback, serverHeaderOptions, clientResponse->result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -1181,7 +1231,7 @@ namespace OC
 
         OCStackResult result;
         ClientCallbackContext::DeleteContext* ctx =
-            new ClientCallbackContext::DeleteContext(callback);
+            new ClientCallbackContext::DeleteContext(callback, m_callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = deleteResourceCallback;
@@ -1236,9 +1286,9 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
-                    result, sequenceNumber);
-        exec.detach();
+        executeCallback(context->executor, context,
+                        std::bind(context->callback, serverHeaderOptions, attrs, result,
+                                  sequenceNumber));
         if (sequenceNumber == MAX_SEQUENCE_NUMBER + 1)
         {
             return OC_STACK_DELETE_TRANSACTION;
@@ -1261,7 +1311,7 @@ namespace OC
         OCStackResult result;
 
         ClientCallbackContext::ObserveContext* ctx =
-            new ClientCallbackContext::ObserveContext(callback);
+            new ClientCallbackContext::ObserveContext(callback, m_callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = observeResourceCallback;
@@ -1358,10 +1408,9 @@ namespace OC
         std::string url = clientResponse->devAddr.addr;
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, clientResponse->result,
-                    clientResponse->sequenceNumber, url);
-
-        exec.detach();
+        executeCallback(context->executor, context,
+                        std::bind(context->callback, clientResponse->result,
+                                  clientResponse->sequenceNumber, url));
 
         return OC_STACK_KEEP_TRANSACTION;
     }
@@ -1376,7 +1425,8 @@ namespace OC
         }
 
         ClientCallbackContext::SubscribePresenceContext* ctx =
-            new ClientCallbackContext::SubscribePresenceContext(presenceHandler);
+            new ClientCallbackContext::SubscribePresenceContext(presenceHandler,
+                                                                m_callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = subscribePresenceCallback;
@@ -1437,7 +1487,7 @@ namespace OC
         OCStackResult result;
 
         ClientCallbackContext::ObserveContext* ctx =
-            new ClientCallbackContext::ObserveContext(callback);
+            new ClientCallbackContext::ObserveContext(callback, m_callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = observeResourceCallback;
@@ -1560,8 +1610,7 @@ namespace OC
             else {
                 OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
+                executeCallback(m_callbackExecutor, nullptr, std::bind(callback, dpDeviceList));
                 result = OC_STACK_OK;
             }
         }
@@ -1599,8 +1648,7 @@ namespace OC
             else {
                 OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
+                executeCallback(m_callbackExecutor, nullptr, std::bind(callback, dpDeviceList));
                 result = OC_STACK_OK;
             }
         }
@@ -1620,8 +1668,8 @@ namespace OC
             static_cast<ClientCallbackContext::DirectPairingContext*>(ctx);
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, cloneDevice(peer), result);
-        exec.detach();
+        executeCallback(context->executor, nullptr,
+                        std::bind(context->callback, cloneDevice(peer), result));
     }
 
     OCStackResult InProcClientWrapper::DoDirectPairing(std::shared_ptr<OCDirectPairing> peer,
@@ -1635,7 +1683,7 @@ namespace OC
 
         OCStackResult result = OC_STACK_ERROR;
         ClientCallbackContext::DirectPairingContext* context =
-            new ClientCallbackContext::DirectPairingContext(callback);
+            new ClientCallbackContext::DirectPairingContext(callback, m_callbackExecutor);
 
         auto cLock = m_csdkLock.lock();
         if (cLock)
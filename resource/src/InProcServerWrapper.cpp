@@ -284,6 +284,7 @@ namespace OC
         if(m_processThread.joinable())
         {
             m_threadRun = false;
+            OCProcessWakeUp();
             m_processThread.join();
         }
 
@@ -296,10 +297,12 @@ namespace OC
         while(cLock && m_threadRun)
         {
             OCStackResult result;
+            uint32_t timeout = 0;
 
             {
                 std::lock_guard<std::recursive_mutex> lock(*cLock);
                 result = OCProcess();
+                timeout = OCGetProcessTimeout();
             }
 
             if(OC_STACK_ERROR == result)
@@ -308,7 +311,11 @@ namespace OC
                 // ...the value of variable result is simply ignored for now.
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until there is something to process, or poll if the stack cannot wait.
+            if(OC_STACK_OK != result || OC_STACK_OK != OCProcessWait(timeout))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -622,7 +629,14 @@ namespace OC
             response.requestHandle = pResponse->getRequestHandle();
             response.ehResult = pResponse->getResponseResult();
 
-            response.payload = reinterpret_cast<OCPayload*>(pResponse->getPayload());
+            if (m_cfg.directEncoding)
+            {
+                response.payload = pResponse->getEncodedPayload();
+            }
+            else
+            {
+                response.payload = reinterpret_cast<OCPayload*>(pResponse->getPayload());
+            }
 
             response.persistentBufferFlag = 0;
 
@@ -375,6 +375,11 @@ namespace OC
             return OCPlatform_impl::Instance().doDirectPairing(peer, pmSel,
                                              pinNumber, resultCallback);
         }
+
+        OCStackResult getCallbackStats(CallbackStats& stats)
+        {
+            return OCPlatform_impl::Instance().getCallbackStats(stats);
+        }
 #ifdef WITH_CLOUD
         OCAccountManager::Ptr constructAccountManagerObject(const std::string& host,
                                                             OCConnectivityType connectivityType)
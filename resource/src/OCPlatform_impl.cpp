@@ -668,6 +668,16 @@ namespace OC
         return checked_guard(m_client, &IClientWrapper::DoDirectPairing,
                              peer, pmSel, pinNumber, resultCallback);
     }
+
+    OCStackResult OCPlatform_impl::getCallbackStats(CallbackStats& stats)
+    {
+        if (!m_client)
+        {
+            return OC_STACK_ERROR;
+        }
+
+        return m_client->GetCallbackStats(stats);
+    }
 #ifdef WITH_CLOUD
     OCAccountManager::Ptr OCPlatform_impl::constructAccountManagerObject(const std::string& host,
                                                             OCConnectivityType connectivityType)
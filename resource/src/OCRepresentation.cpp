@@ -33,6 +33,7 @@
 #include <iomanip>
 #include "iotivity_config.h"
 #include "ocpayload.h"
+#include "cbor.h"
 #include "ocrandom.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
@@ -104,6 +105,375 @@ namespace OC
     }
 }
 
+namespace OC
+{
+    // The encoders below write the same CBOR as OCConvertPayload() does for the OCRepPayload
+    // tree built by getPayload() (see ocpayloadconvert.c), so they must follow its rules:
+    // nested representations only carry their values, vectors are padded to their largest
+    // dimensions and empty byte strings are dropped.
+
+    static const size_t INITIAL_CBOR_PAYLOAD_SIZE = 256;
+
+    static int64_t encodeRepMap(CborEncoder* parent, const OCRepresentation& rep);
+
+    // getPayload() skips the byte strings OCRepPayloadSetPropByteString() refuses.
+    static bool isEncodedValue(const AttributeValue& value)
+    {
+        if (const OCByteString* bytes = boost::get<OCByteString>(&value))
+        {
+            return bytes->bytes && bytes->len;
+        }
+        if (const std::vector<uint8_t>* binary = boost::get<std::vector<uint8_t>>(&value))
+        {
+            return !binary->empty();
+        }
+        return true;
+    }
+
+    static int64_t encodeArrayItem(CborEncoder* array, int item)
+    {
+        return cbor_encode_int(array, item);
+    }
+
+    static int64_t encodeArrayItem(CborEncoder* array, double item)
+    {
+        return cbor_encode_double(array, item);
+    }
+
+    static int64_t encodeArrayItem(CborEncoder* array, bool item)
+    {
+        return cbor_encode_boolean(array, item);
+    }
+
+    static int64_t encodeArrayItem(CborEncoder* array, const std::string& item)
+    {
+        return cbor_encode_text_string(array, item.c_str(), item.size());
+    }
+
+    static int64_t encodeArrayItem(CborEncoder* array, const OCByteString& item)
+    {
+        return item.len ? cbor_encode_byte_string(array, item.bytes, item.len) :
+                          cbor_encode_null(array);
+    }
+
+    static int64_t encodeArrayItem(CborEncoder* array, const OCRepresentation& item)
+    {
+        return encodeRepMap(array, item);
+    }
+
+    // Padding is zeroed memory in the OCRepPayload arrays, NULL for pointer types.
+    template<typename T>
+    static int64_t encodeArrayPadding(CborEncoder* array)
+    {
+        return encodeArrayItem(array, T());
+    }
+
+    template<>
+    int64_t encodeArrayPadding<std::string>(CborEncoder* array)
+    {
+        return cbor_encode_null(array);
+    }
+
+    template<>
+    int64_t encodeArrayPadding<OCRepresentation>(CborEncoder* array)
+    {
+        return cbor_encode_null(array);
+    }
+
+    // Encodes an array of length items, padded past the end of items (or entirely if null).
+    template<typename T>
+    static int64_t encodePaddedArray(CborEncoder* parent, const std::vector<T>* items,
+                                     size_t length)
+    {
+        CborEncoder array;
+        int64_t err = cbor_encoder_create_array(parent, &array, length);
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (items && i < items->size())
+            {
+                err |= encodeArrayItem(&array, (*items)[i]);
+            }
+            else
+            {
+                err |= encodeArrayPadding<T>(&array);
+            }
+        }
+        err |= cbor_encoder_close_container(parent, &array);
+        return err;
+    }
+
+    struct encode_cbor_value: boost::static_visitor<int64_t>
+    {
+        explicit encode_cbor_value(CborEncoder* enc) : encoder(enc) {}
+
+        int64_t operator()(const NullType&) const
+        {
+            return cbor_encode_null(encoder);
+        }
+
+        int64_t operator()(int item) const
+        {
+            return cbor_encode_int(encoder, item);
+        }
+
+        int64_t operator()(double item) const
+        {
+            return cbor_encode_double(encoder, item);
+        }
+
+        int64_t operator()(bool item) const
+        {
+            return cbor_encode_boolean(encoder, item);
+        }
+
+        int64_t operator()(const std::string& item) const
+        {
+            return cbor_encode_text_string(encoder, item.c_str(), item.size());
+        }
+
+        int64_t operator()(const OCByteString& item) const
+        {
+            return cbor_encode_byte_string(encoder, item.bytes, item.len);
+        }
+
+        int64_t operator()(const OCRepresentation& item) const
+        {
+            return encodeRepMap(encoder, item);
+        }
+
+        int64_t operator()(const std::vector<uint8_t>& item) const
+        {
+            return cbor_encode_byte_string(encoder, item.data(), item.size());
+        }
+
+        template<typename T>
+        int64_t operator()(const std::vector<T>& arr) const
+        {
+            return encodePaddedArray(encoder, &arr, arr.size());
+        }
+
+        template<typename T>
+        int64_t operator()(const std::vector<std::vector<T>>& arr) const
+        {
+            size_t dim1 = 0;
+            for (const auto& row : arr)
+            {
+                dim1 = std::max(dim1, row.size());
+            }
+            if (0 == dim1)
+            {
+                return encodePaddedArray<T>(encoder, nullptr, arr.size());
+            }
+
+            CborEncoder array;
+            int64_t err = cbor_encoder_create_array(encoder, &array, arr.size());
+            for (const auto& row : arr)
+            {
+                err |= encodePaddedArray(&array, &row, dim1);
+            }
+            err |= cbor_encoder_close_container(encoder, &array);
+            return err;
+        }
+
+        template<typename T>
+        int64_t operator()(const std::vector<std::vector<std::vector<T>>>& arr) const
+        {
+            size_t dim1 = 0;
+            size_t dim2 = 0;
+            for (const auto& plane : arr)
+            {
+                dim1 = std::max(dim1, plane.size());
+                for (const auto& row : plane)
+                {
+                    dim2 = std::max(dim2, row.size());
+                }
+            }
+            if (0 == dim1)
+            {
+                return encodePaddedArray<T>(encoder, nullptr, arr.size());
+            }
+
+            CborEncoder array;
+            int64_t err = cbor_encoder_create_array(encoder, &array, arr.size());
+            for (const auto& plane : arr)
+            {
+                if (0 == dim2)
+                {
+                    err |= encodePaddedArray<T>(&array, nullptr, dim1);
+                    continue;
+                }
+
+                CborEncoder array2;
+                err |= cbor_encoder_create_array(&array, &array2, dim1);
+                for (size_t j = 0; j < dim1; ++j)
+                {
+                    err |= encodePaddedArray(&array2, j < plane.size() ? &plane[j] : nullptr,
+                                             dim2);
+                }
+                err |= cbor_encoder_close_container(&array, &array2);
+            }
+            err |= cbor_encoder_close_container(encoder, &array);
+            return err;
+        }
+
+        CborEncoder* encoder;
+    };
+
+    static int64_t encodeValues(CborEncoder* map, const OCRepresentation& rep)
+    {
+        int64_t err = CborNoError;
+        for (const auto& value : rep.getValues())
+        {
+            if (isEncodedValue(value.second))
+            {
+                err |= cbor_encode_text_string(map, value.first.c_str(), value.first.size());
+                err |= boost::apply_visitor(encode_cbor_value(map), value.second);
+            }
+        }
+        return err;
+    }
+
+    // Nested representations become an array when their names are the consecutive
+    // non-negative integers, as in OCConvertRepMap().
+    static int64_t encodeRepMap(CborEncoder* parent, const OCRepresentation& rep)
+    {
+        size_t arrayLength = 0;
+        bool isArray = true;
+        for (const auto& value : rep.getValues())
+        {
+            if (!isEncodedValue(value.second))
+            {
+                continue;
+            }
+            char* endp;
+            long i = strtol(value.first.c_str(), &endp, 0);
+            if (*endp != '\0' || i < 0 || arrayLength != (size_t)i)
+            {
+                isArray = false;
+                break;
+            }
+            ++arrayLength;
+        }
+
+        CborEncoder encoder;
+        int64_t err = CborNoError;
+        if (!isArray)
+        {
+            err |= cbor_encoder_create_map(parent, &encoder, CborIndefiniteLength);
+            err |= encodeValues(&encoder, rep);
+        }
+        else
+        {
+            err |= cbor_encoder_create_array(parent, &encoder, arrayLength);
+            for (const auto& value : rep.getValues())
+            {
+                if (isEncodedValue(value.second))
+                {
+                    err |= boost::apply_visitor(encode_cbor_value(&encoder), value.second);
+                }
+            }
+        }
+        err |= cbor_encoder_close_container(parent, &encoder);
+        return err;
+    }
+
+    static int64_t encodeStringArray(CborEncoder* map, const char* name,
+                                     const std::vector<std::string>& strings)
+    {
+        int64_t err = CborNoError;
+        if (!strings.empty())
+        {
+            err |= cbor_encode_text_string(map, name, strlen(name));
+            err |= encodePaddedArray(map, &strings, strings.size());
+        }
+        return err;
+    }
+
+    static int64_t encodeRepresentations(CborEncoder* encoder,
+                                         const std::vector<OCRepresentation>& reps)
+    {
+        int64_t err = CborNoError;
+        CborEncoder rootArray;
+        bool isBatch = reps.size() > 1;
+        if (isBatch)
+        {
+            err |= cbor_encoder_create_array(encoder, &rootArray, reps.size());
+        }
+
+        for (const OCRepresentation& rep : reps)
+        {
+            CborEncoder* parent = isBatch ? &rootArray : encoder;
+            CborEncoder rootMap;
+            err |= cbor_encoder_create_map(parent, &rootMap, CborIndefiniteLength);
+
+            // Only in case of collection href is included.
+            std::string uri = rep.getUri();
+            if (isBatch && !uri.empty())
+            {
+                err |= cbor_encode_text_string(&rootMap, OC_RSRVD_HREF, strlen(OC_RSRVD_HREF));
+                err |= cbor_encode_text_string(&rootMap, uri.c_str(), uri.size());
+            }
+            err |= encodeStringArray(&rootMap, OC_RSRVD_RESOURCE_TYPE, rep.getResourceTypes());
+            err |= encodeStringArray(&rootMap, OC_RSRVD_INTERFACE, rep.getResourceInterfaces());
+            err |= encodeValues(&rootMap, rep);
+
+            err |= cbor_encoder_close_container(parent, &rootMap);
+        }
+
+        if (isBatch)
+        {
+            err |= cbor_encoder_close_container(encoder, &rootArray);
+        }
+        return err;
+    }
+
+    std::vector<uint8_t> MessageContainer::getCborPayload() const
+    {
+        std::vector<uint8_t> cbor;
+        if (m_reps.empty())
+        {
+            return cbor;
+        }
+
+        cbor.resize(INITIAL_CBOR_PAYLOAD_SIZE);
+        for (;;)
+        {
+            CborEncoder encoder;
+            cbor_encoder_init(&encoder, cbor.data(), cbor.size(), 0);
+            int64_t err = encodeRepresentations(&encoder, m_reps);
+
+            // The encoder reports the exact size needed when the buffer is too small.
+            if (CborErrorOutOfMemory == err)
+            {
+                cbor.resize(cbor.size() + cbor_encoder_get_extra_bytes_needed(&encoder));
+                continue;
+            }
+            if (CborNoError != err)
+            {
+                throw OC::OCException("Failed to encode representation");
+            }
+            cbor.resize(cbor_encoder_get_buffer_size(&encoder, cbor.data()));
+            return cbor;
+        }
+    }
+
+    OCPayload* MessageContainer::getEncodedPayload() const
+    {
+        if (m_reps.empty())
+        {
+            return nullptr;
+        }
+
+        std::vector<uint8_t> cbor = getCborPayload();
+        OCEncodedRepPayload* payload = OCEncodedRepPayloadCreate(cbor.data(), cbor.size());
+        if (!payload)
+        {
+            throw std::bad_alloc();
+        }
+        return reinterpret_cast<OCPayload*>(payload);
+    }
+}
+
 namespace OC
 {
     struct get_payload_array: boost::static_visitor<>
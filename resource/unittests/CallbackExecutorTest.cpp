@@ -0,0 +1,214 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <CallbackExecutor.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace CallbackExecutorTest
+{
+    using namespace OC;
+
+    // Blocks the worker threads until release() is called.
+    class Gate
+    {
+    public:
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this]{ return m_open; });
+        }
+
+        void release()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open = true;
+            m_cond.notify_all();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        bool m_open = false;
+    };
+
+    TEST(CallbackExecutorTest, KeyedCallbacksRunInOrder)
+    {
+        const int keys = 8;
+        const int perKey = 500;
+        int keyObjects[keys];
+        std::vector<int> lastValue(keys, 0);
+        std::atomic<bool> outOfOrder(false);
+
+        {
+            CallbackExecutor executor(4, 4 * keys * perKey, CallbackOverflowPolicy::SpawnThread);
+            for (int i = 1; i <= perKey; i++)
+            {
+                for (int k = 0; k < keys; k++)
+                {
+                    executor.post(&keyObjects[k], [&lastValue, &outOfOrder, k, i]()
+                    {
+                        if (lastValue[k] + 1 != i)
+                        {
+                            outOfOrder = true;
+                        }
+                        lastValue[k] = i;
+                    });
+                }
+            }
+            // the destructor runs the callbacks still queued.
+        }
+
+        EXPECT_FALSE(outOfOrder);
+        for (int k = 0; k < keys; k++)
+        {
+            EXPECT_EQ(perKey, lastValue[k]);
+        }
+    }
+
+    TEST(CallbackExecutorTest, StatsCountExecutedCallbacks)
+    {
+        CallbackExecutor executor(2, 64, CallbackOverflowPolicy::SpawnThread);
+        std::atomic<int> count(0);
+        for (int i = 0; i < 20; i++)
+        {
+            executor.post(nullptr, [&count]{ count++; });
+        }
+        while (count < 20)
+        {
+            std::this_thread::yield();
+        }
+
+        CallbackStats stats = executor.getStats();
+        EXPECT_EQ(20u, stats.executed);
+        EXPECT_EQ(0u, stats.dropped);
+        EXPECT_EQ(0u, stats.spawned);
+        EXPECT_EQ(0u, stats.queued);
+        EXPECT_LE(1u, stats.maxQueued);
+        EXPECT_LE(stats.maxQueueLatencyUs, stats.totalQueueLatencyUs);
+    }
+
+    TEST(CallbackExecutorTest, DropNewestDiscardsCallbacksThatDoNotFit)
+    {
+        Gate gate;
+        std::vector<int> ran;
+        int key = 0;
+        {
+            CallbackExecutor executor(1, 2, CallbackOverflowPolicy::DropNewest);
+            executor.post(&key, [&gate]{ gate.wait(); });
+            // wait for the worker to take the blocking callback.
+            while (executor.getStats().queued > 0)
+            {
+                std::this_thread::yield();
+            }
+            for (int i = 1; i <= 4; i++)
+            {
+                executor.post(&key, [&ran, i]{ ran.push_back(i); });
+            }
+
+            CallbackStats stats = executor.getStats();
+            EXPECT_EQ(2u, stats.queued);
+            EXPECT_EQ(2u, stats.dropped);
+            gate.release();
+        }
+        EXPECT_EQ(std::vector<int>({1, 2}), ran);
+    }
+
+    TEST(CallbackExecutorTest, DropOldestKeepsLatestCallbacks)
+    {
+        Gate gate;
+        std::vector<int> ran;
+        int key = 0;
+        {
+            CallbackExecutor executor(1, 2, CallbackOverflowPolicy::DropOldest);
+            executor.post(&key, [&gate]{ gate.wait(); });
+            while (executor.getStats().queued > 0)
+            {
+                std::this_thread::yield();
+            }
+            for (int i = 1; i <= 4; i++)
+            {
+                executor.post(&key, [&ran, i]{ ran.push_back(i); });
+            }
+
+            EXPECT_EQ(2u, executor.getStats().dropped);
+            gate.release();
+        }
+        EXPECT_EQ(std::vector<int>({3, 4}), ran);
+    }
+
+    TEST(CallbackExecutorTest, SpawnThreadRunsOverflowingCallbacks)
+    {
+        Gate gate;
+        std::atomic<int> count(0);
+        int key = 0;
+        {
+            CallbackExecutor executor(1, 1, CallbackOverflowPolicy::SpawnThread);
+            executor.post(&key, [&gate]{ gate.wait(); });
+            while (executor.getStats().queued > 0)
+            {
+                std::this_thread::yield();
+            }
+            executor.post(&key, [&count]{ count++; });
+            executor.post(&key, [&count]{ count++; });
+            executor.post(&key, [&count]{ count++; });
+
+            // the overflowing callbacks do not wait for the blocked worker.
+            while (count < 2)
+            {
+                std::this_thread::yield();
+            }
+            EXPECT_EQ(2u, executor.getStats().spawned);
+            gate.release();
+        }
+        EXPECT_EQ(3, count);
+    }
+
+    TEST(CallbackExecutorTest, ExecutorCanBeDestroyedFromItsCallback)
+    {
+        Gate gate;
+        Gate finished;
+        std::atomic<int> count(0);
+        int key = 0;
+
+        std::shared_ptr<CallbackExecutor> executor =
+            std::make_shared<CallbackExecutor>(1, 4, CallbackOverflowPolicy::DropNewest);
+        std::weak_ptr<CallbackExecutor> weak = executor;
+        std::shared_ptr<CallbackExecutor> self = executor;
+
+        executor->post(&key, [&gate]{ gate.wait(); });
+        // the last reference is released on the worker thread.
+        executor->post(&key, [self]() mutable { self.reset(); });
+        executor->post(&key, [&count, &finished]{ count++; finished.release(); });
+        self.reset();
+        executor.reset();
+        gate.release();
+
+        // the callback queued behind still runs once the executor is gone.
+        finished.wait();
+        EXPECT_TRUE(weak.expired());
+        EXPECT_EQ(1, count);
+    }
+}
@@ -1638,4 +1638,78 @@ namespace OCRepresentationEncodingTest
         OCRepPayloadDestroy(repPayload);
         OCPayloadDestroy(cparsed);
     }
+
+    static void ExpectDirectEncodingMatches(const OC::MessageContainer& mc)
+    {
+        OCRepPayload *repPayload = mc.getPayload();
+        uint8_t *cborData = NULL;
+        size_t cborSize = 0;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)repPayload, OC_FORMAT_CBOR,
+                    &cborData, &cborSize));
+
+        std::vector<uint8_t> direct = mc.getCborPayload();
+        EXPECT_EQ(std::vector<uint8_t>(cborData, cborData + cborSize), direct);
+
+        OICFree(cborData);
+        OCRepPayloadDestroy(repPayload);
+    }
+
+    TEST(RepresentationEncodingDirect, MatchesPayloadConversion)
+    {
+        OC::OCRepresentation inner;
+        inner.setUri("/inner");
+        inner.setValue("int", 1);
+        inner.setValue("str", std::string("inner"));
+
+        OC::OCRepresentation numbered;
+        numbered.setValue("0", 3.5);
+        numbered.setValue("1", false);
+
+        OC::OCRepresentation rep;
+        rep.setUri("/a/light");
+        rep.addResourceType("core.light");
+        rep.addResourceInterface("oic.if.baseline");
+        rep.setNULL("null");
+        rep.setValue("int", -70000);
+        rep.setValue("double", 0.25);
+        rep.setValue("bool", true);
+        rep.setValue("string", std::string("value"));
+        rep.setValue("binary", std::vector<uint8_t>{1, 2, 3});
+        rep.setValue("emptyBinary", std::vector<uint8_t>());
+        rep.setValue("object", inner);
+        rep.setValue("numbered", numbered);
+        rep.setValue("emptyObject", OC::OCRepresentation());
+        rep.setValue("ints", std::vector<int>{1, 2, 3});
+        rep.setValue("noInts", std::vector<int>());
+        rep.setValue("bools", std::vector<bool>{true, false});
+        rep.setValue("strings", std::vector<std::vector<std::string>>{{"a"}, {"b", "c"}});
+        rep.setValue("objects", std::vector<std::vector<OC::OCRepresentation>>{{inner},
+                    {inner, numbered}});
+        rep.setValue("doubles", std::vector<std::vector<std::vector<double>>>{{{1.0}, {2.0, 3.0}},
+                    {{}}});
+        rep.setValue("emptyRows", std::vector<std::vector<int>>{{}, {}});
+
+        OC::MessageContainer single;
+        single.addRepresentation(rep);
+        ExpectDirectEncodingMatches(single);
+
+        OC::OCRepresentation noUri;
+        noUri.setValue("x", 1);
+        OC::MessageContainer batch;
+        batch.addRepresentation(rep);
+        batch.addRepresentation(inner);
+        batch.addRepresentation(noUri);
+        ExpectDirectEncodingMatches(batch);
+
+        OC::MessageContainer empty;
+        EXPECT_TRUE(empty.getCborPayload().empty());
+        EXPECT_EQ(NULL, empty.getEncodedPayload());
+
+        OCPayload *encoded = single.getEncodedPayload();
+        ASSERT_NE((OCPayload*)NULL, encoded);
+        EXPECT_EQ(PAYLOAD_TYPE_ENCODED_REPRESENTATION, encoded->type);
+        EXPECT_EQ(single.getCborPayload().size(),
+                  ((OCEncodedRepPayload*)encoded)->cborPayload.len);
+        OCPayloadDestroy(encoded);
+    }
 }
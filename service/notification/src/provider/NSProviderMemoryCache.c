@@ -20,6 +20,11 @@
 
 #include "NSProviderMemoryCache.h"
 #include <string.h>
+#include <coap/uthash.h>
+
+/* NSProviderAddEntry and NSProviderAddToBucket fail when the indexes cannot grow. */
+#undef uthash_fatal
+#define uthash_fatal(msg) goto uthash_oom
 
 #define NS_PROVIDER_DELETE_REGISTERED_TOPIC_DATA(it, topicData, newObj) \
     { \
@@ -34,17 +39,365 @@
         } \
     }
 
+/**
+ * Hash entry pointing at a cached element. The key is owned by the element data.
+ */
+typedef struct _NSCacheEntry
+{
+    const char * key;
+    NSCacheElement * element;
+    UT_hash_handle hh;
+
+} NSCacheEntry;
+
+/**
+ * Elements of the consumer topic list sharing a consumer ID or a topic name.
+ * The entries are keyed by the other half of the pair.
+ */
+typedef struct _NSCacheBucket
+{
+    char * key;
+    NSCacheEntry * entries;
+    UT_hash_handle hh;
+
+} NSCacheBucket;
+
+/**
+ * Provider cache list. The elements stay on the list in insertion order, the
+ * indexes resolve lookups by consumer ID and topic name without walking it.
+ */
+typedef struct
+{
+    NSCacheList list;
+    size_t count;
+    NSCacheEntry * byId; // subscribers by consumer ID, registered topics by name
+    NSCacheBucket * byConsumer; // consumer topics by consumer ID
+    NSCacheBucket * byTopic; // consumer topics by topic name
+
+} NSProviderCacheList;
+
+#define NS_PROVIDER_CACHE(list) ((NSProviderCacheList *) (list))
+
+static bool NSProviderIsConsumerTopicType(NSCacheType type)
+{
+    return (type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME ||
+            type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID);
+}
+
+static const char * NSProviderGetCacheKey(NSCacheType type, void * data)
+{
+    if (type == NS_PROVIDER_CACHE_SUBSCRIBER || type == NS_PROVIDER_CACHE_SUBSCRIBER_OBSERVE_ID)
+    {
+        return ((NSCacheSubData *) data)->id;
+    }
+    else if (type == NS_PROVIDER_CACHE_REGISTER_TOPIC)
+    {
+        return ((NSCacheTopicData *) data)->topicName;
+    }
+
+    return NULL;
+}
+
+static NSCacheEntry * NSProviderFindEntry(NSCacheEntry * table, const char * key)
+{
+    NSCacheEntry * entry = NULL;
+    HASH_FIND_STR(table, key, entry);
+    return entry;
+}
+
+static bool NSProviderAddEntry(NSCacheEntry ** table, const char * key, NSCacheElement * element)
+{
+    NSCacheEntry * entry = (NSCacheEntry *) OICMalloc(sizeof(NSCacheEntry));
+
+    if (!entry)
+    {
+        return false;
+    }
+
+    entry->key = key;
+    entry->element = element;
+    HASH_ADD_KEYPTR(hh, *table, entry->key, strlen(entry->key), entry);
+    return true;
+
+uthash_oom:
+    if (!entry->hh.tbl || !entry->hh.tbl->buckets)
+    {
+        uthash_free(entry->hh.tbl, sizeof(UT_hash_table));
+        *table = NULL;
+    }
+    else
+    {
+        HASH_DEL(*table, entry);
+    }
+    OICFree(entry);
+    return false;
+}
+
+static void NSProviderRemoveEntry(NSCacheEntry ** table, const char * key)
+{
+    NSCacheEntry * entry = NSProviderFindEntry(*table, key);
+
+    if (entry)
+    {
+        HASH_DEL(*table, entry);
+        OICFree(entry);
+    }
+}
+
+static NSCacheBucket * NSProviderFindBucket(NSCacheBucket * table, const char * key)
+{
+    NSCacheBucket * bucket = NULL;
+    HASH_FIND_STR(table, key, bucket);
+    return bucket;
+}
+
+static void NSProviderRemoveFromBucket(NSCacheBucket ** table, const char * key,
+        const char * entryKey)
+{
+    NSCacheBucket * bucket = NSProviderFindBucket(*table, key);
+
+    if (!bucket)
+    {
+        return;
+    }
+
+    NSProviderRemoveEntry(&bucket->entries, entryKey);
+
+    if (!bucket->entries)
+    {
+        HASH_DEL(*table, bucket);
+        OICFree(bucket->key);
+        OICFree(bucket);
+    }
+}
+
+static bool NSProviderAddToBucket(NSCacheBucket ** table, const char * key,
+        const char * entryKey, NSCacheElement * element)
+{
+    NSCacheBucket * bucket = NSProviderFindBucket(*table, key);
+
+    if (!bucket)
+    {
+        bucket = (NSCacheBucket *) OICCalloc(1, sizeof(NSCacheBucket));
+
+        if (!bucket)
+        {
+            return false;
+        }
+
+        bucket->key = OICStrdup(key);
+
+        if (!bucket->key)
+        {
+            OICFree(bucket);
+            return false;
+        }
+
+        HASH_ADD_KEYPTR(hh, *table, bucket->key, strlen(bucket->key), bucket);
+    }
+
+    if (!NSProviderAddEntry(&bucket->entries, entryKey, element))
+    {
+        if (!bucket->entries)
+        {
+            HASH_DEL(*table, bucket);
+            OICFree(bucket->key);
+            OICFree(bucket);
+        }
+
+        return false;
+    }
+
+    return true;
+
+uthash_oom:
+    if (!bucket->hh.tbl || !bucket->hh.tbl->buckets)
+    {
+        uthash_free(bucket->hh.tbl, sizeof(UT_hash_table));
+        *table = NULL;
+    }
+    else
+    {
+        HASH_DEL(*table, bucket);
+    }
+    OICFree(bucket->key);
+    OICFree(bucket);
+    return false;
+}
+
+static void NSProviderClearBuckets(NSCacheBucket ** table)
+{
+    NSCacheBucket * bucket = NULL;
+    NSCacheBucket * tmpBucket = NULL;
+
+    HASH_ITER(hh, *table, bucket, tmpBucket)
+    {
+        NSCacheEntry * entry = NULL;
+        NSCacheEntry * tmpEntry = NULL;
+
+        HASH_ITER(hh, bucket->entries, entry, tmpEntry)
+        {
+            HASH_DEL(bucket->entries, entry);
+            OICFree(entry);
+        }
+
+        HASH_DEL(*table, bucket);
+        OICFree(bucket->key);
+        OICFree(bucket);
+    }
+}
+
+static bool NSProviderIndexElement(NSCacheList * list, NSCacheElement * element)
+{
+    NSProviderCacheList * cache = NS_PROVIDER_CACHE(list);
+
+    if (NSProviderIsConsumerTopicType(list->cacheType))
+    {
+        NSCacheTopicSubData * data = (NSCacheTopicSubData *) element->data;
+
+        if (!NSProviderAddToBucket(&cache->byConsumer, data->id, data->topicName, element))
+        {
+            return false;
+        }
+
+        if (!NSProviderAddToBucket(&cache->byTopic, data->topicName, data->id, element))
+        {
+            NSProviderRemoveFromBucket(&cache->byConsumer, data->id, data->topicName);
+            return false;
+        }
+
+        return true;
+    }
+
+    const char * key = NSProviderGetCacheKey(list->cacheType, element->data);
+
+    return key ? NSProviderAddEntry(&cache->byId, key, element) : true;
+}
+
+static void NSProviderUnindexElement(NSCacheList * list, NSCacheElement * element)
+{
+    NSProviderCacheList * cache = NS_PROVIDER_CACHE(list);
+
+    if (NSProviderIsConsumerTopicType(list->cacheType))
+    {
+        NSCacheTopicSubData * data = (NSCacheTopicSubData *) element->data;
+        NSProviderRemoveFromBucket(&cache->byConsumer, data->id, data->topicName);
+        NSProviderRemoveFromBucket(&cache->byTopic, data->topicName, data->id);
+        return;
+    }
+
+    const char * key = NSProviderGetCacheKey(list->cacheType, element->data);
+
+    if (key)
+    {
+        NSCacheEntry * entry = NSProviderFindEntry(cache->byId, key);
+
+        // keep the entry of another element registered under the same key.
+        if (entry && entry->element == element)
+        {
+            HASH_DEL(cache->byId, entry);
+            OICFree(entry);
+        }
+    }
+}
+
+static NSCacheElement * NSProviderFindElement(NSCacheList * list, const char * findId)
+{
+    NSProviderCacheList * cache = NS_PROVIDER_CACHE(list);
+    NSCacheType type = list->cacheType;
+
+    if (NSProviderIsConsumerTopicType(type))
+    {
+        NSCacheBucket * bucket = NSProviderFindBucket(
+                (type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME) ?
+                        cache->byTopic : cache->byConsumer, findId);
+        return bucket ? bucket->entries->element : NULL;
+    }
+    else if (type == NS_PROVIDER_CACHE_SUBSCRIBER || type == NS_PROVIDER_CACHE_REGISTER_TOPIC)
+    {
+        NSCacheEntry * entry = NSProviderFindEntry(cache->byId, findId);
+        return entry ? entry->element : NULL;
+    }
+
+    // observe IDs are not indexed; they are only looked up on unsubscription.
+    NSCacheElement * iter = list->head;
+
+    while (iter)
+    {
+        if (NSProviderCompareIdCacheData(type, iter->data, findId))
+        {
+            return iter;
+        }
+
+        iter = iter->next;
+    }
+
+    return NULL;
+}
+
+static NSCacheElement * NSProviderFindConsumerTopic(NSCacheList * conTopicList,
+        const char * cId, const char * topicName)
+{
+    NSCacheBucket * bucket = NSProviderFindBucket(NS_PROVIDER_CACHE(conTopicList)->byConsumer, cId);
+
+    if (!bucket)
+    {
+        return NULL;
+    }
+
+    NSCacheEntry * entry = NSProviderFindEntry(bucket->entries, topicName);
+    return entry ? entry->element : NULL;
+}
+
+static void NSProviderRemoveElement(NSCacheList * list, NSCacheElement * del)
+{
+    NSCacheElement * prev = NULL;
+    NSCacheElement * iter = list->head;
+
+    while (iter && iter != del)
+    {
+        prev = iter;
+        iter = iter->next;
+    }
+
+    if (!iter)
+    {
+        return;
+    }
+
+    if (prev)
+    {
+        prev->next = del->next;
+    }
+    else
+    {
+        list->head = del->next;
+    }
+
+    if (del == list->tail) // delete object same to last object
+    {
+        list->tail = prev;
+    }
+
+    NS_PROVIDER_CACHE(list)->count--;
+    NSProviderUnindexElement(list, del);
+    NSProviderDeleteCacheData(list->cacheType, del->data);
+    NSOICFree(del);
+}
+
 NSCacheList * NSProviderStorageCreate()
 {
     pthread_mutex_lock(&NSCacheMutex);
-    NSCacheList * newList = (NSCacheList *) OICMalloc(sizeof(NSCacheList));
+    NSProviderCacheList * newCache = (NSProviderCacheList *) OICCalloc(1,
+            sizeof(NSProviderCacheList));
 
-    if (!newList)
+    if (!newCache)
     {
         pthread_mutex_unlock(&NSCacheMutex);
         return NULL;
     }
 
+    NSCacheList * newList = &newCache->list;
     newList->head = newList->tail = NULL;
 
     pthread_mutex_unlock(&NSCacheMutex);
@@ -58,32 +411,23 @@ NSCacheElement * NSProviderStorageRead(NSCacheList * list, const char * findId)
     pthread_mutex_lock(&NSCacheMutex);
 
     NS_LOG(DEBUG, "NSCacheRead - IN");
-
-    NSCacheElement * iter = list->head;
-    NSCacheElement * next = NULL;
-    NSCacheType type = list->cacheType;
-
     NS_LOG_V(INFO_PRIVATE, "Find ID - %s", findId);
 
-    while (iter)
-    {
-        next = iter->next;
-
-        if (NSProviderCompareIdCacheData(type, iter->data, findId))
-        {
-            NS_LOG(DEBUG, "Found in Cache");
-            pthread_mutex_unlock(&NSCacheMutex);
-            return iter;
-        }
+    NSCacheElement * found = NSProviderFindElement(list, findId);
 
-        iter = next;
+    if (found)
+    {
+        NS_LOG(DEBUG, "Found in Cache");
+    }
+    else
+    {
+        NS_LOG(DEBUG, "Not found in Cache");
     }
 
-    NS_LOG(DEBUG, "Not found in Cache");
     NS_LOG(DEBUG, "NSCacheRead - OUT");
     pthread_mutex_unlock(&NSCacheMutex);
 
-    return NULL;
+    return found;
 }
 
 NSResult NSCacheUpdateSubScriptionState(NSCacheList * list, char * id, bool state)
@@ -152,73 +496,74 @@ NSResult NSProviderStorageWrite(NSCacheList * list, NSCacheElement * newObj)
         NS_LOG(DEBUG, "Type is SUBSCRIBER");
 
         NSCacheSubData * subData = (NSCacheSubData *) newObj->data;
-        NSCacheElement * it = NSProviderStorageRead(list, subData->id);
+        NSCacheElement * it = NSProviderFindElement(list, subData->id);
 
         if (it)
         {
             NSCacheSubData * itData = (NSCacheSubData *) it->data;
 
-            if (strcmp(itData->id, subData->id) == 0)
-            {
-                NS_LOG(DEBUG, "Update Data - IN");
-
-                NS_LOG_V(INFO_PRIVATE, "currData_ID = %s", itData->id);
-                NS_LOG_V(DEBUG, "currData_MsgObID = %d", itData->messageObId);
-                NS_LOG_V(DEBUG, "currData_SyncObID = %d", itData->syncObId);
-                NS_LOG_V(DEBUG, "currData_IsWhite = %d", itData->isWhite);
+            NS_LOG(DEBUG, "Update Data - IN");
 
-                NS_LOG_V(INFO_PRIVATE, "subData_ID = %s", subData->id);
-                NS_LOG_V(DEBUG, "subData_MsgObID = %d", subData->messageObId);
-                NS_LOG_V(DEBUG, "subData_SyncObID = %d", subData->syncObId);
-                NS_LOG_V(DEBUG, "subData_IsWhite = %d", subData->isWhite);
+            NS_LOG_V(INFO_PRIVATE, "currData_ID = %s", itData->id);
+            NS_LOG_V(DEBUG, "currData_MsgObID = %d", itData->messageObId);
+            NS_LOG_V(DEBUG, "currData_SyncObID = %d", itData->syncObId);
+            NS_LOG_V(DEBUG, "currData_IsWhite = %d", itData->isWhite);
 
-                if (subData->messageObId != 0)
-                {
-                    itData->messageObId = subData->messageObId;
-                }
+            NS_LOG_V(INFO_PRIVATE, "subData_ID = %s", subData->id);
+            NS_LOG_V(DEBUG, "subData_MsgObID = %d", subData->messageObId);
+            NS_LOG_V(DEBUG, "subData_SyncObID = %d", subData->syncObId);
+            NS_LOG_V(DEBUG, "subData_IsWhite = %d", subData->isWhite);
 
-                if (subData->syncObId != 0)
-                {
-                    itData->syncObId = subData->syncObId;
-                }
+            if (subData->messageObId != 0)
+            {
+                itData->messageObId = subData->messageObId;
+            }
 
-                NS_LOG(DEBUG, "Update Data - OUT");
-                NSOICFree(subData);
-                NSOICFree(newObj);
-                pthread_mutex_unlock(&NSCacheMutex);
-                return NS_OK;
+            if (subData->syncObId != 0)
+            {
+                itData->syncObId = subData->syncObId;
             }
-        }
 
+            NS_LOG(DEBUG, "Update Data - OUT");
+            NSOICFree(subData);
+            NSOICFree(newObj);
+            pthread_mutex_unlock(&NSCacheMutex);
+            return NS_OK;
+        }
     }
     else if (type == NS_PROVIDER_CACHE_REGISTER_TOPIC)
     {
         NS_LOG(DEBUG, "Type is REGITSTER TOPIC");
 
         NSCacheTopicData * topicData = (NSCacheTopicData *) newObj->data;
-        NSCacheElement * it = NSProviderStorageRead(list, topicData->topicName);
+        NSCacheElement * it = NSProviderFindElement(list, topicData->topicName);
 
         NS_PROVIDER_DELETE_REGISTERED_TOPIC_DATA(it, topicData, newObj);
     }
-    else if (type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME)
+    else if (NSProviderIsConsumerTopicType(type))
     {
-        NS_LOG(DEBUG, "Type is REGITSTER TOPIC");
+        NS_LOG(DEBUG, "Type is CONSUMER TOPIC");
 
+        // a topic can be subscribed by many consumers, but only once by each.
         NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) newObj->data;
-        NSCacheElement * it = NSProviderStorageRead(list, topicData->topicName);
+        NSCacheElement * it = NSProviderFindConsumerTopic(list, topicData->id,
+                topicData->topicName);
 
         NS_PROVIDER_DELETE_REGISTERED_TOPIC_DATA(it, topicData, newObj);
     }
-    else if (type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID)
-    {
-        NS_LOG(DEBUG, "Type is REGITSTER TOPIC");
-
-        NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) newObj->data;
-        NSCacheElement * it = NSProviderStorageRead(list, topicData->id);
 
-        NS_PROVIDER_DELETE_REGISTERED_TOPIC_DATA(it, topicData, newObj);
+    if (!NSProviderIndexElement(list, newObj))
+    {
+        NS_LOG(ERROR, "Fail to index cache data");
+        NSProviderDeleteCacheData(type, newObj->data);
+        NSOICFree(newObj);
+        pthread_mutex_unlock(&NSCacheMutex);
+        return NS_FAIL;
     }
 
+    newObj->next = NULL;
+    NS_PROVIDER_CACHE(list)->count++;
+
     if (list->head == NULL)
     {
         NS_LOG(DEBUG, "list->head is NULL, Insert First Data");
@@ -235,6 +580,7 @@ NSResult NSProviderStorageWrite(NSCacheList * list, NSCacheElement * newObj)
 
 NSResult NSProviderStorageDestroy(NSCacheList * list)
 {
+    NSProviderCacheList * cache = NS_PROVIDER_CACHE(list);
     NSCacheElement * iter = list->head;
     NSCacheElement * next = NULL;
     NSCacheType type = list->cacheType;
@@ -247,7 +593,19 @@ NSResult NSProviderStorageDestroy(NSCacheList * list)
         iter = next;
     }
 
-    NSOICFree(list);
+    NSCacheEntry * entry = NULL;
+    NSCacheEntry * tmpEntry = NULL;
+
+    HASH_ITER(hh, cache->byId, entry, tmpEntry)
+    {
+        HASH_DEL(cache->byId, entry);
+        OICFree(entry);
+    }
+
+    NSProviderClearBuckets(&cache->byConsumer);
+    NSProviderClearBuckets(&cache->byTopic);
+
+    NSOICFree(cache);
     return NS_OK;
 }
 
@@ -389,59 +747,25 @@ NSResult NSProviderDeleteCacheData(NSCacheType type, void * data)
 NSResult NSProviderStorageDelete(NSCacheList * list, const char * delId)
 {
     pthread_mutex_lock(&NSCacheMutex);
-    NSCacheElement * prev = list->head;
-    NSCacheElement * del = list->head;
 
-    NSCacheType type = list->cacheType;
-
-    if (!del)
+    if (!list->head)
     {
         NS_LOG(DEBUG, "list head is NULL");
         pthread_mutex_unlock(&NSCacheMutex);
         return NS_FAIL;
     }
 
-    if (NSProviderCompareIdCacheData(type, del->data, delId))
-    {
-        if (del == list->head) // first object
-        {
-            if (del == list->tail) // first object (one object)
-            {
-                list->tail = del->next;
-            }
-
-            list->head = del->next;
-            NSProviderDeleteCacheData(type, del->data);
-            NSOICFree(del);
-            pthread_mutex_unlock(&NSCacheMutex);
-            return NS_OK;
-        }
-    }
-
-    del = del->next;
+    NSCacheElement * del = NSProviderFindElement(list, delId);
 
-    while (del)
+    if (!del)
     {
-        if (NSProviderCompareIdCacheData(type, del->data, delId))
-        {
-            if (del == list->tail) // delete object same to last object
-            {
-                list->tail = prev;
-            }
-
-            prev->next = del->next;
-            NSProviderDeleteCacheData(type, del->data);
-            NSOICFree(del);
-            pthread_mutex_unlock(&NSCacheMutex);
-            return NS_OK;
-        }
-
-        prev = del;
-        del = del->next;
+        pthread_mutex_unlock(&NSCacheMutex);
+        return NS_FAIL;
     }
 
+    NSProviderRemoveElement(list, del);
     pthread_mutex_unlock(&NSCacheMutex);
-    return NS_FAIL;
+    return NS_OK;
 }
 
 NSTopicLL * NSProviderGetTopicsCacheData(NSCacheList * regTopicList)
@@ -495,6 +819,7 @@ NSTopicLL * NSProviderGetTopicsCacheData(NSCacheList * regTopicList)
     return topics;
 }
 
+
 NSTopicLL * NSProviderGetConsumerTopicsCacheData(NSCacheList * regTopicList,
         NSCacheList * conTopicList, const char * consumerId)
 {
@@ -509,42 +834,35 @@ NSTopicLL * NSProviderGetConsumerTopicsCacheData(NSCacheList * regTopicList,
         return NULL;
     }
 
-    NSCacheElement * iter = conTopicList->head;
-    conTopicList->cacheType = NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID;
+    NSCacheBucket * bucket = NSProviderFindBucket(NS_PROVIDER_CACHE(conTopicList)->byConsumer,
+            consumerId);
 
-    while (iter)
+    if (bucket)
     {
-        NSCacheTopicSubData * curr = (NSCacheTopicSubData *)iter->data;
+        NS_LOG_V(INFO_PRIVATE, "consumerId = %s", consumerId);
 
-        if (curr && strcmp(curr->id, consumerId) == 0)
-        {
-            NS_LOG_V(INFO_PRIVATE, "curr->id = %s", curr->id);
-            NS_LOG_V(DEBUG, "curr->topicName = %s", curr->topicName);
-            NSTopicLL * topicIter = topics;
+        NSTopicLL * topicIter = topics;
 
-            while (topicIter)
+        while (topicIter)
+        {
+            if (NSProviderFindEntry(bucket->entries, topicIter->topicName))
             {
-                if (strcmp(topicIter->topicName, curr->topicName) == 0)
-                {
-                    topicIter->state = NS_TOPIC_SUBSCRIBED;
-                    break;
-                }
-
-                topicIter = topicIter->next;
+                NS_LOG_V(DEBUG, "subscribed topicName = %s", topicIter->topicName);
+                topicIter->state = NS_TOPIC_SUBSCRIBED;
             }
-        }
 
-        iter = iter->next;
+            topicIter = topicIter->next;
+        }
     }
 
-    conTopicList->cacheType = NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME;
     pthread_mutex_unlock(&NSCacheMutex);
     NS_LOG(DEBUG, "NSProviderGetConsumerTopics - OUT");
 
     return topics;
 }
 
-bool NSProviderIsTopicSubScribed(NSCacheElement * conTopicList, char * cId, char * topicName)
+bool NSProviderIsTopicSubScribed(NSCacheList * conTopicList, const char * cId,
+        const char * topicName)
 {
     pthread_mutex_lock(&NSCacheMutex);
 
@@ -554,23 +872,10 @@ bool NSProviderIsTopicSubScribed(NSCacheElement * conTopicList, char * cId, char
         return false;
     }
 
-    NSCacheElement * iter = conTopicList;
-
-    while (iter)
-    {
-        NSCacheTopicSubData * curr = (NSCacheTopicSubData *) iter->data;
-
-        if ( (strcmp(curr->id, cId) == 0) && (strcmp(curr->topicName, topicName) == 0) )
-        {
-            pthread_mutex_unlock(&NSCacheMutex);
-            return true;
-        }
-
-        iter = iter->next;
-    }
+    bool subscribed = (NSProviderFindConsumerTopic(conTopicList, cId, topicName) != NULL);
 
     pthread_mutex_unlock(&NSCacheMutex);
-    return false;
+    return subscribed;
 }
 
 NSResult NSProviderDeleteConsumerTopic(NSCacheList * conTopicList,
@@ -587,67 +892,111 @@ NSResult NSProviderDeleteConsumerTopic(NSCacheList * conTopicList,
         return NS_ERROR;
     }
 
-    NSCacheElement * prev = conTopicList->head;
-    NSCacheElement * del = conTopicList->head;
-
-    NSCacheType type = conTopicList->cacheType;
-
-    if (!del)
+    if (!conTopicList->head)
     {
         NS_LOG(DEBUG, "list head is NULL");
         pthread_mutex_unlock(&NSCacheMutex);
         return NS_FAIL;
     }
 
-    NSCacheTopicSubData * curr = (NSCacheTopicSubData *) del->data;
     NS_LOG_V(INFO_PRIVATE, "compareid = %s", cId);
     NS_LOG_V(DEBUG, "comparetopicName = %s", topicName);
-    NS_LOG_V(INFO_PRIVATE, "curr->id = %s", curr->id);
-    NS_LOG_V(DEBUG, "curr->topicName = %s", curr->topicName);
 
-    if ( (strncmp(curr->id, cId, NS_UUID_STRING_SIZE) == 0) &&
-            (strcmp(curr->topicName, topicName) == 0) )
+    NSCacheElement * del = NSProviderFindConsumerTopic(conTopicList, cId, topicName);
+
+    if (!del)
     {
-        if (del == conTopicList->head) // first object
-        {
-            if (del == conTopicList->tail) // first object (one object)
-            {
-                conTopicList->tail = del->next;
-            }
+        pthread_mutex_unlock(&NSCacheMutex);
+        return NS_FAIL;
+    }
 
-            conTopicList->head = del->next;
-            NSProviderDeleteCacheData(type, del->data);
-            NSOICFree(del);
-            pthread_mutex_unlock(&NSCacheMutex);
-            return NS_OK;
-        }
+    NSProviderRemoveElement(conTopicList, del);
+    pthread_mutex_unlock(&NSCacheMutex);
+    return NS_OK;
+}
+
+static bool NSProviderAddObserverId(NSCacheSubData * subData, bool isSync,
+        OCObservationId * obArray, size_t * obCount)
+{
+    int obId = isSync ? subData->syncObId : subData->messageObId;
+
+    if (subData->isWhite && obId != 0)
+    {
+        obArray[(*obCount)++] = (OCObservationId) obId;
+        return true;
     }
 
-    curr = NULL;
-    del = del->next;
+    return false;
+}
+
+static OCObservationId * NSProviderGetObserverIds(NSCacheList * subList,
+        NSCacheList * conTopicList, const char * topicName, bool isSync, size_t * obCount)
+{
+    pthread_mutex_lock(&NSCacheMutex);
+
+    NSProviderCacheList * subCache = NS_PROVIDER_CACHE(subList);
+    OCObservationId * obArray = NULL;
+    *obCount = 0;
 
-    while (del)
+    if (topicName && topicName[0] != '\0')
     {
-        curr = (NSCacheTopicSubData *) del->data;
-        if ( (strncmp(curr->id, cId, NS_UUID_STRING_SIZE) == 0) &&
-                (strcmp(curr->topicName, topicName) == 0) )
+        // only the consumers subscribed to the topic are visited.
+        NSCacheBucket * bucket = NSProviderFindBucket(NS_PROVIDER_CACHE(conTopicList)->byTopic,
+                topicName);
+
+        if (bucket)
         {
-            if (del == conTopicList->tail) // delete object same to last object
+            obArray = (OCObservationId *) OICMalloc(
+                    HASH_COUNT(bucket->entries) * sizeof(OCObservationId));
+        }
+
+        if (obArray)
+        {
+            NSCacheEntry * entry = NULL;
+            NSCacheEntry * tmpEntry = NULL;
+
+            HASH_ITER(hh, bucket->entries, entry, tmpEntry)
             {
-                conTopicList->tail = prev;
-            }
+                NSCacheEntry * sub = NSProviderFindEntry(subCache->byId, entry->key);
 
-            prev->next = del->next;
-            NSProviderDeleteCacheData(type, del->data);
-            NSOICFree(del);
-            pthread_mutex_unlock(&NSCacheMutex);
-            return NS_OK;
+                if (sub)
+                {
+                    NSProviderAddObserverId((NSCacheSubData *) sub->element->data, isSync,
+                            obArray, obCount);
+                }
+            }
         }
+    }
+    else if (subCache->count)
+    {
+        obArray = (OCObservationId *) OICMalloc(subCache->count * sizeof(OCObservationId));
+
+        NSCacheElement * it = obArray ? subList->head : NULL;
 
-        prev = del;
-        del = del->next;
+        while (it)
+        {
+            NSProviderAddObserverId((NSCacheSubData *) it->data, isSync, obArray, obCount);
+            it = it->next;
+        }
     }
 
     pthread_mutex_unlock(&NSCacheMutex);
-    return NS_FAIL;
+
+    if (!*obCount)
+    {
+        NSOICFree(obArray);
+    }
+
+    return obArray;
+}
+
+OCObservationId * NSProviderGetMessageObserverIds(NSCacheList * subList,
+        NSCacheList * conTopicList, const char * topicName, size_t * obCount)
+{
+    return NSProviderGetObserverIds(subList, conTopicList, topicName, false, obCount);
+}
+
+OCObservationId * NSProviderGetSyncObserverIds(NSCacheList * subList, size_t * obCount)
+{
+    return NSProviderGetObserverIds(subList, NULL, NULL, true, obCount);
 }
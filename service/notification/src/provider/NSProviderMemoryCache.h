@@ -52,11 +52,17 @@ NSTopicLL * NSProviderGetTopicsCacheData(NSCacheList * regTopicList);
 NSTopicLL * NSProviderGetConsumerTopicsCacheData(NSCacheList * regTopicList,
         NSCacheList * conTopicList, const char * consumerId);
 
-bool NSProviderIsTopicSubScribed(NSCacheElement * conTopicList, char * cId, char * topicName);
+bool NSProviderIsTopicSubScribed(NSCacheList * conTopicList, const char * cId,
+        const char * topicName);
 
 NSResult NSProviderDeleteConsumerTopic(NSCacheList * conTopicList,
         NSCacheTopicSubData * topicSubData);
 
+OCObservationId * NSProviderGetMessageObserverIds(NSCacheList * subList,
+        NSCacheList * conTopicList, const char * topicName, size_t * obCount);
+
+OCObservationId * NSProviderGetSyncObserverIds(NSCacheList * subList, size_t * obCount);
+
 pthread_mutex_t NSCacheMutex;
 pthread_mutexattr_t NSCacheMutexAttr;
 
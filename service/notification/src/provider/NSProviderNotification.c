@@ -108,7 +108,7 @@ NSResult NSSendNotification(NSMessage *msg)
     NS_LOG(DEBUG, "NSSendMessage - IN");
 
     OCResourceHandle rHandle = NULL;
-    OCObservationId obArray[255] = { 0, };
+    OCObservationId * obArray = NULL;
     size_t obCount = 0;
 
     if (NSPutMessageResource(msg, &rHandle) != NS_OK)
@@ -140,38 +140,14 @@ NSResult NSSendNotification(NSMessage *msg)
         return NS_ERROR;
     }
 
-    NSCacheElement * it = consumerSubList->head;
-
-    while (it)
+    if (msg->topic && (msg->topic)[0] != '\0')
     {
-        NSCacheSubData * subData = (NSCacheSubData *) it->data;
-        NS_LOG_V(INFO_PRIVATE, "message subData->id = %s", subData->id);
-        NS_LOG_V(DEBUG, "subData->messageId = %d", subData->messageObId);
-        NS_LOG_V(DEBUG, "subData->syncId = %d", subData->syncObId);
-        NS_LOG_V(DEBUG, "subData->isWhite = %d", subData->isWhite);
-
-        if (subData->isWhite)
-        {
-            if(subData->messageObId != 0)
-            {
-                if (msg->topic && (msg->topic)[0] != '\0')
-                {
-                    NS_LOG_V(DEBUG, "this is topic message: %s", msg->topic);
-
-                    if (NSProviderIsTopicSubScribed(consumerTopicList->head, subData->id, msg->topic))
-                    {
-                        obArray[obCount++] = subData->messageObId;
-                    }
-                }
-                else
-                {
-                    obArray[obCount++] = subData->messageObId;
-                }
-            }
-        }
-        it = it->next;
+        NS_LOG_V(DEBUG, "this is topic message: %s", msg->topic);
     }
 
+    obArray = NSProviderGetMessageObserverIds(consumerSubList, consumerTopicList, msg->topic,
+            &obCount);
+
     for (size_t i = 0; i < obCount; ++i)
     {
         NS_LOG(DEBUG, "-------------------------------------------------------message\n");
@@ -187,8 +163,9 @@ NSResult NSSendNotification(NSMessage *msg)
         return NS_ERROR;
     }
 
-    OCStackResult ocstackResult = OCNotifyListOfObservers(rHandle, obArray, obCount, payload,
+    OCStackResult ocstackResult = NSNotifyListOfObservers(rHandle, obArray, obCount, payload,
             OC_LOW_QOS);
+    NSOICFree(obArray);
 
     NS_LOG_V(DEBUG, "Message ocstackResult = %d", ocstackResult);
 
@@ -211,7 +188,7 @@ NSResult NSSendSync(NSSyncInfo *sync)
 {
     NS_LOG(DEBUG, "NSSendSync - IN");
 
-    OCObservationId obArray[255] = { 0, };
+    OCObservationId * obArray = NULL;
     size_t obCount = 0;
 
     OCResourceHandle rHandle = NULL;
@@ -221,26 +198,6 @@ NSResult NSSendSync(NSSyncInfo *sync)
         return NS_ERROR;
     }
 
-    NSCacheElement * it = consumerSubList->head;
-
-    while (it)
-    {
-        NSCacheSubData * subData = (NSCacheSubData *) it->data;
-        NS_LOG_V(INFO_PRIVATE, "sync subData->id = %s", subData->id);
-        NS_LOG_V(DEBUG, "subData->messageId = %d", subData->messageObId);
-        NS_LOG_V(DEBUG, "subData->syncId = %d", subData->syncObId);
-        NS_LOG_V(DEBUG, "subData->isWhite = %d", subData->isWhite);
-
-        if (subData->isWhite)
-        {
-            if (subData->syncObId != 0)
-            {
-                obArray[obCount++] = subData->syncObId;
-            }
-        }
-        it = it->next;
-    }
-
     OCRepPayload* payload = NULL;
     if (NSSetSyncPayload(sync, &payload) != NS_OK)
     {
@@ -248,6 +205,8 @@ NSResult NSSendSync(NSSyncInfo *sync)
         return NS_ERROR;
     }
 
+    obArray = NSProviderGetSyncObserverIds(consumerSubList, &obCount);
+
 #ifdef WITH_MQ
     if (NSGetMQServerInfo())
     {
@@ -275,8 +234,9 @@ NSResult NSSendSync(NSSyncInfo *sync)
         NS_LOG(DEBUG, "-------------------------------------------------------message\n");
     }
 
-    OCStackResult ocstackResult = OCNotifyListOfObservers(rHandle, obArray,
+    OCStackResult ocstackResult = NSNotifyListOfObservers(rHandle, obArray,
             obCount, payload, OC_LOW_QOS);
+    NSOICFree(obArray);
 
     NS_LOG_V(DEBUG, "Sync ocstackResult = %d", ocstackResult);
     if (ocstackResult != OC_STACK_OK)
@@ -319,6 +319,36 @@ NSResult NSSendConsumerSubResponse(OCEntityHandlerRequest * entityHandlerRequest
     return NS_OK;
 }
 
+OCStackResult NSNotifyListOfObservers(OCResourceHandle handle, OCObservationId * obArray,
+        size_t obCount, OCRepPayload * payload, OCQualityOfService qos)
+{
+    // OCNotifyListOfObservers takes at most UINT8_MAX observers at a time.
+    // A batch without any live observer must not keep the next batches from being sent,
+    // so all batches are sent and the results are combined as the stack does for one batch.
+    size_t sent = 0;
+    OCStackResult ocstackResult = OC_STACK_OK;
+
+    do
+    {
+        size_t batch = (obCount - sent < UINT8_MAX) ? obCount - sent : UINT8_MAX;
+        OCStackResult batchResult = OCNotifyListOfObservers(handle,
+                obArray ? obArray + sent : NULL, (uint8_t) batch, payload, qos);
+
+        if (sent == 0)
+        {
+            ocstackResult = batchResult;
+        }
+        else if (batchResult != ocstackResult)
+        {
+            ocstackResult = OC_STACK_ERROR;
+        }
+
+        sent += batch;
+    } while (sent < obCount);
+
+    return ocstackResult;
+}
+
 #ifdef WITH_MQ
 void NSProviderMQSubscription(NSMQTopicAddress * topicAddr)
 {
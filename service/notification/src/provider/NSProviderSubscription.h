@@ -45,5 +45,7 @@ void NSHandleUnsubscription(OCEntityHandlerRequest *entityHandlerRequest);
 void NSAskAcceptanceToUser(OCEntityHandlerRequest *entityHandlerRequest);
 NSResult NSSendConsumerSubResponse(OCEntityHandlerRequest *entityHandlerRequest);
 NSResult NSSendResponse(const char * id, bool accepted);
+OCStackResult NSNotifyListOfObservers(OCResourceHandle handle, OCObservationId * obArray,
+        size_t obCount, OCRepPayload * payload, OCQualityOfService qos);
 
 #endif /* _NS_PROVIDER_SUBSCRIPTION_H_ */
@@ -141,26 +141,9 @@ NSResult NSSendTopicUpdation()
     OCRepPayloadSetPropInt(payload, NS_ATTRIBUTE_MESSAGE_ID, NS_TOPIC);
     OCRepPayloadSetPropString(payload, NS_ATTRIBUTE_PROVIDER_ID, NSGetProviderInfo()->providerId);
 
-    OCObservationId obArray[255] =
-    { 0, };
     size_t obCount = 0;
-
-    NSCacheElement * it = consumerSubList->head;
-
-    while (it)
-    {
-        NSCacheSubData * subData = (NSCacheSubData *) it->data;
-
-        if (subData->isWhite)
-        {
-            if (subData->messageObId != 0)
-            {
-                obArray[obCount++] = subData->messageObId;
-            }
-        }
-
-        it = it->next;
-    }
+    OCObservationId * obArray = NSProviderGetMessageObserverIds(consumerSubList, NULL, NULL,
+            &obCount);
 
     if (!obCount)
     {
@@ -169,7 +152,11 @@ NSResult NSSendTopicUpdation()
         return NS_ERROR;
     }
 
-    if (OCNotifyListOfObservers(rHandle, obArray, obCount, payload, OC_HIGH_QOS) != OC_STACK_OK)
+    OCStackResult ocstackResult = NSNotifyListOfObservers(rHandle, obArray, obCount, payload,
+            OC_HIGH_QOS);
+    NSOICFree(obArray);
+
+    if (ocstackResult != OC_STACK_OK)
     {
         NS_LOG(ERROR, "fail to send topic updation");
         OCRepPayloadDestroy(payload);
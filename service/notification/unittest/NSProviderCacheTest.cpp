@@ -0,0 +1,337 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <HippoMocks/hippomocks.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C"
+{
+#include "NSProviderMemoryCache.h"
+#include "NSProviderSubscription.h"
+}
+
+namespace
+{
+    std::string ConsumerId(size_t index)
+    {
+        char id[NS_UUID_STRING_SIZE];
+        snprintf(id, sizeof(id), "consumer-%04u", (unsigned) index);
+        return id;
+    }
+
+    NSCacheElement * CreateElement(void * data)
+    {
+        NSCacheElement * element = (NSCacheElement *) OICMalloc(sizeof(NSCacheElement));
+        element->data = (NSCacheData *) data;
+        element->next = NULL;
+        return element;
+    }
+
+    NSCacheElement * CreateSubscriber(const std::string & id, int messageObId, int syncObId,
+            bool isWhite)
+    {
+        NSCacheSubData * subData = (NSCacheSubData *) OICMalloc(sizeof(NSCacheSubData));
+        OICStrcpy(subData->id, sizeof(subData->id), id.c_str());
+        subData->messageObId = messageObId;
+        subData->syncObId = syncObId;
+        subData->isWhite = isWhite;
+        return CreateElement(subData);
+    }
+
+    NSCacheElement * CreateConsumerTopic(const std::string & id, const std::string & topicName)
+    {
+        NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) OICMalloc(
+                sizeof(NSCacheTopicSubData));
+        OICStrcpy(topicData->id, sizeof(topicData->id), id.c_str());
+        topicData->topicName = OICStrdup(topicName.c_str());
+        return CreateElement(topicData);
+    }
+
+    std::vector<int> TakeObserverIds(OCObservationId * obArray, size_t obCount)
+    {
+        std::vector<int> ids(obArray, obArray + obCount);
+        OICFree(obArray);
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+}
+
+class NotificationProviderCacheTest : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        pthread_mutexattr_init(&NSCacheMutexAttr);
+        pthread_mutexattr_settype(&NSCacheMutexAttr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&NSCacheMutex, &NSCacheMutexAttr);
+
+        subList = NSProviderStorageCreate();
+        ASSERT_TRUE(subList != NULL);
+        subList->cacheType = NS_PROVIDER_CACHE_SUBSCRIBER;
+
+        topicList = NSProviderStorageCreate();
+        ASSERT_TRUE(topicList != NULL);
+        topicList->cacheType = NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME;
+    }
+
+    void TearDown()
+    {
+        if (subList)
+        {
+            NSProviderStorageDestroy(subList);
+        }
+        if (topicList)
+        {
+            NSProviderStorageDestroy(topicList);
+        }
+
+        pthread_mutex_destroy(&NSCacheMutex);
+        pthread_mutexattr_destroy(&NSCacheMutexAttr);
+    }
+
+    NSResult WriteSubscriber(size_t index, bool isWhite = true)
+    {
+        // observation IDs are a single byte, so they repeat over many subscribers.
+        return NSProviderStorageWrite(subList, CreateSubscriber(ConsumerId(index),
+                (int) (index % UINT8_MAX) + 1, (int) (index % UINT8_MAX) + 1, isWhite));
+    }
+
+    NSResult WriteConsumerTopic(size_t index, const std::string & topicName)
+    {
+        return NSProviderStorageWrite(topicList, CreateConsumerTopic(ConsumerId(index), topicName));
+    }
+
+    bool IsSubscribed(size_t index, const char * topicName)
+    {
+        return NSProviderIsTopicSubScribed(topicList, ConsumerId(index).c_str(), topicName);
+    }
+
+    std::vector<int> MessageObserverIds(const char * topicName)
+    {
+        size_t obCount = 0;
+        OCObservationId * obArray = NSProviderGetMessageObserverIds(subList, topicList,
+                topicName, &obCount);
+        return TakeObserverIds(obArray, obCount);
+    }
+
+    std::vector<int> SyncObserverIds()
+    {
+        size_t obCount = 0;
+        OCObservationId * obArray = NSProviderGetSyncObserverIds(subList, &obCount);
+        return TakeObserverIds(obArray, obCount);
+    }
+
+    NSCacheList * subList = NULL;
+    NSCacheList * topicList = NULL;
+};
+
+TEST_F(NotificationProviderCacheTest, ExpectManyConsumersSubscribeSameTopic)
+{
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(NS_OK, WriteConsumerTopic(i, "topic1"));
+    }
+
+    // the same consumer can subscribe a topic only once.
+    EXPECT_EQ(NS_FAIL, WriteConsumerTopic(1, "topic1"));
+    EXPECT_EQ(NS_OK, WriteConsumerTopic(1, "topic2"));
+
+    EXPECT_TRUE(IsSubscribed(0, "topic1"));
+    EXPECT_TRUE(IsSubscribed(1, "topic1"));
+    EXPECT_TRUE(IsSubscribed(2, "topic1"));
+    EXPECT_TRUE(IsSubscribed(1, "topic2"));
+    EXPECT_FALSE(IsSubscribed(3, "topic1"));
+    EXPECT_FALSE(IsSubscribed(0, "topic2"));
+    EXPECT_FALSE(IsSubscribed(0, "topic3"));
+
+    NSCacheElement * element = NSProviderStorageRead(topicList, "topic1");
+    ASSERT_TRUE(element != NULL);
+    EXPECT_STREQ("topic1", ((NSCacheTopicSubData *) element->data)->topicName);
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(NS_OK, WriteSubscriber(i));
+    }
+
+    // a topic message goes to the subscribers of the topic only.
+    EXPECT_EQ(std::vector<int>({ 1, 2, 3 }), MessageObserverIds("topic1"));
+    EXPECT_EQ(std::vector<int>({ 2 }), MessageObserverIds("topic2"));
+    EXPECT_TRUE(MessageObserverIds("topic3").empty());
+    EXPECT_EQ(std::vector<int>({ 1, 2, 3, 4 }), MessageObserverIds(NULL));
+}
+
+TEST_F(NotificationProviderCacheTest, ExpectDeletedSubscribersAreRemovedFromIndex)
+{
+    for (size_t i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(NS_OK, WriteSubscriber(i));
+    }
+
+    // delete from the middle, the head and the tail of the list.
+    EXPECT_EQ(NS_OK, NSProviderStorageDelete(subList, ConsumerId(2).c_str()));
+    EXPECT_EQ(NS_FAIL, NSProviderStorageDelete(subList, ConsumerId(2).c_str()));
+    EXPECT_EQ(NS_OK, NSProviderStorageDelete(subList, ConsumerId(0).c_str()));
+    EXPECT_EQ(NS_OK, NSProviderStorageDelete(subList, ConsumerId(4).c_str()));
+
+    EXPECT_TRUE(NSProviderStorageRead(subList, ConsumerId(0).c_str()) == NULL);
+    EXPECT_TRUE(NSProviderStorageRead(subList, ConsumerId(2).c_str()) == NULL);
+    EXPECT_TRUE(NSProviderStorageRead(subList, ConsumerId(4).c_str()) == NULL);
+    ASSERT_TRUE(subList->head != NULL);
+    EXPECT_EQ(subList->head, NSProviderStorageRead(subList, ConsumerId(1).c_str()));
+    EXPECT_EQ(subList->tail, NSProviderStorageRead(subList, ConsumerId(3).c_str()));
+    EXPECT_EQ(subList->tail, subList->head->next);
+
+    // unsubscription deletes by observation ID, which walks the list instead.
+    OCObservationId obId = 4;
+    subList->cacheType = NS_PROVIDER_CACHE_SUBSCRIBER_OBSERVE_ID;
+    EXPECT_EQ(NS_OK, NSProviderStorageDelete(subList, (const char *) &obId));
+    subList->cacheType = NS_PROVIDER_CACHE_SUBSCRIBER;
+    EXPECT_TRUE(NSProviderStorageRead(subList, ConsumerId(3).c_str()) == NULL);
+    EXPECT_EQ(subList->tail, subList->head);
+
+    // a deleted consumer subscribes again.
+    EXPECT_EQ(NS_OK, WriteSubscriber(3));
+    EXPECT_EQ(subList->tail, NSProviderStorageRead(subList, ConsumerId(3).c_str()));
+    EXPECT_EQ(std::vector<int>({ 2, 4 }), SyncObserverIds());
+}
+
+TEST_F(NotificationProviderCacheTest, ExpectDeletedConsumerTopicsAreRemovedFromIndex)
+{
+    EXPECT_EQ(NS_OK, WriteConsumerTopic(0, "topic1"));
+    EXPECT_EQ(NS_OK, WriteConsumerTopic(1, "topic1"));
+    EXPECT_EQ(NS_OK, WriteConsumerTopic(0, "topic2"));
+    EXPECT_EQ(NS_OK, WriteConsumerTopic(1, "topic2"));
+    EXPECT_EQ(NS_OK, WriteSubscriber(0));
+    EXPECT_EQ(NS_OK, WriteSubscriber(1));
+
+    NSCacheTopicSubData topicSubData;
+    OICStrcpy(topicSubData.id, sizeof(topicSubData.id), ConsumerId(1).c_str());
+    topicSubData.topicName = (char *) "topic1";
+    EXPECT_EQ(NS_OK, NSProviderDeleteConsumerTopic(topicList, &topicSubData));
+    EXPECT_EQ(NS_FAIL, NSProviderDeleteConsumerTopic(topicList, &topicSubData));
+    EXPECT_FALSE(IsSubscribed(1, "topic1"));
+    EXPECT_TRUE(IsSubscribed(0, "topic1"));
+    EXPECT_TRUE(IsSubscribed(1, "topic2"));
+    EXPECT_EQ(std::vector<int>({ 1 }), MessageObserverIds("topic1"));
+
+    // deleting all topics of a consumer, as done when the consumer topics are replaced.
+    size_t deleted = 0;
+    topicList->cacheType = NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID;
+    while (NSProviderStorageDelete(topicList, ConsumerId(0).c_str()) != NS_FAIL)
+    {
+        deleted++;
+    }
+    topicList->cacheType = NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME;
+    EXPECT_EQ(2u, deleted);
+    EXPECT_FALSE(IsSubscribed(0, "topic1"));
+    EXPECT_FALSE(IsSubscribed(0, "topic2"));
+    EXPECT_TRUE(IsSubscribed(1, "topic2"));
+    EXPECT_TRUE(MessageObserverIds("topic1").empty());
+
+    // deleting all subscriptions of a topic, as done when the topic is unregistered.
+    deleted = 0;
+    while (NSProviderStorageDelete(topicList, "topic2") != NS_FAIL)
+    {
+        deleted++;
+    }
+    EXPECT_EQ(1u, deleted);
+    EXPECT_TRUE(topicList->head == NULL);
+    EXPECT_TRUE(topicList->tail == NULL);
+    EXPECT_TRUE(MessageObserverIds("topic2").empty());
+
+    EXPECT_EQ(NS_OK, WriteConsumerTopic(0, "topic1"));
+    EXPECT_TRUE(IsSubscribed(0, "topic1"));
+    EXPECT_EQ(std::vector<int>({ 1 }), MessageObserverIds("topic1"));
+}
+
+TEST_F(NotificationProviderCacheTest, ExpectAllObserversCollectedBeyondUint8Max)
+{
+    const size_t count = 3 * UINT8_MAX;
+    size_t allowed = 0;
+    size_t allowedEven = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        // some consumers are not allowed yet, so they are not notified.
+        bool isWhite = (i % 100 != 0);
+        allowed += isWhite ? 1 : 0;
+        allowedEven += (isWhite && i % 2 == 0) ? 1 : 0;
+
+        EXPECT_EQ(NS_OK, WriteSubscriber(i, isWhite));
+        EXPECT_EQ(NS_OK, WriteConsumerTopic(i, "topic1"));
+        if (i % 2 == 0)
+        {
+            EXPECT_EQ(NS_OK, WriteConsumerTopic(i, "topic2"));
+        }
+    }
+
+    EXPECT_EQ(allowed, MessageObserverIds("topic1").size());
+    EXPECT_EQ(allowedEven, MessageObserverIds("topic2").size());
+    EXPECT_EQ(allowed, MessageObserverIds(NULL).size());
+    EXPECT_EQ(allowed, SyncObserverIds().size());
+}
+
+TEST_F(NotificationProviderCacheTest, ExpectObserversNotifiedInBatchesOfUint8Max)
+{
+    MockRepository mocks;
+    std::vector<std::pair<OCObservationId *, uint8_t>> batches;
+    OCStackResult firstResult = OC_STACK_OK;
+
+    mocks.OnCallFunc(OCNotifyListOfObservers).Do(
+        [&batches, &firstResult](OCResourceHandle, OCObservationId * obIdList,
+                uint8_t numberOfIds, const OCRepPayload *, OCQualityOfService)
+        {
+            batches.push_back(std::make_pair(obIdList, numberOfIds));
+            return (batches.size() == 1) ? firstResult : OC_STACK_OK;
+        });
+
+    std::vector<OCObservationId> obArray(2 * UINT8_MAX + 10, 1);
+    OCResourceHandle handle = (OCResourceHandle) &obArray;
+
+    EXPECT_EQ(OC_STACK_OK, NSNotifyListOfObservers(handle, obArray.data(), obArray.size(),
+            NULL, OC_LOW_QOS));
+    ASSERT_EQ(3u, batches.size());
+    EXPECT_EQ(obArray.data(), batches[0].first);
+    EXPECT_EQ(UINT8_MAX, batches[0].second);
+    EXPECT_EQ(obArray.data() + UINT8_MAX, batches[1].first);
+    EXPECT_EQ(UINT8_MAX, batches[1].second);
+    EXPECT_EQ(obArray.data() + 2 * UINT8_MAX, batches[2].first);
+    EXPECT_EQ(10, batches[2].second);
+
+    // the observers of the first batch are gone, the next batches are sent anyway.
+    batches.clear();
+    firstResult = OC_STACK_NO_OBSERVERS;
+    EXPECT_EQ(OC_STACK_ERROR, NSNotifyListOfObservers(handle, obArray.data(), obArray.size(),
+            NULL, OC_LOW_QOS));
+    EXPECT_EQ(3u, batches.size());
+
+    // a list exactly UINT8_MAX long is sent at once.
+    batches.clear();
+    firstResult = OC_STACK_OK;
+    EXPECT_EQ(OC_STACK_OK, NSNotifyListOfObservers(handle, obArray.data(), UINT8_MAX,
+            NULL, OC_LOW_QOS));
+    ASSERT_EQ(1u, batches.size());
+    EXPECT_EQ(UINT8_MAX, batches[0].second);
+}
@@ -51,6 +51,7 @@ namespace OIC
 
             Id post(DelayInMilliSec, Callback);
             bool cancel(Id);
+            bool reschedule(Id, DelayInMilliSec);
             void cancelAll();
 
             size_t getNumOfPending();
@@ -65,6 +65,15 @@ namespace OIC
             return ExpiryTimerImpl::getInstance()->cancel(id);
         }
 
+        bool ExpiryTimer::reschedule(Id id, DelayInMilliSec milliSec)
+        {
+            auto it = m_tasks.find(id);
+
+            if (it == m_tasks.end() || it->second->isExecuted()) return false;
+
+            return ExpiryTimerImpl::getInstance()->reschedule(id, milliSec);
+        }
+
         void ExpiryTimer::cancelAll()
         {
             sweep();
@@ -34,6 +34,7 @@ namespace OIC
 
         ExpiryTimerImpl::ExpiryTimerImpl() :
                 m_tasks{ },
+                m_taskIndex{ },
                 m_thread{ },
                 m_mutex{ },
                 m_cond{ },
@@ -49,6 +50,7 @@ namespace OIC
             {
                 std::lock_guard< std::mutex > lock{ m_mutex };
                 m_tasks.clear();
+                m_taskIndex.clear();
                 m_stop = true;
             }
             m_cond.notify_all();
@@ -82,15 +84,12 @@ namespace OIC
 
             std::lock_guard< std::mutex > lock{ m_mutex };
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end(); ++it)
-            {
-                if(it->second->getId() == id)
-                {
-                    m_tasks.erase(it);
-                    return true;
-                }
-            }
-            return false;
+            auto found = m_taskIndex.find(id);
+            if (found == m_taskIndex.end()) return false;
+
+            m_tasks.erase(found->second);
+            m_taskIndex.erase(found);
+            return true;
         }
 
         size_t ExpiryTimerImpl::cancelAll(
@@ -99,21 +98,40 @@ namespace OIC
             std::lock_guard< std::mutex > lock{ m_mutex };
             size_t erased { 0 };
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end();)
+            for (const auto& task : tasks)
             {
-                if(tasks.count(it->second))
+                auto found = m_taskIndex.find(task->getId());
+                if (found != m_taskIndex.end() && found->second->second == task)
                 {
-                    it = m_tasks.erase(it);
+                    m_tasks.erase(found->second);
+                    m_taskIndex.erase(found);
                     ++erased;
                 }
-                else
-                {
-                    ++it;
-                }
             }
             return erased;
         }
 
+        bool ExpiryTimerImpl::reschedule(Id id, DelayInMillis delay)
+        {
+            if (delay < 0LL)
+            {
+                throw RCSInvalidParameterException{ "delay can't be negative." };
+            }
+
+            if (id == INVALID_ID) return false;
+
+            std::lock_guard< std::mutex > lock{ m_mutex };
+
+            auto found = m_taskIndex.find(id);
+            if (found == m_taskIndex.end()) return false;
+
+            auto task = found->second->second;
+            m_tasks.erase(found->second);
+            insertTask(convertToTime(Milliseconds{ delay }), std::move(task));
+
+            return true;
+        }
+
         ExpiryTimerImpl::Milliseconds ExpiryTimerImpl::convertToTime(Milliseconds delay)
         {
             const auto now = std::chrono::system_clock::now();
@@ -126,19 +144,27 @@ namespace OIC
             std::lock_guard< std::mutex > lock{ m_mutex };
 
             auto newTask = std::make_shared< TimerTask >(id, std::move(cb));
-            m_tasks.insert({ delay, newTask });
-            m_cond.notify_all();
+            insertTask(delay, newTask);
 
             return newTask;
         }
 
-        bool ExpiryTimerImpl::containsId(Id id) const
+        void ExpiryTimerImpl::insertTask(Milliseconds delay, std::shared_ptr< TimerTask > task)
         {
-            for (const auto& info : m_tasks)
+            const Id id{ task->getId() };
+            auto it = m_tasks.insert({ delay, std::move(task) });
+            m_taskIndex[id] = it;
+
+            // the timer thread only needs to wake up if this is the next task to expire.
+            if (it == m_tasks.begin())
             {
-                if (info.second->getId() == id) return true;
+                m_cond.notify_all();
             }
-            return false;
+        }
+
+        bool ExpiryTimerImpl::containsId(Id id) const
+        {
+            return m_taskIndex.find(id) != m_taskIndex.end();
         }
 
         ExpiryTimerImpl::Id ExpiryTimerImpl::generateId()
@@ -163,6 +189,7 @@ namespace OIC
             auto it = m_tasks.begin();
             for (; it != m_tasks.end() && it->first <= now; ++it)
             {
+                m_taskIndex.erase(it->second->getId());
                 it->second->execute();
             }
 
@@ -28,6 +28,7 @@
 #include <chrono>
 #include <condition_variable>
 #include <random>
+#include <unordered_map>
 #include <unordered_set>
 #include <atomic>
 
@@ -63,11 +64,25 @@ namespace OIC
             bool cancel(Id);
             size_t cancelAll(const std::unordered_set< std::shared_ptr<TimerTask > >&);
 
+            /**
+             * Moves a pending task to a new delay, keeping its id and callback.
+             *
+             * @return false if the task was already executed or canceled.
+             */
+            bool reschedule(Id, DelayInMillis);
+
         private:
+            typedef std::multimap< Milliseconds, std::shared_ptr< TimerTask > > TaskMap;
+
             static Milliseconds convertToTime(Milliseconds);
 
             std::shared_ptr< TimerTask > addTask(Milliseconds, Callback, Id);
 
+            /**
+             * @pre The lock must be acquired with m_mutex.
+             */
+            void insertTask(Milliseconds, std::shared_ptr< TimerTask >);
+
             /**
              * @pre The lock must be acquired with m_mutex.
              */
@@ -87,7 +102,8 @@ namespace OIC
             void run();
 
         private:
-            std::multimap< Milliseconds, std::shared_ptr< TimerTask > > m_tasks;
+            TaskMap m_tasks;
+            std::unordered_map< Id, TaskMap::iterator > m_taskIndex;
 
             std::thread m_thread;
             std::mutex m_mutex;
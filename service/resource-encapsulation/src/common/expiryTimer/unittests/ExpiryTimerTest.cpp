@@ -186,6 +186,31 @@ TEST_F(ExpiryTimerImplTest, CallbackBeInvokedWithinToleranceWithMultiplePost)
     ASSERT_EQ(NUM_OF_POST, called);
 }
 
+TEST_F(ExpiryTimerImplTest, SlowCallbackDoesNotDelayOthersExpiringTogether)
+{
+    std::atomic_bool released{ false };
+    std::atomic_int called{ 0 };
+
+    ExpiryTimerImpl::getInstance()->post(10,
+            [this, &released](ExpiryTimerImpl::Id)
+            {
+                Wait(TOLERANCE_IN_MILLIS * 4);
+                released = true;
+            });
+    ExpiryTimerImpl::getInstance()->post(10,
+            [&called](ExpiryTimerImpl::Id)
+            {
+                ++called;
+            });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{ TOLERANCE_IN_MILLIS + 10 });
+
+    ASSERT_EQ(1, called);
+
+    Proceed();
+    while (!released) std::this_thread::yield();
+}
+
 class ExpiryTimerTest: public TestWithMock
 {
 public:
@@ -363,3 +388,48 @@ TEST_F(ExpiryTimerTest, AllTasksAreCancelledAfterTimerDestroyed)
 
     Wait(200);
 }
+
+TEST_F(ExpiryTimerTest, RescheduledTaskBeCalledAfterNewDelay)
+{
+    std::atomic_int called{ 0 };
+
+    auto id = timer.post(10,
+            [&called](ExpiryTimer::Id)
+            {
+                ++called;
+            });
+
+    ASSERT_TRUE(timer.reschedule(id, 150));
+    Wait(TOLERANCE_IN_MILLIS + 10);
+    ASSERT_EQ(0, called);
+
+    Wait(150 + TOLERANCE_IN_MILLIS);
+    ASSERT_EQ(1, called);
+}
+
+TEST_F(ExpiryTimerTest, RescheduleReturnsFalseIfAlreadyExecuted)
+{
+    FunctionObject* functor = mocks.Mock< FunctionObject >();
+
+    mocks.ExpectCall(functor, FunctionObject::execute).Do(
+        [this](ExpiryTimer::Id)
+        {
+            Proceed();
+        }
+    );
+
+    auto id = timer.post(1, std::bind(&FunctionObject::execute, functor, std::placeholders::_1));
+    Wait();
+
+    ASSERT_FALSE(timer.reschedule(id, 10));
+}
+
+TEST_F(ExpiryTimerTest, RescheduleReturnsFalseIfCanceled)
+{
+    FunctionObject* functor = mocks.Mock< FunctionObject >();
+
+    auto id = timer.post(10, std::bind(&FunctionObject::execute, functor, std::placeholders::_1));
+    timer.cancel(id);
+
+    ASSERT_FALSE(timer.reschedule(id, 10));
+}
@@ -221,8 +221,10 @@ namespace OIC
                 mode = CACHE_MODE::OBSERVE;
             }
 
-            networkTimer.cancel(networkTimeOutHandle);
-            networkTimeOutHandle = networkTimer.post(CACHE_DEFAULT_EXPIRED_MILLITIME, pTimerCB);
+            if (!networkTimer.reschedule(networkTimeOutHandle, CACHE_DEFAULT_EXPIRED_MILLITIME))
+            {
+                networkTimeOutHandle = networkTimer.post(CACHE_DEFAULT_EXPIRED_MILLITIME, pTimerCB);
+            }
 
             notifyObservers(_rep.getAttributes(), _result);
         }
@@ -243,9 +245,11 @@ namespace OIC
 
             if (mode != CACHE_MODE::OBSERVE)
             {
-                networkTimer.cancel(networkTimeOutHandle);
-                networkTimeOutHandle = networkTimer.post(
-                                           CACHE_DEFAULT_EXPIRED_MILLITIME, pTimerCB);
+                if (!networkTimer.reschedule(networkTimeOutHandle, CACHE_DEFAULT_EXPIRED_MILLITIME))
+                {
+                    networkTimeOutHandle = networkTimer.post(
+                                               CACHE_DEFAULT_EXPIRED_MILLITIME, pTimerCB);
+                }
 
                 pollingHandle = pollingTimer.post(CACHE_DEFAULT_REPORT_MILLITIME, pPollingCB);
             }
@@ -286,9 +290,11 @@ namespace OIC
                 sResource->cancelObserve();
                 mode = CACHE_MODE::FREQUENCY;
 
-                networkTimer.cancel(networkTimeOutHandle);
-                networkTimeOutHandle = networkTimer.post(
-                                           CACHE_DEFAULT_EXPIRED_MILLITIME, pTimerCB);
+                if (!networkTimer.reschedule(networkTimeOutHandle, CACHE_DEFAULT_EXPIRED_MILLITIME))
+                {
+                    networkTimeOutHandle = networkTimer.post(
+                                               CACHE_DEFAULT_EXPIRED_MILLITIME, pTimerCB);
+                }
 
                 pollingHandle = pollingTimer.post(CACHE_DEFAULT_REPORT_MILLITIME, pPollingCB);
                 return;